@@ -0,0 +1,79 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "ExpiryScheduler.h"
+#include "PwManager.h"
+#include "util/PwUtil.h"
+
+#include <QDateTime>
+#include <cstring>
+
+ExpiryScheduler::ExpiryScheduler(PwManager* pManager, QObject* parent)
+    : QObject(parent)
+    , m_pManager(pManager)
+    , m_bActive(false)
+{
+    std::memset(&m_tLastCheck, 0, sizeof(PW_TIME));
+
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);  // Coarse timers may fire early
+    connect(&m_timer, &QTimer::timeout, this, &ExpiryScheduler::onTimeout);
+}
+
+void ExpiryScheduler::start()
+{
+    PwUtil::getCurrentTime(&m_tLastCheck);
+    m_bActive = true;
+    reschedule();
+}
+
+void ExpiryScheduler::stop()
+{
+    m_bActive = false;
+    m_timer.stop();
+}
+
+void ExpiryScheduler::reschedule()
+{
+    if (!m_bActive || m_pManager == nullptr) {
+        return;
+    }
+
+    qint64 nInterval = MAX_INTERVAL_MS;
+    PW_TIME tNext;
+    if (m_pManager->findNextExpiry(&m_tLastCheck, &tNext)) {
+        // An entry counts as expired once the current time is past its
+        // expiration time, i.e. one second later. Invalid dates are only
+        // picked up by the regular check.
+        const QDateTime dtExpired = PwUtil::pwTimeToDateTime(&tNext).addSecs(1);
+        if (dtExpired.isValid()) {
+            nInterval = qBound<qint64>(0, QDateTime::currentDateTime().msecsTo(dtExpired), MAX_INTERVAL_MS);
+        }
+    }
+    m_timer.start(static_cast<int>(nInterval));
+}
+
+void ExpiryScheduler::onTimeout()
+{
+    if (!m_bActive || m_pManager == nullptr) {
+        return;
+    }
+
+    PW_TIME tNow;
+    PwUtil::getCurrentTime(&tNow);
+    const QList<quint32> vExpired = m_pManager->findEntriesExpiringIn(&m_tLastCheck, &tNow);
+    m_tLastCheck = tNow;
+
+    reschedule();
+    if (!vExpired.isEmpty()) {
+        emit entriesExpired(vExpired);
+    }
+}
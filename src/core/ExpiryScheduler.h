@@ -0,0 +1,107 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+/**
+ * @file ExpiryScheduler.h
+ * @brief Notification when entries of the open database expire
+ */
+
+#ifndef EXPIRYSCHEDULER_H
+#define EXPIRYSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+#include "PwStructs.h"
+
+class PwManager;
+
+/**
+ * @brief Emits entriesExpired() when entries of a database expire
+ *
+ * Instead of polling all entries, one single-shot timer is armed for the
+ * next expiration time after the last check (PwManager::findNextExpiry(),
+ * a binary search in the expiry index). When it fires, the entries that
+ * expired since the last check are reported and the timer is armed for
+ * the next one.
+ *
+ * @par Usage Example:
+ * @code
+ * ExpiryScheduler* scheduler = new ExpiryScheduler(pwManager, this);
+ * connect(scheduler, &ExpiryScheduler::entriesExpired, this, &MyClass::onEntriesExpired);
+ * scheduler->start();
+ * // ... after entries were added or changed:
+ * scheduler->reschedule();
+ * @endcode
+ *
+ * @note Backups and TAN entries are not reported (like findExpiredEntries())
+ */
+class ExpiryScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct a stopped scheduler
+     * @param pManager Database to watch; must outlive the scheduler's use
+     * @param parent Parent QObject for memory management
+     */
+    explicit ExpiryScheduler(PwManager* pManager, QObject* parent = nullptr);
+
+    /**
+     * @brief Start watching from now on
+     *
+     * Entries that have already expired are not reported.
+     */
+    void start();
+
+    /** @brief Stop watching (e.g. when the database is locked or closed) */
+    void stop();
+
+    /**
+     * @brief Re-arm the timer after entries were added or changed
+     *
+     * Cheap (one binary search); does nothing while stopped.
+     */
+    void reschedule();
+
+    [[nodiscard]] bool isActive() const { return m_bActive; }
+
+    /**
+     * @brief Milliseconds until the next check
+     * @return -1 if no check is scheduled
+     */
+    [[nodiscard]] int remainingTime() const { return m_timer.remainingTime(); }
+
+    /**
+     * @brief Longest time between two checks, so changes of the system
+     *        clock are picked up
+     */
+    static constexpr int MAX_INTERVAL_MS = 60 * 60 * 1000;
+
+signals:
+    /**
+     * @brief Emitted when entries have expired since the last check
+     * @param vIndexes Indexes of these entries, ascending
+     */
+    void entriesExpired(const QList<quint32>& vIndexes);
+
+private slots:
+    void onTimeout();
+
+private:
+    PwManager* m_pManager;
+    QTimer m_timer;
+    PW_TIME m_tLastCheck;  // Entries expiring before this have been handled
+    bool m_bActive;
+};
+
+#endif // EXPIRYSCHEDULER_H
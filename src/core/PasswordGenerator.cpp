@@ -116,7 +116,7 @@ QString PasswordGenerator::generate(const PasswordGeneratorSettings& settings, Q
 
         do {
             // Get random index in character set
-            quint32 index = Random::generateUInt32() % charSet.length();
+            quint32 index = Random::uniform(static_cast<quint32>(charSet.length()));
             ch = charSet.at(index);
 
             // If no repeat is enabled, check if we've used this character
@@ -321,7 +321,7 @@ void PasswordGenerator::shuffleString(QString& str)
 {
     // Fisher-Yates shuffle
     for (int i = str.length() - 1; i > 0; --i) {
-        int j = Random::generateUInt32() % (i + 1);
+        int j = static_cast<int>(Random::uniform(static_cast<quint32>(i + 1)));
         QChar temp = str[i];
         str[i] = str[j];
         str[j] = temp;
@@ -486,7 +486,7 @@ QString PasswordGenerator::generateFromPattern(const PasswordGeneratorSettings&
                 }
             }
 
-            int index = Random::generateUInt32() % currentCharSet.length();
+            int index = static_cast<int>(Random::uniform(static_cast<quint32>(currentCharSet.length())));
             QChar generated = currentCharSet[index];
             result += generated;
 
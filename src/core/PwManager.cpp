@@ -10,11 +10,13 @@
 */
 
 #include "PwManager.h"
+#include "PwSearchPlan.h"
+#include "SysDefEx.h"
 #include "crypto/KeyTransform.h"
 #include "crypto/MemoryProtection.h"
 #include "crypto/SHA256.h"
-#include "crypto/Rijndael.h"
-#include "crypto/TwofishClass.h"
+#include "crypto/CipherBackend.h"
+#include "crypto/PayloadKernels.h"
 #include "util/Random.h"
 #include "util/MemUtil.h"
 #include "util/PwUtil.h"
@@ -22,7 +24,12 @@
 #include <QFile>
 #include <QDateTime>
 #include <QDebug>
-#include <QRegularExpression>
+#include <QCollator>
+#include <QFutureInterface>
+#include <QRunnable>
+#include <QThreadPool>
+#include <algorithm>
+#include <numeric>
 #include <cstring>
 #include <cstdlib>
 
@@ -31,18 +38,240 @@ namespace {
     constexpr quint32 INITIAL_ENTRIES = 256;
     constexpr quint32 INITIAL_GROUPS = 32;
     constexpr DWORD DWORD_MAX = 0xFFFFFFFF;  // Maximum value for DWORD (quint32)
-}
+
+    PwGroupTreeNode makeGroupTreeNode(quint32 dwParent)
+    {
+        return PwGroupTreeNode{ dwParent, DWORD_MAX, DWORD_MAX, DWORD_MAX, 0, 0, {} };
+    }
+
+    // Writes KDB v1.x fields (type, size, data) into a buffer that the
+    // caller has sized beforehand. Strings are copied as stored (UTF-8).
+    class RecordWriter
+    {
+    public:
+        RecordWriter(char* pBuffer, quint32 dwPos) : m_pBuffer(pBuffer), m_dwPos(dwPos) {}
+
+        void field(USHORT usFieldType, const void* pData, DWORD dwFieldSize)
+        {
+            // fieldType (USHORT, 2 bytes) and fieldSize (DWORD, 4 bytes) must match the exact binary layout
+            std::memcpy(&m_pBuffer[m_dwPos], &usFieldType, 2); m_dwPos += 2;
+            std::memcpy(&m_pBuffer[m_dwPos], &dwFieldSize, 4); m_dwPos += 4;
+            if (pData != nullptr && dwFieldSize > 0) {
+                std::memcpy(&m_pBuffer[m_dwPos], pData, dwFieldSize);
+            }
+            m_dwPos += dwFieldSize;
+        }
+
+        void stringField(USHORT usFieldType, const char* psz, size_t uLength)
+        {
+            field(usFieldType, psz, static_cast<DWORD>(uLength + 1));  // Includes the terminator
+        }
+
+        void stringField(USHORT usFieldType, const char* psz)
+        {
+            stringField(usFieldType, psz, std::strlen(psz));
+        }
+
+        void timeField(USHORT usFieldType, const PW_TIME* pTime)
+        {
+            quint8 compressedTime[5];
+            PwUtil::packTime(pTime, compressedTime);
+            field(usFieldType, compressedTime, 5);
+        }
+
+        [[nodiscard]] quint32 pos() const { return m_dwPos; }
+
+    private:
+        char* m_pBuffer;
+        quint32 m_dwPos;
+    };
+
+    // openDatabase reads, decrypts and hashes the file in pieces of this size,
+    // small enough for a piece to stay in the L2 cache between the steps
+    constexpr quint32 OPEN_CHUNK_SIZE = 64 * 1024;
+
+    // Larger payloads are decrypted on several threads, in pieces of
+    // PARALLEL_CHUNK_SIZE that the parallel decryptor splits further
+    constexpr quint32 PARALLEL_DECRYPT_THRESHOLD = 4 * 1024 * 1024;
+    constexpr quint32 PARALLEL_CHUNK_SIZE = 1024 * 1024;
+
+    // saveDatabase encrypts and writes the payload in pieces of this size,
+    // reporting progress after each one
+    constexpr quint32 SAVE_PIECE_SIZE = 1024 * 1024;
+
+    // Passes progress on to a PwManager::ProgressCallback (if any), skipping
+    // repeated percentages, and remembers whether the callback canceled
+    class ProgressReporter
+    {
+    public:
+        explicit ProgressReporter(const PwManager::ProgressCallback& fnProgress) : m_fnProgress(fnProgress) {}
+
+        // @return false once the operation has been canceled
+        bool report(PwManager::OperationStage eStage, quint64 qwDone, quint64 qwTotal)
+        {
+            if (!m_fnProgress || m_bCanceled)
+                return !m_bCanceled;
+
+            const int nPercent = (qwTotal == 0) ? 100 : static_cast<int>(qMin(qwDone, qwTotal) * 100 / qwTotal);
+            if (eStage == m_eLastStage && nPercent == m_nLastPercent)
+                return true;
+            m_eLastStage = eStage;
+            m_nLastPercent = nPercent;
+
+            m_bCanceled = !m_fnProgress(eStage, nPercent);
+            return !m_bCanceled;
+        }
+
+        // Callback for transformKey(); empty without a progress callback, so
+        // that the key is transformed in one go
+        PwManager::ProgressCallback forward()
+        {
+            if (!m_fnProgress)
+                return PwManager::ProgressCallback();
+            return [this](PwManager::OperationStage eStage, int nPercent) {
+                return report(eStage, static_cast<quint64>(nPercent), 100);
+            };
+        }
+
+        [[nodiscard]] bool isCanceled() const { return m_bCanceled; }
+
+    private:
+        const PwManager::ProgressCallback& m_fnProgress;
+        PwManager::OperationStage m_eLastStage = PwManager::OperationStage::Read;
+        int m_nLastPercent = -1;
+        bool m_bCanceled = false;
+    };
+
+    // Cipher of the database payload for ALGO_AES / ALGO_TWOFISH
+    CipherBackend::Cipher payloadCipher(int nAlgorithm)
+    {
+        return (nAlgorithm == ALGO_TWOFISH) ? CipherBackend::Cipher::Twofish256 : CipherBackend::Cipher::Aes256;
+    }
+
+    // Geometric (1.5x) growth keeps repeated appends amortized O(1)
+    quint32 grownCapacity(quint32 uCurrent, quint32 uRequired, quint32 uInitial)
+    {
+        quint64 uGrown = qMax<quint64>(static_cast<quint64>(uCurrent) + uCurrent / 2, uInitial);
+        uGrown = qMax<quint64>(uGrown, uRequired);
+        return static_cast<quint32>(qMin<quint64>(uGrown, DWORD_MAX - 1));
+    }
+
+    bool isZeroUuid(const BYTE* pUuid)
+    {
+        for (int i = 0; i < 16; ++i) {
+            if (pUuid[i] != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Map nullptr string fields to empty strings (setEntry requires them)
+    void mapNullStringsToEmpty(PW_ENTRY* pEntry)
+    {
+        static const char emptyString[] = "";
+        if (pEntry->pszTitle == nullptr)
+            pEntry->pszTitle = const_cast<char*>(emptyString);
+        if (pEntry->pszUserName == nullptr)
+            pEntry->pszUserName = const_cast<char*>(emptyString);
+        if (pEntry->pszURL == nullptr)
+            pEntry->pszURL = const_cast<char*>(emptyString);
+        if (pEntry->pszPassword == nullptr)
+            pEntry->pszPassword = const_cast<char*>(emptyString);
+        if (pEntry->pszAdditional == nullptr)
+            pEntry->pszAdditional = const_cast<char*>(emptyString);
+        if (pEntry->pszBinaryDesc == nullptr)
+            pEntry->pszBinaryDesc = const_cast<char*>(emptyString);
+    }
+}
+
+// State of one save between prepareSave() and commitSave(). It has its own
+// copy of the keys, so runSave() does not touch the PwManager.
+struct PwManager::SaveJob
+{
+    QString strFilePath;
+    char* pBuffer = nullptr;    // SecureArena block: header and payload
+    quint32 dwBufferSize = 0;
+    quint32 dwPayloadEnd = 0;   // End of the serialized payload (unpadded)
+    PW_DBHEADER hdr;
+    int nAlgorithm = ALGO_AES;
+    bool bReuseTransformedKey = false;
+    SecureMemory<quint8> keys;  // Master key, then the transformed key
+
+    SaveJob() : keys(64) { std::memset(&hdr, 0, sizeof(PW_DBHEADER)); }
+    ~SaveJob() { SecureArena::release(pBuffer); }  // Erases the buffer
+
+    SaveJob(const SaveJob&) = delete;
+    SaveJob& operator=(const SaveJob&) = delete;
+
+    quint8* masterKey() { return keys.data(); }
+    const quint8* masterKey() const { return keys.data(); }
+    quint8* transformedKey() { return keys.data() + 32; }
+    const quint8* transformedKey() const { return keys.data() + 32; }
+};
+
+// Shared by the PwManager and the worker thread of one asynchronous
+// operation. The worker only touches pStaging or pSaveJob.
+struct PwManager::AsyncOperation
+{
+    QFutureInterface<int> future;
+    std::unique_ptr<PwManager> pStaging;  // openDatabaseAsync: the database being opened
+    std::unique_ptr<SaveJob> pSaveJob;    // saveDatabaseAsync: the serialized database
+    int nResult = PWE_UNKNOWN;
+
+    AsyncOperation()
+    {
+        future.reportStarted();
+        future.setProgressRange(0, PROGRESS_MAXIMUM);
+    }
+
+    void finish(int nError)
+    {
+        nResult = nError;
+        future.reportResult(nError);
+        future.reportFinished();
+    }
+
+    // Reports to the future; canceling the future cancels the operation
+    ProgressCallback progressCallback()
+    {
+        return [this](OperationStage eStage, int nPercent) {
+            future.setProgressValue(encodeProgress(eStage, nPercent));
+            return !future.isCanceled();
+        };
+    }
+
+    // Run fnWork on the global thread pool and finish with its result
+    static void start(const std::shared_ptr<AsyncOperation>& pOp, const std::function<int()>& fnWork)
+    {
+        QThreadPool::globalInstance()->start(QRunnable::create([pOp, fnWork]() {
+            pOp->finish(fnWork());
+        }));
+    }
+};
 
 PwManager::PwManager()
     : m_pEntries(nullptr)
     , m_maxEntries(0)
     , m_numEntries(0)
+    , m_bSearchIndexValid(false)
+    , m_bSearchIndexPasswords(false)
+    , m_bFoldedTextValid(false)
+    , m_bExpiryIndexValid(false)
+    , m_uContentVersion(0)
     , m_pGroups(nullptr)
     , m_maxGroups(0)
     , m_numGroups(0)
+    , m_groupTreeRoot(makeGroupTreeNode(DWORD_MAX))
     , m_pLastEditedEntry(nullptr)
+    , m_keyMemory(PWM_SESSION_KEY_SIZE + 32 + 32)
+    , m_sessionKey(m_keyMemory.data())
+    , m_masterKey(m_sessionKey + PWM_SESSION_KEY_SIZE)
+    , m_transformedMasterKey(m_masterKey + 32)
+    , m_uPasswordNonceCounter(0)
     , m_nAlgorithm(ALGO_AES)
     , m_keyEncRounds(PWM_STD_KEYENCROUNDS)
+    , m_bTransformedKeyValid(false)
+    , m_bFastResave(false)
     , m_bUseTransactedFileWrites(true)
     , m_clr(Qt::white)
 {
@@ -58,6 +287,9 @@ PwManager::PwManager()
     std::memset(m_masterKey, 0, 32);
     std::memset(m_transformedMasterKey, 0, 32);
 
+    // Passwords and the other text fields go to locked SecureArena slabs
+    m_stringArena.setLockMemory(true);
+
     // Initialize UUID arrays
     std::memset(m_aLastSelectedEntryUuid, 0, 16);
     std::memset(m_aLastTopVisibleEntryUuid, 0, 16);
@@ -65,12 +297,21 @@ PwManager::PwManager()
     m_dwLastSelectedGroupId = 0;
     m_dwLastTopVisibleGroupId = 0;
 
-    // Generate session key for in-memory password encryption
+    // Generate session keys for in-memory key and password encryption
     Random::fillBuffer(m_sessionKey, PWM_SESSION_KEY_SIZE);
+
+    quint8 aPasswordKey[32];
+    Random::fillBuffer(aPasswordKey, 32);
+    m_passwordCipher.setKey(aPasswordKey);
+    MemUtil::mem_erase(aPasswordKey, 32);
 }
 
 PwManager::~PwManager()
 {
+    // A pending asynchronous operation only works on its own data
+    if (m_pAsyncOp)
+        m_pAsyncOp->future.cancel();
+
     cleanUp();
 
     // Securely erase sensitive data
@@ -88,9 +329,11 @@ void PwManager::initPrimaryInstance()
 
 void PwManager::cleanUp()
 {
-    // Delete all entries and groups
+    // Delete all entries and groups, then erase and free all their strings
+    // in one go (the lists only free what lives outside the arena)
     deleteEntryList(true);
     deleteGroupList(true);
+    m_stringArena.clear();
 
     m_pLastEditedEntry = nullptr;
 
@@ -124,19 +367,10 @@ void PwManager::deleteEntryList(bool bFreeStrings)
         for (quint32 i = 0; i < m_numEntries; ++i) {
             PW_ENTRY* e = &m_pEntries[i];
 
-            // Unlock password before freeing (if it was locked)
-            if (e->pszPassword && e->uPasswordLen > 0) {
-                unlockEntryPassword(e);
-            }
-
-            // Free strings
-            delete[] e->pszTitle;
-            delete[] e->pszURL;
-            delete[] e->pszUserName;
-            delete[] e->pszPassword;
-            delete[] e->pszAdditional;
+            // Free the attachment; the text fields belong to m_stringArena,
+            // which cleanUp() releases as a whole
             delete[] e->pszBinaryDesc;
-            delete[] e->pBinaryData;
+            SecureArena::release(e->pBinaryData);
 
             // Zero out the structure
             std::memset(e, 0, sizeof(PW_ENTRY));
@@ -147,6 +381,13 @@ void PwManager::deleteEntryList(bool bFreeStrings)
     m_pEntries = nullptr;
     m_maxEntries = 0;
     m_numEntries = 0;
+    m_uuidIndex.clear();
+    m_passwordNonces.clear();
+    m_groupEntries.clear();
+    invalidateSearchIndex();
+    invalidateFoldedText();
+    invalidateExpiryIndex();
+    ++m_uContentVersion;
 }
 
 void PwManager::allocGroups(quint32 uGroups)
@@ -167,21 +408,21 @@ void PwManager::deleteGroupList(bool bFreeStrings)
         return;
 
     if (bFreeStrings) {
-        for (quint32 i = 0; i < m_numGroups; ++i) {
-            PW_GROUP* g = &m_pGroups[i];
-
-            // Free strings
-            delete[] g->pszGroupName;
-
-            // Zero out the structure
-            std::memset(g, 0, sizeof(PW_GROUP));
-        }
+        // Group names belong to m_stringArena, which cleanUp() releases
+        // as a whole; only the structures need erasing here
+        MemUtil::mem_erase(m_pGroups, m_numGroups * sizeof(PW_GROUP));
     }
 
     delete[] m_pGroups;
     m_pGroups = nullptr;
     m_maxGroups = 0;
     m_numGroups = 0;
+
+    m_vGroupTree.clear();
+    m_groupTreeRoot = makeGroupTreeNode(DWORD_MAX);
+    m_groupIdIndex.clear();
+    m_groupNameIndex.clear();
+    ++m_uContentVersion;
 }
 
 quint32 PwManager::getNumberOfEntries() const
@@ -210,27 +451,85 @@ PW_GROUP* PwManager::getGroup(quint32 dwIndex)
 
 void PwManager::lockEntryPassword(PW_ENTRY* pEntry)
 {
-    if (!pEntry || !pEntry->pszPassword || pEntry->uPasswordLen == 0)
+    if (pEntry == nullptr) {
+        cryptEntryPasswords(nullptr, m_numEntries);
         return;
-
-    // XOR password bytes with session key
-    // This is a simple but effective in-memory encryption
-    quint8* password = reinterpret_cast<quint8*>(pEntry->pszPassword);
-    for (quint32 i = 0; i < pEntry->uPasswordLen; ++i) {
-        password[i] ^= m_sessionKey[i % PWM_SESSION_KEY_SIZE];
     }
+    if (!pEntry->pszPassword || pEntry->uPasswordLen == 0)
+        return;
+
+    // XOR the password bytes with the keystream of the entry
+    m_passwordCipher.crypt(passwordNonce(pEntry), reinterpret_cast<quint8*>(pEntry->pszPassword),
+                           pEntry->uPasswordLen);
 }
 
 void PwManager::unlockEntryPassword(PW_ENTRY* pEntry)
 {
-    if (!pEntry || !pEntry->pszPassword || pEntry->uPasswordLen == 0)
-        return;
+    // XOR again to restore the original (CTR mode is its own inverse)
+    lockEntryPassword(pEntry);
+}
+
+bool PwManager::decryptEntryPassword(const PW_ENTRY* pEntry, char* pBuffer) const
+{
+    if (!pEntry || !pEntry->pszPassword || !pBuffer)
+        return false;
 
-    // XOR again to restore original (XOR is reversible)
-    quint8* password = reinterpret_cast<quint8*>(pEntry->pszPassword);
-    for (quint32 i = 0; i < pEntry->uPasswordLen; ++i) {
-        password[i] ^= m_sessionKey[i % PWM_SESSION_KEY_SIZE];
+    std::memcpy(pBuffer, pEntry->pszPassword, pEntry->uPasswordLen);
+    if (!m_passwordCipher.crypt(passwordNonce(pEntry), reinterpret_cast<quint8*>(pBuffer), pEntry->uPasswordLen)) {
+        MemUtil::mem_erase(pBuffer, pEntry->uPasswordLen);
+        return false;
+    }
+    return true;
+}
+
+void PwManager::cryptEntryPasswords(const quint32* pIndices, quint32 dwCount)
+{
+    // The batch encrypts the counter blocks of many short passwords together
+    ProtectedStringCipher::Batch batch(m_passwordCipher);
+    for (quint32 i = 0; i < dwCount; ++i) {
+        PW_ENTRY* pEntry = &m_pEntries[(pIndices != nullptr) ? pIndices[i] : i];
+        if (pEntry->pszPassword != nullptr) {
+            batch.add(passwordNonce(pEntry), reinterpret_cast<quint8*>(pEntry->pszPassword), pEntry->uPasswordLen);
+        }
+    }
+}
+
+const quint8* PwManager::passwordNonce(const PW_ENTRY* pEntry) const
+{
+    // setEntry() gives every stored password a nonce; the zero nonce only
+    // keeps locking and unlocking symmetric should one be missing
+    static const PasswordNonce s_zeroNonce = {};
+    const auto it = m_passwordNonces.constFind(pEntry->pszPassword);
+    return (it != m_passwordNonces.constEnd()) ? it.value().aBytes : s_zeroNonce.aBytes;
+}
+
+void PwManager::renewPasswordNonce(const PW_ENTRY* pEntry)
+{
+    // The counter fills the upper half of the nonce; CTR mode counts its
+    // blocks in the lower half, so the keystreams of two nonces never overlap
+    PasswordNonce& nonce = m_passwordNonces[pEntry->pszPassword];
+    const quint64 uCounter = ++m_uPasswordNonceCounter;
+    for (int i = 0; i < 8; ++i) {
+        nonce.aBytes[i] = static_cast<quint8>(uCounter >> (56 - 8 * i));
     }
+    std::memset(nonce.aBytes + 8, 0, 8);
+}
+
+PwUnlockedPassword::PwUnlockedPassword(const PwManager* pMgr, const PW_ENTRY* pEntry)
+{
+    if (pMgr == nullptr || pEntry == nullptr || pEntry->pszPassword == nullptr || pEntry->uPasswordLen == 0)
+        return;
+
+    // Only this entry's bytes are decrypted, straight into the copy
+    m_baPassword.resize(static_cast<int>(pEntry->uPasswordLen));
+    if (!pMgr->decryptEntryPassword(pEntry, m_baPassword.data()))
+        m_baPassword.clear();
+}
+
+PwUnlockedPassword::~PwUnlockedPassword()
+{
+    if (!m_baPassword.isEmpty())
+        MemUtil::mem_erase(m_baPassword.data(), static_cast<size_t>(m_baPassword.size()));
 }
 
 void PwManager::newDatabase()
@@ -253,6 +552,7 @@ void PwManager::newDatabase()
     Random::fillBuffer(m_dbLastHeader.aMasterSeed, 16);
     Random::fillBuffer(m_dbLastHeader.aEncryptionIV, 16);
     Random::fillBuffer(m_dbLastHeader.aMasterSeed2, 32);
+    m_bTransformedKeyValid = false;
 
     m_numEntries = 0;
     m_numGroups = 0;
@@ -307,6 +607,9 @@ int PwManager::setMasterKey(const QString& masterKey, bool bDiskDrive,
         std::memcpy(m_masterKey, keyData.constData(), 32);
     }
 
+    // The cached transformed key belongs to the old master key
+    m_bTransformedKeyValid = false;
+
     return PWE_SUCCESS;
 }
 
@@ -364,25 +667,43 @@ void PwManager::setDefaultUserName(const QString& strUserName)
     m_strDefaultUserName = strUserName;
 }
 
-bool PwManager::transformMasterKey(const quint8* pKeySeed)
+bool PwManager::transformMasterKey(const quint8* pKeySeed, const ProgressCallback& fnProgress)
 {
     if (!pKeySeed)
         return false;
 
-    // Copy master key to transformed key buffer
-    std::memcpy(m_transformedMasterKey, m_masterKey, 32);
+    // Valid again once the header using pKeySeed is stored in m_dbLastHeader
+    m_bTransformedKeyValid = false;
 
-    // Perform key transformation using OpenSSL
-    if (!KeyTransform::transform256(m_keyEncRounds, m_transformedMasterKey, pKeySeed)) {
-        MemUtil::mem_erase(m_transformedMasterKey, 32);
+    return transformKey(m_masterKey, m_keyEncRounds, pKeySeed, m_transformedMasterKey, fnProgress);
+}
+
+bool PwManager::transformKey(const quint8* pMasterKey32, quint32 dwRounds, const quint8* pKeySeed32,
+                             quint8* pTransformedKey32, const ProgressCallback& fnProgress)
+{
+    // Copy master key to transformed key buffer
+    std::memcpy(pTransformedKey32, pMasterKey32, 32);
+
+    // Perform key transformation using OpenSSL; with a progress callback in
+    // slices, so that it can be canceled
+    bool bTransformed;
+    if (fnProgress) {
+        bTransformed = KeyTransform::transform256(dwRounds, pTransformedKey32, pKeySeed32,
+            [&fnProgress](quint64 qwDone, quint64 qwTotal) {
+                return fnProgress(OperationStage::KeyTransform, static_cast<int>(qwDone * 100 / qwTotal));
+            });
+    } else {
+        bTransformed = KeyTransform::transform256(dwRounds, pTransformedKey32, pKeySeed32);
+    }
+    if (!bTransformed) {
+        MemUtil::mem_erase(pTransformedKey32, 32);
         return false;
     }
 
     // Hash the transformed key with SHA-256
-    QByteArray transformedHash = SHA256::hash(
-        QByteArray(reinterpret_cast<const char*>(m_transformedMasterKey), 32));
-
-    std::memcpy(m_transformedMasterKey, transformedHash.constData(), 32);
+    SHA256::Context keyHash;
+    keyHash.update(pTransformedKey32, 32);
+    keyHash.finalize(pTransformedKey32);
 
     return true;
 }
@@ -406,12 +727,20 @@ void PwManager::protectTransformedMasterKey(bool bProtectKey)
 }
 
 int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
+{
+    return openDatabase(filePath, pRepair, ProgressCallback());
+}
+
+int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair,
+                            const ProgressCallback& fnProgress)
 {
     // Reference: MFC/MFC-KeePass/KeePassLibCpp/Details/PwFileImpl.cpp:86-371
 
     if (filePath.isEmpty())
         return PWE_INVALID_PARAM;
 
+    ProgressReporter progress(fnProgress);
+
     // Initialize repair info
     if (pRepair)
         std::memset(pRepair, 0, sizeof(PWDB_REPAIR_INFO));
@@ -427,55 +756,32 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
         return PWE_INVALID_FILEHEADER;
     }
 
-    // Allocate memory to hold complete file (with extra buffer space)
-    quint32 uAllocated = (quint32)uFileSize + 16 + 1 + 64 + 4;
-    char* pVirtualFile = new char[uAllocated];
-    if (!pVirtualFile) {
-        file.close();
-        return PWE_NO_MEM;
-    }
-    std::memset(&pVirtualFile[uFileSize + 16], 0, 1 + 64);
-
-    // Read entire file into memory
-    if (file.read(pVirtualFile, uFileSize) != uFileSize) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
+    // Read the header structure; the encrypted part is streamed in below
+    PW_DBHEADER hdr;
+    if (file.read(reinterpret_cast<char*>(&hdr), sizeof(PW_DBHEADER)) != (qint64)sizeof(PW_DBHEADER)) {
         file.close();
         return PWE_FILEERROR_READ;
     }
-    file.close();
-
-    // Extract header structure
-    PW_DBHEADER hdr;
-    std::memcpy(&hdr, pVirtualFile, sizeof(PW_DBHEADER));
 
     // Check if it's a KDBX file (KeePass 2.x)
     if ((hdr.dwSignature1 == PWM_DBSIG_1_KDBX_P && hdr.dwSignature2 == PWM_DBSIG_2_KDBX_P) ||
         (hdr.dwSignature1 == PWM_DBSIG_1_KDBX_R && hdr.dwSignature2 == PWM_DBSIG_2_KDBX_R)) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
         m_keyEncRounds = PWM_STD_KEYENCROUNDS;
         return PWE_UNSUPPORTED_KDBX;
     }
 
     // Check if we can open this (KDB v1.x)
     if (hdr.dwSignature1 != PWM_DBSIG_1 || hdr.dwSignature2 != PWM_DBSIG_2) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
         m_keyEncRounds = PWM_STD_KEYENCROUNDS;
         return PWE_INVALID_FILESIGNATURE;
     }
 
     // Check version (allow minor version differences)
     if ((hdr.dwVersion & 0xFFFFFF00) != (PWM_DBVER_DW & 0xFFFFFF00)) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
         return PWE_INVALID_FILEHEADER;
     }
 
     if (hdr.dwGroups == 0) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
         m_keyEncRounds = PWM_STD_KEYENCROUNDS;
         return PWE_DB_EMPTY;
     }
@@ -486,35 +792,32 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
     else if (hdr.dwFlags & PWM_FLAG_TWOFISH)
         m_nAlgorithm = ALGO_TWOFISH;
     else {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
         return PWE_INVALID_FILESTRUCTURE;
     }
 
+    if (!progress.report(OperationStage::Read, 1, 1)) {
+        return PWE_CANCELED;
+    }
+
     m_keyEncRounds = hdr.dwKeyEncRounds;
 
     // Generate transformed master key from master key
-    if (!transformMasterKey(hdr.aMasterSeed2)) {
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
-        return PWE_CRYPT_ERROR;
+    if (!transformMasterKey(hdr.aMasterSeed2, progress.forward())) {
+        return progress.isCanceled() ? PWE_CANCELED : PWE_CRYPT_ERROR;
     }
 
     // Hash the master password with the salt in the file
     // Crypto library interface: UINT8 matches Rijndael/Twofish crypto library expectations
     UINT8 uFinalKey[32];
-    QByteArray masterSeed = QByteArray(reinterpret_cast<const char*>(hdr.aMasterSeed), 16);
-    QByteArray transformedKey = QByteArray(reinterpret_cast<const char*>(m_transformedMasterKey), 32);
-    QByteArray combined = masterSeed + transformedKey;
-    QByteArray finalHash = SHA256::hash(combined);
-    std::memcpy(uFinalKey, finalHash.constData(), 32);
+    SHA256::Context keyHash;
+    keyHash.update(hdr.aMasterSeed, 16);
+    keyHash.update(m_transformedMasterKey, 32);
+    keyHash.finalize(uFinalKey);
 
     // Verify encrypted part size is a multiple of 16 bytes
     if (pRepair == nullptr) {
         if (((uFileSize - sizeof(PW_DBHEADER)) % 16) != 0) {
             MemUtil::mem_erase(uFinalKey, 32);
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
             m_keyEncRounds = PWM_STD_KEYENCROUNDS;
             return PWE_INVALID_FILESIZE;
         }
@@ -529,93 +832,107 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
         pRepair->dwOriginalEntryCount = hdr.dwEntries;
     }
 
-    // Decrypt the database
+    // Set up the decryption of the (possibly truncated) encrypted part
+    const quint32 uEncryptedSize = (quint32)uFileSize - sizeof(PW_DBHEADER);
+    const bool bParallel = (uEncryptedSize >= PARALLEL_DECRYPT_THRESHOLD);
+    const quint32 uPieceSize = bParallel ? PARALLEL_CHUNK_SIZE : OPEN_CHUNK_SIZE;
+    std::unique_ptr<CipherBackend> pCipher = bParallel
+        ? CipherBackend::createParallelDecryptor(payloadCipher(m_nAlgorithm))
+        : CipherBackend::create(payloadCipher(m_nAlgorithm));
+    const bool bCipherReady = pCipher->init(false, uFinalKey, hdr.aEncryptionIV);
+    MemUtil::mem_erase(uFinalKey, 32);
+    if (!bCipherReady) {
+        m_keyEncRounds = PWM_STD_KEYENCROUNDS;
+        return PWE_CRYPT_ERROR;
+    }
+
+    // Allocate memory to hold the header and the decrypted data (with extra buffer space)
+    quint32 uAllocated = (quint32)uFileSize + 16 + 1 + 64 + 4;
+    SecureMemory<char> virtualFile(uAllocated);  // Locked, erased when it goes out of scope
+    char* pVirtualFile = virtualFile.data();
+    std::memcpy(pVirtualFile, &hdr, sizeof(PW_DBHEADER));
+    std::memset(&pVirtualFile[uFileSize], 0, uAllocated - uFileSize);
+
+    // Read, decrypt (in place) and hash the encrypted part piece by piece,
+    // so that each piece is still in the cache for the next step
+    SHA256::Context contentHash;
     quint32 uEncryptedPartSize = 0;
+    bool bPaddingValid = true;
 
-    if (m_nAlgorithm == ALGO_AES) {
-        CRijndael aes;
-        if (aes.Init(CRijndael::CBC, CRijndael::DecryptDir, uFinalKey,
-                     CRijndael::Key32Bytes, hdr.aEncryptionIV) != RIJNDAEL_SUCCESS) {
-            MemUtil::mem_erase(uFinalKey, 32);
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
-            m_keyEncRounds = PWM_STD_KEYENCROUNDS;
-            return PWE_CRYPT_ERROR;
+    for (quint32 uDone = 0; uDone < uEncryptedSize; ) {
+        const quint32 uChunk = qMin(uPieceSize, uEncryptedSize - uDone);
+        UINT8* pChunk = reinterpret_cast<UINT8*>(pVirtualFile) + sizeof(PW_DBHEADER) + uDone;
+
+        if (file.read(reinterpret_cast<char*>(pChunk), uChunk) != (qint64)uChunk) {
+            return PWE_FILEERROR_READ;
         }
+        uDone += uChunk;
 
-        uEncryptedPartSize = (DWORD)aes.PadDecrypt(
-            (UINT8*)pVirtualFile + sizeof(PW_DBHEADER),
-            uFileSize - sizeof(PW_DBHEADER),
-            (UINT8*)pVirtualFile + sizeof(PW_DBHEADER));
-    } else if (m_nAlgorithm == ALGO_TWOFISH) {
-        CTwofish twofish;
-        if (!twofish.Init(uFinalKey, 32, hdr.aEncryptionIV)) {
-            MemUtil::mem_erase(uFinalKey, 32);
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+        // The last piece carries the padding
+        const bool bLastPiece = (uDone == uEncryptedSize);
+        const qint64 nPlainSize = PayloadKernels::decryptThenHash(
+            *pCipher, (pRepair == nullptr) ? &contentHash : nullptr, pChunk, uChunk, bLastPiece, uPieceSize);
+        if (nPlainSize < 0 && !bLastPiece) {
             m_keyEncRounds = PWM_STD_KEYENCROUNDS;
             return PWE_CRYPT_ERROR;
         }
 
-        uEncryptedPartSize = (DWORD)twofish.PadDecrypt(
-            (UINT8*)pVirtualFile + sizeof(PW_DBHEADER),
-            uFileSize - sizeof(PW_DBHEADER),
-            (UINT8*)pVirtualFile + sizeof(PW_DBHEADER));
-    } else {
-        MemUtil::mem_erase(uFinalKey, 32);
-        MemUtil::mem_erase(pVirtualFile, uAllocated);
-        delete[] pVirtualFile;
-        return PWE_INVALID_FILESTRUCTURE;
-    }
-
-    MemUtil::mem_erase(uFinalKey, 32);
+        bPaddingValid = (nPlainSize >= 0);
+        if (bPaddingValid)
+            uEncryptedPartSize += static_cast<quint32>(nPlainSize);
 
-    // Check decryption success
-    if (pRepair == nullptr) {
-        if ((uEncryptedPartSize > 2147483446) ||
-            ((uEncryptedPartSize == 0) && ((hdr.dwGroups != 0) || (hdr.dwEntries != 0)))) {
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+        if (!progress.report(OperationStage::Decrypt, uDone, uEncryptedSize)) {
             m_keyEncRounds = PWM_STD_KEYENCROUNDS;
-            return PWE_INVALID_KEY;
+            return PWE_CANCELED;
         }
     }
+    file.close();
 
-    // Verify content hash (check if key is correct)
+    // Check decryption success and verify content hash (check if key is correct)
     if (pRepair == nullptr) {
-        QByteArray decryptedData = QByteArray(pVirtualFile + sizeof(PW_DBHEADER), uEncryptedPartSize);
-        QByteArray vContentsHash = SHA256::hash(decryptedData);
+        BYTE aContentsHash[32];
+        contentHash.finalize(aContentsHash);
 
-        if (std::memcmp(hdr.aContentsHash, vContentsHash.constData(), 32) != 0) {
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+        if (!bPaddingValid || (uEncryptedPartSize > 2147483446) ||
+            ((uEncryptedPartSize == 0) && ((hdr.dwGroups != 0) || (hdr.dwEntries != 0))) ||
+            (std::memcmp(hdr.aContentsHash, aContentsHash, 32) != 0)) {
             m_keyEncRounds = PWM_STD_KEYENCROUNDS;
             return PWE_INVALID_KEY;
         }
     }
 
+    // Only parse once the content hash matches, so that a wrong key or a
+    // damaged file leaves the currently loaded database untouched
     // Create new database and initialize internal structures
     newDatabase();
 
     // Store header hash (without content hash field)
     hashHeaderWithoutContentHash((quint8*)pVirtualFile, m_vHeaderHash);
 
-    // Parse groups from the decrypted data
+    // Parse groups from the decrypted data. The file has been verified, so
+    // this stage only reports progress and is not canceled.
     quint32 pos = sizeof(PW_DBHEADER);
     quint32 uCurGroup = 0;
+    const quint64 qwRecords = static_cast<quint64>(hdr.dwGroups) + hdr.dwEntries;
 
     PW_GROUP pwGroupTemplate;
     std::memset(&pwGroupTemplate, 0, sizeof(PW_GROUP));
     PwUtil::getNeverExpireTime(&pwGroupTemplate.tExpire);
 
+    // Size the group array and tree index once; addGroup() fills them while parsing.
+    // The header counts are untrusted: every record takes at least one 6-byte
+    // field header, so the file size bounds what can really be in there.
+    const quint32 dwMaxRecords = static_cast<quint32>(qMin<qint64>(uFileSize / 6, DWORD_MAX - 1));
+    reserveGroups(qMin(hdr.dwGroups, dwMaxRecords));
+    m_groupIdIndex.reserve(static_cast<int>(qMin(hdr.dwGroups, dwMaxRecords)));
+    m_groupNameIndex.reserve(static_cast<int>(qMin(hdr.dwGroups, dwMaxRecords)));
+
     while (uCurGroup < hdr.dwGroups) {
         char* p = &pVirtualFile[pos];
 
         // Check bounds
         if (pos + 2 > (quint32)uFileSize) {
             delete[] pwGroupTemplate.pszGroupName;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
             return PWE_INVALID_FILESTRUCTURE;
         }
 
@@ -626,8 +943,6 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
 
         if (pos + 4 > (quint32)uFileSize) {
             delete[] pwGroupTemplate.pszGroupName;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
             return PWE_INVALID_FILESTRUCTURE;
         }
 
@@ -638,20 +953,18 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
 
         if (pos + dwFieldSize > (quint32)uFileSize) {
             delete[] pwGroupTemplate.pszGroupName;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
             return PWE_INVALID_FILESTRUCTURE;
         }
 
         if (!readGroupField(usFieldType, dwFieldSize, (quint8*)p, &pwGroupTemplate, pRepair)) {
             delete[] pwGroupTemplate.pszGroupName;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
             return PWE_INVALID_FILESTRUCTURE;
         }
 
-        if (usFieldType == 0xFFFF)
+        if (usFieldType == 0xFFFF) {
             ++uCurGroup;
+            progress.report(OperationStage::Parse, uCurGroup, qwRecords);
+        }
 
         p += dwFieldSize;
         pos += dwFieldSize;
@@ -665,6 +978,10 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
     std::memset(&pwEntryTemplate, 0, sizeof(PW_ENTRY));
     PwUtil::getNeverExpireTime(&pwEntryTemplate.tExpire);
 
+    // Size the entry array and UUID index once; addEntry() fills them while parsing
+    reserveEntries(qMin(hdr.dwEntries, dwMaxRecords));
+    m_uuidIndex.reserve(static_cast<int>(qMin(hdr.dwEntries, dwMaxRecords)));
+
     while (uCurEntry < hdr.dwEntries) {
         char* p = &pVirtualFile[pos];
 
@@ -675,9 +992,7 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
             delete[] pwEntryTemplate.pszPassword;
             delete[] pwEntryTemplate.pszAdditional;
             delete[] pwEntryTemplate.pszBinaryDesc;
-            delete[] pwEntryTemplate.pBinaryData;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+            SecureArena::release(pwEntryTemplate.pBinaryData);
             return PWE_INVALID_FILESTRUCTURE;
         }
 
@@ -693,9 +1008,7 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
             delete[] pwEntryTemplate.pszPassword;
             delete[] pwEntryTemplate.pszAdditional;
             delete[] pwEntryTemplate.pszBinaryDesc;
-            delete[] pwEntryTemplate.pBinaryData;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+            SecureArena::release(pwEntryTemplate.pBinaryData);
             return PWE_INVALID_FILESTRUCTURE;
         }
 
@@ -711,9 +1024,7 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
             delete[] pwEntryTemplate.pszPassword;
             delete[] pwEntryTemplate.pszAdditional;
             delete[] pwEntryTemplate.pszBinaryDesc;
-            delete[] pwEntryTemplate.pBinaryData;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+            SecureArena::release(pwEntryTemplate.pBinaryData);
             return PWE_INVALID_FILESTRUCTURE;
         }
 
@@ -724,14 +1035,14 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
             delete[] pwEntryTemplate.pszPassword;
             delete[] pwEntryTemplate.pszAdditional;
             delete[] pwEntryTemplate.pszBinaryDesc;
-            delete[] pwEntryTemplate.pBinaryData;
-            MemUtil::mem_erase(pVirtualFile, uAllocated);
-            delete[] pVirtualFile;
+            SecureArena::release(pwEntryTemplate.pBinaryData);
             return PWE_INVALID_FILESTRUCTURE;
         }
 
-        if (usFieldType == 0xFFFF)
+        if (usFieldType == 0xFFFF) {
             ++uCurEntry;
+            progress.report(OperationStage::Parse, static_cast<quint64>(hdr.dwGroups) + uCurEntry, qwRecords);
+        }
 
         p += dwFieldSize;
         pos += dwFieldSize;
@@ -742,14 +1053,11 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
     delete[] pwEntryTemplate.pszPassword;
     delete[] pwEntryTemplate.pszAdditional;
     delete[] pwEntryTemplate.pszBinaryDesc;
-    delete[] pwEntryTemplate.pBinaryData;
+    SecureArena::release(pwEntryTemplate.pBinaryData);  // Erases the attachment
 
-    // Store last header
+    // Store last header; its aMasterSeed2 belongs to m_transformedMasterKey
     std::memcpy(&m_dbLastHeader, &hdr, sizeof(PW_DBHEADER));
-
-    // Erase and delete memory file
-    MemUtil::mem_erase(pVirtualFile, uAllocated);
-    delete[] pVirtualFile;
+    m_bTransformedKeyValid = true;
 
     // Load and remove meta-streams
     const quint32 dwRemovedStreams = loadAndRemoveAllMetaStreams(true);
@@ -763,9 +1071,26 @@ int PwManager::openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair)
 }
 
 int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
+{
+    return saveDatabase(filePath, pWrittenDataHash32, ProgressCallback());
+}
+
+int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32,
+                            const ProgressCallback& fnProgress)
 {
     // Reference: MFC/MFC-KeePass/KeePassLibCpp/Details/PwFileImpl.cpp:373-780
 
+    SaveJob job;
+    int nResult = prepareSave(filePath, job, fnProgress);
+    if (nResult == PWE_SUCCESS)
+        nResult = runSave(job, pWrittenDataHash32, fnProgress);
+    if (nResult == PWE_SUCCESS)
+        commitSave(job);
+    return nResult;
+}
+
+int PwManager::prepareSave(const QString& filePath, SaveJob& job, const ProgressCallback& fnProgress)
+{
     Q_ASSERT(!filePath.isEmpty());
     if (filePath.isEmpty()) {
         return PWE_INVALID_PARAM;
@@ -779,6 +1104,13 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
     // IMPORTANT: Must be done BEFORE setting header counts below!
     addAllMetaStreams();
 
+    // Every return from here on removes them again
+    const auto fail = [this](int nError) {
+        loadAndRemoveAllMetaStreams(false);
+        return nError;
+    };
+    ProgressReporter progress(fnProgress);
+
     //========================================================================
     // STEP 1: Calculate required file size
     //========================================================================
@@ -790,43 +1122,25 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
     writeExtData(extData);
     fileSize += 2 + 4 + extData.size();  // field type + field size + data
 
-    // Calculate size of all groups
+    // Calculate size of all groups and entries. The strings are stored as
+    // UTF-8 already, so only their lengths are needed; the password length
+    // is cached in uPasswordLen, so passwords stay locked here.
     for (quint32 i = 0; i < m_numGroups; ++i) {
         fileSize += 94;  // Fixed overhead for group fields
-
-        // Group name (UTF-8)
-        QString groupName = QString::fromUtf8(m_pGroups[i].pszGroupName);
-        QByteArray nameUtf8 = groupName.toUtf8();
-        fileSize += nameUtf8.length() + 1;  // +1 for null terminator
+        fileSize += std::strlen(m_pGroups[i].pszGroupName) + 1;  // +1 for null terminator
     }
 
-    // Calculate size of all entries
     for (quint32 i = 0; i < m_numEntries; ++i) {
-        PW_ENTRY* entry = &m_pEntries[i];
-
-        // Unlock password temporarily for serialization
-        unlockEntryPassword(entry);
+        const PW_ENTRY* entry = &m_pEntries[i];
 
         fileSize += 134;  // Fixed overhead for entry fields
-
-        // All string fields (UTF-8)
-        QString title = QString::fromUtf8(entry->pszTitle);
-        QString username = QString::fromUtf8(entry->pszUserName);
-        QString url = QString::fromUtf8(entry->pszURL);
-        QString password = QString::fromUtf8(entry->pszPassword);
-        QString notes = QString::fromUtf8(entry->pszAdditional);
-        QString binaryDesc = QString::fromUtf8(entry->pszBinaryDesc);
-
-        fileSize += title.toUtf8().length() + 1;
-        fileSize += username.toUtf8().length() + 1;
-        fileSize += url.toUtf8().length() + 1;
-        fileSize += password.toUtf8().length() + 1;
-        fileSize += notes.toUtf8().length() + 1;
-        fileSize += binaryDesc.toUtf8().length() + 1;
+        fileSize += std::strlen(entry->pszTitle) + 1;
+        fileSize += std::strlen(entry->pszUserName) + 1;
+        fileSize += std::strlen(entry->pszURL) + 1;
+        fileSize += static_cast<quint64>(entry->uPasswordLen) + 1;
+        fileSize += std::strlen(entry->pszAdditional) + 1;
+        fileSize += std::strlen(entry->pszBinaryDesc) + 1;
         fileSize += entry->uBinaryDataLen;
-
-        // Lock password again
-        lockEntryPassword(entry);
     }
 
     // Round up to 16-byte boundary for block cipher
@@ -834,30 +1148,25 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
 
     quint64 allocSize = fileSize + 16;
     if (allocSize > 0xFFFFFFFFULL) {
-        loadAndRemoveAllMetaStreams(false);
-        return PWE_NO_MEM;
+        return fail(PWE_NO_MEM);
     }
 
     //========================================================================
     // STEP 2: Allocate memory buffer
     //========================================================================
 
-    quint32 bufferSize = static_cast<quint32>(allocSize);
-    char* buffer = nullptr;
-    try {
-        buffer = new char[bufferSize];
-        std::memset(buffer, 0, bufferSize);
-    } catch (...) {
-        loadAndRemoveAllMetaStreams(false);
-        return PWE_NO_MEM;
+    job.dwBufferSize = static_cast<quint32>(allocSize);
+    job.pBuffer = static_cast<char*>(SecureArena::allocate(job.dwBufferSize));  // Zero-filled, locked
+    if (job.pBuffer == nullptr) {
+        return fail(PWE_NO_MEM);
     }
+    char* buffer = job.pBuffer;
 
     //========================================================================
     // STEP 3: Build header structure
     //========================================================================
 
-    PW_DBHEADER hdr;
-    std::memset(&hdr, 0, sizeof(PW_DBHEADER));
+    PW_DBHEADER& hdr = job.hdr;
 
     hdr.dwSignature1 = PWM_DBSIG_1;
     hdr.dwSignature2 = PWM_DBSIG_2;
@@ -868,9 +1177,7 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
     } else if (m_nAlgorithm == ALGO_TWOFISH) {
         hdr.dwFlags |= 0x08;  // PWM_FLAG_TWOFISH
     } else {
-        delete[] buffer;
-        loadAndRemoveAllMetaStreams(false);
-        return PWE_INVALID_PARAM;
+        return fail(PWE_INVALID_PARAM);
     }
 
     hdr.dwVersion = PWM_DBVER_DW;
@@ -878,244 +1185,118 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
     hdr.dwEntries = m_numEntries;
     hdr.dwKeyEncRounds = m_keyEncRounds;
 
-    // Generate random seeds and IV
+    // Generate random seeds and IV. In fast-resave mode, the transformed key
+    // of the last open or save is reused if it was computed with the same
+    // rounds; the final key still changes with every save via aMasterSeed.
+    job.bReuseTransformedKey = m_bFastResave && m_bTransformedKeyValid &&
+        (m_dbLastHeader.dwKeyEncRounds == m_keyEncRounds);
     Random::fillBuffer(hdr.aMasterSeed, 16);
     Random::fillBuffer(hdr.aEncryptionIV, 16);
-    Random::fillBuffer(hdr.aMasterSeed2, 32);
-
-    // Hash header (without content hash field)
-    m_vHeaderHash.resize(32);
-    hashHeaderWithoutContentHash(reinterpret_cast<BYTE*>(&hdr), m_vHeaderHash);
+    if (job.bReuseTransformedKey)
+        std::memcpy(hdr.aMasterSeed2, m_dbLastHeader.aMasterSeed2, 32);
+    else
+        Random::fillBuffer(hdr.aMasterSeed2, 32);
+
+    // The keys go with the job; the header hash is stored by commitSave(),
+    // the extended data above carries the one of the previous header
+    job.strFilePath = filePath;
+    job.nAlgorithm = m_nAlgorithm;
+    std::memcpy(job.masterKey(), m_masterKey, 32);
+    if (job.bReuseTransformedKey)
+        std::memcpy(job.transformedKey(), m_transformedMasterKey, 32);
 
     //========================================================================
     // STEP 4: Serialize groups
     //========================================================================
 
-    quint32 pos = sizeof(PW_DBHEADER);  // Skip header for now
+    RecordWriter writer(buffer, sizeof(PW_DBHEADER));  // Skip header for now
+    const quint64 qwRecords = static_cast<quint64>(m_numGroups) + m_numEntries;
 
     for (quint32 i = 0; i < m_numGroups; ++i) {
+        const PW_GROUP* group = &m_pGroups[i];
+
         // First group gets extended data
         if (i == 0) {
-            // KDB v1.x file format: fieldType (USHORT, 2 bytes) and fieldSize (DWORD, 4 bytes) must match exact binary layout
-            USHORT fieldType = 0x0000;
-            DWORD fieldSize = static_cast<DWORD>(extData.size());
-            std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-            std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-            std::memcpy(&buffer[pos], extData.constData(), fieldSize); pos += fieldSize;
-        }
-
-        // Field 0x0001: Group ID
-        USHORT fieldType = 0x0001;
-        DWORD fieldSize = 4;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &m_pGroups[i].uGroupId, 4); pos += 4;
-
-        // Field 0x0002: Group name
-        QString groupName = QString::fromUtf8(m_pGroups[i].pszGroupName);
-        QByteArray nameUtf8 = groupName.toUtf8();
-        fieldType = 0x0002;
-        fieldSize = nameUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], nameUtf8.constData()); pos += fieldSize;
-
-        // Field 0x0003: Creation time
-        quint8 compressedTime[5];
-        PwUtil::packTime(&m_pGroups[i].tCreation, compressedTime);
-        fieldType = 0x0003; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x0004: Last modification time
-        PwUtil::packTime(&m_pGroups[i].tLastMod, compressedTime);
-        fieldType = 0x0004; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x0005: Last access time
-        PwUtil::packTime(&m_pGroups[i].tLastAccess, compressedTime);
-        fieldType = 0x0005; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x0006: Expiration time
-        PwUtil::packTime(&m_pGroups[i].tExpire, compressedTime);
-        fieldType = 0x0006; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x0007: Image ID
-        fieldType = 0x0007; fieldSize = 4;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &m_pGroups[i].uImageId, 4); pos += 4;
-
-        // Field 0x0008: Level
-        fieldType = 0x0008; fieldSize = 2;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &m_pGroups[i].usLevel, 2); pos += 2;
-
-        // Field 0x0009: Flags
-        fieldType = 0x0009; fieldSize = 4;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &m_pGroups[i].dwFlags, 4); pos += 4;
-
-        // Field 0xFFFF: End of group
-        fieldType = 0xFFFF; fieldSize = 0;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
+            writer.field(0x0000, extData.constData(), static_cast<DWORD>(extData.size()));
+        }
+
+        writer.field(0x0001, &group->uGroupId, 4);          // Group ID
+        writer.stringField(0x0002, group->pszGroupName);    // Group name
+        writer.timeField(0x0003, &group->tCreation);        // Creation time
+        writer.timeField(0x0004, &group->tLastMod);         // Last modification time
+        writer.timeField(0x0005, &group->tLastAccess);      // Last access time
+        writer.timeField(0x0006, &group->tExpire);          // Expiration time
+        writer.field(0x0007, &group->uImageId, 4);          // Image ID
+        writer.field(0x0008, &group->usLevel, 2);           // Level
+        writer.field(0x0009, &group->dwFlags, 4);           // Flags
+        writer.field(0xFFFF, nullptr, 0);                   // End of group
+
+        if (!progress.report(OperationStage::Serialize, i + 1, qwRecords)) {
+            return fail(PWE_CANCELED);
+        }
     }
 
     //========================================================================
     // STEP 5: Serialize entries
     //========================================================================
 
+    ProtectedStringCipher::Batch passwordBatch(m_passwordCipher);
     for (quint32 i = 0; i < m_numEntries; ++i) {
         PW_ENTRY* entry = &m_pEntries[i];
 
-        // Unlock password for serialization
-        unlockEntryPassword(entry);
-
-        // Field 0x0001: UUID
-        USHORT fieldType = 0x0001;
-        DWORD fieldSize = 16;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], entry->uuid, 16); pos += 16;
-
-        // Field 0x0002: Group ID
-        fieldType = 0x0002; fieldSize = 4;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &entry->uGroupId, 4); pos += 4;
-
-        // Field 0x0003: Image ID
-        fieldType = 0x0003; fieldSize = 4;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], &entry->uImageId, 4); pos += 4;
-
-        // Field 0x0004: Title
-        QByteArray titleUtf8 = QString::fromUtf8(entry->pszTitle).toUtf8();
-        fieldType = 0x0004; fieldSize = titleUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], titleUtf8.constData()); pos += fieldSize;
-
-        // Field 0x0005: URL
-        QByteArray urlUtf8 = QString::fromUtf8(entry->pszURL).toUtf8();
-        fieldType = 0x0005; fieldSize = urlUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], urlUtf8.constData()); pos += fieldSize;
-
-        // Field 0x0006: Username
-        QByteArray userUtf8 = QString::fromUtf8(entry->pszUserName).toUtf8();
-        fieldType = 0x0006; fieldSize = userUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], userUtf8.constData()); pos += fieldSize;
-
-        // Field 0x0007: Password
-        QByteArray passUtf8 = QString::fromUtf8(entry->pszPassword).toUtf8();
-        fieldType = 0x0007; fieldSize = passUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], passUtf8.constData()); pos += fieldSize;
-
-        // Erase password from temporary buffer
-        MemUtil::mem_erase(const_cast<char*>(passUtf8.constData()), passUtf8.length());
-
-        // Field 0x0008: Notes
-        QByteArray notesUtf8 = QString::fromUtf8(entry->pszAdditional).toUtf8();
-        fieldType = 0x0008; fieldSize = notesUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], notesUtf8.constData()); pos += fieldSize;
-
-        // Field 0x0009: Creation time
-        quint8 compressedTime[5];
-        PwUtil::packTime(&entry->tCreation, compressedTime);
-        fieldType = 0x0009; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x000A: Last modification time
-        PwUtil::packTime(&entry->tLastMod, compressedTime);
-        fieldType = 0x000A; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x000B: Last access time
-        PwUtil::packTime(&entry->tLastAccess, compressedTime);
-        fieldType = 0x000B; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x000C: Expiration time
-        PwUtil::packTime(&entry->tExpire, compressedTime);
-        fieldType = 0x000C; fieldSize = 5;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::memcpy(&buffer[pos], compressedTime, 5); pos += 5;
-
-        // Field 0x000D: Binary description
-        QByteArray binaryDescUtf8 = QString::fromUtf8(entry->pszBinaryDesc).toUtf8();
-        fieldType = 0x000D; fieldSize = binaryDescUtf8.length() + 1;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        std::strcpy(&buffer[pos], binaryDescUtf8.constData()); pos += fieldSize;
-
-        // Field 0x000E: Binary data
-        fieldType = 0x000E; fieldSize = entry->uBinaryDataLen;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-        if (entry->pBinaryData && fieldSize > 0) {
-            std::memcpy(&buffer[pos], entry->pBinaryData, fieldSize);
-        }
-        pos += fieldSize;
-
-        // Field 0xFFFF: End of entry
-        fieldType = 0xFFFF; fieldSize = 0;
-        std::memcpy(&buffer[pos], &fieldType, 2); pos += 2;
-        std::memcpy(&buffer[pos], &fieldSize, 4); pos += 4;
-
-        // Lock password again
-        lockEntryPassword(entry);
+        writer.field(0x0001, entry->uuid, 16);              // UUID
+        writer.field(0x0002, &entry->uGroupId, 4);          // Group ID
+        writer.field(0x0003, &entry->uImageId, 4);          // Image ID
+        writer.stringField(0x0004, entry->pszTitle);        // Title
+        writer.stringField(0x0005, entry->pszURL);          // URL
+        writer.stringField(0x0006, entry->pszUserName);     // Username
+
+        // Password: copied as stored and decrypted inside the buffer, so the
+        // entry itself never needs to be unlocked
+        const quint32 dwPasswordPos = writer.pos() + 6;  // Behind field type and size
+        writer.stringField(0x0007, entry->pszPassword, entry->uPasswordLen);
+        passwordBatch.add(passwordNonce(entry), reinterpret_cast<quint8*>(buffer + dwPasswordPos), entry->uPasswordLen);
+
+        writer.stringField(0x0008, entry->pszAdditional);   // Notes
+        writer.timeField(0x0009, &entry->tCreation);        // Creation time
+        writer.timeField(0x000A, &entry->tLastMod);         // Last modification time
+        writer.timeField(0x000B, &entry->tLastAccess);      // Last access time
+        writer.timeField(0x000C, &entry->tExpire);          // Expiration time
+        writer.stringField(0x000D, entry->pszBinaryDesc);   // Binary description
+        writer.field(0x000E, entry->pBinaryData, entry->uBinaryDataLen);  // Binary data
+        writer.field(0xFFFF, nullptr, 0);                   // End of entry
+
+        if (!progress.report(OperationStage::Serialize, static_cast<quint64>(m_numGroups) + i + 1, qwRecords)) {
+            return fail(PWE_CANCELED);
+        }
     }
 
-    //========================================================================
-    // STEP 6: Compute content hash
-    //========================================================================
+    if (!passwordBatch.flush()) {
+        return fail(PWE_CRYPT_ERROR);
+    }
 
-    SHA256::Context contentHash;
-    contentHash.update(reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER),
-                       pos - sizeof(PW_DBHEADER));
-    contentHash.finalize(hdr.aContentsHash);
+    job.dwPayloadEnd = writer.pos();
+    Q_ASSERT(job.dwPayloadEnd <= job.dwBufferSize);
 
-    // Copy completed header to buffer
-    std::memcpy(buffer, &hdr, sizeof(PW_DBHEADER));
+    loadAndRemoveAllMetaStreams(false);
+    return PWE_SUCCESS;
+}
+
+int PwManager::runSave(SaveJob& job, quint8* pWrittenDataHash32, const ProgressCallback& fnProgress)
+{
+    ProgressReporter progress(fnProgress);
+    PW_DBHEADER& hdr = job.hdr;
+    char* buffer = job.pBuffer;
 
     //========================================================================
-    // STEP 7: Derive encryption key
+    // STEP 6: Derive encryption key
     //========================================================================
 
-    // Transform master key
-    if (!transformMasterKey(hdr.aMasterSeed2)) {
-        MemUtil::mem_erase(buffer, bufferSize);
-        delete[] buffer;
-        loadAndRemoveAllMetaStreams(false);
-        return PWE_CRYPT_ERROR;
+    // Transform master key (skipped when reusing the cached one)
+    if (!job.bReuseTransformedKey &&
+        !transformKey(job.masterKey(), hdr.dwKeyEncRounds, hdr.aMasterSeed2, job.transformedKey(),
+                      progress.forward())) {
+        return progress.isCanceled() ? PWE_CANCELED : PWE_CRYPT_ERROR;
     }
 
     // Derive final encryption key
@@ -1123,77 +1304,79 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
     BYTE finalKey[32];
     SHA256::Context keyHash;
     keyHash.update(hdr.aMasterSeed, 16);
-    keyHash.update(m_transformedMasterKey, 32);
+    keyHash.update(job.transformedKey(), 32);
     keyHash.finalize(finalKey);
 
     //========================================================================
-    // STEP 8: Encrypt content
+    // STEP 7: Compute content hash and encrypt content
     //========================================================================
 
-    quint32 encryptedSize = 0;
-
-    if (m_nAlgorithm == ALGO_AES) {
-        CRijndael aes;
-        if (aes.Init(CRijndael::CBC, CRijndael::EncryptDir, finalKey,
-                     CRijndael::Key32Bytes, hdr.aEncryptionIV) != RIJNDAEL_SUCCESS) {
-            MemUtil::mem_erase(finalKey, 32);
-            MemUtil::mem_erase(buffer, bufferSize);
-            delete[] buffer;
-            loadAndRemoveAllMetaStreams(false);
-            return PWE_CRYPT_ERROR;
-        }
+    std::unique_ptr<CipherBackend> pCipher = CipherBackend::create(payloadCipher(job.nAlgorithm));
+    const bool bCipherReady = pCipher->init(true, finalKey, hdr.aEncryptionIV);
+    MemUtil::mem_erase(finalKey, 32);
+    if (!bCipherReady) {
+        return PWE_CRYPT_ERROR;
+    }
 
-        encryptedSize = static_cast<quint32>(aes.PadEncrypt(
-            reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER),
-            pos - sizeof(PW_DBHEADER),
-            reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER)));
+    // One pass: each tile is hashed and then encrypted while in the cache,
+    // piece by piece for the progress reports. The header only gets the
+    // hash afterwards; it is not encrypted.
+    BYTE* pPayload = reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER);
+    const quint32 dwPayloadSize = job.dwPayloadEnd - sizeof(PW_DBHEADER);
+    SHA256::Context contentHash;
+    quint32 dwDone = 0;
 
-    } else if (m_nAlgorithm == ALGO_TWOFISH) {
-        CTwofish twofish;
-        if (!twofish.Init(finalKey, 32, hdr.aEncryptionIV)) {
-            MemUtil::mem_erase(finalKey, 32);
-            MemUtil::mem_erase(buffer, bufferSize);
-            delete[] buffer;
-            loadAndRemoveAllMetaStreams(false);
+    while ((dwPayloadSize - dwDone) > SAVE_PIECE_SIZE) {
+        if (!PayloadKernels::hashThenEncryptBlocks(*pCipher, contentHash, pPayload + dwDone, SAVE_PIECE_SIZE)) {
             return PWE_CRYPT_ERROR;
         }
+        dwDone += SAVE_PIECE_SIZE;
 
-        encryptedSize = static_cast<quint32>(twofish.PadEncrypt(
-            reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER),
-            pos - sizeof(PW_DBHEADER),
-            reinterpret_cast<BYTE*>(buffer) + sizeof(PW_DBHEADER)));
+        if (!progress.report(OperationStage::Encrypt, dwDone, dwPayloadSize)) {
+            return PWE_CANCELED;
+        }
     }
 
-    MemUtil::mem_erase(finalKey, 32);
+    const qint64 nLastSize = PayloadKernels::hashThenEncrypt(
+        *pCipher, contentHash, pPayload + dwDone, dwPayloadSize - dwDone);
+    quint32 encryptedSize = 0;
+    if (nLastSize > 0)
+        encryptedSize = dwDone + static_cast<quint32>(nLastSize);
+    contentHash.finalize(hdr.aContentsHash);
 
     // Verify encryption succeeded
     if ((encryptedSize % 16) != 0 || encryptedSize == 0) {
-        MemUtil::mem_erase(buffer, bufferSize);
-        delete[] buffer;
-        loadAndRemoveAllMetaStreams(false);
         return PWE_CRYPT_ERROR;
     }
 
+    if (!progress.report(OperationStage::Encrypt, dwPayloadSize, dwPayloadSize)) {
+        return PWE_CANCELED;
+    }
+
+    // Copy completed header to buffer
+    std::memcpy(buffer, &hdr, sizeof(PW_DBHEADER));
+
     //========================================================================
-    // STEP 9: Write to file
+    // STEP 8: Write to file
     //========================================================================
 
+    // Progress is still reported, but a cancel request is ignored from here
+    // on: stopping halfway would leave a truncated file behind
     quint32 totalSize = encryptedSize + sizeof(PW_DBHEADER);
 
-    QFile file(filePath);
+    QFile file(job.strFilePath);
     if (!file.open(QIODevice::WriteOnly)) {
-        MemUtil::mem_erase(buffer, bufferSize);
-        delete[] buffer;
-        loadAndRemoveAllMetaStreams(false);
         return PWE_NOFILEACCESS_WRITE;
     }
 
-    if (file.write(buffer, totalSize) != static_cast<qint64>(totalSize)) {
-        file.close();
-        MemUtil::mem_erase(buffer, bufferSize);
-        delete[] buffer;
-        loadAndRemoveAllMetaStreams(false);
-        return PWE_FILEERROR_WRITE;
+    for (quint32 dwWritten = 0; dwWritten < totalSize; ) {
+        const quint32 dwPiece = qMin(SAVE_PIECE_SIZE, totalSize - dwWritten);
+        if (file.write(buffer + dwWritten, dwPiece) != static_cast<qint64>(dwPiece)) {
+            file.close();
+            return PWE_FILEERROR_WRITE;
+        }
+        dwWritten += dwPiece;
+        progress.report(OperationStage::Write, dwWritten, totalSize);
     }
 
     file.close();
@@ -1205,54 +1388,221 @@ int PwManager::saveDatabase(const QString& filePath, quint8* pWrittenDataHash32)
         writtenHash.finalize(pWrittenDataHash32);
     }
 
+    return PWE_SUCCESS;
+}
+
+void PwManager::commitSave(const SaveJob& job)
+{
     // Backup header
-    std::memcpy(&m_dbLastHeader, &hdr, sizeof(PW_DBHEADER));
+    std::memcpy(&m_dbLastHeader, &job.hdr, sizeof(PW_DBHEADER));
 
-    // Cleanup
-    MemUtil::mem_erase(buffer, bufferSize);
-    delete[] buffer;
-    loadAndRemoveAllMetaStreams(false);
+    // Hash header (without content hash field)
+    m_vHeaderHash.resize(32);
+    hashHeaderWithoutContentHash(reinterpret_cast<const BYTE*>(&job.hdr), m_vHeaderHash);
 
-    return PWE_SUCCESS;
+    // The transformed key only belongs to the new header if the master key
+    // has not been changed while an asynchronous save was running
+    if (std::memcmp(job.masterKey(), m_masterKey, 32) == 0) {
+        std::memcpy(m_transformedMasterKey, job.transformedKey(), 32);
+        m_bTransformedKeyValid = true;
+    } else {
+        m_bTransformedKeyValid = false;
+    }
 }
 
 //=============================================================================
-// Meta-streams and Extended Data
+// Asynchronous Open and Save
 //=============================================================================
 
-void PwManager::writeExtData(QByteArray& data)
+int PwManager::encodeProgress(OperationStage eStage, int nPercent)
 {
-    // Field 0x0001: Header hash
-    writeExtDataField(data, 0x0001,
-                      reinterpret_cast<const BYTE*>(m_vHeaderHash.constData()),
-                      static_cast<DWORD>(m_vHeaderHash.size()));
-
-    // Field 0x0002: Random data to prevent guessing attacks
-    BYTE randomData[32];
-    Random::fillBuffer(randomData, 32);
-    writeExtDataField(data, 0x0002, randomData, 32);
-    MemUtil::mem_erase(randomData, 32);
+    return static_cast<int>(eStage) * 101 + qBound(0, nPercent, 100);
+}
 
-    // Field 0xFFFF: Terminator
-    writeExtDataField(data, 0xFFFF, nullptr, 0);
+PwManager::OperationStage PwManager::progressStage(int nProgressValue)
+{
+    return static_cast<OperationStage>(qBound(0, nProgressValue, PROGRESS_MAXIMUM) / 101);
 }
 
-void PwManager::writeExtDataField(QByteArray& data, quint16 usFieldType,
-                                  const quint8* pData, quint32 dwFieldSize)
+int PwManager::progressPercent(int nProgressValue)
 {
-    // Append field type (2 bytes)
-    data.append(reinterpret_cast<const char*>(&usFieldType), 2);
+    return qBound(0, nProgressValue, PROGRESS_MAXIMUM) % 101;
+}
 
-    // Append field size (4 bytes)
-    data.append(reinterpret_cast<const char*>(&dwFieldSize), 4);
+QFuture<int> PwManager::openDatabaseAsync(const QString& filePath)
+{
+    auto pOp = std::make_shared<AsyncOperation>();
+    const QFuture<int> future = pOp->future.future();
 
-    // Append field data if any
-    if (dwFieldSize > 0 && pData != nullptr) {
-        data.append(reinterpret_cast<const char*>(pData), dwFieldSize);
+    Q_ASSERT(!m_pAsyncOp);
+    if (m_pAsyncOp) {
+        pOp->finish(PWE_INVALID_PARAM);  // One operation at a time
+        return future;
     }
+    m_pAsyncOp = pOp;
+
+    // The file is opened with this database's key; everything else comes from the file
+    pOp->pStaging = std::make_unique<PwManager>();
+    PwManager* pStaging = pOp->pStaging.get();
+    std::memcpy(pStaging->m_masterKey, m_masterKey, 32);
+    pStaging->m_strKeySource = m_strKeySource;
+
+    AsyncOperation* pWork = pOp.get();
+    AsyncOperation::start(pOp, [pWork, pStaging, filePath]() {
+        return pStaging->openDatabase(filePath, nullptr, pWork->progressCallback());
+    });
+    return future;
 }
 
-bool PwManager::addAllMetaStreams()
+QFuture<int> PwManager::saveDatabaseAsync(const QString& filePath)
+{
+    auto pOp = std::make_shared<AsyncOperation>();
+    const QFuture<int> future = pOp->future.future();
+
+    Q_ASSERT(!m_pAsyncOp);
+    if (m_pAsyncOp) {
+        pOp->finish(PWE_INVALID_PARAM);  // One operation at a time
+        return future;
+    }
+    m_pAsyncOp = pOp;
+
+    // Serializing reads the database, so it happens right here
+    pOp->pSaveJob = std::make_unique<SaveJob>();
+    const int nPrepared = prepareSave(filePath, *pOp->pSaveJob, ProgressCallback());
+    if (nPrepared != PWE_SUCCESS) {
+        pOp->finish(nPrepared);
+        return future;
+    }
+
+    AsyncOperation* pWork = pOp.get();
+    SaveJob* pJob = pOp->pSaveJob.get();
+    AsyncOperation::start(pOp, [pWork, pJob]() {
+        return runSave(*pJob, nullptr, pWork->progressCallback());
+    });
+    return future;
+}
+
+int PwManager::finishAsyncOperation()
+{
+    if (!m_pAsyncOp)
+        return PWE_UNKNOWN;
+
+    const std::shared_ptr<AsyncOperation> pOp = std::move(m_pAsyncOp);
+    pOp->future.waitForFinished();
+
+    int nResult = pOp->nResult;
+    if (pOp->pStaging) {
+        // A database that was opened after all is dropped when canceled
+        if (nResult == PWE_SUCCESS && pOp->future.isCanceled())
+            nResult = PWE_CANCELED;
+        if (nResult == PWE_SUCCESS)
+            swapDatabase(*pOp->pStaging);
+    } else if (nResult == PWE_SUCCESS) {
+        // The file has been written; a late cancel does not undo that
+        commitSave(*pOp->pSaveJob);
+    }
+
+    // The previous database goes away with pStaging
+    return nResult;
+}
+
+void PwManager::swapDatabase(PwManager& other) noexcept
+{
+    // Contents and their indexes; the strings stay in their arena
+    std::swap(m_pEntries, other.m_pEntries);
+    std::swap(m_maxEntries, other.m_maxEntries);
+    std::swap(m_numEntries, other.m_numEntries);
+    m_uuidIndex.swap(other.m_uuidIndex);
+    m_passwordNonces.swap(other.m_passwordNonces);
+    std::swap(m_uPasswordNonceCounter, other.m_uPasswordNonceCounter);
+    m_groupEntries.swap(other.m_groupEntries);
+    m_searchIndex.swap(other.m_searchIndex);
+    std::swap(m_bSearchIndexValid, other.m_bSearchIndexValid);
+    m_foldedText.swap(other.m_foldedText);
+    std::swap(m_bFoldedTextValid, other.m_bFoldedTextValid);
+    m_expiryIndex.swap(other.m_expiryIndex);
+    std::swap(m_bExpiryIndexValid, other.m_bExpiryIndexValid);
+    if (m_bSearchIndexPasswords != other.m_bSearchIndexPasswords) {
+        // Built with the other manager's password setting
+        invalidateSearchIndex();
+        other.invalidateSearchIndex();
+    }
+    // Versions only grow, so no cached result matches either database now
+    ++m_uContentVersion;
+    ++other.m_uContentVersion;
+    std::swap(m_pGroups, other.m_pGroups);
+    std::swap(m_maxGroups, other.m_maxGroups);
+    std::swap(m_numGroups, other.m_numGroups);
+    m_vGroupTree.swap(other.m_vGroupTree);
+    std::swap(m_groupTreeRoot, other.m_groupTreeRoot);
+    m_groupIdIndex.swap(other.m_groupIdIndex);
+    m_groupNameIndex.swap(other.m_groupNameIndex);
+    m_stringArena.swap(other.m_stringArena);
+    std::swap(m_pLastEditedEntry, other.m_pLastEditedEntry);
+
+    // Header and keys; the locked passwords go with the keystream they were
+    // encrypted with
+    std::swap(m_dbLastHeader, other.m_dbLastHeader);
+    m_vHeaderHash.swap(other.m_vHeaderHash);
+    std::swap(m_keyMemory, other.m_keyMemory);
+    std::swap(m_sessionKey, other.m_sessionKey);
+    std::swap(m_masterKey, other.m_masterKey);
+    std::swap(m_transformedMasterKey, other.m_transformedMasterKey);
+    m_passwordCipher.swap(other.m_passwordCipher);
+    std::swap(m_nAlgorithm, other.m_nAlgorithm);
+    std::swap(m_keyEncRounds, other.m_keyEncRounds);
+    std::swap(m_bTransformedKeyValid, other.m_bTransformedKeyValid);
+    m_strKeySource.swap(other.m_strKeySource);
+
+    // Settings stored in meta-streams
+    m_strDefaultUserName.swap(other.m_strDefaultUserName);
+    m_vSearchHistory.swap(other.m_vSearchHistory);
+    m_vCustomKVPs.swap(other.m_vCustomKVPs);
+    m_vUnknownMetaStreams.swap(other.m_vUnknownMetaStreams);
+    std::swap(m_clr, other.m_clr);
+    std::swap(m_dwLastSelectedGroupId, other.m_dwLastSelectedGroupId);
+    std::swap(m_dwLastTopVisibleGroupId, other.m_dwLastTopVisibleGroupId);
+    std::swap_ranges(m_aLastSelectedEntryUuid, m_aLastSelectedEntryUuid + 16, other.m_aLastSelectedEntryUuid);
+    std::swap_ranges(m_aLastTopVisibleEntryUuid, m_aLastTopVisibleEntryUuid + 16, other.m_aLastTopVisibleEntryUuid);
+}
+
+//=============================================================================
+// Meta-streams and Extended Data
+//=============================================================================
+
+void PwManager::writeExtData(QByteArray& data)
+{
+    // Field 0x0001: Header hash
+    writeExtDataField(data, 0x0001,
+                      reinterpret_cast<const BYTE*>(m_vHeaderHash.constData()),
+                      static_cast<DWORD>(m_vHeaderHash.size()));
+
+    // Field 0x0002: Random data to prevent guessing attacks
+    BYTE randomData[32];
+    Random::fillBuffer(randomData, 32);
+    writeExtDataField(data, 0x0002, randomData, 32);
+    MemUtil::mem_erase(randomData, 32);
+
+    // Field 0xFFFF: Terminator
+    writeExtDataField(data, 0xFFFF, nullptr, 0);
+}
+
+void PwManager::writeExtDataField(QByteArray& data, quint16 usFieldType,
+                                  const quint8* pData, quint32 dwFieldSize)
+{
+    // Append field type (2 bytes)
+    data.append(reinterpret_cast<const char*>(&usFieldType), 2);
+
+    // Append field size (4 bytes)
+    data.append(reinterpret_cast<const char*>(&dwFieldSize), 4);
+
+    // Append field data if any
+    if (dwFieldSize > 0 && pData != nullptr) {
+        data.append(reinterpret_cast<const char*>(pData), dwFieldSize);
+    }
+}
+
+bool PwManager::addAllMetaStreams()
 {
     // Reference: MFC/MFC-KeePass/KeePassLibCpp/PwManager.cpp:1677-1734
     // This method adds meta-streams (special entries) that store UI state,
@@ -1418,18 +1768,22 @@ QByteArray PwManager::serializeCustomKvp(const CustomKvp& kvp)
 
 quint32 PwManager::getNumberOfItemsInGroup(const QString& groupName) const
 {
-    Q_UNUSED(groupName);
-    return 0;
+    const quint32 idGroup = getGroupId(groupName);
+    if (idGroup == DWORD_MAX) {
+        return 0;
+    }
+
+    return getNumberOfItemsInGroupN(idGroup);
 }
 
 quint32 PwManager::getNumberOfItemsInGroupN(quint32 idGroup) const
 {
-    quint32 count = 0;
-    for (quint32 i = 0; i < m_numEntries; ++i) {
-        if (m_pEntries[i].uGroupId == idGroup)
-            count++;
+    auto it = m_groupEntries.constFind(idGroup);
+    if (it == m_groupEntries.constEnd()) {
+        return 0;
     }
-    return count;
+
+    return static_cast<quint32>(it.value().size());
 }
 
 quint32 PwManager::getEntryByGroupN(quint32 idGroup, quint32 dwIndex) const
@@ -1440,54 +1794,287 @@ quint32 PwManager::getEntryByGroupN(quint32 idGroup, quint32 dwIndex) const
     if (idGroup == DWORD_MAX) {
         return DWORD_MAX;
     }
-    if (dwIndex >= m_numEntries) {
+
+    auto it = m_groupEntries.constFind(idGroup);
+    if (it == m_groupEntries.constEnd() || dwIndex >= static_cast<quint32>(it.value().size())) {
         return DWORD_MAX;
     }
 
-    quint32 uEntryInGroupCounter = 0;
-    for (quint32 uCurrentEntry = 0; uCurrentEntry < m_numEntries; ++uCurrentEntry) {
-        if (m_pEntries[uCurrentEntry].uGroupId == idGroup) {
-            if (dwIndex == uEntryInGroupCounter) {
-                return uCurrentEntry;
-            }
-            ++uEntryInGroupCounter;
-        }
+    return it.value().at(static_cast<int>(dwIndex));
+}
+
+PW_ENTRY* PwManager::getEntryByGroup(quint32 idGroup, quint32 dwIndex)
+{
+    return getEntry(getEntryByGroupN(idGroup, dwIndex));
+}
+
+quint32 PwManager::getEntryPosInGroup(const PW_ENTRY* pEntry) const
+{
+    // Reference: MFC CPwManager::GetEntryPosInGroup
+    // Returns the position of an entry within its group (inverse of getEntryByGroupN)
+
+    if (pEntry == nullptr || m_pEntries == nullptr) {
+        return DWORD_MAX;
     }
 
-    return DWORD_MAX;
+    // Compare as integers: pEntry may point into a different array
+    const quintptr uBase = reinterpret_cast<quintptr>(m_pEntries);
+    const quintptr uPtr = reinterpret_cast<quintptr>(pEntry);
+    if (uPtr < uBase || ((uPtr - uBase) % sizeof(PW_ENTRY)) != 0 ||
+        ((uPtr - uBase) / sizeof(PW_ENTRY)) >= m_numEntries) {
+        return DWORD_MAX;
+    }
+    const quint32 dwIndex = static_cast<quint32>((uPtr - uBase) / sizeof(PW_ENTRY));
+
+    auto it = m_groupEntries.constFind(pEntry->uGroupId);
+    if (it == m_groupEntries.constEnd()) {
+        return DWORD_MAX;
+    }
+
+    const QVector<quint32>& vEntries = it.value();
+    auto itPos = std::lower_bound(vEntries.constBegin(), vEntries.constEnd(), dwIndex);
+    if (itPos == vEntries.constEnd() || *itPos != dwIndex) {
+        return DWORD_MAX;
+    }
+
+    return static_cast<quint32>(itPos - vEntries.constBegin());
+}
+
+void PwManager::linkEntryToGroup(quint32 dwIndex)
+{
+    QVector<quint32>& vEntries = m_groupEntries[m_pEntries[dwIndex].uGroupId];
+
+    // Appending (load, add) is the common case and keeps the vector sorted
+    if (vEntries.isEmpty() || vEntries.last() < dwIndex) {
+        vEntries.append(dwIndex);
+    } else {
+        vEntries.insert(std::lower_bound(vEntries.begin(), vEntries.end(), dwIndex), dwIndex);
+    }
+}
+
+void PwManager::unlinkEntryFromGroup(quint32 dwIndex)
+{
+    auto it = m_groupEntries.find(m_pEntries[dwIndex].uGroupId);
+    if (it == m_groupEntries.end()) {
+        return;
+    }
+
+    QVector<quint32>& vEntries = it.value();
+    auto itPos = std::lower_bound(vEntries.begin(), vEntries.end(), dwIndex);
+    if (itPos != vEntries.end() && *itPos == dwIndex) {
+        vEntries.erase(itPos);
+    }
+
+    if (vEntries.isEmpty()) {
+        m_groupEntries.erase(it);
+    }
+}
+
+void PwManager::rebuildGroupEntryLists()
+{
+    m_groupEntries.clear();
+
+    for (quint32 i = 0; i < m_numEntries; ++i)
+        linkEntryToGroup(i);
 }
 
 PW_ENTRY* PwManager::getEntryByUuid(const quint8* pUuid)
 {
-    if (!pUuid)
+    const quint32 dwIndex = getEntryByUuidN(pUuid);
+    if (dwIndex == DWORD_MAX)
         return nullptr;
 
-    for (quint32 i = 0; i < m_numEntries; ++i) {
-        if (std::memcmp(m_pEntries[i].uuid, pUuid, 16) == 0)
-            return &m_pEntries[i];
+    return &m_pEntries[dwIndex];
+}
+
+quint32 PwManager::getEntryByUuidN(const quint8* pUuid) const
+{
+    // Reference: MFC CPwManager::GetEntryByUuidN (linear scan);
+    // here the UUID index answers in constant time
+    if (!pUuid)
+        return DWORD_MAX;
+
+    return m_uuidIndex.value(PwUuidKey::fromBytes(pUuid), DWORD_MAX);
+}
+
+QVector<quint32> PwManager::resolveUuids(const QVector<PW_UUID_STRUCT>& uuids) const
+{
+    // Bulk variant of getEntryByUuidN() for callers resolving many
+    // references at once (merge, field references). Unknown UUIDs
+    // resolve to DWORD_MAX, the result is parallel to the input.
+    QVector<quint32> vIndexes;
+    vIndexes.reserve(uuids.size());
+
+    for (const PW_UUID_STRUCT& u : uuids)
+        vIndexes.append(m_uuidIndex.value(PwUuidKey::fromBytes(u.uuid), DWORD_MAX));
+
+    return vIndexes;
+}
+
+void PwManager::indexEntryUuid(quint32 dwIndex)
+{
+    // The index maps each UUID to its first occurrence, matching the
+    // result of the front-to-back scan it replaces if UUIDs ever collide
+    const PwUuidKey key = PwUuidKey::fromBytes(m_pEntries[dwIndex].uuid);
+    auto it = m_uuidIndex.find(key);
+    if (it == m_uuidIndex.end())
+        m_uuidIndex.insert(key, dwIndex);
+    else if (it.value() > dwIndex)
+        it.value() = dwIndex;
+}
+
+void PwManager::unindexEntryUuid(quint32 dwIndex)
+{
+    const PwUuidKey key = PwUuidKey::fromBytes(m_pEntries[dwIndex].uuid);
+    auto it = m_uuidIndex.find(key);
+    if (it == m_uuidIndex.end() || it.value() != dwIndex)
+        return;
+
+    m_uuidIndex.erase(it);
+
+    // Fall back to a later entry carrying the same UUID, if any
+    for (quint32 i = dwIndex + 1; i < m_numEntries; ++i) {
+        if (std::memcmp(m_pEntries[i].uuid, m_pEntries[dwIndex].uuid, 16) == 0) {
+            m_uuidIndex.insert(key, i);
+            break;
+        }
     }
+}
 
-    return nullptr;
+void PwManager::rebuildUuidIndex()
+{
+    m_uuidIndex.clear();
+    m_uuidIndex.reserve(static_cast<int>(m_numEntries));
+
+    for (quint32 i = 0; i < m_numEntries; ++i)
+        indexEntryUuid(i);
 }
 
-PW_GROUP* PwManager::getGroupById(quint32 idGroup)
+void PwManager::setSearchIndexPasswords(bool bIndexPasswords)
 {
-    for (quint32 i = 0; i < m_numGroups; ++i) {
-        if (m_pGroups[i].uGroupId == idGroup)
-            return &m_pGroups[i];
+    if (bIndexPasswords != m_bSearchIndexPasswords) {
+        m_bSearchIndexPasswords = bIndexPasswords;
+        invalidateSearchIndex();
     }
+}
 
-    return nullptr;
+PwSearchSession& PwManager::getSearchSession()
+{
+    if (!m_pSearchSession)
+        m_pSearchSession = std::make_unique<PwSearchSession>(this);
+    return *m_pSearchSession;
 }
 
-quint32 PwManager::getGroupByIdN(quint32 idGroup) const
+const TrigramIndex& PwManager::getSearchIndex()
 {
-    for (quint32 i = 0; i < m_numGroups; ++i) {
-        if (m_pGroups[i].uGroupId == idGroup)
-            return i;
+    if (!m_bSearchIndexValid) {
+        m_searchIndex.clear();
+        m_bSearchIndexValid = true;
+        for (quint32 i = 0; i < m_numEntries; ++i)
+            updateSearchIndex(i, true);
+    }
+    return m_searchIndex;
+}
+
+void PwManager::updateSearchIndex(quint32 dwIndex, bool bAdd)
+{
+    if (!m_bSearchIndexValid)
+        return;
+
+    // The password (if indexed at all) is decrypted into a locked buffer
+    const PW_ENTRY& e = m_pEntries[dwIndex];
+    const bool bPassword = m_bSearchIndexPasswords && e.uPasswordLen != 0;
+    SecureMemory<char> password(bPassword ? static_cast<size_t>(e.uPasswordLen) + 1 : 1);
+    const char* apszTexts[] = { e.pszTitle, e.pszUserName, e.pszURL, e.pszAdditional, password.data() };
+    if (bPassword)
+        decryptEntryPassword(&e, password.data());
+
+    if (bAdd)
+        m_searchIndex.add(dwIndex, apszTexts, 5);
+    else
+        m_searchIndex.remove(dwIndex, apszTexts, 5);
+}
+
+void PwManager::invalidateSearchIndex()
+{
+    m_searchIndex.clear();
+    m_bSearchIndexValid = false;
+}
+
+const FoldedTextStore& PwManager::getFoldedText()
+{
+    if (!m_bFoldedTextValid) {
+        m_foldedText.clear();
+        m_bFoldedTextValid = true;
+        for (quint32 i = 0; i < m_numEntries; ++i)
+            updateFoldedText(i);
+    }
+    return m_foldedText;
+}
+
+void PwManager::updateFoldedText(quint32 dwIndex)
+{
+    if (!m_bFoldedTextValid)
+        return;
+
+    // Rows are only ever appended at the end
+    if (dwIndex > m_foldedText.getRowCount()) {
+        invalidateFoldedText();
+        return;
+    }
+
+    const PW_ENTRY& e = m_pEntries[dwIndex];
+    const char* apszTexts[FoldedTextStore::ColumnCount] = { e.pszTitle, e.pszUserName, e.pszURL,
+                                                            e.pszAdditional };
+    m_foldedText.setRow(dwIndex, apszTexts);
+}
+
+void PwManager::invalidateFoldedText()
+{
+    m_foldedText.clear();
+    m_bFoldedTextValid = false;
+}
+
+const ExpiryIndex& PwManager::getExpiryIndex()
+{
+    if (!m_bExpiryIndexValid) {
+        m_expiryIndex.clear();
+        m_bExpiryIndexValid = true;
+        for (quint32 i = 0; i < m_numEntries; ++i)
+            updateExpiryIndex(i, true);
     }
+    return m_expiryIndex;
+}
+
+void PwManager::updateExpiryIndex(quint32 dwIndex, bool bAdd)
+{
+    if (!m_bExpiryIndexValid)
+        return;
 
-    return static_cast<quint32>(-1);
+    if (bAdd)
+        m_expiryIndex.insert(dwIndex, &m_pEntries[dwIndex].tExpire);
+    else
+        m_expiryIndex.remove(dwIndex, &m_pEntries[dwIndex].tExpire);
+}
+
+void PwManager::invalidateExpiryIndex()
+{
+    m_expiryIndex.clear();
+    m_bExpiryIndexValid = false;
+}
+
+PW_GROUP* PwManager::getGroupById(quint32 idGroup)
+{
+    const quint32 dwIndex = getGroupByIdN(idGroup);
+    if (dwIndex == DWORD_MAX)
+        return nullptr;
+
+    return &m_pGroups[dwIndex];
+}
+
+quint32 PwManager::getGroupByIdN(quint32 idGroup) const
+{
+    return m_groupIdIndex.value(idGroup, DWORD_MAX);
 }
 
 quint32 PwManager::getGroupId(const QString& groupName) const
@@ -1499,14 +2086,12 @@ quint32 PwManager::getGroupId(const QString& groupName) const
         return DWORD_MAX;
     }
 
-    for (quint32 i = 0; i < m_numGroups; ++i) {
-        QString currentName = QString::fromUtf8(m_pGroups[i].pszGroupName);
-        if (currentName.compare(groupName, Qt::CaseInsensitive) == 0) {
-            return m_pGroups[i].uGroupId;
-        }
+    const quint32 dwIndex = m_groupNameIndex.value(groupName.toCaseFolded(), DWORD_MAX);
+    if (dwIndex == DWORD_MAX) {
+        return DWORD_MAX;
     }
 
-    return DWORD_MAX;
+    return m_pGroups[dwIndex].uGroupId;
 }
 
 quint32 PwManager::getGroupIdByIndex(quint32 uGroupIndex) const
@@ -1521,6 +2106,220 @@ quint32 PwManager::getGroupIdByIndex(quint32 uGroupIndex) const
     return m_pGroups[uGroupIndex].uGroupId;
 }
 
+quint32 PwManager::getLastChildGroup(quint32 dwParentGroupIndex) const
+{
+    // Reference: MFC CPwManager::GetLastChildGroup
+    // Returns the index of the last group in the subtree of the given group,
+    // i.e. the position after which a new child group has to be inserted
+
+    if (m_numGroups <= 1) {
+        return 0;
+    }
+    if (dwParentGroupIndex == DWORD_MAX || dwParentGroupIndex >= (m_numGroups - 1)) {
+        return m_numGroups - 1;
+    }
+
+    quint32 dwLast = dwParentGroupIndex;
+    while (m_vGroupTree[dwLast].dwChildren != 0) {
+        dwLast = m_vGroupTree[dwLast].dwLastChild;
+    }
+
+    return dwLast;
+}
+
+bool PwManager::getGroupTree(quint32 idGroup, quint32* pGroupIndexes) const
+{
+    // Reference: MFC CPwManager::GetGroupTree
+    // Fills pGroupIndexes[level] with the index of the ancestor at that level,
+    // from the root down to the group itself (pGroupIndexes[usLevel])
+
+    if (pGroupIndexes == nullptr) {
+        return false;
+    }
+
+    quint32 dwIndex = getGroupByIdN(idGroup);
+    if (dwIndex == DWORD_MAX) {
+        return false;
+    }
+
+    while (dwIndex != DWORD_MAX) {
+        pGroupIndexes[m_pGroups[dwIndex].usLevel] = dwIndex;
+        dwIndex = m_vGroupTree[dwIndex].dwParent;
+    }
+
+    return true;
+}
+
+quint32 PwManager::getGroupIndex(const PW_GROUP* pGroup) const
+{
+    if (pGroup == nullptr || m_pGroups == nullptr) {
+        return DWORD_MAX;
+    }
+
+    // Compare as integers: pGroup may point into a different array
+    const quintptr uBase = reinterpret_cast<quintptr>(m_pGroups);
+    const quintptr uPtr = reinterpret_cast<quintptr>(pGroup);
+    if (uPtr < uBase || ((uPtr - uBase) % sizeof(PW_GROUP)) != 0) {
+        return DWORD_MAX;
+    }
+
+    const quintptr uIndex = (uPtr - uBase) / sizeof(PW_GROUP);
+    if (uIndex >= m_numGroups) {
+        return DWORD_MAX;
+    }
+
+    return static_cast<quint32>(uIndex);
+}
+
+quint32 PwManager::getGroupParentN(quint32 dwGroupIndex) const
+{
+    if (dwGroupIndex >= m_numGroups) {
+        return DWORD_MAX;
+    }
+
+    return m_vGroupTree[dwGroupIndex].dwParent;
+}
+
+quint32 PwManager::getGroupRowN(quint32 dwGroupIndex) const
+{
+    if (dwGroupIndex >= m_numGroups) {
+        return DWORD_MAX;
+    }
+
+    return m_vGroupTree[dwGroupIndex].dwRow;
+}
+
+quint32 PwManager::getGroupChildCount(quint32 dwParentIndex) const
+{
+    if (dwParentIndex == DWORD_MAX) {
+        return m_groupTreeRoot.dwChildren;
+    }
+    if (dwParentIndex >= m_numGroups) {
+        return 0;
+    }
+
+    return m_vGroupTree[dwParentIndex].dwChildren;
+}
+
+quint32 PwManager::getGroupChildN(quint32 dwParentIndex, quint32 dwRow) const
+{
+    const PwGroupTreeNode* pParent = nullptr;
+    if (dwParentIndex == DWORD_MAX) {
+        pParent = &m_groupTreeRoot;
+    } else if (dwParentIndex < m_numGroups) {
+        pParent = &m_vGroupTree[dwParentIndex];
+    } else {
+        return DWORD_MAX;
+    }
+
+    if (dwRow >= pParent->dwChildren) {
+        return DWORD_MAX;
+    }
+
+    return pParent->vChildren[static_cast<int>(dwRow)];
+}
+
+QString PwManager::groupNameKey(const char* pszGroupName)
+{
+    return QString::fromUtf8(pszGroupName != nullptr ? pszGroupName : "").toCaseFolded();
+}
+
+void PwManager::linkGroup(quint32 dwIndex)
+{
+    // Groups are stored in pre-order, so the parent of a group is the nearest
+    // preceding group with a lower level: an ancestor of its predecessor
+    Q_ASSERT(static_cast<quint32>(m_vGroupTree.size()) == dwIndex);
+
+    const quint16 usLevel = m_pGroups[dwIndex].usLevel;
+    quint32 dwParent = DWORD_MAX;
+    if (dwIndex > 0 && usLevel > 0) {
+        dwParent = dwIndex - 1;
+        while (dwParent != DWORD_MAX && m_pGroups[dwParent].usLevel >= usLevel) {
+            dwParent = m_vGroupTree[dwParent].dwParent;
+        }
+    }
+
+    m_vGroupTree.append(makeGroupTreeNode(dwParent));
+
+    PwGroupTreeNode& parent = (dwParent == DWORD_MAX) ? m_groupTreeRoot : m_vGroupTree[dwParent];
+    if (parent.dwChildren == 0) {
+        parent.dwFirstChild = dwIndex;
+    } else {
+        m_vGroupTree[parent.dwLastChild].dwNextSibling = dwIndex;
+    }
+    parent.dwLastChild = dwIndex;
+    parent.vChildren.append(dwIndex);
+    m_vGroupTree[dwIndex].dwRow = parent.dwChildren++;
+}
+
+void PwManager::indexGroup(quint32 dwIndex)
+{
+    // Both maps point to the first group with a given ID / name, matching
+    // the front-to-back scans they replace
+    auto itId = m_groupIdIndex.find(m_pGroups[dwIndex].uGroupId);
+    if (itId == m_groupIdIndex.end())
+        m_groupIdIndex.insert(m_pGroups[dwIndex].uGroupId, dwIndex);
+    else if (itId.value() > dwIndex)
+        itId.value() = dwIndex;
+
+    const QString strKey = groupNameKey(m_pGroups[dwIndex].pszGroupName);
+    auto itName = m_groupNameIndex.find(strKey);
+    if (itName == m_groupNameIndex.end())
+        m_groupNameIndex.insert(strKey, dwIndex);
+    else if (itName.value() > dwIndex)
+        itName.value() = dwIndex;
+}
+
+void PwManager::unindexGroupId(quint32 dwIndex)
+{
+    const quint32 uGroupId = m_pGroups[dwIndex].uGroupId;
+    auto it = m_groupIdIndex.find(uGroupId);
+    if (it == m_groupIdIndex.end() || it.value() != dwIndex)
+        return;
+
+    m_groupIdIndex.erase(it);
+
+    for (quint32 i = dwIndex + 1; i < m_numGroups; ++i) {
+        if (m_pGroups[i].uGroupId == uGroupId) {
+            m_groupIdIndex.insert(uGroupId, i);
+            break;
+        }
+    }
+}
+
+void PwManager::unindexGroupName(quint32 dwIndex)
+{
+    const QString strKey = groupNameKey(m_pGroups[dwIndex].pszGroupName);
+    auto it = m_groupNameIndex.find(strKey);
+    if (it == m_groupNameIndex.end() || it.value() != dwIndex)
+        return;
+
+    m_groupNameIndex.erase(it);
+
+    for (quint32 i = dwIndex + 1; i < m_numGroups; ++i) {
+        if (groupNameKey(m_pGroups[i].pszGroupName) == strKey) {
+            m_groupNameIndex.insert(strKey, i);
+            break;
+        }
+    }
+}
+
+void PwManager::rebuildGroupIndex()
+{
+    m_vGroupTree.clear();
+    m_vGroupTree.reserve(static_cast<int>(m_numGroups));
+    m_groupTreeRoot = makeGroupTreeNode(DWORD_MAX);
+    m_groupIdIndex.clear();
+    m_groupIdIndex.reserve(static_cast<int>(m_numGroups));
+    m_groupNameIndex.clear();
+    m_groupNameIndex.reserve(static_cast<int>(m_numGroups));
+
+    for (quint32 i = 0; i < m_numGroups; ++i) {
+        indexGroup(i);
+        linkGroup(i);
+    }
+}
+
 PW_ENTRY* PwManager::getLastEditedEntry()
 {
     return m_pLastEditedEntry;
@@ -1546,15 +2345,7 @@ bool PwManager::addGroup(const PW_GROUP* pTemplate)
             }
 
             // Check if this ID already exists
-            bool exists = false;
-            for (quint32 i = 0; i < m_numGroups; ++i) {
-                if (m_pGroups[i].uGroupId == newId) {
-                    exists = true;
-                    break;
-                }
-            }
-
-            if (!exists) {
+            if (!m_groupIdIndex.contains(newId)) {
                 break;
             }
         }
@@ -1563,22 +2354,18 @@ bool PwManager::addGroup(const PW_GROUP* pTemplate)
 
     // Expand array if needed
     if (m_numGroups == m_maxGroups) {
-        quint32 newMax = m_maxGroups + 8;
-        PW_GROUP* newGroups = new PW_GROUP[newMax];
-        std::memset(newGroups, 0, newMax * sizeof(PW_GROUP));
-
-        // Copy existing groups
-        if (m_pGroups != nullptr) {
-            std::memcpy(newGroups, m_pGroups, m_numGroups * sizeof(PW_GROUP));
-            delete[] m_pGroups;
-        }
-
-        m_pGroups = newGroups;
-        m_maxGroups = newMax;
+        reserveGroups(grownCapacity(m_maxGroups, m_numGroups + 1, INITIAL_GROUPS));
     }
 
     ++m_numGroups;
-    return setGroup(m_numGroups - 1, &groupCopy);
+    if (!setGroup(m_numGroups - 1, &groupCopy)) {
+        return false;
+    }
+
+    // Appending never changes existing links: hook the group into the tree
+    indexGroup(m_numGroups - 1);
+    linkGroup(m_numGroups - 1);
+    return true;
 }
 
 bool PwManager::setGroup(quint32 dwIndex, const PW_GROUP* pTemplate)
@@ -1595,19 +2382,24 @@ bool PwManager::setGroup(quint32 dwIndex, const PW_GROUP* pTemplate)
         return false;
     }
 
-    // Free old group name
-    delete[] m_pGroups[dwIndex].pszGroupName;
-
-    // Allocate and copy new group name
-    if (pTemplate->pszGroupName) {
-        size_t len = std::strlen(pTemplate->pszGroupName);
-        m_pGroups[dwIndex].pszGroupName = new char[len + 1];
-        std::strcpy(m_pGroups[dwIndex].pszGroupName, pTemplate->pszGroupName);
-    } else {
-        m_pGroups[dwIndex].pszGroupName = new char[1];
-        m_pGroups[dwIndex].pszGroupName[0] = '\0';
+    // Groups not yet in the tree index are being appended by addGroup
+    const bool bIndexed = (dwIndex < static_cast<quint32>(m_vGroupTree.size()));
+    const bool bLevelChanged = bIndexed && (m_pGroups[dwIndex].usLevel != pTemplate->usLevel);
+    if (bIndexed) {
+        const char* pszOld = m_pGroups[dwIndex].pszGroupName;
+        const char* pszNew = pTemplate->pszGroupName;
+        if (std::strcmp(pszOld ? pszOld : "", pszNew ? pszNew : "") != 0) {
+            unindexGroupName(dwIndex);
+        }
+        if (m_pGroups[dwIndex].uGroupId != pTemplate->uGroupId) {
+            unindexGroupId(dwIndex);
+        }
     }
 
+    // Copy the group name into the arena (nullptr becomes "")
+    m_pGroups[dwIndex].pszGroupName =
+        m_stringArena.assign(m_pGroups[dwIndex].pszGroupName, pTemplate->pszGroupName);
+
     // Copy all fields
     m_pGroups[dwIndex].uGroupId = pTemplate->uGroupId;
     m_pGroups[dwIndex].uImageId = pTemplate->uImageId;
@@ -1619,6 +2411,13 @@ bool PwManager::setGroup(quint32 dwIndex, const PW_GROUP* pTemplate)
     m_pGroups[dwIndex].tLastAccess = pTemplate->tLastAccess;
     m_pGroups[dwIndex].tExpire = pTemplate->tExpire;
 
+    if (bLevelChanged) {
+        rebuildGroupIndex();
+    } else if (bIndexed) {
+        indexGroup(dwIndex);
+    }
+    ++m_uContentVersion;
+
     return true;
 }
 
@@ -1645,40 +2444,34 @@ bool PwManager::setEntry(quint32 dwIndex, const PW_ENTRY* pTemplate)
 
     PW_ENTRY* entry = &m_pEntries[dwIndex];
 
-    // Copy UUID
-    std::memcpy(entry->uuid, pTemplate->uuid, 16);
-    entry->uGroupId = pTemplate->uGroupId;
+    // Drop the old texts from the search index (new slots have group 0)
+    if (entry->uGroupId != 0) {
+        updateSearchIndex(dwIndex, false);
+        updateExpiryIndex(dwIndex, false);
+    }
+
+    // Copy UUID (and keep the UUID index in sync if it changes)
+    if (std::memcmp(entry->uuid, pTemplate->uuid, 16) != 0) {
+        unindexEntryUuid(dwIndex);
+        std::memcpy(entry->uuid, pTemplate->uuid, 16);
+    }
+    indexEntryUuid(dwIndex);
+
+    // Keep the per-group membership lists in sync (new slots have group 0)
+    if (entry->uGroupId != pTemplate->uGroupId) {
+        unlinkEntryFromGroup(dwIndex);
+        entry->uGroupId = pTemplate->uGroupId;
+        linkEntryToGroup(dwIndex);
+    }
     entry->uImageId = pTemplate->uImageId;
 
-    // Free and allocate title
-    delete[] entry->pszTitle;
-    size_t len = std::strlen(pTemplate->pszTitle);
-    entry->pszTitle = new char[len + 1];
-    std::strcpy(entry->pszTitle, pTemplate->pszTitle);
-
-    // Free and allocate username
-    delete[] entry->pszUserName;
-    len = std::strlen(pTemplate->pszUserName);
-    entry->pszUserName = new char[len + 1];
-    std::strcpy(entry->pszUserName, pTemplate->pszUserName);
-
-    // Free and allocate URL
-    delete[] entry->pszURL;
-    len = std::strlen(pTemplate->pszURL);
-    entry->pszURL = new char[len + 1];
-    std::strcpy(entry->pszURL, pTemplate->pszURL);
-
-    // Free and allocate password
-    delete[] entry->pszPassword;
-    len = std::strlen(pTemplate->pszPassword);
-    entry->pszPassword = new char[len + 1];
-    std::strcpy(entry->pszPassword, pTemplate->pszPassword);
-
-    // Free and allocate additional
-    delete[] entry->pszAdditional;
-    len = std::strlen(pTemplate->pszAdditional);
-    entry->pszAdditional = new char[len + 1];
-    std::strcpy(entry->pszAdditional, pTemplate->pszAdditional);
+    // Copy the strings into the arena (a value that fits overwrites the old one)
+    entry->pszTitle = m_stringArena.assign(entry->pszTitle, pTemplate->pszTitle);
+    entry->pszUserName = m_stringArena.assign(entry->pszUserName, pTemplate->pszUserName);
+    entry->pszURL = m_stringArena.assign(entry->pszURL, pTemplate->pszURL);
+    const char* pszOldPassword = entry->pszPassword;
+    entry->pszPassword = m_stringArena.assign(entry->pszPassword, pTemplate->pszPassword);
+    entry->pszAdditional = m_stringArena.assign(entry->pszAdditional, pTemplate->pszAdditional);
 
     // Handle binary data (only if different from current)
     if (!((entry->pBinaryData == pTemplate->pBinaryData) &&
@@ -1687,7 +2480,7 @@ bool PwManager::setEntry(quint32 dwIndex, const PW_ENTRY* pTemplate)
         // Free old binary desc
         delete[] entry->pszBinaryDesc;
         if (pTemplate->pszBinaryDesc) {
-            len = std::strlen(pTemplate->pszBinaryDesc);
+            const size_t len = std::strlen(pTemplate->pszBinaryDesc);
             entry->pszBinaryDesc = new char[len + 1];
             std::strcpy(entry->pszBinaryDesc, pTemplate->pszBinaryDesc);
         } else {
@@ -1696,9 +2489,11 @@ bool PwManager::setEntry(quint32 dwIndex, const PW_ENTRY* pTemplate)
         }
 
         // Free old binary data
-        delete[] entry->pBinaryData;
+        SecureArena::release(entry->pBinaryData);
         if (pTemplate->pBinaryData && pTemplate->uBinaryDataLen > 0) {
-            entry->pBinaryData = new BYTE[pTemplate->uBinaryDataLen];
+            entry->pBinaryData = static_cast<BYTE*>(SecureArena::allocate(pTemplate->uBinaryDataLen));
+            if (entry->pBinaryData == nullptr)
+                throw std::bad_alloc();
             std::memcpy(entry->pBinaryData, pTemplate->pBinaryData, pTemplate->uBinaryDataLen);
             entry->uBinaryDataLen = pTemplate->uBinaryDataLen;
         } else {
@@ -1709,13 +2504,21 @@ bool PwManager::setEntry(quint32 dwIndex, const PW_ENTRY* pTemplate)
 
     // Update password length and lock it
     entry->uPasswordLen = static_cast<DWORD>(std::strlen(entry->pszPassword));
+    if (pszOldPassword != entry->pszPassword) {
+        m_passwordNonces.remove(pszOldPassword);
+    }
+    renewPasswordNonce(entry);
     lockEntryPassword(entry);
+    updateSearchIndex(dwIndex, true);
+    updateFoldedText(dwIndex);
+    ++m_uContentVersion;
 
     // Copy timestamps
     entry->tCreation = pTemplate->tCreation;
     entry->tLastMod = pTemplate->tLastMod;
     entry->tLastAccess = pTemplate->tLastAccess;
     entry->tExpire = pTemplate->tExpire;
+    updateExpiryIndex(dwIndex, true);
 
     // Ensure binary desc is never null
     if (entry->pszBinaryDesc == nullptr) {
@@ -1741,59 +2544,159 @@ bool PwManager::addEntry(const PW_ENTRY* pTemplate)
 
     // Expand array if needed
     if (m_numEntries == m_maxEntries) {
-        quint32 newMax = m_maxEntries + 32;
-        PW_ENTRY* newEntries = new PW_ENTRY[newMax];
-        std::memset(newEntries, 0, newMax * sizeof(PW_ENTRY));
-
-        // Copy existing entries
-        if (m_pEntries != nullptr) {
-            std::memcpy(newEntries, m_pEntries, m_numEntries * sizeof(PW_ENTRY));
-            delete[] m_pEntries;
-        }
-
-        m_pEntries = newEntries;
-        m_maxEntries = newMax;
+        reserveEntries(grownCapacity(m_maxEntries, m_numEntries + 1, INITIAL_ENTRIES));
     }
 
     // Copy template to local variable
     PW_ENTRY entryCopy = *pTemplate;
 
     // Generate UUID if it's all zeros
-    bool isZeroUuid = true;
-    for (int i = 0; i < 16; ++i) {
-        if (entryCopy.uuid[i] != 0) {
-            isZeroUuid = false;
-            break;
+    if (isZeroUuid(entryCopy.uuid)) {
+        Random::generateUuid(entryCopy.uuid);
+    }
+
+    // Map nullptr pointers to empty strings
+    mapNullStringsToEmpty(&entryCopy);
+
+    ++m_numEntries;
+    return setEntry(m_numEntries - 1, &entryCopy);
+}
+
+bool PwManager::addEntries(const PW_ENTRY* pTemplates, quint32 dwCount)
+{
+    // Batch version of addEntry() for imports: the array grows at most once,
+    // all missing UUIDs come from a single random generator call, and each
+    // entry is copied and its password locked in one pass.
+
+    if (dwCount == 0) {
+        return true;
+    }
+    Q_ASSERT(pTemplates != nullptr);
+    if (pTemplates == nullptr || dwCount > (DWORD_MAX - 1 - m_numEntries)) {
+        return false;
+    }
+
+    // Validate and allocate everything first; should copying an entry still
+    // fail (the string or attachment arenas throw std::bad_alloc), the
+    // entries added so far are discarded again: the batch is added
+    // completely or not at all
+    quint32 dwNeedUuid = 0;
+    for (quint32 i = 0; i < dwCount; ++i) {
+        if (pTemplates[i].uGroupId == 0 || pTemplates[i].uGroupId == DWORD_MAX) {
+            return false;
         }
+        if (isZeroUuid(pTemplates[i].uuid)) {
+            ++dwNeedUuid;
+        }
+    }
+
+    QByteArray vUuids(static_cast<int>(dwNeedUuid * 16), '\0');
+    if (dwNeedUuid > 0 &&
+        !Random::generateUuids(reinterpret_cast<quint8*>(vUuids.data()), dwNeedUuid)) {
+        return false;
     }
 
-    if (isZeroUuid) {
-        Random::fillBuffer(entryCopy.uuid, 16);
+    if (m_numEntries + dwCount > m_maxEntries) {
+        reserveEntries(grownCapacity(m_maxEntries, m_numEntries + dwCount, INITIAL_ENTRIES));
     }
+    m_uuidIndex.reserve(static_cast<int>(m_numEntries + dwCount));
 
-    // Map nullptr pointers to empty strings
-    static const char emptyString[] = "";
-    if (entryCopy.pszTitle == nullptr) {
-        entryCopy.pszTitle = const_cast<char*>(emptyString);
+    const quint32 dwFirst = m_numEntries;
+    const char* pNextUuid = vUuids.constData();
+    try {
+        for (quint32 i = 0; i < dwCount; ++i) {
+            PW_ENTRY entryCopy = pTemplates[i];
+            if (isZeroUuid(entryCopy.uuid)) {
+                std::memcpy(entryCopy.uuid, pNextUuid, 16);
+                pNextUuid += 16;
+            }
+            mapNullStringsToEmpty(&entryCopy);
+
+            ++m_numEntries;
+            if (!setEntry(m_numEntries - 1, &entryCopy)) {
+                discardEntriesFrom(dwFirst);  // Not reached, the templates were validated above
+                return false;
+            }
+        }
+    } catch (...) {
+        discardEntriesFrom(dwFirst);
+        throw;
     }
-    if (entryCopy.pszUserName == nullptr) {
-        entryCopy.pszUserName = const_cast<char*>(emptyString);
+
+    return true;
+}
+
+void PwManager::discardEntriesFrom(quint32 dwFirst)
+{
+    // Removes the entries dwFirst.. that a failed addEntries() call appended.
+    // The slot setEntry() gave up on may be half filled; its unset pointers
+    // are still null, as new slots are zeroed.
+    for (quint32 i = dwFirst; i < m_numEntries; ++i) {
+        PW_ENTRY* pe = &m_pEntries[i];
+        m_stringArena.release(pe->pszTitle);
+        m_stringArena.release(pe->pszURL);
+        m_stringArena.release(pe->pszUserName);
+        m_passwordNonces.remove(pe->pszPassword);
+        m_stringArena.release(pe->pszPassword);
+        m_stringArena.release(pe->pszAdditional);
+        delete[] pe->pszBinaryDesc;
+        SecureArena::release(pe->pBinaryData);
+        if (m_pLastEditedEntry == pe) {
+            m_pLastEditedEntry = nullptr;
+        }
     }
-    if (entryCopy.pszURL == nullptr) {
-        entryCopy.pszURL = const_cast<char*>(emptyString);
+
+    MemUtil::mem_erase(&m_pEntries[dwFirst], (m_numEntries - dwFirst) * sizeof(PW_ENTRY));
+    m_numEntries = dwFirst;
+    ++m_uContentVersion;
+
+    // The derived indexes may hold some of the discarded entries
+    rebuildUuidIndex();
+    rebuildGroupEntryLists();
+    invalidateSearchIndex();
+    invalidateFoldedText();
+    invalidateExpiryIndex();
+}
+
+void PwManager::reserveEntries(quint32 uCount)
+{
+    // Grows the entry array to hold at least uCount entries (never shrinks)
+    if (uCount <= m_maxEntries) {
+        return;
     }
-    if (entryCopy.pszPassword == nullptr) {
-        entryCopy.pszPassword = const_cast<char*>(emptyString);
+
+    PW_ENTRY* newEntries = new PW_ENTRY[uCount];
+    std::memset(newEntries, 0, uCount * sizeof(PW_ENTRY));
+
+    // Copy existing entries
+    if (m_pEntries != nullptr) {
+        std::memcpy(newEntries, m_pEntries, m_numEntries * sizeof(PW_ENTRY));
+        delete[] m_pEntries;
     }
-    if (entryCopy.pszAdditional == nullptr) {
-        entryCopy.pszAdditional = const_cast<char*>(emptyString);
+
+    m_pEntries = newEntries;
+    m_maxEntries = uCount;
+}
+
+void PwManager::reserveGroups(quint32 uCount)
+{
+    // Grows the group array to hold at least uCount groups (never shrinks)
+    if (uCount <= m_maxGroups) {
+        return;
     }
-    if (entryCopy.pszBinaryDesc == nullptr) {
-        entryCopy.pszBinaryDesc = const_cast<char*>(emptyString);
+
+    PW_GROUP* newGroups = new PW_GROUP[uCount];
+    std::memset(newGroups, 0, uCount * sizeof(PW_GROUP));
+
+    // Copy existing groups
+    if (m_pGroups != nullptr) {
+        std::memcpy(newGroups, m_pGroups, m_numGroups * sizeof(PW_GROUP));
+        delete[] m_pGroups;
     }
 
-    ++m_numEntries;
-    return setEntry(m_numEntries - 1, &entryCopy);
+    m_pGroups = newGroups;
+    m_maxGroups = uCount;
+    m_vGroupTree.reserve(static_cast<int>(uCount));
 }
 
 bool PwManager::backupEntry(const PW_ENTRY* pe, bool* pbGroupCreated)
@@ -1805,6 +2708,25 @@ bool PwManager::backupEntry(const PW_ENTRY* pe, bool* pbGroupCreated)
         return false;
     }
 
+    const quint32 dwGroupId = getOrCreateBackupGroup(pbGroupCreated);
+    if (dwGroupId == DWORD_MAX) {
+        return false;
+    }
+
+    // Create backup copy of entry
+    PW_ENTRY pwe = *pe;
+    QDateTime now = QDateTime::currentDateTime();
+    PwUtil::dateTimeToPwTime(now, &pwe.tLastMod);
+    pwe.uGroupId = dwGroupId;
+    std::memset(&pwe.uuid, 0, 16);  // Zero UUID so new one is generated
+
+    return addEntry(&pwe);
+}
+
+quint32 PwManager::getOrCreateBackupGroup(bool* pbGroupCreated)
+{
+    // Returns the ID of the "Backup" group, creating it if necessary
+
     if (pbGroupCreated != nullptr) {
         *pbGroupCreated = false;
     }
@@ -1825,7 +2747,7 @@ bool PwManager::backupEntry(const PW_ENTRY* pe, bool* pbGroupCreated)
         pwg.uImageId = 4;  // Icon for backup group
 
         if (!addGroup(&pwg)) {
-            return false;
+            return DWORD_MAX;
         }
 
         if (pbGroupCreated != nullptr) {
@@ -1835,18 +2757,7 @@ bool PwManager::backupEntry(const PW_ENTRY* pe, bool* pbGroupCreated)
         dwGroupId = getGroupId("Backup");
     }
 
-    if (dwGroupId == DWORD_MAX) {
-        return false;
-    }
-
-    // Create backup copy of entry
-    PW_ENTRY pwe = *pe;
-    QDateTime now = QDateTime::currentDateTime();
-    PwUtil::dateTimeToPwTime(now, &pwe.tLastMod);
-    pwe.uGroupId = dwGroupId;
-    std::memset(&pwe.uuid, 0, 16);  // Zero UUID so new one is generated
-
-    return addEntry(&pwe);
+    return dwGroupId;
 }
 
 bool PwManager::deleteEntry(quint32 dwIndex)
@@ -1859,21 +2770,64 @@ bool PwManager::deleteEntry(quint32 dwIndex)
         return false;
     }
 
+    unlinkEntryFromGroup(dwIndex);
+    updateSearchIndex(dwIndex, false);
+    ++m_uContentVersion;
+
     // Free all dynamically allocated memory for this entry
-    delete[] m_pEntries[dwIndex].pszTitle;
-    delete[] m_pEntries[dwIndex].pszURL;
-    delete[] m_pEntries[dwIndex].pszUserName;
-    delete[] m_pEntries[dwIndex].pszPassword;
-    delete[] m_pEntries[dwIndex].pszAdditional;
+    m_stringArena.release(m_pEntries[dwIndex].pszTitle);
+    m_stringArena.release(m_pEntries[dwIndex].pszURL);
+    m_stringArena.release(m_pEntries[dwIndex].pszUserName);
+    m_passwordNonces.remove(m_pEntries[dwIndex].pszPassword);
+    m_stringArena.release(m_pEntries[dwIndex].pszPassword);
+    m_stringArena.release(m_pEntries[dwIndex].pszAdditional);
     delete[] m_pEntries[dwIndex].pszBinaryDesc;
-    delete[] m_pEntries[dwIndex].pBinaryData;
+    SecureArena::release(m_pEntries[dwIndex].pBinaryData);
+
+    // Drop the UUID index slot before the entry is overwritten; a
+    // duplicate UUID further down is picked up while shifting below
+    const PwUuidKey key = PwUuidKey::fromBytes(m_pEntries[dwIndex].uuid);
+    auto itKey = m_uuidIndex.find(key);
+    if (itKey != m_uuidIndex.end() && itKey.value() == dwIndex)
+        m_uuidIndex.erase(itKey);
 
     // If not the last entry, shift all entries after it down by one position
     if (dwIndex != (m_numEntries - 1)) {
         for (quint32 i = dwIndex; i < (m_numEntries - 1); ++i) {
             m_pEntries[i] = m_pEntries[i + 1];
+
+            auto it = m_uuidIndex.find(PwUuidKey::fromBytes(m_pEntries[i].uuid));
+            if (it == m_uuidIndex.end())
+                m_uuidIndex.insert(PwUuidKey::fromBytes(m_pEntries[i].uuid), i);
+            else if (it.value() == i + 1)
+                it.value() = i;
+        }
+    }
+
+    // Entries behind the deleted one moved down by one position
+    for (auto it = m_groupEntries.begin(); it != m_groupEntries.end(); ++it) {
+        QVector<quint32>& vEntries = it.value();
+        for (auto itPos = std::upper_bound(vEntries.begin(), vEntries.end(), dwIndex);
+             itPos != vEntries.end(); ++itPos) {
+            --(*itPos);
+        }
+    }
+    if (m_bSearchIndexValid || m_bExpiryIndexValid) {
+        QVector<quint32> vNewIndexes(static_cast<int>(m_numEntries));
+        std::iota(vNewIndexes.begin(), vNewIndexes.end(), 0U);
+        for (quint32 i = dwIndex + 1; i < m_numEntries; ++i)
+            vNewIndexes[i] = i - 1;
+        if (m_bSearchIndexValid) {
+            m_searchIndex.remapIds(vNewIndexes.constData(), dwIndex);
+        }
+        if (m_bExpiryIndexValid) {
+            vNewIndexes[dwIndex] = ExpiryIndex::REMOVED;
+            m_expiryIndex.remapIndexes(vNewIndexes.constData(), dwIndex);
         }
     }
+    if (m_bFoldedTextValid) {
+        m_foldedText.removeRows(&dwIndex, 1);
+    }
 
     // Securely erase the last entry's memory
     MemUtil::mem_erase(&m_pEntries[m_numEntries - 1], sizeof(PW_ENTRY));
@@ -1882,6 +2836,138 @@ bool PwManager::deleteEntry(quint32 dwIndex)
     return true;
 }
 
+quint32 PwManager::deleteEntries(const QVector<quint32>& vIndices)
+{
+    // Deletes a set of entries (any order, duplicates and invalid indexes
+    // are ignored) with a single stable compaction pass instead of one
+    // shift of the remaining entries per deleted entry.
+    // Returns the number of deleted entries.
+
+    QVector<bool> vDelete(static_cast<int>(m_numEntries), false);
+    quint32 dwFirst = m_numEntries;
+    quint32 dwDeleted = 0;
+    for (quint32 dwIndex : vIndices) {
+        if (dwIndex < m_numEntries && !vDelete[dwIndex]) {
+            vDelete[dwIndex] = true;
+            dwFirst = qMin(dwFirst, dwIndex);
+            ++dwDeleted;
+        }
+    }
+
+    if (dwDeleted == 0) {
+        return 0;
+    }
+
+    // Free the deleted entries' strings and attachments, then move the
+    // remaining ones down in order
+    QVector<quint32> vNewIndexes;
+    if (m_bSearchIndexValid || m_bExpiryIndexValid) {
+        vNewIndexes.resize(static_cast<int>(m_numEntries));
+    }
+    quint32 dwOut = dwFirst;
+    for (quint32 i = dwFirst; i < m_numEntries; ++i) {
+        PW_ENTRY* pe = &m_pEntries[i];
+        if (!vNewIndexes.isEmpty()) {
+            vNewIndexes[i] = dwOut;
+        }
+        if (vDelete[i]) {
+            updateSearchIndex(i, false);
+            m_stringArena.release(pe->pszTitle);
+            m_stringArena.release(pe->pszURL);
+            m_stringArena.release(pe->pszUserName);
+            m_passwordNonces.remove(pe->pszPassword);
+            m_stringArena.release(pe->pszPassword);
+            m_stringArena.release(pe->pszAdditional);
+            delete[] pe->pszBinaryDesc;
+            SecureArena::release(pe->pBinaryData);
+        } else {
+            if (dwOut != i) {
+                m_pEntries[dwOut] = *pe;
+            }
+            ++dwOut;
+        }
+    }
+
+    // Securely erase the vacated tail
+    MemUtil::mem_erase(&m_pEntries[dwOut], (m_numEntries - dwOut) * sizeof(PW_ENTRY));
+    m_numEntries = dwOut;
+    ++m_uContentVersion;
+
+    rebuildUuidIndex();
+    rebuildGroupEntryLists();
+    if (m_bSearchIndexValid) {
+        m_searchIndex.remapIds(vNewIndexes.constData(), dwFirst);
+    }
+    if (m_bExpiryIndexValid) {
+        for (int i = static_cast<int>(dwFirst); i < vDelete.size(); ++i) {
+            if (vDelete[i]) {
+                vNewIndexes[i] = ExpiryIndex::REMOVED;
+            }
+        }
+        m_expiryIndex.remapIndexes(vNewIndexes.constData(), dwFirst);
+    }
+    if (m_bFoldedTextValid) {
+        QVector<quint32> vDeletedRows;
+        vDeletedRows.reserve(static_cast<int>(dwDeleted));
+        for (int i = static_cast<int>(dwFirst); i < vDelete.size(); ++i) {
+            if (vDelete[i]) {
+                vDeletedRows.append(static_cast<quint32>(i));
+            }
+        }
+        m_foldedText.removeRows(vDeletedRows.constData(), dwDeleted);
+    }
+
+    return dwDeleted;
+}
+
+quint32 PwManager::deleteEntries(const std::function<bool(const PW_ENTRY*)>& fnPredicate)
+{
+    // Deletes all entries for which fnPredicate returns true
+
+    QVector<quint32> vIndices;
+    for (quint32 i = 0; i < m_numEntries; ++i) {
+        if (fnPredicate(&m_pEntries[i])) {
+            vIndices.append(i);
+        }
+    }
+
+    return deleteEntries(vIndices);
+}
+
+bool PwManager::setEntryGroup(quint32 dwIndex, quint32 uGroupId)
+{
+    // Moves an entry into another group without touching its other fields
+
+    if (dwIndex >= m_numEntries || uGroupId == 0 || uGroupId == DWORD_MAX) {
+        return false;
+    }
+
+    if (m_pEntries[dwIndex].uGroupId != uGroupId) {
+        unlinkEntryFromGroup(dwIndex);
+        m_pEntries[dwIndex].uGroupId = uGroupId;
+        linkEntryToGroup(dwIndex);
+        ++m_uContentVersion;
+    }
+
+    return true;
+}
+
+bool PwManager::setEntryExpiry(quint32 dwIndex, const PW_TIME* pExpire)
+{
+    // Changes an entry's expiration time without touching its other fields
+
+    if (dwIndex >= m_numEntries || pExpire == nullptr) {
+        return false;
+    }
+
+    updateExpiryIndex(dwIndex, false);
+    m_pEntries[dwIndex].tExpire = *pExpire;
+    updateExpiryIndex(dwIndex, true);
+    ++m_uContentVersion;
+
+    return true;
+}
+
 bool PwManager::deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries)
 {
     // Reference: MFC/MFC-KeePass/KeePassLibCpp/PwManager.cpp:885-930
@@ -1896,30 +2982,42 @@ bool PwManager::deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries)
     quint32 dwInvGroup1 = getGroupId("Backup");
     quint32 dwInvGroup2 = getGroupId("Backup (from Templates)");
 
-    // Delete all entries in this group
-    if (m_numEntries > 0) {
-        quint32 i = 0;
-        while (true) {
-            PW_ENTRY *p = &m_pEntries[i];
-            if (p->uGroupId == uGroupId) {
-                // Backup entry if requested and not already in a backup group
-                if (bCreateBackupEntries &&
-                    (p->uGroupId != dwInvGroup1) &&
-                    (p->uGroupId != dwInvGroup2)) {
-                    unlockEntryPassword(p);
-                    backupEntry(p, nullptr);
-                    lockEntryPassword(p);
-                }
-
-                // Delete the entry
-                deleteEntry(i);
-                --i;  // Adjust index since we just shifted entries down
+    // The group's entries, taken from the per-group list instead of a scan
+    QVector<quint32> vEntries;
+    auto itGroup = m_groupEntries.constFind(uGroupId);
+    if (itGroup != m_groupEntries.constEnd()) {
+        vEntries = itGroup.value();
+    }
+
+    // Backup entries if requested and not already in a backup group. All
+    // backups are added in one batch; they are appended behind the existing
+    // entries, so vEntries stays valid.
+    if (bCreateBackupEntries && !vEntries.isEmpty() &&
+        (uGroupId != dwInvGroup1) && (uGroupId != dwInvGroup2)) {
+        const quint32 dwBackupGroupId = getOrCreateBackupGroup(nullptr);
+        if (dwBackupGroupId != DWORD_MAX) {
+            PW_TIME tNow;
+            PwUtil::dateTimeToPwTime(QDateTime::currentDateTime(), &tNow);
+
+            QVector<PW_ENTRY> vBackups;
+            vBackups.reserve(vEntries.size());
+            cryptEntryPasswords(vEntries.constData(), static_cast<quint32>(vEntries.size()));  // Unlock
+            for (quint32 dwIndex : vEntries) {
+                PW_ENTRY pwe = m_pEntries[dwIndex];
+                pwe.tLastMod = tNow;
+                pwe.uGroupId = dwBackupGroupId;
+                std::memset(&pwe.uuid, 0, 16);  // Zero UUID so new one is generated
+                vBackups.append(pwe);
             }
 
-            if (++i >= m_numEntries) break;
+            addEntries(vBackups.constData(), static_cast<quint32>(vBackups.size()));
+            cryptEntryPasswords(vEntries.constData(), static_cast<quint32>(vEntries.size()));  // Lock again
         }
     }
 
+    // Delete all entries in this group in one pass
+    deleteEntries(vEntries);
+
     // Find the group index
     quint32 inx = getGroupByIdN(uGroupId);
     if (inx == DWORD_MAX) {
@@ -1927,7 +3025,7 @@ bool PwManager::deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries)
     }
 
     // Free dynamically allocated group name
-    delete[] m_pGroups[inx].pszGroupName;
+    m_stringArena.release(m_pGroups[inx].pszGroupName);
 
     // If not the last group, shift all groups down by one position
     if (inx != (m_numGroups - 1)) {
@@ -1939,8 +3037,9 @@ bool PwManager::deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries)
     // Securely erase the last group's memory
     MemUtil::mem_erase(&m_pGroups[m_numGroups - 1], sizeof(PW_GROUP));
     --m_numGroups;
+    ++m_uContentVersion;
 
-    // Fix group tree hierarchy
+    // Fix group tree hierarchy (also rebuilds the group tree index)
     fixGroupTree();
 
     return true;
@@ -1948,9 +3047,97 @@ bool PwManager::deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries)
 
 void PwManager::sortGroup(quint32 idGroup, quint32 dwSortByField)
 {
-    Q_UNUSED(idGroup);
-    Q_UNUSED(dwSortByField);
-    // TODO: Implement
+    // Reference: MFC CPwManager::SortGroup
+    // Sorts the entries of a group by one field (see the header for the
+    // field numbers). The group's entries only trade places among each
+    // other; entries of other groups keep their positions.
+
+    auto itGroup = m_groupEntries.constFind(idGroup);
+    if (itGroup == m_groupEntries.constEnd() || itGroup.value().size() <= 1) {
+        return;
+    }
+    if (dwSortByField > 9) {
+        return;
+    }
+
+    const QVector<quint32> vSlots = itGroup.value();  // Ascending entry indexes
+    QVector<int> vOrder(vSlots.size());
+    std::iota(vOrder.begin(), vOrder.end(), 0);
+
+    if (dwSortByField == 3) {
+        // Passwords are compared in place, so no plaintext copies are made
+        const quint32 dwSlots = static_cast<quint32>(vSlots.size());
+        cryptEntryPasswords(vSlots.constData(), dwSlots);  // Unlock
+        std::stable_sort(vOrder.begin(), vOrder.end(), [this, &vSlots](int a, int b) {
+            return qstricmp(m_pEntries[vSlots[a]].pszPassword, m_pEntries[vSlots[b]].pszPassword) < 0;
+        });
+        cryptEntryPasswords(vSlots.constData(), dwSlots);  // Lock again
+    } else if (dwSortByField <= 4) {
+        // One collation key per entry instead of per comparison
+        QCollator collator;
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        QVector<QCollatorSortKey> vKeys;
+        vKeys.reserve(vSlots.size());
+        for (quint32 dwIndex : vSlots) {
+            const PW_ENTRY& e = m_pEntries[dwIndex];
+            const char* pszField = (dwSortByField == 0) ? e.pszTitle :
+                                   (dwSortByField == 1) ? e.pszUserName :
+                                   (dwSortByField == 2) ? e.pszURL : e.pszAdditional;
+            vKeys.append(collator.sortKey(QString::fromUtf8(pszField)));
+        }
+        std::stable_sort(vOrder.begin(), vOrder.end(), [&vKeys](int a, int b) {
+            return vKeys[a].compare(vKeys[b]) < 0;
+        });
+    } else if (dwSortByField <= 8) {
+        // Times packed into one integer that orders like the time itself
+        QVector<quint64> vKeys;
+        vKeys.reserve(vSlots.size());
+        for (quint32 dwIndex : vSlots) {
+            const PW_ENTRY& e = m_pEntries[dwIndex];
+            const PW_TIME& t = (dwSortByField == 5) ? e.tCreation :
+                               (dwSortByField == 6) ? e.tLastMod :
+                               (dwSortByField == 7) ? e.tLastAccess : e.tExpire;
+            vKeys.append(PwUtil::timeToKey(&t));
+        }
+        std::stable_sort(vOrder.begin(), vOrder.end(), [&vKeys](int a, int b) {
+            return vKeys[a] < vKeys[b];
+        });
+    } else {
+        std::stable_sort(vOrder.begin(), vOrder.end(), [this, &vSlots](int a, int b) {
+            return std::memcmp(m_pEntries[vSlots[a]].uuid, m_pEntries[vSlots[b]].uuid, 16) < 0;
+        });
+    }
+
+    // Put the entries back into the group's slots in sorted order
+    QVector<PW_ENTRY> vSorted;
+    vSorted.reserve(vSlots.size());
+    for (int i : vOrder) {
+        vSorted.append(m_pEntries[vSlots[i]]);
+    }
+    for (int i = 0; i < vSlots.size(); ++i) {
+        m_pEntries[vSlots[i]] = vSorted[i];
+    }
+
+    if (m_bSearchIndexValid || m_bFoldedTextValid || m_bExpiryIndexValid) {
+        QVector<quint32> vNewIndexes(static_cast<int>(m_numEntries));
+        std::iota(vNewIndexes.begin(), vNewIndexes.end(), 0U);
+        for (int i = 0; i < vSlots.size(); ++i) {
+            vNewIndexes[vSlots[vOrder[i]]] = vSlots[i];
+        }
+        if (m_bSearchIndexValid) {
+            m_searchIndex.remapIds(vNewIndexes.constData(), vSlots.first());
+        }
+        if (m_bFoldedTextValid) {
+            m_foldedText.remapRows(vNewIndexes.constData(), vSlots.first());
+        }
+        if (m_bExpiryIndexValid) {
+            m_expiryIndex.remapIndexes(vNewIndexes.constData(), vSlots.first());
+        }
+    }
+
+    // The set of slots per group is unchanged, only the UUIDs moved
+    rebuildUuidIndex();
+    ++m_uContentVersion;
 }
 
 void PwManager::sortGroupList()
@@ -1962,28 +3149,91 @@ void PwManager::sortGroupList()
         return;  // Nothing to sort
     }
 
-    // Sort groups at each level independently
-    // This is a simple bubble sort that respects tree levels
-    bool swapped = true;
-    while (swapped) {
-        swapped = false;
-        for (quint32 i = 0; i < m_numGroups - 1; ++i) {
-            // Only compare groups at the same level
-            if (m_pGroups[i].usLevel == m_pGroups[i + 1].usLevel) {
-                // Compare group names (case-insensitive)
-                QString name1 = QString::fromUtf8(m_pGroups[i].pszGroupName).toLower();
-                QString name2 = QString::fromUtf8(m_pGroups[i + 1].pszGroupName).toLower();
-
-                if (name1 > name2) {
-                    // Swap groups
-                    PW_GROUP temp = m_pGroups[i];
-                    m_pGroups[i] = m_pGroups[i + 1];
-                    m_pGroups[i + 1] = temp;
-                    swapped = true;
-                }
-            }
+    // Siblings are sorted by name; every group takes its subtree along, so
+    // the tree itself is unchanged. The collation key of each name is
+    // computed once instead of converting both names on every comparison.
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    QVector<QCollatorSortKey> vKeys;
+    vKeys.reserve(static_cast<int>(m_numGroups));
+    for (quint32 i = 0; i < m_numGroups; ++i) {
+        vKeys.append(collator.sortKey(QString::fromUtf8(m_pGroups[i].pszGroupName)));
+    }
+
+    QVector<quint32> vStack;
+    const auto pushSortedChildren = [this, &vKeys, &vStack](const PwGroupTreeNode& node) {
+        const int nFirst = vStack.size();
+        for (quint32 c = node.dwFirstChild; c != DWORD_MAX; c = m_vGroupTree[c].dwNextSibling) {
+            vStack.append(c);
         }
+        std::stable_sort(vStack.begin() + nFirst, vStack.end(), [&vKeys](quint32 a, quint32 b) {
+            return vKeys[a].compare(vKeys[b]) < 0;
+        });
+        // Reversed, so that the stack pops the children in sorted order
+        std::reverse(vStack.begin() + nFirst, vStack.end());
+    };
+
+    // Pre-order walk with sorted siblings gives the new flat order
+    QVector<quint32> vOrder;
+    vOrder.reserve(static_cast<int>(m_numGroups));
+    pushSortedChildren(m_groupTreeRoot);
+    while (!vStack.isEmpty()) {
+        const quint32 dwGroup = vStack.takeLast();
+        vOrder.append(dwGroup);
+        pushSortedChildren(m_vGroupTree[dwGroup]);
+    }
+
+    Q_ASSERT(vOrder.size() == static_cast<int>(m_numGroups));
+    if (vOrder.size() != static_cast<int>(m_numGroups)) {
+        return;
+    }
+
+    // Rebuild the flat group list in one pass
+    QVector<PW_GROUP> vSorted;
+    vSorted.reserve(vOrder.size());
+    for (quint32 dwGroup : vOrder) {
+        vSorted.append(m_pGroups[dwGroup]);
+    }
+    std::memcpy(m_pGroups, vSorted.constData(), m_numGroups * sizeof(PW_GROUP));
+
+    rebuildGroupIndex();
+}
+
+bool PwManager::moveGroup(quint32 dwFrom, quint32 dwTo)
+{
+    // Reference: MFC CPwManager::MoveGroup
+    // Bubbles a single group from position dwFrom to position dwTo
+
+    if (dwFrom >= m_numGroups || dwTo >= m_numGroups) {
+        return false;
+    }
+    if (dwFrom == dwTo) {
+        return true;
+    }
+
+    const qint32 lDir = ((dwFrom < dwTo) ? 1 : -1);
+    for (qint32 i = static_cast<qint32>(dwFrom); i != static_cast<qint32>(dwTo); i += lDir) {
+        PW_GROUP pg = m_pGroups[i];
+        m_pGroups[i] = m_pGroups[i + lDir];
+        m_pGroups[i + lDir] = pg;
+    }
+
+    fixGroupTree();  // Also rebuilds the group tree index
+    return true;
+}
+
+bool PwManager::moveGroupEx(quint32 dwFromId, quint32 dwToId)
+{
+    // Reference: MFC CPwManager::MoveGroupEx
+    // Same as moveGroup(), but addressing the groups by ID
+
+    const quint32 dwFrom = getGroupByIdN(dwFromId);
+    const quint32 dwTo = getGroupByIdN(dwToId);
+    if (dwFrom == DWORD_MAX || dwTo == DWORD_MAX) {
+        return false;
     }
+
+    return moveGroup(dwFrom, dwTo);
 }
 
 bool PwManager::moveGroupExDir(quint32 dwGroupId, int iDirection)
@@ -2017,6 +3267,7 @@ bool PwManager::moveGroupExDir(quint32 dwGroupId, int iDirection)
                 PW_GROUP temp = m_pGroups[groupIndex];
                 m_pGroups[groupIndex] = m_pGroups[i];
                 m_pGroups[i] = temp;
+                rebuildGroupIndex();
                 return true;
             }
         }
@@ -2034,6 +3285,7 @@ bool PwManager::moveGroupExDir(quint32 dwGroupId, int iDirection)
                 PW_GROUP temp = m_pGroups[groupIndex];
                 m_pGroups[groupIndex] = m_pGroups[i];
                 m_pGroups[i] = temp;
+                rebuildGroupIndex();
                 return true;
             }
         }
@@ -2050,6 +3302,7 @@ void PwManager::fixGroupTree()
     // Ensures first group is root and each group level increases by at most 1
 
     if (m_numGroups == 0) {
+        rebuildGroupIndex();
         return;
     }
 
@@ -2065,6 +3318,8 @@ void PwManager::fixGroupTree()
 
         usLastLevel = m_pGroups[i].usLevel;
     }
+
+    rebuildGroupIndex();
 }
 
 void PwManager::moveEntry(quint32 idGroup, quint32 dwFrom, quint32 dwTo)
@@ -2096,7 +3351,8 @@ void PwManager::moveEntry(quint32 idGroup, quint32 dwFrom, quint32 dwTo)
 void PwManager::moveInternal(quint32 dwFrom, quint32 dwTo)
 {
     // Reference: MFC/MFC-KeePass/KeePassLibCpp/PwManager.cpp CPwManager::MoveInternal (lines 1073-1093)
-    // Bubbles an entry from position dwFrom to position dwTo by swapping with neighbors
+    // Moves an entry from position dwFrom to position dwTo, shifting the entries
+    // in between by one (MFC bubbles the entry through them by swapping)
 
     if (dwFrom == dwTo) {
         return;  // Nothing to do
@@ -2111,42 +3367,62 @@ void PwManager::moveInternal(quint32 dwFrom, quint32 dwTo)
     // Set moving direction
     const qint32 lDir = ((dwFrom < dwTo) ? 1 : -1);
 
-    qint32 i = static_cast<qint32>(dwFrom);
-    while (true) {
-        if (i == static_cast<qint32>(dwTo)) {
-            break;
-        }
+    // One rotation instead of |dwTo - dwFrom| three-way struct swaps
+    if (dwFrom < dwTo) {
+        std::rotate(m_pEntries + dwFrom, m_pEntries + dwFrom + 1, m_pEntries + dwTo + 1);
+    } else {
+        std::rotate(m_pEntries + dwTo, m_pEntries + dwFrom, m_pEntries + dwFrom + 1);
+    }
+    ++m_uContentVersion;
 
-        // Swap current entry with next entry in direction
-        PW_ENTRY pe = m_pEntries[i];
-        m_pEntries[i] = m_pEntries[i + lDir];
-        m_pEntries[i + lDir] = pe;
+    // Only positions in [dwLow, dwHigh] changed
+    const quint32 dwLow = qMin(dwFrom, dwTo);
+    const quint32 dwHigh = qMax(dwFrom, dwTo);
 
-        i += lDir;
-    }
-}
+    // Per-group lists: the moved entry jumps, everything in between shifts by
+    // one against the moving direction. Only the moved entry's own group can
+    // change its relative order.
+    for (auto it = m_groupEntries.begin(); it != m_groupEntries.end(); ++it) {
+        QVector<quint32>& vEntries = it.value();
+        auto itFirst = std::lower_bound(vEntries.begin(), vEntries.end(), dwLow);
+        auto itLast = std::upper_bound(itFirst, vEntries.end(), dwHigh);
+        if (itFirst == itLast) {
+            continue;
+        }
 
-// Helper function for string matching in search
-static bool matchesSearch(const QString& text, const QString& searchString,
-                          bool caseSensitive, bool useRegex, const QRegularExpression& regex)
-{
-    if (text.isEmpty() && searchString.isEmpty()) {
-        return true;
+        for (auto itPos = itFirst; itPos != itLast; ++itPos) {
+            *itPos = (*itPos == dwFrom) ? dwTo : static_cast<quint32>(static_cast<qint32>(*itPos) - lDir);
+        }
+        if (it.key() == m_pEntries[dwTo].uGroupId) {
+            std::sort(itFirst, itLast);
+        }
     }
 
-    if (text.isEmpty()) {
-        return false;
+    if (m_bSearchIndexValid || m_bExpiryIndexValid) {
+        QVector<quint32> vNewIndexes(static_cast<int>(m_numEntries));
+        std::iota(vNewIndexes.begin(), vNewIndexes.end(), 0U);
+        for (quint32 j = dwLow; j <= dwHigh; ++j) {
+            vNewIndexes[j] = (j == dwFrom) ? dwTo : static_cast<quint32>(static_cast<qint32>(j) - lDir);
+        }
+        if (m_bSearchIndexValid) {
+            m_searchIndex.remapIds(vNewIndexes.constData(), dwLow);
+        }
+        if (m_bExpiryIndexValid) {
+            m_expiryIndex.remapIndexes(vNewIndexes.constData(), dwLow);
+        }
+    }
+    if (m_bFoldedTextValid) {
+        m_foldedText.moveRow(dwFrom, dwTo);
     }
 
-    if (useRegex) {
-        // Use regex matching
-        QRegularExpressionMatch match = regex.match(text);
-        return match.hasMatch();
-    } else {
-        // Use simple string contains
-        Qt::CaseSensitivity cs = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-        return text.contains(searchString, cs);
+    // Re-point the UUIDs of the shifted entries
+    for (quint32 j = dwLow; j <= dwHigh; ++j) {
+        auto it = m_uuidIndex.find(PwUuidKey::fromBytes(m_pEntries[j].uuid));
+        if (it != m_uuidIndex.end() && it.value() >= dwLow && it.value() <= dwHigh)
+            m_uuidIndex.erase(it);
     }
+    for (quint32 j = dwLow; j <= dwHigh; ++j)
+        indexEntryUuid(j);
 }
 
 quint32 PwManager::find(const QString& findString, bool bCaseSensitive, quint32 searchFlags,
@@ -2164,92 +3440,13 @@ quint32 PwManager::find(const QString& findString, bool bCaseSensitive, quint32
         return 0xFFFFFFFF;
     }
 
-    quint32 nEnd = (nEndExcl == 0xFFFFFFFF) ? m_numEntries : nEndExcl;
-    if (nEnd > m_numEntries) {
-        nEnd = m_numEntries;
-    }
-
-    // Check if regex flag is set
-    bool useRegex = (searchFlags & PWMS_REGEX) != 0;
-    QRegularExpression regex;
-
-    if (useRegex) {
-        QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
-        if (!bCaseSensitive) {
-            options |= QRegularExpression::CaseInsensitiveOption;
-        }
-
-        regex.setPattern(findString);
-        regex.setPatternOptions(options);
-
-        if (!regex.isValid()) {
-            if (pError) *pError = QString("Invalid regular expression: %1").arg(regex.errorString());
-            return 0xFFFFFFFF;
-        }
-    }
-
-    // Search through entries
-    for (quint32 i = nStart; i < nEnd; ++i) {
-        PW_ENTRY* entry = &m_pEntries[i];
-        if (!entry) continue;
-
-        // Check each field based on search flags
-        if (searchFlags & PWMF_TITLE) {
-            QString title = QString::fromUtf8(entry->pszTitle);
-            if (matchesSearch(title, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_USER) {
-            QString username = QString::fromUtf8(entry->pszUserName);
-            if (matchesSearch(username, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_URL) {
-            QString url = QString::fromUtf8(entry->pszURL);
-            if (matchesSearch(url, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_PASSWORD) {
-            unlockEntryPassword(entry);
-            QString password = QString::fromUtf8(entry->pszPassword);
-            lockEntryPassword(entry);
-            if (matchesSearch(password, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_ADDITIONAL) {
-            QString notes = QString::fromUtf8(entry->pszAdditional);
-            if (matchesSearch(notes, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_UUID) {
-            QString uuid = PwUtil::uuidToString(entry->uuid);
-            if (matchesSearch(uuid, findString, bCaseSensitive, useRegex, regex)) {
-                return i;
-            }
-        }
-
-        if (searchFlags & PWMF_GROUPNAME) {
-            PW_GROUP* group = getGroupById(entry->uGroupId);
-            if (group) {
-                QString groupName = QString::fromUtf8(group->pszGroupName);
-                if (matchesSearch(groupName, findString, bCaseSensitive, useRegex, regex)) {
-                    return i;
-                }
-            }
-        }
+    const PwSearchPlan plan(this, findString, bCaseSensitive, searchFlags);
+    if (!plan.isValid()) {
+        if (pError) *pError = plan.errorString();
+        return 0xFFFFFFFF;
     }
 
-    return 0xFFFFFFFF;  // Not found
+    return plan.findFirst(nStart, nEndExcl);
 }
 
 quint32 PwManager::findEx(const QString& findString, bool bCaseSensitive, quint32 searchFlags,
@@ -2263,140 +3460,70 @@ QList<quint32> PwManager::findAll(const QString& findString, bool bCaseSensitive
                                    bool excludeBackups, bool excludeExpired, QString* pError)
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp _Find method
-    // Finds ALL matching entries with optional filtering
-    QList<quint32> results;
-
-    if (findString.isEmpty()) {
-        if (pError) *pError = "Search string cannot be empty";
-        return results;
-    }
-
-    // Get current time for expiry checking
-    PW_TIME currentTime;
-    PwUtil::getCurrentTime(&currentTime);
-
-    // Get IDs for backup groups
-    quint32 backupGroupId = getGroupId(PWS_BACKUPGROUP);
-    quint32 backupSrcGroupId = getGroupId(PWS_BACKUPGROUP_SRC);
-
-    // Loop through all entries and find matches
-    quint32 cnt = 0;
-    while (cnt < m_numEntries) {
-        QString error;
-        quint32 foundIndex = find(findString, bCaseSensitive, searchFlags, cnt, 0xFFFFFFFF, &error);
-
-        if (foundIndex == 0xFFFFFFFF) {
-            // No more matches
-            if (!error.isEmpty() && pError && pError->isEmpty()) {
-                *pError = error;
-            }
-            break;
-        }
-
-        PW_ENTRY* entry = getEntry(foundIndex);
-        if (!entry) {
-            break;
-        }
-
-        // Apply filters
-        bool includeEntry = true;
-
-        // Filter: Exclude backups
-        if (excludeBackups && includeEntry) {
-            if (entry->uGroupId == backupGroupId || entry->uGroupId == backupSrcGroupId) {
-                includeEntry = false;
-            }
-        }
-
-        // Filter: Exclude expired entries
-        if (excludeExpired && includeEntry) {
-            if (PwUtil::compareTime(&currentTime, &entry->tExpire) > 0) {
-                includeEntry = false;
-            }
-        }
-
-        // Add to results if it passes all filters
-        if (includeEntry) {
-            results.append(foundIndex);
-        }
-
-        // Continue searching from next entry
-        cnt = foundIndex + 1;
-        if (cnt >= m_numEntries) {
-            break;
-        }
+    // Finds ALL matching entries with optional filtering. The query is
+    // compiled once, then all entries are scanned in one (parallel) pass.
+    const PwSearchPlan plan(this, findString, bCaseSensitive, searchFlags, excludeBackups, excludeExpired);
+    if (!plan.isValid()) {
+        if (pError) *pError = plan.errorString();
+        return QList<quint32>();
     }
 
-    return results;
+    return plan.findAll();
 }
 
 QList<quint32> PwManager::findExpiredEntries(bool excludeBackups, bool excludeTANs)
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp _ShowExpiredEntries method
     // Finds all entries that have expired (tExpire < current time)
-    QList<quint32> results;
 
-    // Get current time
+    PW_TIME timeZero;
+    std::memset(&timeZero, 0, sizeof(PW_TIME));
     PW_TIME currentTime;
     PwUtil::getCurrentTime(&currentTime);
 
-    // Get IDs for backup groups
-    quint32 backupGroupId = 0, backupSrcGroupId = 0;
-    if (excludeBackups) {
-        backupGroupId = getGroupId(PWS_BACKUPGROUP);
-        backupSrcGroupId = getGroupId(PWS_BACKUPGROUP_SRC);
-    }
-
-    // Loop through all entries
-    for (quint32 i = 0; i < m_numEntries; ++i) {
-        PW_ENTRY* entry = getEntry(i);
-        if (!entry) continue;
-
-        // Apply filters
-        bool includeEntry = true;
-
-        // Filter: Exclude backups
-        if (excludeBackups && includeEntry) {
-            if (entry->uGroupId == backupGroupId || entry->uGroupId == backupSrcGroupId) {
-                includeEntry = false;
-            }
-        }
-
-        // Filter: Exclude TAN entries
-        if (excludeTANs && includeEntry && entry->pszTitle) {
-            if (QString::fromUtf8(entry->pszTitle) == "<TAN>") {
-                includeEntry = false;
-            }
-        }
-
-        // Check if expired
-        if (includeEntry) {
-            // Entry is expired if current time > expire time
-            if (PwUtil::compareTime(&currentTime, &entry->tExpire) > 0) {
-                results.append(i);
-            }
-        }
-    }
-
-    return results;
+    return findEntriesExpiringIn(&timeZero, &currentTime, excludeBackups, excludeTANs);
 }
 
 QList<quint32> PwManager::findSoonToExpireEntries(int days, bool excludeBackups, bool excludeTANs)
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp _ShowExpiredEntries method
     // Finds entries that will expire within the specified number of days
-    QList<quint32> results;
 
     // Get current time
     PW_TIME currentTime;
     PwUtil::getCurrentTime(&currentTime);
 
-    // Calculate date range (using MFC's date comparison method)
-    // MFC formula: date = (year * 13 * 32) + (month * 32) + day
+    // MFC compares dates as (year * 13 * 32) + (month * 32) + day and takes
+    // the entries with today <= date <= today + days. With months 1..12 and
+    // days 1..31 that number orders like the date, so the last date in range
+    // is today + days written back in that form, and the entries are the
+    // ones expiring from today 00:00:00 until before the day after it.
     const quint32 dwDateNow = (static_cast<quint32>(currentTime.shYear) * 13 * 32) +
                               (static_cast<quint32>(currentTime.btMonth) * 32) +
                               (static_cast<quint32>(currentTime.btDay) & 0xFF);
-    const quint32 dwSoonToExpireDays = static_cast<quint32>(days);
+    const quint32 dwDateLast = dwDateNow + static_cast<quint32>(qMax(days, 0));
+
+    PW_TIME timeFrom;
+    std::memset(&timeFrom, 0, sizeof(PW_TIME));
+    timeFrom.shYear = currentTime.shYear;
+    timeFrom.btMonth = currentTime.btMonth;
+    timeFrom.btDay = currentTime.btDay;
+
+    PW_TIME timeTo;
+    std::memset(&timeTo, 0, sizeof(PW_TIME));
+    timeTo.shYear = static_cast<USHORT>(dwDateLast / (13 * 32));
+    timeTo.btMonth = static_cast<BYTE>((dwDateLast % (13 * 32)) / 32);
+    timeTo.btDay = static_cast<BYTE>((dwDateLast % 32) + 1);  // At most 32, still before the next month
+
+    return findEntriesExpiringIn(&timeFrom, &timeTo, excludeBackups, excludeTANs);
+}
+
+QList<quint32> PwManager::findEntriesExpiringIn(const PW_TIME* pFrom, const PW_TIME* pTo,
+                                                bool excludeBackups, bool excludeTANs)
+{
+    // Walks the expiry index from the first entry at pFrom to the last one
+    // before pTo
+    QList<quint32> results;
 
     // Get IDs for backup groups
     quint32 backupGroupId = 0, backupSrcGroupId = 0;
@@ -2405,45 +3532,42 @@ QList<quint32> PwManager::findSoonToExpireEntries(int days, bool excludeBackups,
         backupSrcGroupId = getGroupId(PWS_BACKUPGROUP_SRC);
     }
 
-    // Loop through all entries
-    for (quint32 i = 0; i < m_numEntries; ++i) {
-        PW_ENTRY* entry = getEntry(i);
-        if (!entry) continue;
-
-        // Apply filters
-        bool includeEntry = true;
+    const ExpiryIndex& index = getExpiryIndex();
+    const quint64 qwTo = PwUtil::timeToKey(pTo);
+    for (const ExpiryIndex::Key* pKey = index.lowerBound(PwUtil::timeToKey(pFrom));
+         pKey != index.end() && pKey->qwTime < qwTo; ++pKey) {
+        const PW_ENTRY& entry = m_pEntries[pKey->dwIndex];
 
         // Filter: Exclude backups
-        if (excludeBackups && includeEntry) {
-            if (entry->uGroupId == backupGroupId || entry->uGroupId == backupSrcGroupId) {
-                includeEntry = false;
-            }
+        if (excludeBackups && (entry.uGroupId == backupGroupId || entry.uGroupId == backupSrcGroupId)) {
+            continue;
         }
 
         // Filter: Exclude TAN entries
-        if (excludeTANs && includeEntry && entry->pszTitle) {
-            if (QString::fromUtf8(entry->pszTitle) == "<TAN>") {
-                includeEntry = false;
-            }
+        if (excludeTANs && entry.pszTitle && std::strcmp(entry.pszTitle, "<TAN>") == 0) {
+            continue;
         }
 
-        // Check if expiring soon
-        if (includeEntry) {
-            // Calculate entry's expiration date using MFC formula
-            const quint32 dwDate = (static_cast<quint32>(entry->tExpire.shYear) * 13 * 32) +
-                                   (static_cast<quint32>(entry->tExpire.btMonth) * 32) +
-                                   (static_cast<quint32>(entry->tExpire.btDay) & 0xFF);
-
-            // Include if: expiration date >= today AND (expiration - today) <= days
-            if ((dwDate >= dwDateNow) && ((dwDate - dwDateNow) <= dwSoonToExpireDays)) {
-                results.append(i);
-            }
-        }
+        results.append(pKey->dwIndex);
     }
 
+    // In entry order, like the list views show them
+    std::sort(results.begin(), results.end());
     return results;
 }
 
+bool PwManager::findNextExpiry(const PW_TIME* pFrom, PW_TIME* pExpire)
+{
+    const ExpiryIndex& index = getExpiryIndex();
+    const ExpiryIndex::Key* pKey = index.lowerBound(PwUtil::timeToKey(pFrom));
+    if (pKey == index.end()) {
+        return false;
+    }
+
+    PwUtil::keyToTime(pKey->qwTime, pExpire);
+    return true;
+}
+
 // Helper function to convert UTF-8 to QString (and allocate TCHAR string)
 static TCHAR* utf8ToString(const BYTE* pUTF8String)
 {
@@ -2657,10 +3781,13 @@ bool PwManager::readEntryField(quint16 usFieldType, quint32 dwFieldSize,
         break;
 
     case ENT_FIELD_BINARYDATA: // 0x000E
-        delete[] pEntry->pBinaryData;
+        // The template's copy comes from the SecureArena, so it is erased when freed
+        SecureArena::release(pEntry->pBinaryData);
         pEntry->pBinaryData = nullptr;
         if (dwFieldSize != 0) {
-            pEntry->pBinaryData = new BYTE[dwFieldSize];
+            pEntry->pBinaryData = static_cast<BYTE*>(SecureArena::allocate(dwFieldSize));
+            if (pEntry->pBinaryData == nullptr)
+                throw std::bad_alloc();
             std::memcpy(pEntry->pBinaryData, pData, dwFieldSize);
             pEntry->uBinaryDataLen = dwFieldSize;
         } else {
@@ -2682,7 +3809,7 @@ bool PwManager::readEntryField(quint16 usFieldType, quint32 dwFieldSize,
         delete[] pEntry->pszPassword;
         delete[] pEntry->pszAdditional;
         delete[] pEntry->pszBinaryDesc;
-        delete[] pEntry->pBinaryData;
+        SecureArena::release(pEntry->pBinaryData);
         std::memset(pEntry, 0, sizeof(PW_ENTRY));
         PwUtil::getNeverExpireTime(&pEntry->tExpire);
         break;
@@ -2733,43 +3860,14 @@ quint32 PwManager::loadAndRemoveAllMetaStreams(bool bAcceptUnknown)
 
     Q_UNUSED(bAcceptUnknown);
 
-    quint32 dwRemoved = 0;
-
-    // Scan entries from back to front (to safely remove while iterating)
-    for (quint32 i = m_numEntries; i > 0; --i) {
-        PW_ENTRY* entry = &m_pEntries[i - 1];
-
-        // Check if this is a meta-stream entry
-        bool isMetaStream = false;
-        if (entry->pszBinaryDesc && strcmp(entry->pszBinaryDesc, "bin-stream") == 0 &&
-            entry->pszTitle && strcmp(entry->pszTitle, "Meta-Info") == 0 &&
-            entry->pszUserName && strcmp(entry->pszUserName, "SYSTEM") == 0 &&
-            entry->pszURL && strcmp(entry->pszURL, "$") == 0) {
-            isMetaStream = true;
-        }
-
-        if (isMetaStream) {
-            // TODO: Actually parse and load the meta-stream data
-            // For now, just remove the entry
-
-            // Free entry strings
-            if (entry->pszTitle) delete[] entry->pszTitle;
-            if (entry->pszUserName) delete[] entry->pszUserName;
-            if (entry->pszPassword) delete[] entry->pszPassword;
-            if (entry->pszURL) delete[] entry->pszURL;
-            if (entry->pszAdditional) delete[] entry->pszAdditional;
-            if (entry->pszBinaryDesc) delete[] entry->pszBinaryDesc;
-            if (entry->pBinaryData) delete[] entry->pBinaryData;
-
-            // Shift remaining entries down
-            for (quint32 j = i - 1; j < m_numEntries - 1; ++j) {
-                m_pEntries[j] = m_pEntries[j + 1];
-            }
-
-            m_numEntries--;
-            dwRemoved++;
-        }
-    }
+    // TODO: Actually parse and load the meta-stream data
+    // For now, just remove the entries (all in one pass)
+    const quint32 dwRemoved = deleteEntries([](const PW_ENTRY* entry) {
+        return entry->pszBinaryDesc && strcmp(entry->pszBinaryDesc, "bin-stream") == 0 &&
+               entry->pszTitle && strcmp(entry->pszTitle, "Meta-Info") == 0 &&
+               entry->pszUserName && strcmp(entry->pszUserName, "SYSTEM") == 0 &&
+               entry->pszURL && strcmp(entry->pszURL, "$") == 0;
+    });
 
     return dwRemoved;
 }
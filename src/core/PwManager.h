@@ -14,8 +14,18 @@
 
 #include <QString>
 #include <QVector>
+#include <QHash>
 #include <QColor>
+#include <QFuture>
+#include <functional>
+#include <memory>
 #include "PwStructs.h"
+#include "crypto/MemoryProtection.h"
+#include "crypto/ProtectedStringCipher.h"
+#include "util/StringArena.h"
+#include "util/TrigramIndex.h"
+#include "util/FoldedTextStore.h"
+#include "util/ExpiryIndex.h"
 
 // General product information
 namespace PwProduct {
@@ -74,7 +84,8 @@ enum class PwError : quint8 {
     UNSUPPORTED_KDBX = 18,
     GETLASTERROR = 19,
     DB_EMPTY = 20,
-    ATTACH_TOOLARGE = 21
+    ATTACH_TOOLARGE = 21,
+    CANCELED = 22           ///< Canceled through a progress callback (Qt port only)
 };
 
 // Field flags (for Find function)
@@ -142,6 +153,7 @@ namespace PwGroupFlags {
 #define PWE_GETLASTERROR       static_cast<int>(PwError::GETLASTERROR)
 #define PWE_DB_EMPTY           static_cast<int>(PwError::DB_EMPTY)
 #define PWE_ATTACH_TOOLARGE    static_cast<int>(PwError::ATTACH_TOOLARGE)
+#define PWE_CANCELED           static_cast<int>(PwError::CANCELED)
 #define PWMF_TITLE             PwFieldFlags::TITLE
 #define PWMF_USER              PwFieldFlags::USER
 #define PWMF_URL               PwFieldFlags::URL
@@ -156,6 +168,8 @@ namespace PwGroupFlags {
 #define PWMS_REGEX             PwSearchFlags::REGEX
 #define PWGF_EXPANDED          PwGroupFlags::EXPANDED
 
+class PwSearchSession;
+
 /**
  * @class PwManager
  * @brief Core database management class for KeePass KDB v1.x format
@@ -196,6 +210,10 @@ public:
     int setMasterKey(const QString& masterKey, bool bDiskDrive, const QString& secondKey,
                      bool bOverwrite, const QString& providerName);
 
+    // Capacity (arrays grow geometrically; reserve up front for bulk loads)
+    void reserveEntries(quint32 uCount);
+    void reserveGroups(quint32 uCount);
+
     // Database info
     [[nodiscard]] quint32 getNumberOfEntries() const;
     [[nodiscard]] quint32 getNumberOfGroups() const;
@@ -208,6 +226,7 @@ public:
     [[nodiscard]] quint32 getEntryByGroupN(quint32 idGroup, quint32 dwIndex) const;
     PW_ENTRY* getEntryByUuid(const quint8* pUuid);
     [[nodiscard]] quint32 getEntryByUuidN(const quint8* pUuid) const;
+    [[nodiscard]] QVector<quint32> resolveUuids(const QVector<PW_UUID_STRUCT>& uuids) const;
     [[nodiscard]] quint32 getEntryPosInGroup(const PW_ENTRY* pEntry) const;
     PW_ENTRY* getLastEditedEntry();
 
@@ -220,23 +239,87 @@ public:
     [[nodiscard]] quint32 getLastChildGroup(quint32 dwParentGroupIndex) const;
     bool getGroupTree(quint32 idGroup, quint32* pGroupIndexes) const;
 
+    // Group tree navigation (maintained index, no usLevel scans).
+    // A parent index of DWORD_MAX stands for the invisible root.
+    [[nodiscard]] quint32 getGroupIndex(const PW_GROUP* pGroup) const;
+    [[nodiscard]] quint32 getGroupParentN(quint32 dwGroupIndex) const;
+    [[nodiscard]] quint32 getGroupRowN(quint32 dwGroupIndex) const;
+    [[nodiscard]] quint32 getGroupChildCount(quint32 dwParentIndex) const;
+    [[nodiscard]] quint32 getGroupChildN(quint32 dwParentIndex, quint32 dwRow) const;
+
     // Add/modify/delete
     bool addGroup(const PW_GROUP* pTemplate);
     bool addEntry(const PW_ENTRY* pTemplate);
+    bool addEntries(const PW_ENTRY* pTemplates, quint32 dwCount);
     bool backupEntry(const PW_ENTRY* pe, bool* pbGroupCreated = nullptr);
     bool deleteEntry(quint32 dwIndex);
+    quint32 deleteEntries(const QVector<quint32>& vIndices);
+    quint32 deleteEntries(const std::function<bool(const PW_ENTRY*)>& fnPredicate);
     bool deleteGroupById(quint32 uGroupId, bool bCreateBackupEntries);
     bool setGroup(quint32 dwIndex, const PW_GROUP* pTemplate);
     bool setEntry(quint32 dwIndex, const PW_ENTRY* pTemplate);
-
-    // Password encryption/decryption in memory
+    bool setEntryGroup(quint32 dwIndex, quint32 uGroupId);
+    bool setEntryExpiry(quint32 dwIndex, const PW_TIME* pExpire);
+
+    // Password encryption/decryption in memory. Passwords are kept encrypted
+    // with AES-256-CTR under a random session key, with a fresh nonce each
+    // time setEntry() stores one. Locking and unlocking toggle the stored bytes, so calls must be
+    // paired; nullptr processes all entries in one batch. Callers that only
+    // read a password should use PwUnlockedPassword instead.
     void lockEntryPassword(PW_ENTRY* pEntry);
     void unlockEntryPassword(PW_ENTRY* pEntry);
 
+    /// Decrypt the (locked) password of pEntry into pBuffer, which needs room
+    /// for uPasswordLen bytes; the entry itself is not changed
+    bool decryptEntryPassword(const PW_ENTRY* pEntry, char* pBuffer) const;
+
+    /// Stages of openDatabase() and saveDatabase(), for progress reports
+    enum class OperationStage : quint8
+    {
+        Read,          ///< Reading and checking the header
+        KeyTransform,  ///< Transforming the master key
+        Decrypt,       ///< Reading, decrypting and hashing the payload
+        Parse,         ///< Building groups and entries
+        Serialize,     ///< Writing groups and entries into the buffer
+        Encrypt,       ///< Hashing and encrypting the payload
+        Write          ///< Writing the file
+    };
+
+    /// Called with the current stage and how far it is (0-100). Returning
+    /// false cancels the operation with PWE_CANCELED, except in the parse
+    /// stage (the file has been verified by then) and the write stage
+    /// (stopping would leave a truncated file).
+    using ProgressCallback = std::function<bool(OperationStage eStage, int nPercent)>;
+
     // Database operations
     void newDatabase();
     int openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair = nullptr);
     int saveDatabase(const QString& filePath, quint8* pWrittenDataHash32 = nullptr);
+    int openDatabase(const QString& filePath, PWDB_REPAIR_INFO* pRepair, const ProgressCallback& fnProgress);
+    int saveDatabase(const QString& filePath, quint8* pWrittenDataHash32, const ProgressCallback& fnProgress);
+
+    // Asynchronous open and save. The slow part runs on a worker thread:
+    // openDatabaseAsync loads the file into a separate PwManager (with this
+    // one's master key), saveDatabaseAsync serializes the database right
+    // away and leaves key transformation, encryption and writing to the
+    // worker. Nothing in this PwManager changes until finishAsyncOperation()
+    // is called on its own thread, which swaps the opened database in (or
+    // records the saved header) in one step. The futures report
+    // encodeProgress() values and can be canceled; one operation at a time.
+    QFuture<int> openDatabaseAsync(const QString& filePath);
+    QFuture<int> saveDatabaseAsync(const QString& filePath);
+
+    /// Apply the result of the pending asynchronous operation, waiting for
+    /// it if it is still running
+    /// @return Its error code (PWE_CANCELED if canceled), PWE_UNKNOWN if none is pending
+    int finishAsyncOperation();
+    [[nodiscard]] bool isAsyncOperationPending() const { return m_pAsyncOp != nullptr; }
+
+    /// Progress values of the asynchronous operations: stage and percentage in one int
+    static constexpr int PROGRESS_MAXIMUM = 7 * 101 - 1;
+    [[nodiscard]] static int encodeProgress(OperationStage eStage, int nPercent);
+    [[nodiscard]] static OperationStage progressStage(int nProgressValue);
+    [[nodiscard]] static int progressPercent(int nProgressValue);
 
     // Move operations
     void moveEntry(quint32 idGroup, quint32 dwFrom, quint32 dwTo);
@@ -245,6 +328,9 @@ public:
     bool moveGroupExDir(quint32 dwGroupId, int iDirection);
 
     // Sort operations
+    // Sorts a group's entries by 0 = title, 1 = user name, 2 = URL, 3 = password,
+    // 4 = notes, 5 = creation, 6 = last modification, 7 = last access,
+    // 8 = expiration or 9 = UUID (the MFC list column order)
     void sortGroup(quint32 idGroup, quint32 dwSortByField);
     void sortGroupList();
 
@@ -259,10 +345,41 @@ public:
     QList<quint32> findAll(const QString& findString, bool bCaseSensitive, quint32 searchFlags,
                            bool excludeBackups, bool excludeExpired, QString* pError = nullptr);
 
-    // Expiration-based searches
+    /// Trigram index over the case-folded title, user name, URL and notes of
+    /// all entries; built by the first search that can use it, then kept up
+    /// to date. Passwords are only indexed when enabled here.
+    void setSearchIndexPasswords(bool bIndexPasswords);
+    [[nodiscard]] bool isSearchIndexPasswords() const { return m_bSearchIndexPasswords; }
+    const TrigramIndex& getSearchIndex();
+    [[nodiscard]] TrigramIndex::Stats getSearchIndexStats() { return getSearchIndex().getStats(); }
+
+    /// Case-folded copies of the same fields, row = entry index, for
+    /// case-insensitive scans; built on first use, then kept up to date
+    const FoldedTextStore& getFoldedText();
+
+    /// Search-as-you-type session on this database (see PwSearchSession)
+    PwSearchSession& getSearchSession();
+
+    /// Changes whenever entries are added, changed, removed or moved, or
+    /// groups are added, changed or removed; for caches of search results
+    [[nodiscard]] quint64 getContentVersion() const { return m_uContentVersion; }
+
+    // Expiration-based searches (ascending indexes)
     QList<quint32> findExpiredEntries(bool excludeBackups = true, bool excludeTANs = true);
     QList<quint32> findSoonToExpireEntries(int days = 7, bool excludeBackups = true, bool excludeTANs = true);
 
+    /// Entries with pFrom <= expiration time < pTo, ascending
+    QList<quint32> findEntriesExpiringIn(const PW_TIME* pFrom, const PW_TIME* pTo,
+                                         bool excludeBackups = true, bool excludeTANs = true);
+
+    /// Earliest expiration time >= pFrom of any entry
+    /// @return false if there is none
+    bool findNextExpiry(const PW_TIME* pFrom, PW_TIME* pExpire);
+
+    /// Entry indexes sorted by expiration time; built on first use, then
+    /// kept up to date
+    const ExpiryIndex& getExpiryIndex();
+
     // Encryption settings
     [[nodiscard]] int getAlgorithm() const;
     bool setAlgorithm(int nAlgorithm);
@@ -289,6 +406,17 @@ public:
 
     // Settings
     void setTransactedFileWrites(bool bTransacted) { m_bUseTransactedFileWrites = bTransacted; }
+    void setLockStringMemory(bool bLock) { m_stringArena.setLockMemory(bLock); }
+    [[nodiscard]] bool isStringMemoryLocked() const { return m_stringArena.isMemoryLocked(); }
+    [[nodiscard]] StringArena::Stats getStringMemoryStats() const { return m_stringArena.getStats(); }
+
+    // Fast resave: saveDatabase keeps aMasterSeed2 and the key transformation
+    // rounds of the last open or save and reuses the cached transformed key,
+    // so only aMasterSeed and aEncryptionIV are rotated. Off by default.
+    void setFastResave(bool bFastResave) { m_bFastResave = bFastResave; }
+    [[nodiscard]] bool isFastResave() const { return m_bFastResave; }
+    /// Make the next save run the full key transformation with a new aMasterSeed2
+    void invalidateTransformedMasterKey() { m_bTransformedKeyValid = false; }
     [[nodiscard]] QColor getColor() const;
     void setColor(const QColor& clr);
     [[nodiscard]] QString getDefaultUserName() const;
@@ -328,38 +456,148 @@ private:
     void parseMetaStream(PW_ENTRY* p, bool bAcceptUnknown);
     bool canIgnoreUnknownMetaStream(const PwMetaStream& msUnknown) const;
 
-    bool transformMasterKey(const quint8* pKeySeed);
+    bool transformMasterKey(const quint8* pKeySeed, const ProgressCallback& fnProgress = ProgressCallback());
+    static bool transformKey(const quint8* pMasterKey32, quint32 dwRounds, const quint8* pKeySeed32,
+                             quint8* pTransformedKey32, const ProgressCallback& fnProgress);
+
+    // saveDatabase in three steps: serializing (touches the database),
+    // transforming, encrypting and writing (touches only the job, may run
+    // on another thread), and recording the new header
+    struct SaveJob;
+    struct AsyncOperation;
+    int prepareSave(const QString& filePath, SaveJob& job, const ProgressCallback& fnProgress);
+    static int runSave(SaveJob& job, quint8* pWrittenDataHash32, const ProgressCallback& fnProgress);
+    void commitSave(const SaveJob& job);
+
+    /// Exchange the whole database (contents, keys, header) with another PwManager
+    void swapDatabase(PwManager& other) noexcept;
     static void hashHeaderWithoutContentHash(const quint8* pbHeader, QByteArray& vHash);
 
     quint32 deleteLostEntries();
+    quint32 getOrCreateBackupGroup(bool* pbGroupCreated);
     void moveInternal(quint32 dwFrom, quint32 dwTo);
 
+    // Password nonce maintenance (see m_passwordNonces)
+    [[nodiscard]] const quint8* passwordNonce(const PW_ENTRY* pEntry) const;
+    void renewPasswordNonce(const PW_ENTRY* pEntry);
+    void discardEntriesFrom(quint32 dwFirst);
+
+    // UUID index maintenance (see m_uuidIndex)
+    void indexEntryUuid(quint32 dwIndex);
+    void unindexEntryUuid(quint32 dwIndex);
+    void rebuildUuidIndex();
+
+    // Search index maintenance (see m_searchIndex): add or remove the texts
+    // an entry has now; no-ops while the index is not built
+    void updateSearchIndex(quint32 dwIndex, bool bAdd);
+    void invalidateSearchIndex();
+
+    // Folded text maintenance (see m_foldedText); no-ops while it is not built
+    void updateFoldedText(quint32 dwIndex);
+    void invalidateFoldedText();
+
+    // Expiry index maintenance (see m_expiryIndex); no-ops while it is not built
+    void updateExpiryIndex(quint32 dwIndex, bool bAdd);
+    void invalidateExpiryIndex();
+
+    // Per-group entry lists maintenance (see m_groupEntries)
+    void linkEntryToGroup(quint32 dwIndex);
+    void unlinkEntryFromGroup(quint32 dwIndex);
+    void rebuildGroupEntryLists();
+
+    // Group tree index maintenance (see m_vGroupTree)
+    void linkGroup(quint32 dwIndex);
+    void indexGroup(quint32 dwIndex);
+    void unindexGroupName(quint32 dwIndex);
+    void unindexGroupId(quint32 dwIndex);
+    void rebuildGroupIndex();
+    [[nodiscard]] static QString groupNameKey(const char* pszGroupName);
+
     static QByteArray serializeCustomKvp(const CustomKvp& kvp);
     static bool deserializeCustomKvp(const quint8* pStream, CustomKvp& kvpBuffer);
 
     void protectMasterKey(bool bProtectKey);
     void protectTransformedMasterKey(bool bProtectKey);
 
+    // Toggle the passwords of the entries pIndices[0..dwCount) (nullptr: the
+    // first dwCount entries) in batches
+    void cryptEntryPasswords(const quint32* pIndices, quint32 dwCount);
+
     // Member variables - Qt types and naming conventions
     PW_ENTRY* m_pEntries;      // Pointer kept as-is (array of entries)
     quint32 m_maxEntries;      // Maximum allocated entries
     quint32 m_numEntries;      // Current number of entries
 
+    // UUID -> index of the first entry with that UUID in m_pEntries.
+    // Kept in sync by every function that adds, removes or reorders entries.
+    QHash<PwUuidKey, quint32> m_uuidIndex;
+
+    // Group ID -> indexes of the entries in that group, ascending, i.e. in the
+    // order saveDatabase writes them. Makes group-scoped queries O(group size).
+    QHash<quint32, QVector<quint32>> m_groupEntries;
+
+    // Trigrams of the entry texts -> entry indexes. Only maintained while
+    // m_bSearchIndexValid; bulk changes drop it and the next search rebuilds it.
+    TrigramIndex m_searchIndex;
+    bool m_bSearchIndexValid;
+    bool m_bSearchIndexPasswords;
+
+    // Folded entry texts, one row per entry. Valid under the same rules as
+    // the search index, tracked by m_bFoldedTextValid.
+    FoldedTextStore m_foldedText;
+    bool m_bFoldedTextValid;
+
+    // Entry indexes by expiration time. Valid under the same rules as the
+    // search index, tracked by m_bExpiryIndexValid.
+    ExpiryIndex m_expiryIndex;
+    bool m_bExpiryIndexValid;
+
+    quint64 m_uContentVersion;                         // See getContentVersion()
+    std::unique_ptr<PwSearchSession> m_pSearchSession; // Created on first use
+
     PW_GROUP* m_pGroups;       // Pointer kept as-is (array of groups)
     quint32 m_maxGroups;       // Maximum allocated groups
     quint32 m_numGroups;       // Current number of groups
 
+    // Group tree index, kept in sync with m_pGroups by addGroup, setGroup,
+    // deleteGroupById, the moveGroup* functions, sortGroupList and fixGroupTree.
+    // The tree is derived from the flat pre-order list and its usLevel values.
+    QVector<PwGroupTreeNode> m_vGroupTree;   // Parallel to m_pGroups
+    PwGroupTreeNode m_groupTreeRoot;          // Children are the top-level groups
+    QHash<quint32, quint32> m_groupIdIndex;   // Group ID -> group index
+    QHash<QString, quint32> m_groupNameIndex; // Case-folded name -> first group index
+
+    // Storage for the text fields of all entries and the group names; its
+    // slabs come from the SecureArena. Attachments stay separate blocks
+    // (pszBinaryDesc on the heap, pBinaryData in the SecureArena), since
+    // PwUtil attaches and removes them directly.
+    StringArena m_stringArena;
+
     PW_DBHEADER m_dbLastHeader;
     PW_ENTRY* m_pLastEditedEntry;
     QByteArray m_vHeaderHash;
 
-    // NOLINTBEGIN(modernize-avoid-c-arrays) - Cryptographic keys interface with C APIs (OpenSSL)
-    quint8 m_sessionKey[PWM_SESSION_KEY_SIZE];  // Session key for in-memory encryption
-    quint8 m_masterKey[32];                      // Hashed master password
-    quint8 m_transformedMasterKey[32];           // Transformed key after N rounds
-    // NOLINTEND(modernize-avoid-c-arrays)
+    // The keys share one locked SecureArena block
+    SecureMemory<quint8> m_keyMemory;
+    quint8* m_sessionKey;                        // Session key for in-memory encryption
+    quint8* m_masterKey;                         // Hashed master password (32 bytes)
+    quint8* m_transformedMasterKey;              // Transformed key after N rounds (32 bytes)
+    ProtectedStringCipher m_passwordCipher;      // Keystream of the locked entry passwords
+
+    // Nonce of each locked password, keyed by its arena block, which moves
+    // with the entry when entries are reordered. setEntry() takes a new one
+    // from the counter for every encryption, so no keystream is used twice.
+    struct PasswordNonce
+    {
+        quint8 aBytes[16];
+    };
+    QHash<const char*, PasswordNonce> m_passwordNonces;
+    quint64 m_uPasswordNonceCounter;
+
     int m_nAlgorithm;                            // Encryption algorithm (ALGO_AES or ALGO_TWOFISH)
     quint32 m_keyEncRounds;                      // Number of key transformation rounds
+    bool m_bTransformedKeyValid;                 // m_transformedMasterKey matches m_dbLastHeader
+    bool m_bFastResave;
     QString m_strKeySource;
 
     QString m_strDefaultUserName;
@@ -369,6 +607,29 @@ private:
 
     bool m_bUseTransactedFileWrites;
     QColor m_clr;
+
+    std::shared_ptr<AsyncOperation> m_pAsyncOp;  // Pending openDatabaseAsync/saveDatabaseAsync
+};
+
+/// Decrypted copy of one entry's password for callers that only read it
+/// (search, export, placeholders). The entry stays locked, so no relock is
+/// needed; the copy is erased when the object goes out of scope.
+class PwUnlockedPassword
+{
+public:
+    PwUnlockedPassword(const PwManager* pMgr, const PW_ENTRY* pEntry);
+    ~PwUnlockedPassword();
+
+    PwUnlockedPassword(const PwUnlockedPassword&) = delete;
+    PwUnlockedPassword& operator=(const PwUnlockedPassword&) = delete;
+
+    /// NUL-terminated UTF-8 password ("" if the entry has none)
+    [[nodiscard]] const char* data() const { return m_baPassword.constData(); }
+    [[nodiscard]] quint32 size() const { return static_cast<quint32>(m_baPassword.size()); }
+    [[nodiscard]] QString toString() const { return QString::fromUtf8(m_baPassword); }
+
+private:
+    QByteArray m_baPassword;
 };
 
 #endif // PW_MANAGER_H
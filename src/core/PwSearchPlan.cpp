@@ -0,0 +1,412 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "PwSearchPlan.h"
+#include "PwManager.h"
+#include "crypto/MemoryProtection.h"
+#include "util/FoldedText.h"
+#include "util/FoldedTextStore.h"
+#include "util/MemUtil.h"
+#include "util/PwUtil.h"
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // Separate from QThreadPool::globalInstance(), so that a search started
+    // from a pool thread cannot wait on chunks queued behind itself
+    QThreadPool* searchThreadPool()
+    {
+        static QThreadPool pool;
+        return &pool;
+    }
+
+    inline size_t textLength(const char* psz)
+    {
+        return (psz != nullptr) ? std::strlen(psz) : 0;
+    }
+
+    // Same text as PwUtil::uuidToString(): 8-4-4-4-12 lowercase hex digits
+    void formatUuid(const quint8* pUuid, char* pOut36)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+        int nPos = 0;
+        for (int i = 0; i < 16; ++i) {
+            if (i == 4 || i == 6 || i == 8 || i == 10)
+                pOut36[nPos++] = '-';
+            pOut36[nPos++] = hexDigits[pUuid[i] >> 4];
+            pOut36[nPos++] = hexDigits[pUuid[i] & 0x0F];
+        }
+    }
+}
+
+PwSearchPlan::PwSearchPlan(PwManager* pMgr, const QString& findString, bool bCaseSensitive,
+                           quint32 searchFlags, bool bExcludeBackups, bool bExcludeExpired)
+    : m_pMgr(pMgr)
+    , m_strFind(findString)
+    , m_dwFields(searchFlags)
+    , m_bCaseSensitive(bCaseSensitive)
+    , m_bRegex((searchFlags & PWMS_REGEX) != 0)
+    , m_pFoldedText(nullptr)
+    , m_bIndexed(false)
+    , m_bUseCandidates(false)
+    , m_bExcludeBackups(bExcludeBackups)
+    , m_dwBackupGroupId(0)
+    , m_dwBackupSrcGroupId(0)
+    , m_bExcludeExpired(bExcludeExpired)
+{
+    std::memset(&m_tNow, 0, sizeof(PW_TIME));
+
+    if (findString.isEmpty()) {
+        m_strError = "Search string cannot be empty";
+        return;
+    }
+
+    if (m_bRegex) {
+        QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
+        if (!bCaseSensitive) {
+            options |= QRegularExpression::CaseInsensitiveOption;
+        }
+
+        m_regex.setPattern(findString);
+        m_regex.setPatternOptions(options);
+
+        if (!m_regex.isValid()) {
+            m_strError = QString("Invalid regular expression: %1").arg(m_regex.errorString());
+            return;
+        }
+
+        // Compile (with the JIT where available) once, not on the first match
+        m_regex.optimize();
+    } else {
+        // Plain text is searched for in the UTF-8 fields directly. Without
+        // case sensitivity, the folded text is searched for in folded
+        // fields, which matches like QString's case-insensitive contains().
+        m_baNeedle = findString.toUtf8();
+        if (!bCaseSensitive) {
+            QByteArray baFolded(static_cast<int>(m_baNeedle.size() * FoldedText::MAX_EXPANSION), '\0');
+            baFolded.resize(static_cast<int>(
+                FoldedText::fold(m_baNeedle.constData(), static_cast<size_t>(m_baNeedle.size()), baFolded.data())));
+            m_baNeedle = baFolded;
+
+            if (m_dwFields & (PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_ADDITIONAL))
+                m_pFoldedText = &pMgr->getFoldedText();
+        }
+    }
+
+    // There are few groups; each name is matched once instead of per entry
+    if (m_dwFields & PWMF_GROUPNAME) {
+        QByteArray baFoldBuffer;
+        for (quint32 i = 0; i < pMgr->getNumberOfGroups(); ++i) {
+            const PW_GROUP* pGroup = pMgr->getGroup(i);
+            const size_t uLength = textLength(pGroup->pszGroupName);
+            const int nFoldSize = static_cast<int>(uLength * FoldedText::MAX_EXPANSION);
+            if (baFoldBuffer.size() < nFoldSize)
+                baFoldBuffer.resize(nFoldSize);
+            if (matchesText(pGroup->pszGroupName, uLength, baFoldBuffer.data()))
+                m_matchingGroupIds.insert(pGroup->uGroupId);
+        }
+    }
+
+    // The index knows which entries contain all trigrams of the text (folded)
+    // in one of the indexed fields; neither regular expressions nor UUIDs
+    // can be looked up in it
+    m_bIndexed = !m_bRegex && (m_dwFields & PWMF_UUID) == 0 &&
+                 ((m_dwFields & PWMF_PASSWORD) == 0 || pMgr->isSearchIndexPasswords());
+
+    if (bExcludeBackups) {
+        m_dwBackupGroupId = pMgr->getGroupId(PWS_BACKUPGROUP);
+        m_dwBackupSrcGroupId = pMgr->getGroupId(PWS_BACKUPGROUP_SRC);
+    }
+
+    if (bExcludeExpired) {
+        PwUtil::getCurrentTime(&m_tNow);
+    }
+}
+
+PwSearchPlan::~PwSearchPlan() = default;
+
+quint32 PwSearchPlan::clampEnd(quint32 dwEndExcl) const
+{
+    return qMin(dwEndExcl, m_pMgr->getNumberOfEntries());
+}
+
+quint32 PwSearchPlan::findFirst(quint32 dwStart, quint32 dwEndExcl) const
+{
+    if (!isValid())
+        return 0xFFFFFFFF;
+
+    quint32 dwFrom = dwStart;
+    quint32 dwTo = clampEnd(dwEndExcl);
+    const quint32* pIndexes = candidateRange(&dwFrom, &dwTo);
+
+    QList<quint32> results;
+    scan(pIndexes, dwFrom, dwTo, true, results);
+    return results.isEmpty() ? 0xFFFFFFFF : results.first();
+}
+
+QList<quint32> PwSearchPlan::findAll(quint32 dwStart, quint32 dwEndExcl, int nThreads) const
+{
+    QList<quint32> results;
+    quint32 dwFrom = dwStart;
+    quint32 dwEnd = clampEnd(dwEndExcl);
+    if (!isValid() || dwFrom >= dwEnd)
+        return results;
+
+    const quint32* pIndexes = candidateRange(&dwFrom, &dwEnd);
+    return scanParallel(pIndexes, dwFrom, dwEnd, nThreads);
+}
+
+QList<quint32> PwSearchPlan::findAllIn(const QVector<quint32>& vIndexes, int nThreads) const
+{
+    if (!isValid())
+        return QList<quint32>();
+
+    // Entries that no longer exist are skipped
+    const quint32* pBegin = vIndexes.constData();
+    const quint32* pEnd = std::lower_bound(pBegin, pBegin + vIndexes.size(), m_pMgr->getNumberOfEntries());
+    return scanParallel(pBegin, 0, static_cast<quint32>(pEnd - pBegin), nThreads);
+}
+
+QList<quint32> PwSearchPlan::scanParallel(const quint32* pIndexes, quint32 dwFrom, quint32 dwEnd,
+                                          int nThreads) const
+{
+    QList<quint32> results;
+    if (dwFrom >= dwEnd)
+        return results;
+
+    const quint32 dwChunks = (dwEnd - dwFrom + CHUNK_ENTRIES - 1) / CHUNK_ENTRIES;
+    const quint32 dwThreads = static_cast<quint32>((nThreads > 0) ? nThreads : qMax(1, QThread::idealThreadCount()));
+    const int nWorkers = static_cast<int>(qMin(dwChunks, dwThreads));
+
+    // Workers take the next chunk until none are left. Every chunk has its
+    // own result list, so joining them in chunk order keeps the entry order.
+    std::vector<QList<quint32>> vChunkResults(dwChunks);
+    std::atomic<quint32> dwNextChunk{0};
+    auto work = [&]() {
+        for (quint32 dwChunk = dwNextChunk++; dwChunk < dwChunks; dwChunk = dwNextChunk++) {
+            const quint32 dwChunkFrom = dwFrom + dwChunk * CHUNK_ENTRIES;
+            const quint32 dwChunkTo = static_cast<quint32>(
+                qMin<quint64>(static_cast<quint64>(dwChunkFrom) + CHUNK_ENTRIES, dwEnd));
+            scan(pIndexes, dwChunkFrom, dwChunkTo, false, vChunkResults[dwChunk]);
+        }
+    };
+
+    // The calling thread works as well
+    QSemaphore semDone;
+    for (int i = 1; i < nWorkers; ++i) {
+        searchThreadPool()->start(QRunnable::create([&work, &semDone]() {
+            work();
+            semDone.release();
+        }));
+    }
+    work();
+    semDone.acquire(nWorkers - 1);
+
+    int nResults = 0;
+    for (const QList<quint32>& chunkResults : vChunkResults)
+        nResults += chunkResults.size();
+    results.reserve(nResults);
+    for (const QList<quint32>& chunkResults : vChunkResults)
+        results.append(chunkResults);
+    return results;
+}
+
+const quint32* PwSearchPlan::candidateRange(quint32* pdwFrom, quint32* pdwTo) const
+{
+    // Looked up on first use only: findAllIn() does not need the candidates
+    std::call_once(m_candidatesOnce, [this]() {
+        if (!m_bIndexed)
+            return;
+
+        const quint32 dwTextFields = PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_PASSWORD | PWMF_ADDITIONAL;
+        m_bUseCandidates = ((m_dwFields & dwTextFields) == 0) ||
+                           m_pMgr->getSearchIndex().lookup(m_strFind, &m_vCandidates);
+        if (m_bUseCandidates && !m_matchingGroupIds.isEmpty()) {
+            for (quint32 dwGroupId : m_matchingGroupIds) {
+                const quint32 dwCount = m_pMgr->getNumberOfItemsInGroupN(dwGroupId);
+                for (quint32 i = 0; i < dwCount; ++i)
+                    m_vCandidates.append(m_pMgr->getEntryByGroupN(dwGroupId, i));
+            }
+            std::sort(m_vCandidates.begin(), m_vCandidates.end());
+            m_vCandidates.erase(std::unique(m_vCandidates.begin(), m_vCandidates.end()), m_vCandidates.end());
+        }
+    });
+
+    if (!m_bUseCandidates)
+        return nullptr;
+
+    const quint32* pBegin = m_vCandidates.constData();
+    const quint32* pEnd = pBegin + m_vCandidates.size();
+    *pdwFrom = static_cast<quint32>(std::lower_bound(pBegin, pEnd, *pdwFrom) - pBegin);
+    *pdwTo = static_cast<quint32>(std::lower_bound(pBegin, pEnd, *pdwTo) - pBegin);
+    return pBegin;
+}
+
+void PwSearchPlan::scan(const quint32* pIndexes, quint32 dwFrom, quint32 dwTo, bool bFirstOnly,
+                        QList<quint32>& vResults) const
+{
+    // One locked buffer for all passwords of the range and their folded copies
+    quint32 uMaxPasswordLen = 0;
+    if (m_dwFields & PWMF_PASSWORD) {
+        for (quint32 i = dwFrom; i < dwTo; ++i)
+            uMaxPasswordLen = qMax(uMaxPasswordLen, m_pMgr->getEntry(pIndexes ? pIndexes[i] : i)->uPasswordLen);
+    }
+    SecureMemory<char> passwordBuffer(static_cast<size_t>(uMaxPasswordLen) * (1 + FoldedText::MAX_EXPANSION) + 1);
+
+    for (quint32 dwPos = dwFrom; dwPos < dwTo; ++dwPos) {
+        const quint32 i = pIndexes ? pIndexes[dwPos] : dwPos;
+        const PW_ENTRY* pEntry = m_pMgr->getEntry(i);
+
+        // Filters first, they are cheaper than any field
+        if (m_bExcludeBackups &&
+            (pEntry->uGroupId == m_dwBackupGroupId || pEntry->uGroupId == m_dwBackupSrcGroupId)) {
+            continue;
+        }
+        if (m_bExcludeExpired && PwUtil::compareTime(&m_tNow, &pEntry->tExpire) > 0) {
+            continue;
+        }
+
+        if (matchesEntry(i, pEntry, passwordBuffer.data())) {
+            vResults.append(i);
+            if (bFirstOnly)
+                return;
+        }
+    }
+}
+
+bool PwSearchPlan::matchesEntry(quint32 dwIndex, const PW_ENTRY* pEntry, char* pBuffer) const
+{
+    // Title, user name, URL and notes come folded from the store when the
+    // search is not case-sensitive
+    auto matchesField = [this, dwIndex](quint32 dwField, FoldedTextStore::Column column, const char* pszText) {
+        if ((m_dwFields & dwField) == 0)
+            return false;
+        if (m_pFoldedText != nullptr) {
+            size_t uLength = 0;
+            const char* pFolded = m_pFoldedText->text(dwIndex, column, &uLength);
+            return containsNeedle(pFolded, uLength);
+        }
+        return matchesText(pszText, textLength(pszText), nullptr);
+    };
+
+    if (matchesField(PWMF_TITLE, FoldedTextStore::Title, pEntry->pszTitle))
+        return true;
+    if (matchesField(PWMF_USER, FoldedTextStore::UserName, pEntry->pszUserName))
+        return true;
+    if (matchesField(PWMF_URL, FoldedTextStore::Url, pEntry->pszURL))
+        return true;
+
+    // The password is decrypted (and folded) in the locked buffer, never in the entry
+    if ((m_dwFields & PWMF_PASSWORD) && pEntry->uPasswordLen != 0 &&
+        m_pMgr->decryptEntryPassword(pEntry, pBuffer)) {
+        char* pFoldBuffer = pBuffer + pEntry->uPasswordLen + 1;
+        const bool bMatch = matchesText(pBuffer, pEntry->uPasswordLen, pFoldBuffer);
+        MemUtil::mem_erase(pBuffer, pEntry->uPasswordLen);
+        if (!m_bRegex && !m_bCaseSensitive)
+            MemUtil::mem_erase(pFoldBuffer, pEntry->uPasswordLen * FoldedText::MAX_EXPANSION);
+        if (bMatch)
+            return true;
+    }
+
+    if (matchesField(PWMF_ADDITIONAL, FoldedTextStore::Notes, pEntry->pszAdditional))
+        return true;
+
+    // A UUID is lowercase hex, which folding does not change
+    if (m_dwFields & PWMF_UUID) {
+        char szUuid[36];
+        formatUuid(pEntry->uuid, szUuid);
+        if (m_bRegex ? matchesText(szUuid, sizeof(szUuid), nullptr) : containsNeedle(szUuid, sizeof(szUuid)))
+            return true;
+    }
+
+    return (m_dwFields & PWMF_GROUPNAME) && m_matchingGroupIds.contains(pEntry->uGroupId);
+}
+
+bool PwSearchPlan::matchesText(const char* pText, size_t uLength, char* pFoldBuffer) const
+{
+    // An empty field never matches (the search text is never empty)
+    if (uLength == 0)
+        return false;
+
+    if (m_bRegex)
+        return m_regex.match(QString::fromUtf8(pText, static_cast<int>(uLength))).hasMatch();
+
+    if (m_bCaseSensitive)
+        return containsNeedle(pText, uLength);
+
+    return containsNeedle(pFoldBuffer, FoldedText::fold(pText, uLength, pFoldBuffer));
+}
+
+bool PwSearchPlan::containsNeedle(const char* pText, size_t uLength) const
+{
+    return FoldedText::contains(pText, uLength, m_baNeedle.constData(), static_cast<size_t>(m_baNeedle.size()));
+}
+
+PwSearchSession::PwSearchSession(PwManager* pMgr)
+    : m_pMgr(pMgr)
+    , m_bHaveResults(false)
+    , m_uContentVersion(0)
+    , m_bCaseSensitive(false)
+    , m_dwFlags(0)
+    , m_bExcludeBackups(false)
+    , m_bExcludeExpired(false)
+    , m_bRefined(false)
+{
+}
+
+QList<quint32> PwSearchSession::search(const QString& findString, bool bCaseSensitive, quint32 searchFlags,
+                                       bool bExcludeBackups, bool bExcludeExpired, QString* pError)
+{
+    const PwSearchPlan plan(m_pMgr, findString, bCaseSensitive, searchFlags, bExcludeBackups, bExcludeExpired);
+    if (!plan.isValid()) {
+        if (pError) *pError = plan.errorString();
+        reset();
+        return QList<quint32>();
+    }
+
+    // Entries that expire in between are filtered out again by the new
+    // plan; regular expressions can match anywhere, so they never refine
+    m_bRefined = m_bHaveResults && m_uContentVersion == m_pMgr->getContentVersion() &&
+                 (searchFlags & PWMS_REGEX) == 0 && searchFlags == m_dwFlags &&
+                 bCaseSensitive == m_bCaseSensitive && bExcludeBackups == m_bExcludeBackups &&
+                 bExcludeExpired == m_bExcludeExpired &&
+                 findString.contains(m_strFind, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+
+    const QList<quint32> results = m_bRefined ? plan.findAllIn(m_vResults) : plan.findAll();
+
+    m_bHaveResults = true;
+    m_uContentVersion = m_pMgr->getContentVersion();
+    m_strFind = findString;
+    m_bCaseSensitive = bCaseSensitive;
+    m_dwFlags = searchFlags;
+    m_bExcludeBackups = bExcludeBackups;
+    m_bExcludeExpired = bExcludeExpired;
+    m_vResults.clear();
+    m_vResults.reserve(results.size());
+    for (quint32 dwIndex : results)
+        m_vResults.append(dwIndex);
+    return results;
+}
+
+void PwSearchSession::reset()
+{
+    m_bHaveResults = false;
+    m_bRefined = false;
+    m_strFind.clear();
+    m_vResults.clear();
+}
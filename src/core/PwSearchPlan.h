@@ -0,0 +1,146 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef PW_SEARCH_PLAN_H
+#define PW_SEARCH_PLAN_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <mutex>
+#include "PwStructs.h"
+
+class PwManager;
+class FoldedTextStore;
+
+/// A find()/findAll() query compiled once against a database: the search
+/// text as UTF-8 (case-folded unless the search is case-sensitive), the
+/// regular expression (JIT compiled), the fields to look at, the groups
+/// whose name matches and the backup and expiry filters. Plain text is
+/// found with FoldedText::find() in the stored UTF-8 fields, or without
+/// case sensitivity in their folded copies (see PwManager::getFoldedText);
+/// only regular expressions go through QString.
+///
+/// Plain text searches in indexed fields (see PwManager::getSearchIndex)
+/// only look at the candidates from the trigram index and the entries of
+/// the groups whose name matches.
+///
+/// The plan keeps pointers into the database, so it must not outlive a
+/// change to it. Matching only reads, so several threads can share a plan.
+class PwSearchPlan
+{
+public:
+    PwSearchPlan(PwManager* pMgr, const QString& findString, bool bCaseSensitive, quint32 searchFlags,
+                 bool bExcludeBackups = false, bool bExcludeExpired = false);
+    ~PwSearchPlan();
+
+    PwSearchPlan(const PwSearchPlan&) = delete;
+    PwSearchPlan& operator=(const PwSearchPlan&) = delete;
+
+    /// @return false for an empty search text or an invalid regular expression
+    [[nodiscard]] bool isValid() const { return m_strError.isEmpty(); }
+    [[nodiscard]] QString errorString() const { return m_strError; }
+
+    /// @return Index of the first matching entry in [dwStart, dwEndExcl), or 0xFFFFFFFF
+    quint32 findFirst(quint32 dwStart, quint32 dwEndExcl = 0xFFFFFFFF) const;
+
+    /// All matching entries in [dwStart, dwEndExcl), ascending. Large ranges
+    /// are scanned in chunks on up to nThreads threads (0 = ideal count).
+    QList<quint32> findAll(quint32 dwStart = 0, quint32 dwEndExcl = 0xFFFFFFFF, int nThreads = 0) const;
+
+    /// The matching entries among vIndexes (ascending), e.g. the results of
+    /// a broader search; costs time in proportion to vIndexes only
+    QList<quint32> findAllIn(const QVector<quint32>& vIndexes, int nThreads = 0) const;
+
+    /// Entries per chunk of the parallel scan
+    static constexpr quint32 CHUNK_ENTRIES = 2048;
+
+private:
+    // Appends the matches among the entries pIndexes[dwFrom..dwTo) (nullptr:
+    // the entries dwFrom..dwTo) to vResults; stops after the first one with bFirstOnly
+    void scan(const quint32* pIndexes, quint32 dwFrom, quint32 dwTo, bool bFirstOnly,
+              QList<quint32>& vResults) const;
+    QList<quint32> scanParallel(const quint32* pIndexes, quint32 dwFrom, quint32 dwEnd, int nThreads) const;
+    // Turns the entry range into a range of candidates, if there are any
+    const quint32* candidateRange(quint32* pdwFrom, quint32* pdwTo) const;
+    // pBuffer has room for the password and its folded copy
+    bool matchesEntry(quint32 dwIndex, const PW_ENTRY* pEntry, char* pBuffer) const;
+    // Text as stored; pFoldBuffer (MAX_EXPANSION * uLength bytes) is only
+    // used without case sensitivity
+    bool matchesText(const char* pText, size_t uLength, char* pFoldBuffer) const;
+    // Plain search for m_baNeedle, i.e. in folded text without case sensitivity
+    bool containsNeedle(const char* pText, size_t uLength) const;
+    quint32 clampEnd(quint32 dwEndExcl) const;
+
+    PwManager* m_pMgr;
+    QString m_strFind;
+    QString m_strError;
+    quint32 m_dwFields;
+    bool m_bCaseSensitive;
+    bool m_bRegex;
+    QRegularExpression m_regex;
+
+    QByteArray m_baNeedle;                // UTF-8 search text, folded without case sensitivity
+    const FoldedTextStore* m_pFoldedText; // Case-insensitive plain text search in the text fields
+
+    QSet<quint32> m_matchingGroupIds;  // PWMF_GROUPNAME: groups whose name matches
+
+    bool m_bIndexed;                           // The search index can narrow this search
+    mutable std::once_flag m_candidatesOnce;
+    mutable bool m_bUseCandidates;             // Only m_vCandidates can match
+    mutable QVector<quint32> m_vCandidates;    // Ascending entry indexes
+
+    bool m_bExcludeBackups;
+    quint32 m_dwBackupGroupId;
+    quint32 m_dwBackupSrcGroupId;
+    bool m_bExcludeExpired;
+    PW_TIME m_tNow;
+};
+
+/// Search-as-you-type over one database: remembers the last query and its
+/// results. A query that only extends the last one (same options, the old
+/// text is part of the new one) can only match a subset of the old results,
+/// so only those are checked. Any change to the database (see
+/// PwManager::getContentVersion) makes the next search start over.
+class PwSearchSession
+{
+public:
+    explicit PwSearchSession(PwManager* pMgr);
+
+    /// Same parameters and result as PwManager::findAll()
+    QList<quint32> search(const QString& findString, bool bCaseSensitive, quint32 searchFlags,
+                          bool bExcludeBackups, bool bExcludeExpired, QString* pError = nullptr);
+
+    /// Forget the last results; the next search looks at all entries
+    void reset();
+
+    /// @return true if the last search() only checked the previous results
+    [[nodiscard]] bool wasRefined() const { return m_bRefined; }
+
+private:
+    PwManager* m_pMgr;
+
+    bool m_bHaveResults;
+    quint64 m_uContentVersion;  // Of the database when m_vResults was found
+    QString m_strFind;
+    bool m_bCaseSensitive;
+    quint32 m_dwFlags;
+    bool m_bExcludeBackups;
+    bool m_bExcludeExpired;
+    QVector<quint32> m_vResults;  // Ascending
+    bool m_bRefined;
+};
+
+#endif // PW_SEARCH_PLAN_H
@@ -33,9 +33,11 @@
 #define PWSTRUCTS_H
 
 #include <QByteArray>
+#include <QHash>
 #include <QString>
 #include <QVector>
 #include <QtGlobal>
+#include <cstring>
 
 /**
  * @file PwStructs.h
@@ -251,6 +253,47 @@ struct CustomKvp
     QString value;
 };
 
+/// Entry UUID as a hashable value (key type of the PwManager UUID index)
+struct PwUuidKey
+{
+    quint64 lo;
+    quint64 hi;
+
+    static PwUuidKey fromBytes(const BYTE* pUuid)
+    {
+        PwUuidKey key;
+        std::memcpy(&key.lo, pUuid, 8);
+        std::memcpy(&key.hi, pUuid + 8, 8);
+        return key;
+    }
+
+    bool operator==(const PwUuidKey& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const PwUuidKey& other) const { return !(*this == other); }
+};
+
+// QHash seeds and hash values are uint in Qt 5 and size_t in Qt 6
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+inline size_t qHash(const PwUuidKey& key, size_t seed = 0) noexcept
+#else
+inline uint qHash(const PwUuidKey& key, uint seed = 0) noexcept
+#endif
+{
+    return qHashBits(&key, sizeof(PwUuidKey), seed);
+}
+
+/// Links of one group in the PwManager group tree index.
+/// All members are group indexes; DWORD_MAX (0xFFFFFFFF) means "none".
+struct PwGroupTreeNode
+{
+    DWORD dwParent;       ///< Parent group, none for top-level groups
+    DWORD dwFirstChild;   ///< First direct child
+    DWORD dwLastChild;    ///< Last direct child (for O(1) appends)
+    DWORD dwNextSibling;  ///< Next group with the same parent
+    DWORD dwRow;          ///< Position among the siblings
+    DWORD dwChildren;     ///< Number of direct children
+    QVector<quint32> vChildren;  ///< Direct children by row (O(1) row lookups)
+};
+
 /// Simple UI state
 #pragma pack(push, 1)
 typedef struct _PMS_SIMPLE_UI_STATE
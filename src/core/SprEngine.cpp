@@ -7,9 +7,11 @@
 #include "SprEngine.h"
 #include "PwManager.h"
 #include "PwStructs.h"
+#include "util/FoldedText.h"
 #include <QCoreApplication>
 #include <QDir>
 #include <QRegularExpression>
+#include <cstring>
 
 SprEngine::SprEngine()
 {
@@ -164,11 +166,8 @@ QString SprEngine::resolveEntryField(const QString& fieldName,
 
     if (fieldName == "PASSWORD") {
         if (entry->pszPassword != nullptr && database != nullptr) {
-            // Unlock password to access it
-            database->unlockEntryPassword(entry);
-            QString password = QString::fromUtf8(entry->pszPassword);
-            database->lockEntryPassword(entry);
-            return password;
+            // Decrypt a copy; the entry stays locked
+            return PwUnlockedPassword(database, entry).toString();
         }
         return QString();
     }
@@ -357,61 +356,70 @@ PW_ENTRY* SprEngine::findEntryByField(PwManager* database,
         return nullptr;
     }
 
-    quint32 entryCount = database->getNumberOfEntries();
-
-    for (quint32 i = 0; i < entryCount; ++i) {
-        PW_ENTRY* entry = database->getEntry(i);
-        if (entry == nullptr) {
-            continue;
+    // UUID references resolve through the UUID index instead of
+    // formatting every entry's UUID as hex
+    if (searchType == QLatin1Char('I')) {
+        const QByteArray hex = searchValue.toLatin1().toLower();
+        if (hex.size() != 32) {
+            return nullptr;
+        }
+        const QByteArray uuid = QByteArray::fromHex(hex);
+        if (uuid.size() != 16 || uuid.toHex() != hex) {
+            return nullptr;  // Not a well-formed UUID, cannot match any entry
         }
+        return database->getEntryByUuid(reinterpret_cast<const quint8*>(uuid.constData()));
+    }
 
-        QString fieldValue;
+    quint32 entryCount = database->getNumberOfEntries();
 
-        switch (searchType.toLatin1()) {
-            case 'T':  // Title
-                if (entry->pszTitle != nullptr) {
-                    fieldValue = QString::fromUtf8(entry->pszTitle);
-                }
-                break;
-            case 'U':  // Username
-                if (entry->pszUserName != nullptr) {
-                    fieldValue = QString::fromUtf8(entry->pszUserName);
-                }
-                break;
-            case 'A':  // URL
-                if (entry->pszURL != nullptr) {
-                    fieldValue = QString::fromUtf8(entry->pszURL);
-                }
-                break;
-            case 'P':  // Password
-                if (entry->pszPassword != nullptr) {
-                    database->unlockEntryPassword(entry);
-                    fieldValue = QString::fromUtf8(entry->pszPassword);
-                    database->lockEntryPassword(entry);
-                }
-                break;
-            case 'N':  // Notes
-                if (entry->pszAdditional != nullptr) {
-                    fieldValue = QString::fromUtf8(entry->pszAdditional);
-                }
-                break;
-            case 'I':  // UUID
-                {
-                    // Convert UUID bytes to string for comparison
-                    QString uuidStr;
-                    for (int j = 0; j < 16; ++j) {
-                        uuidStr += QString("%1").arg(entry->uuid[j], 2, 16, QChar('0'));
-                    }
-                    fieldValue = uuidStr;
-                }
-                break;
-            default:
+    // Passwords are only compared after unlocking them one by one
+    if (searchType == QLatin1Char('P')) {
+        for (quint32 i = 0; i < entryCount; ++i) {
+            PW_ENTRY* entry = database->getEntry(i);
+            if (entry == nullptr || entry->pszPassword == nullptr) {
                 continue;
+            }
+
+            // Case-insensitive comparison
+            if (PwUnlockedPassword(database, entry).toString().compare(searchValue, Qt::CaseInsensitive) == 0) {
+                return entry;
+            }
         }
+        return nullptr;
+    }
+
+    FoldedTextStore::Column column;
+    switch (searchType.toLatin1()) {
+        case 'T':  // Title
+            column = FoldedTextStore::Title;
+            break;
+        case 'U':  // Username
+            column = FoldedTextStore::UserName;
+            break;
+        case 'A':  // URL
+            column = FoldedTextStore::Url;
+            break;
+        case 'N':  // Notes
+            column = FoldedTextStore::Notes;
+            break;
+        default:
+            return nullptr;
+    }
+
+    // Case-insensitive comparison: equal folded texts, compared without
+    // converting any field to QString
+    const QByteArray value = searchValue.toUtf8();
+    QByteArray foldedValue(static_cast<int>(value.size() * FoldedText::MAX_EXPANSION), '\0');
+    foldedValue.resize(static_cast<int>(
+        FoldedText::fold(value.constData(), static_cast<size_t>(value.size()), foldedValue.data())));
 
-        // Case-insensitive comparison
-        if (fieldValue.compare(searchValue, Qt::CaseInsensitive) == 0) {
-            return entry;
+    const FoldedTextStore& foldedText = database->getFoldedText();
+    for (quint32 i = 0; i < entryCount; ++i) {
+        size_t length = 0;
+        const char* field = foldedText.text(i, column, &length);
+        if (length == static_cast<size_t>(foldedValue.size()) &&
+            (length == 0 || std::memcmp(field, foldedValue.constData(), length) == 0)) {
+            return database->getEntry(i);
         }
     }
 
@@ -444,10 +452,7 @@ QString SprEngine::getEntryField(PW_ENTRY* entry,
             break;
         case 'P':  // Password
             if (entry->pszPassword != nullptr && database != nullptr) {
-                database->unlockEntryPassword(entry);
-                QString password = QString::fromUtf8(entry->pszPassword);
-                database->lockEntryPassword(entry);
-                return password;
+                return PwUnlockedPassword(database, entry).toString();
             }
             break;
         case 'N':  // Notes
@@ -0,0 +1,84 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef AES_NI_H
+#define AES_NI_H
+
+// AES-NI helpers shared by the *_aesni.cpp files. Functions marked with
+// AESNI_TARGET are compiled for AES-NI only, so callers must check the CPU
+// first (KeyTransform::isBackendSupported(KeyTransform::Backend::AesNi)).
+// AESNI_TARGET is left undefined where the intrinsics are not available.
+
+#include <QtGlobal>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AESNI_HAVE_X86 1
+#endif
+
+#if defined(AESNI_HAVE_X86) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#elif defined(AESNI_HAVE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#define AESNI_TARGET
+#endif
+
+#if defined(AESNI_TARGET)
+
+namespace AesNi {
+    AESNI_TARGET inline __m128i expandEven(__m128i k, __m128i t)
+    {
+        t = _mm_shuffle_epi32(t, 0xFF);
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        return _mm_xor_si128(k, t);
+    }
+
+    AESNI_TARGET inline __m128i expandOdd(__m128i kEven, __m128i k)
+    {
+        const __m128i t = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(kEven, 0x00), 0xAA);
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        return _mm_xor_si128(k, t);
+    }
+
+    // FIPS-197 AES-256 key expansion into 15 round keys. The round constant
+    // must be an immediate, hence the unrolled sequence.
+    AESNI_TARGET inline void expandKey256(const quint8* pKey32, __m128i* pSchedule)
+    {
+        pSchedule[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pKey32));
+        pSchedule[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pKey32 + 16));
+
+        pSchedule[2] = expandEven(pSchedule[0], _mm_aeskeygenassist_si128(pSchedule[1], 0x01));
+        pSchedule[3] = expandOdd(pSchedule[2], pSchedule[1]);
+        pSchedule[4] = expandEven(pSchedule[2], _mm_aeskeygenassist_si128(pSchedule[3], 0x02));
+        pSchedule[5] = expandOdd(pSchedule[4], pSchedule[3]);
+        pSchedule[6] = expandEven(pSchedule[4], _mm_aeskeygenassist_si128(pSchedule[5], 0x04));
+        pSchedule[7] = expandOdd(pSchedule[6], pSchedule[5]);
+        pSchedule[8] = expandEven(pSchedule[6], _mm_aeskeygenassist_si128(pSchedule[7], 0x08));
+        pSchedule[9] = expandOdd(pSchedule[8], pSchedule[7]);
+        pSchedule[10] = expandEven(pSchedule[8], _mm_aeskeygenassist_si128(pSchedule[9], 0x10));
+        pSchedule[11] = expandOdd(pSchedule[10], pSchedule[9]);
+        pSchedule[12] = expandEven(pSchedule[10], _mm_aeskeygenassist_si128(pSchedule[11], 0x20));
+        pSchedule[13] = expandOdd(pSchedule[12], pSchedule[11]);
+        pSchedule[14] = expandEven(pSchedule[12], _mm_aeskeygenassist_si128(pSchedule[13], 0x40));
+    }
+}
+
+#endif // AESNI_TARGET
+
+#endif // AES_NI_H
@@ -0,0 +1,461 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "CipherBackend.h"
+#include "Rijndael.h"
+#include "TwofishClass.h"
+#include "../util/MemUtil.h"
+#include <openssl/evp.h>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+    std::atomic<bool> g_bCrossCheck{false};
+
+    // A thread handles at least this much data per call; smaller calls use fewer threads
+    constexpr quint32 PARALLEL_MIN_SLICE_SIZE = 64 * 1024;
+
+    // Separate from QThreadPool::globalInstance(), so that a database opened
+    // from a pool thread cannot wait on slices queued behind itself
+    QThreadPool* cipherThreadPool()
+    {
+        static QThreadPool pool;
+        return &pool;
+    }
+
+    class ReferenceAesCbc : public CipherBackend
+    {
+    public:
+        bool init(bool bEncrypt, const quint8* pKey32, const quint8* pIV16) override
+        {
+            return m_aes.Init(CRijndael::CBC, bEncrypt ? CRijndael::EncryptDir : CRijndael::DecryptDir,
+                              pKey32, CRijndael::Key32Bytes, pIV16) == RIJNDAEL_SUCCESS;
+        }
+
+        qint64 padEncrypt(const quint8* pIn, quint32 uSize, quint8* pOut) override
+        {
+            return m_aes.PadEncrypt(pIn, static_cast<int>(uSize), pOut);
+        }
+
+        bool encryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+
+            const int nBits = m_aes.BlockEncrypt(pData, static_cast<int>(uSize) * 8, pData);
+            m_aes.SetInitVector(pData + uSize - 16);
+            return nBits == static_cast<int>(uSize) * 8;
+        }
+
+        bool decryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+
+            // CRijndael does not carry the chaining value between calls
+            quint8 aNextIV[16];
+            std::memcpy(aNextIV, pData + uSize - 16, 16);
+            const int nBits = m_aes.BlockDecrypt(pData, static_cast<int>(uSize) * 8, pData);
+            m_aes.SetInitVector(aNextIV);
+            return nBits == static_cast<int>(uSize) * 8;
+        }
+
+        qint32 decryptFinal(quint8* pData, quint32 uSize) override
+        {
+            return m_aes.PadDecrypt(pData, static_cast<int>(uSize), pData);
+        }
+
+        Implementation implementation() const override { return Implementation::Reference; }
+
+    private:
+        CRijndael m_aes;
+    };
+
+    class ReferenceTwofishCbc : public CipherBackend
+    {
+    public:
+        bool init([[maybe_unused]] bool bEncrypt, const quint8* pKey32, const quint8* pIV16) override
+        {
+            return m_twofish.Init(pKey32, 32, pIV16);
+        }
+
+        qint64 padEncrypt(const quint8* pIn, quint32 uSize, quint8* pOut) override
+        {
+            return m_twofish.PadEncrypt(pIn, static_cast<INT32>(uSize), pOut);
+        }
+
+        bool encryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+            return m_twofish.BlockEncrypt(pData, static_cast<INT32>(uSize), pData) == static_cast<INT32>(uSize);
+        }
+
+        bool decryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+            return m_twofish.BlockDecrypt(pData, static_cast<INT32>(uSize), pData) == static_cast<INT32>(uSize);
+        }
+
+        qint32 decryptFinal(quint8* pData, quint32 uSize) override
+        {
+            return m_twofish.PadDecrypt(pData, static_cast<INT32>(uSize), pData);
+        }
+
+        Implementation implementation() const override { return Implementation::Reference; }
+
+    private:
+        CTwofish m_twofish;
+    };
+
+    // Padding is handled here for decryption, so that bad padding is
+    // detected exactly like in CRijndael::PadDecrypt
+    class OpenSslAesCbc : public CipherBackend
+    {
+    public:
+        OpenSslAesCbc() : m_pCtx(EVP_CIPHER_CTX_new()) {}
+        ~OpenSslAesCbc() override { EVP_CIPHER_CTX_free(m_pCtx); }
+
+        OpenSslAesCbc(const OpenSslAesCbc&) = delete;
+        OpenSslAesCbc& operator=(const OpenSslAesCbc&) = delete;
+
+        bool init(bool bEncrypt, const quint8* pKey32, const quint8* pIV16) override
+        {
+            if (m_pCtx == nullptr)
+                return false;
+
+            quint8 aZeroIV[16] = { 0 };
+            if (EVP_CipherInit_ex(m_pCtx, EVP_aes_256_cbc(), nullptr, pKey32,
+                                  (pIV16 != nullptr) ? pIV16 : aZeroIV, bEncrypt ? 1 : 0) != 1)
+                return false;
+            return EVP_CIPHER_CTX_set_padding(m_pCtx, bEncrypt ? 1 : 0) == 1;
+        }
+
+        qint64 padEncrypt(const quint8* pIn, quint32 uSize, quint8* pOut) override
+        {
+            if (pIn == nullptr || uSize == 0)
+                return 0;
+
+            int nUpdate = 0;
+            int nFinal = 0;
+            if (EVP_EncryptUpdate(m_pCtx, pOut, &nUpdate, pIn, static_cast<int>(uSize)) != 1)
+                return -1;
+            if (EVP_EncryptFinal_ex(m_pCtx, pOut + nUpdate, &nFinal) != 1)
+                return -1;
+            return static_cast<qint64>(nUpdate) + nFinal;
+        }
+
+        bool encryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+
+            // With whole blocks, EVP returns all of them right away
+            int nOut = 0;
+            return (EVP_EncryptUpdate(m_pCtx, pData, &nOut, pData, static_cast<int>(uSize)) == 1) &&
+                   (nOut == static_cast<int>(uSize));
+        }
+
+        bool decryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+
+            int nOut = 0;
+            return (EVP_DecryptUpdate(m_pCtx, pData, &nOut, pData, static_cast<int>(uSize)) == 1) &&
+                   (nOut == static_cast<int>(uSize));
+        }
+
+        qint32 decryptFinal(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return 0;
+            if ((uSize % 16) != 0 || !decryptBlocks(pData, uSize))
+                return -1;
+
+            const quint8 uPadLen = pData[uSize - 1];
+            if (uPadLen == 0 || uPadLen > 16)
+                return -1;
+            for (quint32 i = uSize - uPadLen; i < uSize; ++i) {
+                if (pData[i] != uPadLen)
+                    return -1;
+            }
+            return static_cast<qint32>(uSize - uPadLen);
+        }
+
+        Implementation implementation() const override { return Implementation::OpenSsl; }
+
+    private:
+        EVP_CIPHER_CTX* m_pCtx;
+    };
+
+    // Runs the fast implementation on the caller's data and the reference
+    // implementation on a copy; any difference makes the call fail
+    class CrossCheckCbc : public CipherBackend
+    {
+    public:
+        CrossCheckCbc(std::unique_ptr<CipherBackend> pFast, std::unique_ptr<CipherBackend> pReference)
+            : m_pFast(std::move(pFast)), m_pReference(std::move(pReference))
+        {
+        }
+
+        bool init(bool bEncrypt, const quint8* pKey32, const quint8* pIV16) override
+        {
+            const bool bFast = m_pFast->init(bEncrypt, pKey32, pIV16);
+            const bool bReference = m_pReference->init(bEncrypt, pKey32, pIV16);
+            return bFast && bReference;
+        }
+
+        qint64 padEncrypt(const quint8* pIn, quint32 uSize, quint8* pOut) override
+        {
+            QVector<quint8> vCopy(static_cast<int>(uSize) + 16);
+            if (uSize > 0)
+                std::memcpy(vCopy.data(), pIn, uSize);
+
+            const qint64 nReference = m_pReference->padEncrypt(vCopy.constData(), uSize, vCopy.data());
+            const qint64 nFast = m_pFast->padEncrypt(pIn, uSize, pOut);
+            const bool bSame = (nFast == nReference) &&
+                ((nFast <= 0) || std::memcmp(pOut, vCopy.constData(), static_cast<size_t>(nFast)) == 0);
+
+            MemUtil::mem_erase(vCopy.data(), static_cast<size_t>(vCopy.size()));
+            return bSame ? nFast : -1;
+        }
+
+        bool encryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            QVector<quint8> vCopy(static_cast<int>(uSize));
+            if (uSize > 0)
+                std::memcpy(vCopy.data(), pData, uSize);
+
+            const bool bReference = m_pReference->encryptBlocks(vCopy.data(), uSize);
+            const bool bFast = m_pFast->encryptBlocks(pData, uSize);
+            const bool bSame = bReference && bFast &&
+                ((uSize == 0) || std::memcmp(pData, vCopy.constData(), uSize) == 0);
+
+            MemUtil::mem_erase(vCopy.data(), static_cast<size_t>(vCopy.size()));
+            return bSame;
+        }
+
+        bool decryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            QVector<quint8> vCopy(static_cast<int>(uSize));
+            if (uSize > 0)
+                std::memcpy(vCopy.data(), pData, uSize);
+
+            const bool bReference = m_pReference->decryptBlocks(vCopy.data(), uSize);
+            const bool bFast = m_pFast->decryptBlocks(pData, uSize);
+            const bool bSame = bReference && bFast &&
+                ((uSize == 0) || std::memcmp(pData, vCopy.constData(), uSize) == 0);
+
+            MemUtil::mem_erase(vCopy.data(), static_cast<size_t>(vCopy.size()));
+            return bSame;
+        }
+
+        qint32 decryptFinal(quint8* pData, quint32 uSize) override
+        {
+            QVector<quint8> vCopy(static_cast<int>(uSize));
+            if (uSize > 0)
+                std::memcpy(vCopy.data(), pData, uSize);
+
+            const qint32 nReference = m_pReference->decryptFinal(vCopy.data(), uSize);
+            const qint32 nFast = m_pFast->decryptFinal(pData, uSize);
+
+            // On bad padding the implementations may leave different garbage behind
+            const bool bSame = (nFast == nReference) &&
+                ((nFast <= 0) || std::memcmp(pData, vCopy.constData(), static_cast<size_t>(nFast)) == 0);
+
+            MemUtil::mem_erase(vCopy.data(), static_cast<size_t>(vCopy.size()));
+            return bSame ? nFast : -1;
+        }
+
+        Implementation implementation() const override { return m_pFast->implementation(); }
+
+    private:
+        std::unique_ptr<CipherBackend> m_pFast;
+        std::unique_ptr<CipherBackend> m_pReference;
+    };
+
+    // Splits each call into slices of whole blocks. The IV of a slice is the
+    // last ciphertext block of the slice before it, saved before any thread
+    // starts decrypting in place. The first slice runs on the calling thread.
+    class ParallelCbcDecryptor : public CipherBackend
+    {
+    public:
+        ParallelCbcDecryptor(Cipher cipher, int nThreads)
+            : m_cipher(cipher)
+            , m_nThreads((nThreads > 0) ? nThreads : qMax(1, QThread::idealThreadCount()))
+        {
+            std::memset(m_aKey, 0, sizeof(m_aKey));
+            std::memset(m_aIV, 0, sizeof(m_aIV));
+        }
+
+        ~ParallelCbcDecryptor() override
+        {
+            MemUtil::mem_erase(m_aKey, sizeof(m_aKey));
+            MemUtil::mem_erase(m_aIV, sizeof(m_aIV));
+        }
+
+        ParallelCbcDecryptor(const ParallelCbcDecryptor&) = delete;
+        ParallelCbcDecryptor& operator=(const ParallelCbcDecryptor&) = delete;
+
+        bool init(bool bEncrypt, const quint8* pKey32, const quint8* pIV16) override
+        {
+            if (bEncrypt || pKey32 == nullptr)
+                return false;
+
+            std::memcpy(m_aKey, pKey32, 32);
+            if (pIV16 != nullptr)
+                std::memcpy(m_aIV, pIV16, 16);
+            else
+                std::memset(m_aIV, 0, 16);
+            return true;
+        }
+
+        qint64 padEncrypt([[maybe_unused]] const quint8* pIn, [[maybe_unused]] quint32 uSize,
+                          [[maybe_unused]] quint8* pOut) override
+        {
+            return -1;
+        }
+
+        bool encryptBlocks([[maybe_unused]] quint8* pData, [[maybe_unused]] quint32 uSize) override
+        {
+            return false;
+        }
+
+        bool decryptBlocks(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return true;
+            if ((uSize % 16) != 0)
+                return false;
+
+            const quint32 uBlocks = uSize / 16;
+            const int nSlices = static_cast<int>(qBound<quint32>(1, uSize / PARALLEL_MIN_SLICE_SIZE,
+                                                                 static_cast<quint32>(m_nThreads)));
+            const quint32 uSliceBlocks = uBlocks / static_cast<quint32>(nSlices);
+
+            // One backend per slice, set up here so that no key schedule is
+            // prepared concurrently
+            std::vector<std::unique_ptr<CipherBackend>> vSlices(static_cast<size_t>(nSlices));
+            for (int i = 0; i < nSlices; ++i) {
+                const quint8* pIV = (i == 0) ? m_aIV : pData + (i * uSliceBlocks * 16) - 16;
+                vSlices[i] = CipherBackend::create(m_cipher);
+                if (!vSlices[i]->init(false, m_aKey, pIV))
+                    return false;
+            }
+            std::memcpy(m_aIV, pData + uSize - 16, 16);
+
+            std::atomic<bool> bSuccess{true};
+            QSemaphore semDone;
+            for (int i = 1; i < nSlices; ++i) {
+                quint8* pSlice = pData + (i * uSliceBlocks * 16);
+                const quint32 uSliceSize = (i == nSlices - 1) ? (uBlocks - i * uSliceBlocks) * 16
+                                                              : uSliceBlocks * 16;
+                CipherBackend* pBackend = vSlices[i].get();
+                cipherThreadPool()->start(QRunnable::create([pBackend, pSlice, uSliceSize, &bSuccess, &semDone]() {
+                    if (!pBackend->decryptBlocks(pSlice, uSliceSize))
+                        bSuccess = false;
+                    semDone.release();
+                }));
+            }
+
+            const quint32 uFirstSize = ((nSlices == 1) ? uBlocks : uSliceBlocks) * 16;
+            if (!vSlices[0]->decryptBlocks(pData, uFirstSize))
+                bSuccess = false;
+
+            semDone.acquire(nSlices - 1);
+            return bSuccess.load();
+        }
+
+        qint32 decryptFinal(quint8* pData, quint32 uSize) override
+        {
+            if (uSize == 0)
+                return 0;
+            if ((uSize % 16) != 0 || !decryptBlocks(pData, uSize - 16))
+                return -1;
+
+            // The padding is in the last block, checked by a sequential backend
+            std::unique_ptr<CipherBackend> pLast = CipherBackend::create(m_cipher);
+            if (!pLast->init(false, m_aKey, m_aIV))
+                return -1;
+            const qint32 nLast = pLast->decryptFinal(pData + uSize - 16, 16);
+            return (nLast < 0) ? -1 : static_cast<qint32>(uSize - 16) + nLast;
+        }
+
+        Implementation implementation() const override
+        {
+            return isSupported(m_cipher, Implementation::OpenSsl) ? Implementation::OpenSsl
+                                                                   : Implementation::Reference;
+        }
+
+    private:
+        Cipher m_cipher;
+        int m_nThreads;
+        quint8 m_aKey[32];
+        quint8 m_aIV[16];   // Chaining value for the next call
+    };
+}
+
+std::unique_ptr<CipherBackend> CipherBackend::create(Cipher cipher)
+{
+    if (!isSupported(cipher, Implementation::OpenSsl))
+        return create(cipher, Implementation::Reference);
+
+    if (g_bCrossCheck.load()) {
+        return std::make_unique<CrossCheckCbc>(create(cipher, Implementation::OpenSsl),
+                                               create(cipher, Implementation::Reference));
+    }
+    return create(cipher, Implementation::OpenSsl);
+}
+
+std::unique_ptr<CipherBackend> CipherBackend::create(Cipher cipher, Implementation impl)
+{
+    if (impl == Implementation::OpenSsl) {
+        if (cipher == Cipher::Aes256)
+            return std::make_unique<OpenSslAesCbc>();
+        return nullptr;
+    }
+
+    if (cipher == Cipher::Aes256)
+        return std::make_unique<ReferenceAesCbc>();
+    return std::make_unique<ReferenceTwofishCbc>();
+}
+
+std::unique_ptr<CipherBackend> CipherBackend::createParallelDecryptor(Cipher cipher, int nThreads)
+{
+    return std::make_unique<ParallelCbcDecryptor>(cipher, nThreads);
+}
+
+bool CipherBackend::isSupported(Cipher cipher, Implementation impl)
+{
+    return (impl == Implementation::Reference) || (cipher == Cipher::Aes256);
+}
+
+const char* CipherBackend::implementationName(Implementation impl)
+{
+    return (impl == Implementation::OpenSsl) ? "OpenSSL" : "Reference";
+}
+
+void CipherBackend::setCrossCheck(bool bEnable)
+{
+    g_bCrossCheck.store(bEnable);
+}
+
+bool CipherBackend::isCrossCheckEnabled()
+{
+    return g_bCrossCheck.load();
+}
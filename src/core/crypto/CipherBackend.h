@@ -0,0 +1,87 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef CIPHER_BACKEND_H
+#define CIPHER_BACKEND_H
+
+#include <QtGlobal>
+#include <memory>
+
+/// CBC encryption of the database payload (256-bit key, 16-byte blocks,
+/// PKCS#7 padding). openDatabase and saveDatabase go through this interface;
+/// which implementation runs is decided at runtime by create().
+///
+/// A backend works in one direction only. Decryption can be done in pieces:
+/// decryptBlocks() for all but the last piece, then decryptFinal().
+class CipherBackend
+{
+public:
+    enum class Cipher
+    {
+        Aes256,
+        Twofish256
+    };
+
+    enum class Implementation
+    {
+        Reference,  ///< CRijndael / CTwofish, portable C code
+        OpenSsl     ///< OpenSSL EVP (AES only), uses AES-NI and similar where available
+    };
+
+    virtual ~CipherBackend() = default;
+
+    /// Set key and IV for encryption (bEncrypt) or decryption
+    virtual bool init(bool bEncrypt, const quint8* pKey32, const quint8* pIV16) = 0;
+
+    /// Encrypt uSize bytes and append the padding. pOut needs room for
+    /// uSize + 16 bytes and may be equal to pIn. Continues the chain of
+    /// preceding encryptBlocks() calls.
+    /// @return Ciphertext size, 0 for empty input, negative on error
+    virtual qint64 padEncrypt(const quint8* pIn, quint32 uSize, quint8* pOut) = 0;
+
+    /// Encrypt whole blocks in place without padding; the chaining value
+    /// carries over to the next call, the last piece goes through padEncrypt()
+    virtual bool encryptBlocks(quint8* pData, quint32 uSize) = 0;
+
+    /// Decrypt whole blocks in place; the chaining value carries over to the next call
+    virtual bool decryptBlocks(quint8* pData, quint32 uSize) = 0;
+
+    /// Decrypt the last piece (whole blocks) in place and check its padding
+    /// @return Plaintext size of the piece, or a negative value on bad padding
+    virtual qint32 decryptFinal(quint8* pData, quint32 uSize) = 0;
+
+    [[nodiscard]] virtual Implementation implementation() const = 0;
+
+    /// Create a backend with the fastest implementation supporting the cipher
+    /// (or a cross-checking one, see setCrossCheck)
+    static std::unique_ptr<CipherBackend> create(Cipher cipher);
+
+    /// Create a backend with a specific implementation
+    /// @return nullptr if the implementation does not support the cipher
+    static std::unique_ptr<CipherBackend> create(Cipher cipher, Implementation impl);
+
+    /// Create a decryption backend that splits every call across up to
+    /// nThreads threads (0 = QThread::idealThreadCount()). In CBC mode each
+    /// plaintext block only depends on two ciphertext blocks, so the pieces
+    /// are independent once their boundary IVs have been saved.
+    static std::unique_ptr<CipherBackend> createParallelDecryptor(Cipher cipher, int nThreads = 0);
+
+    [[nodiscard]] static bool isSupported(Cipher cipher, Implementation impl);
+    [[nodiscard]] static const char* implementationName(Implementation impl);
+
+    /// Cross-check mode (for tests): create(Cipher) returns backends that run
+    /// the reference and the fast implementation side by side and fail as
+    /// soon as their output differs in any byte
+    static void setCrossCheck(bool bEnable);
+    [[nodiscard]] static bool isCrossCheckEnabled();
+};
+
+#endif // CIPHER_BACKEND_H
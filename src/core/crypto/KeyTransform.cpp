@@ -10,9 +10,14 @@
 */
 
 #include "KeyTransform.h"
+#include "../util/MemUtil.h"
 #include <openssl/evp.h>
 #include <openssl/aes.h>
 #include <QElapsedTimer>
+#include <QSysInfo>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 // Use OpenSSL for AES-256 ECB encryption
@@ -60,11 +65,88 @@ bool KeyTransform::transform16(quint64 qwRounds, quint8* pBuffer16, const quint8
     return true;
 }
 
+KeyTransform::Backend KeyTransform::activeBackend()
+{
+    static const Backend backend = cpuSupportsAesNi() ? Backend::AesNi : Backend::OpenSsl;
+    return backend;
+}
+
+bool KeyTransform::isBackendSupported(Backend backend)
+{
+    return (backend == Backend::OpenSsl) || cpuSupportsAesNi();
+}
+
+const char* KeyTransform::backendName(Backend backend)
+{
+    return (backend == Backend::AesNi) ? "AES-NI" : "OpenSSL";
+}
+
 bool KeyTransform::transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32)
+{
+    return transform256(qwRounds, pBuffer32, pKeySeed32, activeBackend());
+}
+
+bool KeyTransform::transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32,
+                                Backend backend)
 {
     if (!pBuffer32 || !pKeySeed32)
         return false;
 
+    if (backend == Backend::OpenSsl)
+        return transform256OpenSsl(qwRounds, pBuffer32, pKeySeed32);
+
+    if (!isBackendSupported(backend))
+        return false;
+
+    // Work on a local copy, so that pBuffer32 is only written on success
+    quint8 buffer[32];
+    std::memcpy(buffer, pBuffer32, 32);
+    const bool success = transform256AesNi(qwRounds, buffer, pKeySeed32);
+    if (success)
+        std::memcpy(pBuffer32, buffer, 32);
+    MemUtil::mem_erase(buffer, 32);
+    return success;
+}
+
+bool KeyTransform::transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32,
+                                const ProgressCallback& fnProgress)
+{
+    if (!fnProgress)
+        return transform256(qwRounds, pBuffer32, pKeySeed32);
+    if (!pBuffer32 || !pKeySeed32)
+        return false;
+
+    // The state between rounds is just the 32-byte buffer, so the rounds can
+    // be split freely. Slices are not made too small: each one expands the
+    // key schedule (and starts a thread with the OpenSSL backend) again.
+    const quint64 qwMinSlice = 50000;
+    const quint64 qwSlice = qMax(qwRounds / 100, qwMinSlice);
+    const Backend backend = activeBackend();
+
+    quint8 buffer[32];
+    std::memcpy(buffer, pBuffer32, 32);
+    bool success = true;
+    for (quint64 qwDone = 0; qwDone < qwRounds; ) {
+        const quint64 qwRun = qMin(qwSlice, qwRounds - qwDone);
+        if (!transform256(qwRun, buffer, pKeySeed32, backend)) {
+            success = false;
+            break;
+        }
+        qwDone += qwRun;
+        if (!fnProgress(qwDone, qwRounds)) {
+            success = false;
+            break;
+        }
+    }
+
+    if (success)
+        std::memcpy(pBuffer32, buffer, 32);
+    MemUtil::mem_erase(buffer, 32);
+    return success;
+}
+
+bool KeyTransform::transform256OpenSsl(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32)
+{
     // Create local copies of the data and key (security pattern from MFC version)
     quint8 buffer[32];
     quint8 key[32];
@@ -100,52 +182,90 @@ bool KeyTransform::transform256(quint64 qwRounds, quint8* pBuffer32, const quint
     return success;
 }
 
-quint64 KeyTransform::benchmark(quint32 dwTimeMs)
+KeyTransform::Calibration KeyTransform::calibrate(Backend backend, quint32 dwTrials, quint32 dwTrialMs)
 {
-    // Benchmark parameters
-    quint8 testBuffer[16] = { 0 };
-    quint8 testKey[32] = { 0 };
+    Calibration result;
+    result.backend = backend;
+    if (!isBackendSupported(backend) || dwTrials == 0 || dwTrialMs == 0)
+        return result;
 
-    // Initialize test data with some non-zero values
-    for (int i = 0; i < 16; ++i)
+    quint8 testBuffer[32];
+    quint8 testKey[32];
+    for (int i = 0; i < 32; ++i) {
         testBuffer[i] = static_cast<quint8>(i);
-    for (int i = 0; i < 32; ++i)
         testKey[i] = static_cast<quint8>(i * 2);
+    }
 
-    // Measure how many rounds we can do in the given time
+    // Warm-up: brings the CPU out of its idle clock and tells how many
+    // rounds fill one trial
+    const quint64 roundsPerCheck = 10000;
     QElapsedTimer timer;
     timer.start();
+    quint64 warmupRounds = 0;
+    while (timer.elapsed() < static_cast<qint64>(dwTrialMs)) {
+        if (!transform256(roundsPerCheck, testBuffer, testKey, backend))
+            return result;
+        warmupRounds += roundsPerCheck;
+    }
+    const double warmupNs = static_cast<double>(qMax<qint64>(timer.nsecsElapsed(), 1));
+    const quint64 roundsPerTrial = qMax<quint64>(
+        roundsPerCheck, static_cast<quint64>(warmupRounds * (dwTrialMs * 1e6) / warmupNs));
 
-    quint64 rounds = 0;
-    const quint64 roundsPerCheck = 10000; // Check time every 10,000 rounds
+    QVector<double> rates;
+    rates.reserve(static_cast<int>(dwTrials));
+    for (quint32 i = 0; i < dwTrials; ++i) {
+        timer.restart();
+        if (!transform256(roundsPerTrial, testBuffer, testKey, backend))
+            return result;
+        const qint64 elapsedNs = qMax<qint64>(timer.nsecsElapsed(), 1);
+        rates.append(static_cast<double>(roundsPerTrial) * 1e9 / static_cast<double>(elapsedNs));
+    }
 
-    // Initialize OpenSSL context once for efficiency
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    if (!ctx)
-        return 0;
+    // Median, and the nearest-rank 5th percentile of the speed (= the
+    // 95th percentile of the trial duration)
+    std::sort(rates.begin(), rates.end());
+    const int n = rates.size();
+    const double median = ((n % 2) != 0) ? rates[n / 2] : (rates[n / 2 - 1] + rates[n / 2]) / 2.0;
+    const int p95Index = qMax(0, static_cast<int>(std::ceil(0.05 * n)) - 1);
 
-    if (EVP_EncryptInit_ex(ctx, EVP_aes_256_ecb(), nullptr, testKey, nullptr) != 1) {
-        EVP_CIPHER_CTX_free(ctx);
+    result.qwMedianRoundsPerSec = static_cast<quint64>(median);
+    result.qwP95RoundsPerSec = static_cast<quint64>(rates[p95Index]);
+    result.dwTrials = dwTrials;
+    return result;
+}
+
+quint32 KeyTransform::roundsForDuration(const Calibration& calibration, quint32 dwTargetMs)
+{
+    if (calibration.qwMedianRoundsPerSec == 0)
         return 0;
-    }
 
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    const double rounds = static_cast<double>(calibration.qwMedianRoundsPerSec) * dwTargetMs / 1000.0;
+    return static_cast<quint32>(std::clamp(rounds, 1.0, static_cast<double>(0xFFFFFFFEU)));
+}
 
-    int outLen = 0;
-    while (timer.elapsed() < static_cast<qint64>(dwTimeMs)) {
-        // Do a batch of rounds
-        for (quint64 i = 0; i < roundsPerCheck; ++i) {
-            if (EVP_EncryptUpdate(ctx, testBuffer, &outLen, testBuffer, 16) != 1) {
-                EVP_CIPHER_CTX_free(ctx);
-                return rounds;
-            }
-        }
-        rounds += roundsPerCheck;
-    }
+double KeyTransform::durationForRounds(const Calibration& calibration, quint64 qwRounds, bool bWorstCase)
+{
+    const quint64 qwRate = bWorstCase ? calibration.qwP95RoundsPerSec : calibration.qwMedianRoundsPerSec;
+    if (qwRate == 0)
+        return 0.0;
+    return static_cast<double>(qwRounds) * 1000.0 / static_cast<double>(qwRate);
+}
 
-    EVP_CIPHER_CTX_free(ctx);
+QString KeyTransform::cpuModelName()
+{
+    static const QString model = [] {
+        const QString brand = cpuBrandString();
+        return brand.isEmpty() ? QSysInfo::currentCpuArchitecture() : brand;
+    }();
+    return model;
+}
 
-    // Return average rounds per thread (divide by 2 for two parallel threads)
-    // This matches the MFC version behavior
-    return rounds / 2;
+quint64 KeyTransform::benchmark(quint32 dwTimeMs)
+{
+    // Ten slices of the time budget: one warm-up and nine timed trials.
+    // Unlike the old single-half loop, this measures transform256 itself,
+    // so the result is the round count of one real transformation.
+    const quint32 dwTrialMs = qMax<quint32>(dwTimeMs / 10, 1);
+    const Calibration calibration = calibrate(activeBackend(), 9, dwTrialMs);
+    return calibration.qwMedianRoundsPerSec * dwTimeMs / 1000;
 }
@@ -13,15 +13,35 @@
 #define KEY_TRANSFORM_H
 
 #include <QtGlobal>
+#include <QString>
 #include <QThread>
+#include <functional>
 #include "../PwStructs.h"
 
-/// Key transformation using AES-256 ECB mode (OpenSSL implementation)
+/// Key transformation using AES-256 ECB mode
 /// This class performs the CPU-intensive key derivation function used by KeePass
 /// to slow down brute-force attacks on the master password.
+/// The backend is chosen at runtime: AES-NI when the CPU supports it,
+/// otherwise OpenSSL. Both produce identical results.
 class KeyTransform
 {
 public:
+    /// Implementations of transform256
+    enum class Backend
+    {
+        OpenSsl,  ///< OpenSSL EVP, one thread per 16-byte half
+        AesNi     ///< AES-NI intrinsics, both halves interleaved in one thread
+    };
+
+    /// @return The fastest backend supported by this CPU
+    static Backend activeBackend();
+
+    /// @return true if the backend can run on this CPU
+    static bool isBackendSupported(Backend backend);
+
+    /// @return Display name of the backend (for benchmarks and diagnostics)
+    static const char* backendName(Backend backend);
+
     /// Transform a 16-byte buffer using qwRounds iterations of AES-256 ECB
     /// @param qwRounds Number of transformation rounds (typically 600,000)
     /// @param pBuffer16 Pointer to 16-byte buffer to transform (input/output)
@@ -29,7 +49,7 @@ public:
     /// @return true on success, false on error
     static bool transform16(quint64 qwRounds, quint8* pBuffer16, const quint8* pKeySeed32);
 
-    /// Transform a 32-byte buffer (splits into two 16-byte halves, processes in parallel)
+    /// Transform a 32-byte buffer (both 16-byte halves, using the active backend)
     /// This is the main key transformation function used by KeePass
     /// @param qwRounds Number of transformation rounds (typically 600,000)
     /// @param pBuffer32 Pointer to 32-byte buffer to transform (input/output)
@@ -37,10 +57,62 @@ public:
     /// @return true on success, false on error
     static bool transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32);
 
+    /// transform256 with an explicit backend (fails if it is not supported)
+    static bool transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32,
+                             Backend backend);
+
+    /// Progress callback: rounds done so far and in total; return false to cancel
+    using ProgressCallback = std::function<bool(quint64 qwDone, quint64 qwTotal)>;
+
+    /// transform256 (active backend) in slices of about 1% of the rounds,
+    /// calling fnProgress after each slice. pBuffer32 is only written when
+    /// all rounds are done.
+    /// @return false on error or if fnProgress canceled the transformation
+    static bool transform256(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32,
+                             const ProgressCallback& fnProgress);
+
+    /// Speed of transform256 on this machine, see calibrate()
+    struct Calibration
+    {
+        Backend backend = Backend::OpenSsl;
+        quint64 qwMedianRoundsPerSec = 0;  ///< Typical speed; 0 if the measurement failed
+        quint64 qwP95RoundsPerSec = 0;     ///< Speed reached in 95% of the trials (slow end)
+        quint32 dwTrials = 0;              ///< Timed trials, warm-up not included
+    };
+
+    /// Measure transform256 with a backend, the way a database is unlocked
+    /// (both halves, all threads of the backend). A warm-up trial sizes the
+    /// round count and is discarded, then dwTrials trials of about dwTrialMs
+    /// each are timed. Taking the median and the slow end of the trials
+    /// keeps frequency scaling and background load out of the result.
+    static Calibration calibrate(Backend backend, quint32 dwTrials = 9, quint32 dwTrialMs = 100);
+
+    /// Rounds that take about dwTargetMs at the median speed of a calibration
+    /// @return Round count in 1..0xFFFFFFFE, 0 if the calibration is empty
+    static quint32 roundsForDuration(const Calibration& calibration, quint32 dwTargetMs);
+
+    /// Expected transformation time of qwRounds rounds, in milliseconds
+    /// @param bWorstCase Use the slow end (p95) instead of the median speed
+    static double durationForRounds(const Calibration& calibration, quint64 qwRounds,
+                                    bool bWorstCase = false);
+
+    /// @return CPU model (x86 brand string, otherwise the architecture name),
+    ///         used to tell calibrations of different machines apart
+    static QString cpuModelName();
+
     /// Benchmark key transformation to determine optimal round count for given time
+    /// (calibrates the active backend within about dwTimeMs)
     /// @param dwTimeMs Target time in milliseconds
     /// @return Number of rounds that can be computed in the given time
     static quint64 benchmark(quint32 dwTimeMs);
+
+private:
+    // Defined in KeyTransform_aesni.cpp
+    static bool transform256AesNi(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32);
+    static bool cpuSupportsAesNi();
+    static QString cpuBrandString();
+
+    static bool transform256OpenSsl(quint64 qwRounds, quint8* pBuffer32, const quint8* pKeySeed32);
 };
 
 /// Private worker thread for parallel key transformation
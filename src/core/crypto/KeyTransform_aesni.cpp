@@ -0,0 +1,120 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+// AES-NI backend of the key transformation. The AES-256 key schedule is
+// expanded once, then both 16-byte halves are encrypted round by round in
+// one thread: the two independent AESENC chains hide each other's latency.
+// The functions are compiled for AES-NI only (target attribute), so the
+// rest of the library does not depend on the instruction set.
+
+#include "KeyTransform.h"
+#include "AesNi.h"
+#include <cstring>
+
+#if defined(AESNI_TARGET)
+
+AESNI_TARGET bool KeyTransform::transform256AesNi(quint64 qwRounds, quint8* pBuffer32,
+                                                  const quint8* pKeySeed32)
+{
+    __m128i k[15];
+    AesNi::expandKey256(pKeySeed32, k);
+
+    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer32));
+    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer32 + 16));
+
+    for (quint64 i = 0; i < qwRounds; ++i) {
+        b0 = _mm_xor_si128(b0, k[0]);
+        b1 = _mm_xor_si128(b1, k[0]);
+        for (int r = 1; r < 14; ++r) {
+            b0 = _mm_aesenc_si128(b0, k[r]);
+            b1 = _mm_aesenc_si128(b1, k[r]);
+        }
+        b0 = _mm_aesenclast_si128(b0, k[14]);
+        b1 = _mm_aesenclast_si128(b1, k[14]);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pBuffer32), b0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pBuffer32 + 16), b1);
+
+    // Erase the key schedule and the register copies of the data
+    const __m128i zero = _mm_setzero_si128();
+    for (__m128i& roundKey : k) {
+        _mm_storeu_si128(&roundKey, zero);
+    }
+    b0 = zero;
+    b1 = zero;
+    return true;
+}
+
+bool KeyTransform::cpuSupportsAesNi()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int aInfo[4] = { 0 };
+    __cpuid(aInfo, 1);
+    const bool bAes = (aInfo[2] & (1 << 25)) != 0;
+    const bool bSse2 = (aInfo[3] & (1 << 26)) != 0;
+    return bAes && bSse2;
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    return ((ecx & bit_AES) != 0) && ((edx & bit_SSE2) != 0);
+#endif
+}
+
+QString KeyTransform::cpuBrandString()
+{
+    // Leaves 0x80000002..0x80000004 hold the 48-byte processor brand string
+    unsigned int aRegs[12] = { 0 };
+#if defined(_MSC_VER) && !defined(__clang__)
+    int aInfo[4] = { 0 };
+    __cpuid(aInfo, 0x80000000);
+    if (static_cast<unsigned int>(aInfo[0]) < 0x80000004U)
+        return QString();
+    for (unsigned int i = 0; i < 3; ++i)
+        __cpuid(reinterpret_cast<int*>(&aRegs[i * 4]), static_cast<int>(0x80000002U + i));
+#else
+    if (__get_cpuid_max(0x80000000U, nullptr) < 0x80000004U)
+        return QString();
+    for (unsigned int i = 0; i < 3; ++i) {
+        __get_cpuid(0x80000002U + i, &aRegs[i * 4], &aRegs[i * 4 + 1], &aRegs[i * 4 + 2],
+                    &aRegs[i * 4 + 3]);
+    }
+#endif
+    char szBrand[49];
+    std::memcpy(szBrand, aRegs, 48);
+    szBrand[48] = '\0';
+    return QString::fromLatin1(szBrand).simplified();
+}
+
+#else // No x86 intrinsics available
+
+bool KeyTransform::transform256AesNi([[maybe_unused]] quint64 qwRounds,
+                                     [[maybe_unused]] quint8* pBuffer32,
+                                     [[maybe_unused]] const quint8* pKeySeed32)
+{
+    return false;
+}
+
+bool KeyTransform::cpuSupportsAesNi()
+{
+    return false;
+}
+
+QString KeyTransform::cpuBrandString()
+{
+    return QString();
+}
+
+#endif
@@ -13,7 +13,10 @@
 #define MEMORY_PROTECTION_H
 
 #include <cstddef>
+#include <new>
+#include <type_traits>
 #include <QtGlobal>
+#include "../platform/SecureArena.h"
 
 /// Cross-platform memory protection utilities
 /// Provides secure memory handling to prevent sensitive data from being
@@ -53,33 +56,30 @@ private:
 };
 
 /// RAII wrapper for secure memory allocation
-/// Automatically locks memory on construction and unlocks/erases on destruction
+/// The zero-filled block comes from the SecureArena, whose pages are locked
+/// and excluded from core dumps; the destructor erases it
 template<typename T>
 class SecureMemory
 {
+    static_assert(std::is_trivially_default_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "SecureMemory holds plain data only");
+
 public:
     explicit SecureMemory(size_t count = 1)
-        : m_data(new T[count])
+        : m_data(static_cast<T*>(SecureArena::allocate(count * sizeof(T))))
         , m_size(count * sizeof(T))
         , m_locked(false)
     {
-        // Lock the memory to prevent swapping
-        m_locked = MemoryProtection::lockMemory(m_data, m_size);
+        if (m_data == nullptr)
+            throw std::bad_alloc();
+        m_locked = SecureArena::isLocked(m_data);
     }
 
     ~SecureMemory()
     {
-        if (m_data) {
-            // Securely erase the data
-            MemoryProtection::secureErase(m_data, m_size);
-
-            // Unlock if it was locked
-            if (m_locked) {
-                MemoryProtection::unlockMemory(m_data, m_size);
-            }
-
-            delete[] m_data;
-        }
+        // Erases the block
+        SecureArena::release(m_data);
     }
 
     // Disable copying
@@ -101,13 +101,7 @@ public:
     {
         if (this != &other) {
             // Clean up existing data
-            if (m_data) {
-                MemoryProtection::secureErase(m_data, m_size);
-                if (m_locked) {
-                    MemoryProtection::unlockMemory(m_data, m_size);
-                }
-                delete[] m_data;
-            }
+            SecureArena::release(m_data);
 
             // Move from other
             m_data = other.m_data;
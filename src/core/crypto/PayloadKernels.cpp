@@ -0,0 +1,79 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "PayloadKernels.h"
+
+namespace PayloadKernels {
+
+qint64 hashThenEncrypt(CipherBackend& cipher, SHA256::Context& hash, quint8* pData,
+                       quint32 uSize, quint32 uTileSize)
+{
+    if (uSize == 0)
+        return 0;
+    if (uTileSize == 0 || (uTileSize % 16) != 0)
+        return -1;
+
+    // All tiles but the last are whole blocks; the last one (never empty)
+    // carries the padding
+    const quint32 uPos = ((uSize - 1) / uTileSize) * uTileSize;
+    if (!hashThenEncryptBlocks(cipher, hash, pData, uPos, uTileSize))
+        return -1;
+
+    hash.update(pData + uPos, uSize - uPos);
+    const qint64 nLast = cipher.padEncrypt(pData + uPos, uSize - uPos, pData + uPos);
+    if (nLast <= 0)
+        return -1;
+    return static_cast<qint64>(uPos) + nLast;
+}
+
+bool hashThenEncryptBlocks(CipherBackend& cipher, SHA256::Context& hash, quint8* pData,
+                           quint32 uSize, quint32 uTileSize)
+{
+    if ((uSize % 16) != 0 || uTileSize == 0 || (uTileSize % 16) != 0)
+        return false;
+
+    for (quint32 uPos = 0; uPos < uSize; ) {
+        const quint32 uTile = qMin(uTileSize, uSize - uPos);
+        hash.update(pData + uPos, uTile);
+        if (!cipher.encryptBlocks(pData + uPos, uTile))
+            return false;
+        uPos += uTile;
+    }
+    return true;
+}
+
+qint64 decryptThenHash(CipherBackend& cipher, SHA256::Context* pHash, quint8* pData,
+                       quint32 uSize, bool bFinal, quint32 uTileSize)
+{
+    if ((uSize % 16) != 0 || uTileSize == 0 || (uTileSize % 16) != 0)
+        return -1;
+
+    quint32 uPos = 0;
+    while ((uSize - uPos) > uTileSize || (!bFinal && uPos < uSize)) {
+        const quint32 uTile = qMin(uTileSize, uSize - uPos);
+        if (!cipher.decryptBlocks(pData + uPos, uTile))
+            return -1;
+        if (pHash != nullptr)
+            pHash->update(pData + uPos, uTile);
+        uPos += uTile;
+    }
+    if (!bFinal)
+        return static_cast<qint64>(uSize);
+
+    const qint32 nLast = cipher.decryptFinal(pData + uPos, uSize - uPos);
+    if (nLast < 0)
+        return -1;
+    if (pHash != nullptr)
+        pHash->update(pData + uPos, static_cast<unsigned long>(nLast));
+    return static_cast<qint64>(uPos) + nLast;
+}
+
+} // namespace PayloadKernels
@@ -0,0 +1,48 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef PAYLOAD_KERNELS_H
+#define PAYLOAD_KERNELS_H
+
+#include <QtGlobal>
+#include "CipherBackend.h"
+#include "SHA256.h"
+
+/// Single-pass hashing and CBC encryption of the database payload.
+/// The payload is processed in tiles small enough to stay in the L2 cache,
+/// so each tile is hashed and encrypted (save) or decrypted and hashed
+/// (open) while it is still hot, instead of streaming the whole buffer
+/// through the cache once per step.
+namespace PayloadKernels {
+    constexpr quint32 DEFAULT_TILE_SIZE = 64 * 1024;  ///< Multiple of the 16-byte block size
+
+    /// Hash uSize plaintext bytes into hash, then encrypt them in place with
+    /// padding. pData needs room for uSize + 16 bytes.
+    /// @return Ciphertext size, 0 for empty input, negative on error
+    qint64 hashThenEncrypt(CipherBackend& cipher, SHA256::Context& hash, quint8* pData,
+                           quint32 uSize, quint32 uTileSize = DEFAULT_TILE_SIZE);
+
+    /// hashThenEncrypt() for a piece in the middle of the payload: uSize
+    /// (whole blocks) is hashed and encrypted in place without padding, the
+    /// chaining value carries over to the next call
+    bool hashThenEncryptBlocks(CipherBackend& cipher, SHA256::Context& hash, quint8* pData,
+                               quint32 uSize, quint32 uTileSize = DEFAULT_TILE_SIZE);
+
+    /// Decrypt uSize bytes (whole blocks) in place and hash the plaintext
+    /// (pHash may be nullptr). With bFinal, the data ends the payload and
+    /// its padding is checked and removed; a piece with bad padding is not
+    /// hashed.
+    /// @return Plaintext size, negative on error or bad padding
+    qint64 decryptThenHash(CipherBackend& cipher, SHA256::Context* pHash, quint8* pData,
+                           quint32 uSize, bool bFinal, quint32 uTileSize = DEFAULT_TILE_SIZE);
+}
+
+#endif // PAYLOAD_KERNELS_H
@@ -0,0 +1,196 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "ProtectedStringCipher.h"
+#include "KeyTransform.h"
+#include "../util/MemUtil.h"
+#include <openssl/evp.h>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    // Counter blocks encrypted per call of encryptBlocks (1 KB of keystream)
+    constexpr quint32 STAGE_BLOCKS = 64;
+
+    // Counter block uIndex of a string: its nonce plus uIndex, 128-bit big-endian
+    void makeCounterBlock(const quint8* pNonce16, quint64 uIndex, quint8* pBlock16)
+    {
+        const quint64 uHigh = qFromBigEndian<quint64>(pNonce16);
+        const quint64 uLow = qFromBigEndian<quint64>(pNonce16 + 8);
+        const quint64 uSum = uLow + uIndex;
+        qToBigEndian<quint64>(uHigh + ((uSum < uLow) ? 1 : 0), pBlock16);
+        qToBigEndian<quint64>(uSum, pBlock16 + 8);
+    }
+
+    void xorBytes(quint8* pData, const quint8* pStream, quint32 uSize)
+    {
+        for (quint32 i = 0; i < uSize; ++i) {
+            pData[i] ^= pStream[i];
+        }
+    }
+}
+
+ProtectedStringCipher::ProtectedStringCipher()
+    : ProtectedStringCipher(activeBackend())
+{
+}
+
+ProtectedStringCipher::ProtectedStringCipher(Backend backend)
+    : m_backend(isBackendSupported(backend) ? backend : Backend::OpenSsl)
+    , m_pEvpCtx(nullptr)
+    , m_bKeySet(false)
+{
+    std::memset(m_aRoundKeys, 0, sizeof(m_aRoundKeys));
+}
+
+ProtectedStringCipher::~ProtectedStringCipher()
+{
+    MemUtil::mem_erase(m_aRoundKeys, sizeof(m_aRoundKeys));
+    EVP_CIPHER_CTX_free(static_cast<EVP_CIPHER_CTX*>(m_pEvpCtx));
+}
+
+void ProtectedStringCipher::swap(ProtectedStringCipher& other) noexcept
+{
+    std::swap(m_backend, other.m_backend);
+    std::swap_ranges(m_aRoundKeys, m_aRoundKeys + sizeof(m_aRoundKeys), other.m_aRoundKeys);
+    std::swap(m_pEvpCtx, other.m_pEvpCtx);
+    std::swap(m_bKeySet, other.m_bKeySet);
+}
+
+bool ProtectedStringCipher::setKey(const quint8* pKey32)
+{
+    m_bKeySet = false;
+    if (pKey32 == nullptr)
+        return false;
+
+    if (m_backend == Backend::AesNi) {
+        expandKeyAesNi(pKey32, m_aRoundKeys);
+        m_bKeySet = true;
+        return true;
+    }
+
+    if (m_pEvpCtx == nullptr)
+        m_pEvpCtx = EVP_CIPHER_CTX_new();
+    EVP_CIPHER_CTX* pCtx = static_cast<EVP_CIPHER_CTX*>(m_pEvpCtx);
+    if (pCtx == nullptr || EVP_EncryptInit_ex(pCtx, EVP_aes_256_ecb(), nullptr, pKey32, nullptr) != 1)
+        return false;
+    EVP_CIPHER_CTX_set_padding(pCtx, 0);
+    m_bKeySet = true;
+    return true;
+}
+
+bool ProtectedStringCipher::crypt(const quint8* pNonce16, quint8* pData, quint32 uSize) const
+{
+    const Item item{ pNonce16, pData, uSize };
+    return cryptMany(&item, 1);
+}
+
+bool ProtectedStringCipher::cryptMany(const Item* pItems, int nCount) const
+{
+    Q_ASSERT(m_bKeySet);
+    if (!m_bKeySet)
+        return false;
+    if (pItems == nullptr || nCount <= 0)
+        return true;
+
+    if (m_backend == Backend::AesNi) {
+        cryptManyAesNi(m_aRoundKeys, pItems, nCount);
+        return true;
+    }
+
+    // The counter blocks of consecutive strings are staged together and
+    // encrypted in one call; a string may span several stages
+    struct Span
+    {
+        quint8* pData;
+        quint32 uSize;
+        quint32 uStreamPos;
+    };
+    alignas(16) quint8 aStream[STAGE_BLOCKS * 16];
+    Span aSpans[STAGE_BLOCKS];
+    quint32 uStaged = 0;
+    quint32 nSpans = 0;
+    quint32 uStreamUsed = 0;  // Blocks of aStream to erase at the end
+    bool bSuccess = true;
+
+    // Spans whose keystream could not be generated are left unchanged
+    auto flush = [&]() {
+        if (encryptBlocksOpenSsl(aStream, uStaged)) {
+            for (quint32 i = 0; i < nSpans; ++i) {
+                xorBytes(aSpans[i].pData, aStream + aSpans[i].uStreamPos, aSpans[i].uSize);
+            }
+        } else {
+            bSuccess = false;
+        }
+        uStreamUsed = qMax(uStreamUsed, uStaged);
+        uStaged = 0;
+        nSpans = 0;
+    };
+
+    for (int i = 0; i < nCount; ++i) {
+        const Item& item = pItems[i];
+        quint32 uDone = 0;
+        quint64 uBlockIndex = 0;
+
+        while (uDone < item.uSize) {
+            if (uStaged == STAGE_BLOCKS)
+                flush();
+
+            const quint32 uRest = item.uSize - uDone;
+            const quint32 uBlocks = qMin((uRest + 15) / 16, STAGE_BLOCKS - uStaged);
+            for (quint32 b = 0; b < uBlocks; ++b) {
+                makeCounterBlock(item.pNonce16, uBlockIndex++, aStream + ((uStaged + b) * 16));
+            }
+
+            const quint32 uBytes = qMin(uRest, uBlocks * 16);
+            aSpans[nSpans++] = Span{ item.pData + uDone, uBytes, uStaged * 16 };
+            uStaged += uBlocks;
+            uDone += uBytes;
+        }
+    }
+
+    if (uStaged != 0)
+        flush();
+    MemUtil::mem_erase(aStream, uStreamUsed * 16);
+    return bSuccess;
+}
+
+bool ProtectedStringCipher::encryptBlocksOpenSsl(quint8* pBlocks, quint32 uBlocks) const
+{
+    // EVP contexts are not thread-safe, so every call works on its own copy
+    EVP_CIPHER_CTX* pCtx = EVP_CIPHER_CTX_new();
+    int nOut = 0;
+    const bool bOk = (pCtx != nullptr) &&
+        (EVP_CIPHER_CTX_copy(pCtx, static_cast<EVP_CIPHER_CTX*>(m_pEvpCtx)) == 1) &&
+        (EVP_EncryptUpdate(pCtx, pBlocks, &nOut, pBlocks, static_cast<int>(uBlocks * 16)) == 1);
+    EVP_CIPHER_CTX_free(pCtx);
+    return bOk && (nOut == static_cast<int>(uBlocks * 16));
+}
+
+ProtectedStringCipher::Backend ProtectedStringCipher::activeBackend()
+{
+    static const Backend backend = isBackendSupported(Backend::AesNi) ? Backend::AesNi : Backend::OpenSsl;
+    return backend;
+}
+
+bool ProtectedStringCipher::isBackendSupported(Backend backend)
+{
+    if (backend == Backend::AesNi)
+        return KeyTransform::isBackendSupported(KeyTransform::Backend::AesNi);
+    return true;
+}
+
+const char* ProtectedStringCipher::backendName(Backend backend)
+{
+    return (backend == Backend::AesNi) ? "AES-NI" : "OpenSSL";
+}
@@ -0,0 +1,124 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef PROTECTED_STRING_CIPHER_H
+#define PROTECTED_STRING_CIPHER_H
+
+#include <QtGlobal>
+
+/// AES-256 in CTR mode for the strings kept encrypted in memory (the entry
+/// passwords). Every string has its own 16-byte nonce, the initial counter
+/// block; block i of its keystream is AES(key, nonce + i), with the nonce
+/// read as a 128-bit big-endian number like OpenSSL's EVP_aes_256_ctr.
+/// Encryption and decryption are the same operation.
+///
+/// Keystream is only generated for the bytes being processed, in 16-byte
+/// blocks. cryptMany() fills the AES pipeline with the blocks of many short
+/// strings at once. All crypt functions may run on several threads at once.
+class ProtectedStringCipher
+{
+public:
+    enum class Backend
+    {
+        OpenSsl,  ///< OpenSSL EVP (AES-256-ECB over the counter blocks)
+        AesNi     ///< AES-NI intrinsics, eight blocks interleaved
+    };
+
+    /// One string for cryptMany
+    struct Item
+    {
+        const quint8* pNonce16;
+        quint8* pData;
+        quint32 uSize;
+    };
+
+    /// Collects items and passes them to cryptMany() in groups, so that
+    /// callers can add strings one by one. Remaining items are processed by
+    /// flush() or the destructor; pData must stay valid until then.
+    class Batch
+    {
+    public:
+        explicit Batch(const ProtectedStringCipher& cipher) : m_cipher(cipher), m_nItems(0), m_bSuccess(true) {}
+        ~Batch() { flush(); }
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        void add(const quint8* pNonce16, quint8* pData, quint32 uSize)
+        {
+            if (uSize == 0)
+                return;
+            if (m_nItems == BATCH_SIZE)
+                flush();
+            m_aItems[m_nItems++] = Item{ pNonce16, pData, uSize };
+        }
+
+        /// @return false if any string added so far was left unchanged
+        bool flush()
+        {
+            if (!m_cipher.cryptMany(m_aItems, m_nItems))
+                m_bSuccess = false;
+            m_nItems = 0;
+            return m_bSuccess;
+        }
+
+    private:
+        static constexpr int BATCH_SIZE = 64;
+
+        const ProtectedStringCipher& m_cipher;
+        Item m_aItems[BATCH_SIZE];
+        int m_nItems;
+        bool m_bSuccess;
+    };
+
+    /// Uses the active backend; setKey() must be called before any crypt
+    ProtectedStringCipher();
+    explicit ProtectedStringCipher(Backend backend);
+    ~ProtectedStringCipher();
+
+    ProtectedStringCipher(const ProtectedStringCipher&) = delete;
+    ProtectedStringCipher& operator=(const ProtectedStringCipher&) = delete;
+
+    /// Set the 32-byte key; the caller may erase pKey32 afterwards
+    bool setKey(const quint8* pKey32);
+
+    /// XOR uSize bytes at pData with the keystream of pNonce16
+    /// @return false (data unchanged) if no key is set or the backend failed
+    bool crypt(const quint8* pNonce16, quint8* pData, quint32 uSize) const;
+
+    /// crypt() for nCount independent strings
+    bool cryptMany(const Item* pItems, int nCount) const;
+
+    [[nodiscard]] Backend backend() const { return m_backend; }
+
+    /// Exchange backend and key with another cipher
+    void swap(ProtectedStringCipher& other) noexcept;
+
+    /// @return The fastest backend supported by this CPU
+    static Backend activeBackend();
+    static bool isBackendSupported(Backend backend);
+    static const char* backendName(Backend backend);
+
+private:
+    // OpenSsl: encrypt uBlocks counter blocks in place (ECB)
+    bool encryptBlocksOpenSsl(quint8* pBlocks, quint32 uBlocks) const;
+
+    // Defined in ProtectedStringCipher_aesni.cpp
+    static void expandKeyAesNi(const quint8* pKey32, quint8* pRoundKeys240);
+    static void cryptManyAesNi(const quint8* pRoundKeys240, const Item* pItems, int nCount);
+
+    Backend m_backend;
+    alignas(16) quint8 m_aRoundKeys[15 * 16];  // AesNi
+    void* m_pEvpCtx;                            // OpenSsl (EVP_CIPHER_CTX, copied per call)
+    bool m_bKeySet;
+};
+
+#endif // PROTECTED_STRING_CIPHER_H
@@ -0,0 +1,135 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+// AES-NI backend of ProtectedStringCipher. The counter blocks of the strings
+// are collected eight at a time and encrypted round by round, so that the
+// independent AESENC chains keep the AES unit busy even though a password
+// only needs one or two blocks. The keystream stays in registers and is
+// XORed straight into the strings.
+
+#include "ProtectedStringCipher.h"
+#include "AesNi.h"
+#include "../util/MemUtil.h"
+#include <QtEndian>
+#include <cstring>
+
+#if defined(AESNI_TARGET)
+
+// GCC keeps the eight blocks in registers only if the lane loops are unrolled
+#if defined(__GNUC__) && !defined(__clang__)
+#define PSC_UNROLL_LANES _Pragma("GCC unroll 8")
+#else
+#define PSC_UNROLL_LANES
+#endif
+
+namespace {
+    struct PendingBlocks
+    {
+        __m128i aCounters[8];
+        quint8* apData[8];
+        quint32 auSize[8];  // 1 to 16
+        int nCount;
+    };
+
+    // Encrypt the pending counter blocks and XOR the keystream into their strings
+    AESNI_TARGET void cryptPending(const __m128i* k, PendingBlocks& pending, quint8* pScratch16)
+    {
+        __m128i b[8];
+        PSC_UNROLL_LANES
+        for (int j = 0; j < 8; ++j) {
+            b[j] = _mm_xor_si128(pending.aCounters[j], k[0]);
+        }
+        for (int r = 1; r < 14; ++r) {
+            PSC_UNROLL_LANES
+            for (int j = 0; j < 8; ++j) {
+                b[j] = _mm_aesenc_si128(b[j], k[r]);
+            }
+        }
+        PSC_UNROLL_LANES
+        for (int j = 0; j < 8; ++j) {
+            b[j] = _mm_aesenclast_si128(b[j], k[14]);
+        }
+
+        for (int j = 0; j < pending.nCount; ++j) {
+            quint8* pData = pending.apData[j];
+            if (pending.auSize[j] == 16) {
+                __m128i* pBlock = reinterpret_cast<__m128i*>(pData);
+                _mm_storeu_si128(pBlock, _mm_xor_si128(_mm_loadu_si128(pBlock), b[j]));
+            } else {
+                // Last block of a string: never touch the bytes behind it
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pScratch16), b[j]);
+                for (quint32 i = 0; i < pending.auSize[j]; ++i) {
+                    pData[i] ^= pScratch16[i];
+                }
+            }
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        for (__m128i& block : b) {
+            block = zero;
+        }
+        pending.nCount = 0;
+    }
+}
+
+AESNI_TARGET void ProtectedStringCipher::expandKeyAesNi(const quint8* pKey32, quint8* pRoundKeys240)
+{
+    AesNi::expandKey256(pKey32, reinterpret_cast<__m128i*>(pRoundKeys240));
+}
+
+AESNI_TARGET void ProtectedStringCipher::cryptManyAesNi(const quint8* pRoundKeys240, const Item* pItems,
+                                                        int nCount)
+{
+    const __m128i* k = reinterpret_cast<const __m128i*>(pRoundKeys240);
+    PendingBlocks pending;
+    pending.nCount = 0;
+    quint8 aScratch[16];
+
+    for (int i = 0; i < nCount; ++i) {
+        const Item& item = pItems[i];
+        const quint64 uHigh = qFromBigEndian<quint64>(item.pNonce16);
+        const quint64 uLow = qFromBigEndian<quint64>(item.pNonce16 + 8);
+
+        quint64 uBlockIndex = 0;
+        for (quint32 uDone = 0; uDone < item.uSize; uDone += 16) {
+            // Counter block: nonce + block index, 128-bit big-endian
+            const quint64 uSum = uLow + uBlockIndex++;
+            const quint64 uCarry = (uSum < uLow) ? 1 : 0;
+            pending.aCounters[pending.nCount] = _mm_set_epi64x(
+                static_cast<qint64>(qToBigEndian<quint64>(uSum)),
+                static_cast<qint64>(qToBigEndian<quint64>(uHigh + uCarry)));
+            pending.apData[pending.nCount] = item.pData + uDone;
+            pending.auSize[pending.nCount] = qMin<quint32>(16, item.uSize - uDone);
+
+            if (++pending.nCount == 8)
+                cryptPending(k, pending, aScratch);
+        }
+    }
+
+    if (pending.nCount != 0)
+        cryptPending(k, pending, aScratch);
+    MemUtil::mem_erase(aScratch, sizeof(aScratch));
+}
+
+#else // No x86 intrinsics available
+
+void ProtectedStringCipher::expandKeyAesNi([[maybe_unused]] const quint8* pKey32,
+                                           [[maybe_unused]] quint8* pRoundKeys240)
+{
+}
+
+void ProtectedStringCipher::cryptManyAesNi([[maybe_unused]] const quint8* pRoundKeys240,
+                                           [[maybe_unused]] const Item* pItems,
+                                           [[maybe_unused]] int nCount)
+{
+}
+
+#endif
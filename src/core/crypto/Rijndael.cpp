@@ -1297,6 +1297,12 @@ int CRijndael::PadDecrypt(const UINT8 *input, int inputOctets, UINT8 *outBuffer)
 	return (16 * numBlocks) - padLen;
 }
 
+void CRijndael::SetInitVector(const UINT8 *initVector)
+{
+	if(initVector != NULL) memcpy(m_initVector, initVector, RD_MAX_IV_SIZE);
+	else memset(m_initVector, 0, RD_MAX_IV_SIZE);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ALGORITHM
 //////////////////////////////////////////////////////////////////////////////
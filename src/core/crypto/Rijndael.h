@@ -149,6 +149,11 @@ public:
 	// Returns the decrypted buffer length in BYTES and an error code < 0 in case of error
 	int PadDecrypt(const UINT8 *input, int inputOctets, UINT8 *outBuffer);
 
+	// Replaces the init vector without redoing the key schedule
+	// To continue a CBC stream that is processed in pieces, pass the last
+	// ciphertext block of the previous piece
+	void SetInitVector(const UINT8 *initVector);
+
 protected:
 	void KeySched(UINT8 key[RD_MAX_KEY_COLUMNS][4]);
 	void KeyEncToDec();
@@ -10,5 +10,321 @@
 */
 
 #include "SHA256.h"
+#include "../util/MemUtil.h"
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
-// Implementation is header-only, this file exists for build system compatibility
+namespace {
+    // FIPS 180-4 initial hash value
+    const quint32 SHA256_INITIAL_STATE[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    void storeBigEndian32(quint8* p, quint32 v)
+    {
+        p[0] = static_cast<quint8>(v >> 24);
+        p[1] = static_cast<quint8>(v >> 16);
+        p[2] = static_cast<quint8>(v >> 8);
+        p[3] = static_cast<quint8>(v);
+    }
+
+    void storeBigEndian64(quint8* p, quint64 v)
+    {
+        storeBigEndian32(p, static_cast<quint32>(v >> 32));
+        storeBigEndian32(p + 4, static_cast<quint32>(v));
+    }
+
+    // Writes the padded tail of a message of qwLength bytes into pTail128:
+    // the uRest (< 64) bytes after its last whole block, 0x80, zeros and
+    // the bit length
+    // @return Number of tail blocks (1 or 2)
+    quint32 buildPaddedTail(const quint8* pRest, quint32 uRest, quint64 qwLength, quint8* pTail128)
+    {
+        std::memset(pTail128, 0, 128);
+        if (uRest != 0)
+            std::memcpy(pTail128, pRest, uRest);
+        pTail128[uRest] = 0x80;
+
+        const quint32 uTailBlocks = (uRest + 9 > 64) ? 2 : 1;
+        storeBigEndian64(pTail128 + (uTailBlocks * 64) - 8, qwLength * 8);
+        return uTailBlocks;
+    }
+}
+
+SHA256::Backend SHA256::activeBackend()
+{
+    static const Backend backend = isBackendSupported(Backend::ShaNi) ? Backend::ShaNi : Backend::OpenSsl;
+    return backend;
+}
+
+bool SHA256::isBackendSupported(Backend backend)
+{
+    if (backend == Backend::ShaNi) {
+        static const bool bShaNi = cpuSupportsShaNi();
+        return bShaNi;
+    }
+    return true;
+}
+
+const char* SHA256::backendName(Backend backend)
+{
+    switch (backend) {
+    case Backend::Portable:
+        return "Portable";
+    case Backend::OpenSsl:
+        return "OpenSSL";
+    case Backend::ShaNi:
+        return "SHA-NI";
+    }
+    return "Unknown";
+}
+
+SHA256::BatchMode SHA256::activeBatchMode()
+{
+    // SHA-NI hashes a single stream faster than eight AVX2 lanes together
+    if (activeBackend() == Backend::ShaNi || !isBatchModeSupported(BatchMode::Avx2x8))
+        return BatchMode::Sequential;
+    return BatchMode::Avx2x8;
+}
+
+bool SHA256::isBatchModeSupported(BatchMode mode)
+{
+    if (mode == BatchMode::Avx2x8) {
+        static const bool bAvx2 = cpuSupportsAvx2();
+        return bAvx2;
+    }
+    return true;
+}
+
+QByteArray SHA256::hash(const QByteArray& data)
+{
+    QByteArray result(32, 0);
+    hash(reinterpret_cast<const unsigned char*>(data.constData()),
+         static_cast<unsigned long>(data.size()),
+         reinterpret_cast<unsigned char*>(result.data()));
+    return result;
+}
+
+void SHA256::hash(const unsigned char* input, unsigned long length, unsigned char* output)
+{
+    hash(input, length, output, activeBackend());
+}
+
+void SHA256::hash(const unsigned char* input, unsigned long length, unsigned char* output,
+                  Backend backend)
+{
+    Context ctx(backend);
+    ctx.update(input, length);
+    ctx.finalize(output);
+}
+
+void SHA256::hashMany(const unsigned char* const* ppInputs, const unsigned long* pLengths,
+                      int nCount, unsigned char* pOutputs)
+{
+    hashMany(ppInputs, pLengths, nCount, pOutputs, activeBatchMode());
+}
+
+void SHA256::hashMany(const unsigned char* const* ppInputs, const unsigned long* pLengths,
+                      int nCount, unsigned char* pOutputs, BatchMode mode)
+{
+    if (nCount <= 0)
+        return;
+
+    if (mode == BatchMode::Sequential || !isBatchModeSupported(mode)) {
+        for (int i = 0; i < nCount; ++i) {
+            hash(ppInputs[i], pLengths[i], pOutputs + (32 * i));
+        }
+        return;
+    }
+
+    // Longest messages first, so that the eight messages of a group have
+    // similar lengths and few lanes idle while the longest one finishes
+    QVector<int> vOrder(nCount);
+    std::iota(vOrder.begin(), vOrder.end(), 0);
+    std::stable_sort(vOrder.begin(), vOrder.end(), [pLengths](int a, int b) {
+        return pLengths[a] > pLengths[b];
+    });
+
+    struct Lane
+    {
+        const quint8* pData;
+        quint64 qwFullBlocks;
+        quint64 qwBlocks;
+        quint8 aTail[128];
+    };
+
+    static const quint8 aIdleBlock[64] = { 0 };
+    Lane aLanes[8];
+    quint32 aStates[64];  // Word w of lane j at index 8 * w + j
+
+    for (int nFirst = 0; nFirst < nCount; nFirst += 8) {
+        const int nLanes = qMin(8, nCount - nFirst);
+
+        for (int j = 0; j < nLanes; ++j) {
+            const int i = vOrder[nFirst + j];
+            Lane& lane = aLanes[j];
+            lane.pData = ppInputs[i];
+            lane.qwFullBlocks = pLengths[i] / 64;
+            lane.qwBlocks = lane.qwFullBlocks +
+                buildPaddedTail(lane.pData + (64 * lane.qwFullBlocks), static_cast<quint32>(pLengths[i] % 64),
+                                pLengths[i], lane.aTail);
+        }
+        for (int w = 0; w < 8; ++w) {
+            for (int j = 0; j < 8; ++j) {
+                aStates[(8 * w) + j] = SHA256_INITIAL_STATE[w];
+            }
+        }
+
+        const quint64 qwMaxBlocks = aLanes[0].qwBlocks;
+        for (quint64 b = 0; b < qwMaxBlocks; ++b) {
+            const quint8* apBlocks[8];
+            quint32 uActiveMask = 0;
+            for (int j = 0; j < 8; ++j) {
+                apBlocks[j] = aIdleBlock;
+                if (j >= nLanes || b >= aLanes[j].qwBlocks)
+                    continue;
+
+                const Lane& lane = aLanes[j];
+                apBlocks[j] = (b < lane.qwFullBlocks) ? lane.pData + (64 * b)
+                                                      : lane.aTail + (64 * (b - lane.qwFullBlocks));
+                uActiveMask |= (1U << j);
+            }
+            compressAvx2x8(aStates, apBlocks, uActiveMask);
+        }
+
+        for (int j = 0; j < nLanes; ++j) {
+            unsigned char* pOut = pOutputs + (32 * vOrder[nFirst + j]);
+            for (int w = 0; w < 8; ++w) {
+                storeBigEndian32(pOut + (4 * w), aStates[(8 * w) + j]);
+            }
+            MemUtil::mem_erase(aLanes[j].aTail, sizeof(aLanes[j].aTail));
+        }
+    }
+
+    MemUtil::mem_erase(aStates, sizeof(aStates));
+}
+
+QVector<QByteArray> SHA256::hashMany(const QVector<QByteArray>& vInputs)
+{
+    const int nCount = vInputs.size();
+    QVector<const unsigned char*> vPointers(nCount);
+    QVector<unsigned long> vLengths(nCount);
+    for (int i = 0; i < nCount; ++i) {
+        vPointers[i] = reinterpret_cast<const unsigned char*>(vInputs[i].constData());
+        vLengths[i] = static_cast<unsigned long>(vInputs[i].size());
+    }
+
+    QByteArray digests(32 * nCount, 0);
+    hashMany(vPointers.constData(), vLengths.constData(), nCount,
+             reinterpret_cast<unsigned char*>(digests.data()));
+
+    QVector<QByteArray> vResult;
+    vResult.reserve(nCount);
+    for (int i = 0; i < nCount; ++i) {
+        vResult.append(digests.mid(32 * i, 32));
+    }
+    return vResult;
+}
+
+SHA256::Context::Context()
+    : Context(SHA256::activeBackend())
+{
+}
+
+SHA256::Context::Context(Backend backend)
+    : m_backend(SHA256::isBackendSupported(backend) ? backend : Backend::Portable)
+    , m_pEvpCtx(nullptr)
+    , m_uBlockUsed(0)
+    , m_qwLength(0)
+{
+    sha256_begin(&m_ctx);
+    std::memcpy(m_aState, SHA256_INITIAL_STATE, sizeof(m_aState));
+    std::memset(m_aBlock, 0, sizeof(m_aBlock));
+
+    if (m_backend == Backend::OpenSsl) {
+        EVP_MD_CTX* pEvp = EVP_MD_CTX_new();
+        if (pEvp != nullptr && EVP_DigestInit_ex(pEvp, EVP_sha256(), nullptr) == 1) {
+            m_pEvpCtx = pEvp;
+        } else {
+            EVP_MD_CTX_free(pEvp);
+            m_backend = Backend::Portable;
+        }
+    }
+}
+
+SHA256::Context::~Context()
+{
+    if (m_pEvpCtx != nullptr)
+        EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(m_pEvpCtx));  // Also erases its state
+
+    MemUtil::mem_erase(&m_ctx, sizeof(m_ctx));
+    MemUtil::mem_erase(m_aState, sizeof(m_aState));
+    MemUtil::mem_erase(m_aBlock, sizeof(m_aBlock));
+}
+
+void SHA256::Context::update(const unsigned char* data, unsigned long length)
+{
+    if (length == 0)
+        return;
+
+    if (m_backend == Backend::Portable) {
+        sha256_hash(data, length, &m_ctx);
+        return;
+    }
+    if (m_backend == Backend::OpenSsl) {
+        EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(m_pEvpCtx), data, length);
+        return;
+    }
+
+    m_qwLength += length;
+
+    // Complete a partial block first
+    if (m_uBlockUsed != 0) {
+        const quint32 uTake = static_cast<quint32>(qMin<unsigned long>(64 - m_uBlockUsed, length));
+        std::memcpy(m_aBlock + m_uBlockUsed, data, uTake);
+        m_uBlockUsed += uTake;
+        data += uTake;
+        length -= uTake;
+        if (m_uBlockUsed < 64)
+            return;
+        compressShaNi(m_aState, m_aBlock, 1);
+        m_uBlockUsed = 0;
+    }
+
+    // Whole blocks straight from the input
+    const size_t uBlocks = length / 64;
+    if (uBlocks != 0) {
+        compressShaNi(m_aState, data, uBlocks);
+        data += uBlocks * 64;
+        length -= static_cast<unsigned long>(uBlocks * 64);
+    }
+
+    if (length != 0) {
+        std::memcpy(m_aBlock, data, length);
+        m_uBlockUsed = static_cast<quint32>(length);
+    }
+}
+
+void SHA256::Context::finalize(unsigned char* output)
+{
+    if (m_backend == Backend::Portable) {
+        sha256_end(output, &m_ctx);
+        return;
+    }
+    if (m_backend == Backend::OpenSsl) {
+        EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(m_pEvpCtx), output, nullptr);
+        return;
+    }
+
+    quint8 aTail[128];
+    const quint32 uTailBlocks = buildPaddedTail(m_aBlock, m_uBlockUsed, m_qwLength, aTail);
+    compressShaNi(m_aState, aTail, uTailBlocks);
+    MemUtil::mem_erase(aTail, sizeof(aTail));
+
+    for (int w = 0; w < 8; ++w) {
+        storeBigEndian32(output + (4 * w), m_aState[w]);
+    }
+}
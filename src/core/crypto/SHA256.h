@@ -13,62 +13,102 @@
 #define SHA256_H
 
 #include <QByteArray>
+#include <QVector>
 #include "SHA2/SHA2.h"
 
 /// Qt-friendly wrapper for SHA-256 hashing
-/// Wraps the original SHA2 implementation from MFC version
+/// The implementation is chosen at runtime: SHA-NI when the CPU supports it,
+/// otherwise OpenSSL. The original SHA2 code from the MFC version is kept as
+/// the portable reference. All backends produce identical digests.
 class SHA256
 {
 public:
-    /// Hash data and return 32-byte SHA-256 digest
-    static QByteArray hash(const QByteArray& data)
+    /// Implementations of a single hash stream
+    enum class Backend
     {
-        QByteArray result(32, 0);
-        sha256_ctx ctx;
-        sha256_begin(&ctx);
-        sha256_hash(reinterpret_cast<const unsigned char*>(data.constData()),
-                    static_cast<unsigned long>(data.size()), &ctx);
-        sha256_end(reinterpret_cast<unsigned char*>(result.data()), &ctx);
-        return result;
-    }
+        Portable,  ///< SHA2.cpp (Brian Gladman), the MFC version's code
+        OpenSsl,   ///< OpenSSL EVP
+        ShaNi      ///< SHA-NI intrinsics
+    };
 
-    /// Hash raw bytes and return 32-byte SHA-256 digest
-    static void hash(const unsigned char* input, unsigned long length, unsigned char* output)
+    /// How hashMany processes its messages
+    enum class BatchMode
     {
-        sha256_ctx ctx;
-        sha256_begin(&ctx);
-        sha256_hash(input, length, &ctx);
-        sha256_end(output, &ctx);
-    }
+        Sequential,  ///< One message after the other with the active backend
+        Avx2x8       ///< Eight messages at once, one per 32-bit lane of the AVX2 registers
+    };
+
+    /// @return The fastest backend supported by this CPU
+    static Backend activeBackend();
+    static bool isBackendSupported(Backend backend);
+    static const char* backendName(Backend backend);
+
+    /// @return The fastest batch mode for this CPU (Avx2x8 only without SHA-NI)
+    static BatchMode activeBatchMode();
+    static bool isBatchModeSupported(BatchMode mode);
+
+    /// Hash data and return 32-byte SHA-256 digest
+    static QByteArray hash(const QByteArray& data);
+
+    /// Hash raw bytes and return 32-byte SHA-256 digest
+    static void hash(const unsigned char* input, unsigned long length, unsigned char* output);
+
+    /// hash with an explicit backend (falls back to Portable if it is not supported)
+    static void hash(const unsigned char* input, unsigned long length, unsigned char* output,
+                     Backend backend);
+
+    /// Hash nCount independent messages; the digest of message i is written
+    /// to pOutputs + 32 * i. Meant for batch callers (attachment comparisons,
+    /// integrity checks) with many small to medium messages.
+    static void hashMany(const unsigned char* const* ppInputs, const unsigned long* pLengths,
+                         int nCount, unsigned char* pOutputs);
+    static void hashMany(const unsigned char* const* ppInputs, const unsigned long* pLengths,
+                         int nCount, unsigned char* pOutputs, BatchMode mode);
+    static QVector<QByteArray> hashMany(const QVector<QByteArray>& vInputs);
 
     /// Create a hash context for incremental hashing
     class Context
     {
     public:
-        Context() { sha256_begin(&m_ctx); }
+        Context();
+        explicit Context(Backend backend);
+        ~Context();
+
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
 
         void update(const QByteArray& data) {
-            sha256_hash(reinterpret_cast<const unsigned char*>(data.constData()),
-                       static_cast<unsigned long>(data.size()), &m_ctx);
+            update(reinterpret_cast<const unsigned char*>(data.constData()),
+                   static_cast<unsigned long>(data.size()));
         }
 
-        void update(const unsigned char* data, unsigned long length) {
-            sha256_hash(data, length, &m_ctx);
-        }
+        void update(const unsigned char* data, unsigned long length);
 
         QByteArray finalize() {
             QByteArray result(32, 0);
-            sha256_end(reinterpret_cast<unsigned char*>(result.data()), &m_ctx);
+            finalize(reinterpret_cast<unsigned char*>(result.data()));
             return result;
         }
 
-        void finalize(unsigned char* output) {
-            sha256_end(output, &m_ctx);
-        }
+        void finalize(unsigned char* output);
 
     private:
-        sha256_ctx m_ctx;
+        Backend m_backend;
+        sha256_ctx m_ctx;          // Portable
+        void* m_pEvpCtx;           // OpenSsl (EVP_MD_CTX)
+        // ShaNi: chaining state and the partial block
+        quint32 m_aState[8];
+        quint8 m_aBlock[64];
+        quint32 m_uBlockUsed;
+        quint64 m_qwLength;
     };
+
+private:
+    // Defined in SHA256_x86.cpp
+    static bool cpuSupportsShaNi();
+    static bool cpuSupportsAvx2();
+    static void compressShaNi(quint32* pState, const quint8* pBlocks, size_t uBlocks);
+    static void compressAvx2x8(quint32* pStates, const quint8* const* ppBlocks, quint32 uActiveMask);
 };
 
 #endif // SHA256_H
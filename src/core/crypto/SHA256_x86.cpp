@@ -0,0 +1,274 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+// x86 backends of SHA256: the SHA-NI compression function for single
+// streams and an AVX2 compression function that runs eight independent
+// messages in the eight 32-bit lanes of the vector registers. Each function
+// is compiled for its instruction set only (target attribute), so the rest
+// of the library does not depend on it; SHA256 checks the CPU first.
+
+#include "SHA256.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SHA_HAVE_X86 1
+#endif
+
+#if defined(SHA_HAVE_X86) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#define SHA_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(SHA_HAVE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define SHA_TARGET_SHANI
+#define SHA_TARGET_AVX2
+#endif
+
+#if defined(SHA_TARGET_SHANI)
+
+namespace {
+    alignas(16) const quint32 K256[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    SHA_TARGET_SHANI inline void fourRounds(__m128i& vState0, __m128i& vState1, __m128i vW, int nGroup)
+    {
+        __m128i vK = _mm_add_epi32(vW, _mm_load_si128(reinterpret_cast<const __m128i*>(K256 + (4 * nGroup))));
+        vState1 = _mm_sha256rnds2_epu32(vState1, vState0, vK);
+        vK = _mm_shuffle_epi32(vK, 0x0E);
+        vState0 = _mm_sha256rnds2_epu32(vState0, vState1, vK);
+    }
+
+    SHA_TARGET_AVX2 inline __m256i rotr32x8(__m256i x, int n)
+    {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    }
+
+    SHA_TARGET_AVX2 inline __m256i loadBigEndianWords(const quint8* const* ppBlocks, int nWord)
+    {
+        const __m256i vSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                              12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        int aWords[8];
+        for (int j = 0; j < 8; ++j) {
+            std::memcpy(&aWords[j], ppBlocks[j] + (4 * nWord), 4);
+        }
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aWords));
+        return _mm256_shuffle_epi8(v, vSwap);
+    }
+}
+
+// Process uBlocks 64-byte blocks. The state is kept as ABEF/CDGH, the
+// layout the SHA256RNDS2 instruction works on; each loop iteration does
+// four rounds and extends the message schedule by four words.
+SHA_TARGET_SHANI void SHA256::compressShaNi(quint32* pState, const quint8* pBlocks, size_t uBlocks)
+{
+    const __m128i vSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i vTmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pState));
+    __m128i vState1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pState + 4));
+    vTmp = _mm_shuffle_epi32(vTmp, 0xB1);                // CDAB
+    vState1 = _mm_shuffle_epi32(vState1, 0x1B);          // EFGH
+    __m128i vState0 = _mm_alignr_epi8(vTmp, vState1, 8); // ABEF
+    vState1 = _mm_blend_epi16(vState1, vTmp, 0xF0);      // CDGH
+
+    for (; uBlocks != 0; --uBlocks, pBlocks += 64) {
+        const __m128i vSave0 = vState0;
+        const __m128i vSave1 = vState1;
+        __m128i vMsg[4];
+
+        for (int i = 0; i < 4; ++i) {
+            vMsg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlocks + (16 * i))),
+                                       vSwap);
+            fourRounds(vState0, vState1, vMsg[i], i);
+        }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 12
+#endif
+        for (int i = 4; i < 16; ++i) {
+            // W[i] = msg2(msg1(W[i-4], W[i-3]) + (W[i-2][1..3], W[i-1][0]), W[i-1])
+            const __m128i vPrev = vMsg[(i - 1) & 3];
+            __m128i vT = _mm_sha256msg1_epu32(vMsg[i & 3], vMsg[(i - 3) & 3]);
+            vT = _mm_add_epi32(vT, _mm_alignr_epi8(vPrev, vMsg[(i - 2) & 3], 4));
+            vMsg[i & 3] = _mm_sha256msg2_epu32(vT, vPrev);
+            fourRounds(vState0, vState1, vMsg[i & 3], i);
+        }
+
+        vState0 = _mm_add_epi32(vState0, vSave0);
+        vState1 = _mm_add_epi32(vState1, vSave1);
+    }
+
+    vTmp = _mm_shuffle_epi32(vState0, 0x1B);             // FEBA
+    vState1 = _mm_shuffle_epi32(vState1, 0xB1);          // DCHG
+    vState0 = _mm_blend_epi16(vTmp, vState1, 0xF0);      // DCBA
+    vState1 = _mm_alignr_epi8(vState1, vTmp, 8);         // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pState), vState0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pState + 4), vState1);
+}
+
+// One block for each of eight messages, the FIPS 180-4 rounds written out
+// on vectors. pStates holds word w of lane j at index 8 * w + j; lanes not
+// in uActiveMask keep their state.
+SHA_TARGET_AVX2 void SHA256::compressAvx2x8(quint32* pStates, const quint8* const* ppBlocks,
+                                            quint32 uActiveMask)
+{
+    __m256i vH[8];
+    for (int w = 0; w < 8; ++w) {
+        vH[w] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pStates + (8 * w)));
+    }
+
+    __m256i a = vH[0], b = vH[1], c = vH[2], d = vH[3];
+    __m256i e = vH[4], f = vH[5], g = vH[6], h = vH[7];
+    __m256i vW[16];
+
+    for (int t = 0; t < 64; ++t) {
+        __m256i vWt;
+        if (t < 16) {
+            vWt = loadBigEndianWords(ppBlocks, t);
+        } else {
+            const __m256i w15 = vW[(t - 15) & 15];
+            const __m256i w2 = vW[(t - 2) & 15];
+            const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr32x8(w15, 7), rotr32x8(w15, 18)),
+                                                _mm256_srli_epi32(w15, 3));
+            const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr32x8(w2, 17), rotr32x8(w2, 19)),
+                                                _mm256_srli_epi32(w2, 10));
+            vWt = _mm256_add_epi32(_mm256_add_epi32(vW[t & 15], s0),
+                                   _mm256_add_epi32(vW[(t - 7) & 15], s1));
+        }
+        vW[t & 15] = vWt;
+
+        const __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(rotr32x8(e, 6), rotr32x8(e, 11)), rotr32x8(e, 25));
+        const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        const __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1),
+                                            _mm256_add_epi32(_mm256_add_epi32(ch, vWt),
+                                                             _mm256_set1_epi32(static_cast<int>(K256[t]))));
+        const __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(rotr32x8(a, 2), rotr32x8(a, 13)), rotr32x8(a, 22));
+        const __m256i maj = _mm256_xor_si256(_mm256_and_si256(a, b),
+                                             _mm256_and_si256(c, _mm256_xor_si256(a, b)));
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, _mm256_add_epi32(S0, maj));
+    }
+
+    // All bits set in the lanes that take the new state
+    const __m256i vLaneBits = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+    const __m256i vActive = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(uActiveMask)), vLaneBits), vLaneBits);
+
+    const __m256i vNew[8] = { a, b, c, d, e, f, g, h };
+    for (int w = 0; w < 8; ++w) {
+        const __m256i vSum = _mm256_add_epi32(vH[w], vNew[w]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pStates + (8 * w)),
+                            _mm256_blendv_epi8(vH[w], vSum, vActive));
+    }
+}
+
+bool SHA256::cpuSupportsShaNi()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int aInfo[4] = { 0 };
+    __cpuid(aInfo, 0);
+    if (aInfo[0] < 7)
+        return false;
+    __cpuid(aInfo, 1);
+    const bool bSse41 = (aInfo[2] & (1 << 19)) != 0;
+    const bool bSsse3 = (aInfo[2] & (1 << 9)) != 0;
+    __cpuidex(aInfo, 7, 0);
+    return bSse41 && bSsse3 && ((aInfo[1] & (1 << 29)) != 0);
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    const bool bSse41 = (ecx & bit_SSE4_1) != 0;
+    const bool bSsse3 = (ecx & bit_SSSE3) != 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    return bSse41 && bSsse3 && ((ebx & (1U << 29)) != 0);
+#endif
+}
+
+bool SHA256::cpuSupportsAvx2()
+{
+    // AVX2 also needs the OS to save the YMM registers (OSXSAVE and XCR0)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int aInfo[4] = { 0 };
+    __cpuid(aInfo, 0);
+    if (aInfo[0] < 7)
+        return false;
+    __cpuid(aInfo, 1);
+    if ((aInfo[2] & (1 << 27)) == 0)
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(aInfo, 7, 0);
+    return (aInfo[1] & (1 << 5)) != 0;
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_OSXSAVE) == 0)
+        return false;
+
+    unsigned int uXcr0Low = 0;
+    unsigned int uXcr0High = 0;
+    __asm__("xgetbv" : "=a"(uXcr0Low), "=d"(uXcr0High) : "c"(0));
+    if ((uXcr0Low & 0x6) != 0x6)
+        return false;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    return (ebx & bit_AVX2) != 0;
+#endif
+}
+
+#else // No x86 intrinsics available
+
+void SHA256::compressShaNi([[maybe_unused]] quint32* pState, [[maybe_unused]] const quint8* pBlocks,
+                           [[maybe_unused]] size_t uBlocks)
+{
+}
+
+void SHA256::compressAvx2x8([[maybe_unused]] quint32* pStates,
+                            [[maybe_unused]] const quint8* const* ppBlocks,
+                            [[maybe_unused]] quint32 uActiveMask)
+{
+}
+
+bool SHA256::cpuSupportsShaNi()
+{
+    return false;
+}
+
+bool SHA256::cpuSupportsAvx2()
+{
+    return false;
+}
+
+#endif
@@ -34,6 +34,15 @@ public:
     /// Decrypt with PKCS#7 padding
     INT32 PadDecrypt(const UINT8* pInput, INT32 nInputOctets, UINT8* pOutBuffer);
 
+    /// Decrypt whole blocks without padding. The IV is carried over to the
+    /// next call, so a stream can be decrypted in pieces, the last one with
+    /// PadDecrypt. Lengths are in bytes.
+    INT32 BlockDecrypt(const UINT8* pInput, INT32 nInputOctets, UINT8* pOutBuffer);
+
+    /// Encrypt whole blocks without padding, carrying the IV like
+    /// BlockDecrypt; the last piece goes through PadEncrypt.
+    INT32 BlockEncrypt(const UINT8* pInput, INT32 nInputOctets, UINT8* pOutBuffer);
+
 private:
     Twofish_key m_key;
     UINT8 m_pInitVector[16];
@@ -102,9 +102,6 @@ bool PwExport::exportToTxt(PwManager *manager, QFile &file,
     QTextStream out(&file);
     out.setEncoding(QStringConverter::Utf8);
 
-    // Unlock all passwords for export
-    manager->unlockEntryPassword(nullptr);
-
     for (const PW_ENTRY* entry : entries) {
         if (entry == nullptr) continue;
 
@@ -130,7 +127,7 @@ bool PwExport::exportToTxt(PwManager *manager, QFile &file,
 
         // Password
         if ((fieldFlags & PwExportFlags::PASSWORD) != 0) {
-            out << "Password: " << QString::fromUtf8(entry->pszPassword) << "\n";
+            out << "Password: " << PwUnlockedPassword(manager, entry).toString() << "\n";
         }
 
         // URL
@@ -195,9 +192,6 @@ bool PwExport::exportToTxt(PwManager *manager, QFile &file,
         out << "\n";
     }
 
-    // Lock passwords again
-    manager->lockEntryPassword(nullptr);
-
     return true;
 }
 
@@ -209,9 +203,6 @@ bool PwExport::exportToHtml(PwManager *manager, QFile &file,
     QTextStream out(&file);
     out.setEncoding(QStringConverter::Utf8);
 
-    // Unlock all passwords for export
-    manager->unlockEntryPassword(nullptr);
-
     // Write HTML header with CSS styling (matching MFC)
     out << "<!DOCTYPE html>\n";
     out << "<html>\n";
@@ -305,7 +296,7 @@ bool PwExport::exportToHtml(PwManager *manager, QFile &file,
 
         // Password (with monospace styling)
         if ((fieldFlags & PwExportFlags::PASSWORD) != 0) {
-            QString password = QString::fromUtf8(entry->pszPassword);
+            QString password = PwUnlockedPassword(manager, entry).toString();
             out << "<td><span class=\"f_password\">" << encodeHtml(password) << "</span></td>\n";
         }
 
@@ -391,9 +382,6 @@ bool PwExport::exportToHtml(PwManager *manager, QFile &file,
     out << "</body>\n";
     out << "</html>\n";
 
-    // Lock passwords again
-    manager->lockEntryPassword(nullptr);
-
     return true;
 }
 
@@ -405,9 +393,6 @@ bool PwExport::exportToXml(PwManager *manager, QFile &file,
     QTextStream out(&file);
     out.setEncoding(QStringConverter::Utf8);
 
-    // Unlock all passwords for export
-    manager->unlockEntryPassword(nullptr);
-
     // XML declaration
     out << "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n";
     out << "<pwlist>\n";
@@ -450,7 +435,7 @@ bool PwExport::exportToXml(PwManager *manager, QFile &file,
 
         // Password
         if ((fieldFlags & PwExportFlags::PASSWORD) != 0) {
-            QString password = QString::fromUtf8(entry->pszPassword);
+            QString password = PwUnlockedPassword(manager, entry).toString();
             out << "\t\t<password>" << encodeXml(password) << "</password>\n";
         }
 
@@ -523,9 +508,6 @@ bool PwExport::exportToXml(PwManager *manager, QFile &file,
 
     out << "</pwlist>\n";
 
-    // Lock passwords again
-    manager->lockEntryPassword(nullptr);
-
     return true;
 }
 
@@ -642,9 +624,10 @@ QList<const PW_ENTRY*> PwExport::getEntriesForGroup(PwManager *manager,
 
     if (!includeSubgroups) {
         // Just this group
-        for (quint32 i = 0; i < manager->getNumberOfEntries(); ++i) {
-            const PW_ENTRY* entry = manager->getEntry(i);
-            if ((entry != nullptr) && (entry->uGroupId == groupId)) {
+        const quint32 numInGroup = manager->getNumberOfItemsInGroupN(groupId);
+        for (quint32 n = 0; n < numInGroup; ++n) {
+            const PW_ENTRY* entry = manager->getEntryByGroup(groupId, n);
+            if (entry != nullptr) {
                 result.append(entry);
             }
         }
@@ -71,6 +71,10 @@ bool PwImport::mergeDatabase(PwManager *targetManager,
     bool createNewUUIDs = (mergeMode == KdbMergeMode::CREATE_NEW_UUIDS);
     bool compareTimes = (mergeMode == KdbMergeMode::OVERWRITE_IF_NEWER);
 
+    // Grow the target arrays once instead of while adding
+    targetManager->reserveGroups(targetManager->getNumberOfGroups() + sourceManager.getNumberOfGroups());
+    targetManager->reserveEntries(targetManager->getNumberOfEntries() + sourceManager.getNumberOfEntries());
+
     // Merge groups first
     for (quint32 i = 0; i < sourceManager.getNumberOfGroups(); ++i) {
         const PW_GROUP* srcGroup = sourceManager.getGroup(i);
@@ -88,31 +92,28 @@ bool PwImport::mergeDatabase(PwManager *targetManager,
 
             targetManager->addGroup(&newGroup);
         } else {
-            // Look for existing group by ID
-            bool found = false;
-            for (quint32 j = 0; j < targetManager->getNumberOfGroups(); ++j) {
-                const PW_GROUP* tgtGroup = targetManager->getGroup(j);
-                if (tgtGroup != nullptr && tgtGroup->uGroupId == srcGroup->uGroupId) {
-                    found = true;
-
-                    if (compareTimes) {
-                        // Only replace if source is newer
-                        if (PwUtil::compareTime(&srcGroup->tLastMod, &tgtGroup->tLastMod) > 0) {
-                            PW_GROUP updatedGroup = *srcGroup;
-                            if (srcGroup->pszGroupName != nullptr) {
-                                updatedGroup.pszGroupName = strdup(srcGroup->pszGroupName);
-                            }
-                            targetManager->setGroup(j, &updatedGroup);
-                        }
-                    } else {
-                        // Overwrite unconditionally
+            // Look for existing group by ID (constant-time index lookup)
+            const quint32 j = targetManager->getGroupByIdN(srcGroup->uGroupId);
+            const PW_GROUP* tgtGroup = targetManager->getGroup(j);
+            const bool found = (tgtGroup != nullptr);
+
+            if (found) {
+                if (compareTimes) {
+                    // Only replace if source is newer
+                    if (PwUtil::compareTime(&srcGroup->tLastMod, &tgtGroup->tLastMod) > 0) {
                         PW_GROUP updatedGroup = *srcGroup;
                         if (srcGroup->pszGroupName != nullptr) {
                             updatedGroup.pszGroupName = strdup(srcGroup->pszGroupName);
                         }
                         targetManager->setGroup(j, &updatedGroup);
                     }
-                    break;
+                } else {
+                    // Overwrite unconditionally
+                    PW_GROUP updatedGroup = *srcGroup;
+                    if (srcGroup->pszGroupName != nullptr) {
+                        updatedGroup.pszGroupName = strdup(srcGroup->pszGroupName);
+                    }
+                    targetManager->setGroup(j, &updatedGroup);
                 }
             }
 
@@ -171,52 +172,48 @@ bool PwImport::mergeDatabase(PwManager *targetManager,
 
             targetManager->addEntry(&newEntry);
         } else {
-            // Look for existing entry by UUID
-            bool found = false;
-            for (quint32 j = 0; j < targetManager->getNumberOfEntries(); ++j) {
-                const PW_ENTRY* tgtEntry = targetManager->getEntry(j);
-                if (tgtEntry != nullptr &&
-                    memcmp(tgtEntry->uuid, srcEntry->uuid, 16) == 0) {
-                    found = true;
-
-                    bool shouldReplace = !compareTimes ||
-                        (PwUtil::compareTime(&srcEntry->tLastMod, &tgtEntry->tLastMod) > 0);
-
-                    if (shouldReplace) {
-                        // Replace entry
-                        PW_ENTRY updatedEntry;
-                        memset(&updatedEntry, 0, sizeof(PW_ENTRY));
-                        memcpy(updatedEntry.uuid, srcEntry->uuid, 16);
-
-                        updatedEntry.uGroupId = srcEntry->uGroupId;
-                        updatedEntry.uImageId = srcEntry->uImageId;
-                        updatedEntry.tCreation = srcEntry->tCreation;
-                        updatedEntry.tLastMod = srcEntry->tLastMod;
-                        updatedEntry.tLastAccess = srcEntry->tLastAccess;
-                        updatedEntry.tExpire = srcEntry->tExpire;
-
-                        if (srcEntry->pszTitle != nullptr) {
-                            updatedEntry.pszTitle = strdup(srcEntry->pszTitle);
-                        }
-                        if (srcEntry->pszUserName != nullptr) {
-                            updatedEntry.pszUserName = strdup(srcEntry->pszUserName);
-                        }
-                        if (srcEntry->pszURL != nullptr) {
-                            updatedEntry.pszURL = strdup(srcEntry->pszURL);
-                        }
-                        if (srcEntry->pszAdditional != nullptr) {
-                            updatedEntry.pszAdditional = strdup(srcEntry->pszAdditional);
-                        }
-                        if (srcEntry->pszPassword != nullptr) {
-                            updatedEntry.uPasswordLen = srcEntry->uPasswordLen;
-                            updatedEntry.pszPassword = static_cast<char*>(malloc(updatedEntry.uPasswordLen + 1));
-                            memcpy(updatedEntry.pszPassword, srcEntry->pszPassword, updatedEntry.uPasswordLen);
-                            updatedEntry.pszPassword[updatedEntry.uPasswordLen] = '\0';
-                        }
-
-                        targetManager->setEntry(j, &updatedEntry);
+            // Look for existing entry by UUID (constant-time index lookup)
+            const quint32 j = targetManager->getEntryByUuidN(srcEntry->uuid);
+            const PW_ENTRY* tgtEntry = targetManager->getEntry(j);
+            const bool found = (tgtEntry != nullptr);
+
+            if (found) {
+                bool shouldReplace = !compareTimes ||
+                    (PwUtil::compareTime(&srcEntry->tLastMod, &tgtEntry->tLastMod) > 0);
+
+                if (shouldReplace) {
+                    // Replace entry
+                    PW_ENTRY updatedEntry;
+                    memset(&updatedEntry, 0, sizeof(PW_ENTRY));
+                    memcpy(updatedEntry.uuid, srcEntry->uuid, 16);
+
+                    updatedEntry.uGroupId = srcEntry->uGroupId;
+                    updatedEntry.uImageId = srcEntry->uImageId;
+                    updatedEntry.tCreation = srcEntry->tCreation;
+                    updatedEntry.tLastMod = srcEntry->tLastMod;
+                    updatedEntry.tLastAccess = srcEntry->tLastAccess;
+                    updatedEntry.tExpire = srcEntry->tExpire;
+
+                    if (srcEntry->pszTitle != nullptr) {
+                        updatedEntry.pszTitle = strdup(srcEntry->pszTitle);
+                    }
+                    if (srcEntry->pszUserName != nullptr) {
+                        updatedEntry.pszUserName = strdup(srcEntry->pszUserName);
+                    }
+                    if (srcEntry->pszURL != nullptr) {
+                        updatedEntry.pszURL = strdup(srcEntry->pszURL);
+                    }
+                    if (srcEntry->pszAdditional != nullptr) {
+                        updatedEntry.pszAdditional = strdup(srcEntry->pszAdditional);
                     }
-                    break;
+                    if (srcEntry->pszPassword != nullptr) {
+                        updatedEntry.uPasswordLen = srcEntry->uPasswordLen;
+                        updatedEntry.pszPassword = static_cast<char*>(malloc(updatedEntry.uPasswordLen + 1));
+                        memcpy(updatedEntry.pszPassword, srcEntry->pszPassword, updatedEntry.uPasswordLen);
+                        updatedEntry.pszPassword[updatedEntry.uPasswordLen] = '\0';
+                    }
+
+                    targetManager->setEntry(j, &updatedEntry);
                 }
             }
 
@@ -276,6 +273,7 @@ bool PwImport::importCodeWallet(PwManager *manager, const QString &filePath,
     QString groupName = "Imported";
     bool inNotes = false;
     int importedCount = 0;
+    QVector<PW_ENTRY> entries;  // Added in one batch at the end
 
     auto saveCurrentEntry = [&]() {
         if (title.isEmpty() && userName.isEmpty() && password.isEmpty()) {
@@ -287,9 +285,8 @@ bool PwImport::importCodeWallet(PwManager *manager, const QString &filePath,
 
         // Create entry
         PW_ENTRY entry;
-        memset(&entry, 0, sizeof(PW_ENTRY));
+        memset(&entry, 0, sizeof(PW_ENTRY));  // Zero UUID: assigned by addEntries
 
-        Random::generateUuid(entry.uuid);
         entry.uGroupId = groupId;
         entry.uImageId = getPreferredIcon(groupName);
 
@@ -335,7 +332,7 @@ bool PwImport::importCodeWallet(PwManager *manager, const QString &filePath,
             entry.pszPassword[entry.uPasswordLen] = '\0';
         }
 
-        manager->addEntry(&entry);
+        entries.append(entry);
         importedCount++;
 
         // Reset for next entry
@@ -422,6 +419,10 @@ bool PwImport::importCodeWallet(PwManager *manager, const QString &filePath,
     // Save last entry
     saveCurrentEntry();
 
+    if (!addImportedEntries(manager, entries)) {
+        importedCount = 0;
+    }
+
     if (errorMsg != nullptr) {
         *errorMsg = QString("Imported %1 entries").arg(importedCount);
     }
@@ -439,6 +440,7 @@ bool PwImport::importPwSafe(PwManager *manager, const QString &filePath,
     }
 
     int importedCount = 0;
+    QVector<PW_ENTRY> entries;  // Added in one batch at the end
 
     for (const QString &line : lines) {
         if (line.trimmed().isEmpty()) continue;
@@ -471,9 +473,8 @@ bool PwImport::importPwSafe(PwManager *manager, const QString &filePath,
 
         // Create entry
         PW_ENTRY entry;
-        memset(&entry, 0, sizeof(PW_ENTRY));
+        memset(&entry, 0, sizeof(PW_ENTRY));  // Zero UUID: assigned by addEntries
 
-        Random::generateUuid(entry.uuid);
         entry.uGroupId = groupId;
         entry.uImageId = getPreferredIcon(groupName);
 
@@ -511,10 +512,14 @@ bool PwImport::importPwSafe(PwManager *manager, const QString &filePath,
             entry.pszPassword[entry.uPasswordLen] = '\0';
         }
 
-        manager->addEntry(&entry);
+        entries.append(entry);
         importedCount++;
     }
 
+    if (!addImportedEntries(manager, entries)) {
+        importedCount = 0;
+    }
+
     if (errorMsg != nullptr) {
         *errorMsg = QString("Imported %1 entries").arg(importedCount);
     }
@@ -595,6 +600,28 @@ QStringList PwImport::readLines(const QString &filePath, QString *errorMsg)
     return content.split('\n');
 }
 
+// Add parsed entries in one batch and release their strings
+bool PwImport::addImportedEntries(PwManager *manager, QVector<PW_ENTRY> &entries)
+{
+    bool success = manager->addEntries(entries.constData(),
+                                       static_cast<quint32>(entries.size()));
+
+    // The importers strdup()/malloc() the strings; PwManager keeps its own copies
+    for (PW_ENTRY &entry : entries) {
+        free(entry.pszTitle);
+        free(entry.pszUserName);
+        free(entry.pszURL);
+        free(entry.pszAdditional);
+        if (entry.pszPassword != nullptr) {
+            memset(entry.pszPassword, 0, entry.uPasswordLen);
+            free(entry.pszPassword);
+        }
+    }
+    entries.clear();
+
+    return success;
+}
+
 // Find or create a group by name
 quint32 PwImport::findOrCreateGroup(PwManager *manager, const QString &groupName)
 {
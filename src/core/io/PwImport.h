@@ -55,6 +55,7 @@ private:
     static QString extractField(const QString &line, const QString &prefix);
     static bool isFieldPrefix(const QString &line, const QStringList &prefixes,
                              QString *value);
+    static bool addImportedEntries(PwManager *manager, QVector<PW_ENTRY> &entries);
 
     // Password Safe specific
     static void splitPwSafeTitle(const QString &combined, QString &group,
@@ -1,12 +1,16 @@
 /*
   Qt KeePass - Memory Protection (Unix/macOS/Linux)
 
-  Implementation using mlock/munlock system calls.
+  Implementation using mlock/munlock system calls, and the secure arena
+  (mmap/mlock/madvise).
 */
 
 #include "MemoryProtection.h"
+#include "SecureArena.h"
 #include <cstring>
+#include <mutex>
 #include <new>
+#include <vector>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
@@ -158,3 +162,245 @@ void SecureMemory::clear()
         OPENSSL_cleanse(m_data, m_size);
     }
 }
+
+// SecureArena implementation
+
+namespace {
+    // Chunks for small blocks; one mmap + mlock serves many blocks
+    constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // Size classes are powers of two from MIN_CLASS_SIZE to MAX_CLASS_SIZE
+    constexpr size_t MIN_CLASS_SIZE = 16;
+    constexpr size_t MAX_CLASS_SIZE = 4096;
+    constexpr int NUM_CLASSES = 9;
+
+    // Released large blocks kept mapped (and locked) for reuse, in bytes;
+    // the least recently released ones are unmapped first
+    constexpr size_t LARGE_CACHE_LIMIT = 1024 * 1024;
+
+    constexpr quint32 BLOCK_MAGIC = 0x53414245;  // "SABE"
+    constexpr quint32 FLAG_LOCKED = 1;
+    constexpr quint32 FLAG_LARGE = 2;
+
+    // Precedes every block; its size keeps the blocks 16-byte aligned
+    struct BlockHeader
+    {
+        quint64 uCapacity;
+        quint32 uMagic;
+        quint32 uFlags;
+    };
+    static_assert(sizeof(BlockHeader) == 16, "BlockHeader must keep blocks 16-byte aligned");
+
+    struct ArenaState
+    {
+        std::mutex mutex;
+        std::vector<void*> vFree[NUM_CLASSES];  // Erased blocks per size class
+        std::vector<BlockHeader*> vLargeFree;   // Erased large blocks, still mapped, oldest first
+        size_t uLargeFreeBytes = 0;
+        char* pChunk = nullptr;                 // Chunk being carved
+        size_t uChunkUsed = CHUNK_SIZE;
+        bool bChunkLocked = false;
+        quint64 uUnlockCalls = 0;
+        SecureArena::Stats stats{};
+    };
+
+    // Never destroyed, so blocks may still be released during static destruction
+    ArenaState& arenaState()
+    {
+        static ArenaState* pState = new ArenaState();
+        return *pState;
+    }
+
+    BlockHeader* headerOf(const void* ptr)
+    {
+        return reinterpret_cast<BlockHeader*>(const_cast<char*>(static_cast<const char*>(ptr))) - 1;
+    }
+
+    int classIndex(size_t size)
+    {
+        int nIndex = 0;
+        size_t uClassSize = MIN_CLASS_SIZE;
+        while (uClassSize < size) {
+            uClassSize <<= 1;
+            ++nIndex;
+        }
+        return nIndex;
+    }
+
+    // Map, lock and exclude from core dumps; state.mutex must be held
+    char* mapPages(ArenaState& state, size_t size, bool* pLocked)
+    {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ++state.stats.uMapCalls;
+        if (p == MAP_FAILED) {
+            return nullptr;
+        }
+
+#if defined(MADV_DONTDUMP)
+        madvise(p, size, MADV_DONTDUMP);
+#elif defined(MADV_NOCORE)
+        madvise(p, size, MADV_NOCORE);
+#endif
+
+        ++state.stats.uLockCalls;
+        *pLocked = (mlock(p, size) == 0);
+        if (*pLocked) {
+            state.stats.uBytesLocked += size;
+            if (state.stats.uBytesLocked > state.stats.uBytesLockedPeak) {
+                state.stats.uBytesLockedPeak = state.stats.uBytesLocked;
+            }
+        } else {
+            ++state.stats.uLockFailures;
+        }
+
+        state.stats.uBytesMapped += size;
+        return static_cast<char*>(p);
+    }
+
+    void unmapPages(ArenaState& state, void* p, size_t size, bool bLocked)
+    {
+        if (bLocked) {
+            munlock(p, size);
+            ++state.uUnlockCalls;
+            state.stats.uBytesLocked -= size;
+        }
+        munmap(p, size);
+        state.stats.uBytesMapped -= size;
+    }
+}
+
+void* SecureArena::allocate(size_t size)
+{
+    ArenaState& state = arenaState();
+    std::lock_guard<std::mutex> guard(state.mutex);
+
+    BlockHeader* pHeader = nullptr;
+
+    if (size <= MAX_CLASS_SIZE) {
+        const int nClass = classIndex(size);
+        const size_t uCapacity = MIN_CLASS_SIZE << nClass;
+
+        if (!state.vFree[nClass].empty()) {
+            void* p = state.vFree[nClass].back();
+            state.vFree[nClass].pop_back();
+            ++state.stats.uRecycledBlocks;
+            pHeader = headerOf(p);
+            pHeader->uMagic = BLOCK_MAGIC;
+        } else {
+            const size_t uNeeded = sizeof(BlockHeader) + uCapacity;
+            if (CHUNK_SIZE - state.uChunkUsed < uNeeded) {
+                // The tail of the old chunk is left unused
+                bool bLocked = false;
+                char* pChunk = mapPages(state, CHUNK_SIZE, &bLocked);
+                if (pChunk == nullptr) {
+                    return nullptr;
+                }
+                state.pChunk = pChunk;
+                state.uChunkUsed = 0;
+                state.bChunkLocked = bLocked;
+            }
+
+            pHeader = reinterpret_cast<BlockHeader*>(state.pChunk + state.uChunkUsed);
+            state.uChunkUsed += uNeeded;
+            pHeader->uCapacity = uCapacity;
+            pHeader->uMagic = BLOCK_MAGIC;
+            pHeader->uFlags = state.bChunkLocked ? FLAG_LOCKED : 0;
+        }
+    } else {
+        // Most recently released block that fits without wasting more than half
+        for (size_t i = state.vLargeFree.size(); i-- > 0; ) {
+            BlockHeader* pCached = state.vLargeFree[i];
+            if (pCached->uCapacity >= size && pCached->uCapacity / 2 <= size) {
+                state.vLargeFree.erase(state.vLargeFree.begin() + static_cast<std::ptrdiff_t>(i));
+                state.uLargeFreeBytes -= sizeof(BlockHeader) + pCached->uCapacity;
+                ++state.stats.uRecycledBlocks;
+                pHeader = pCached;
+                pHeader->uMagic = BLOCK_MAGIC;
+                break;
+            }
+        }
+
+        if (pHeader == nullptr) {
+            const size_t uPageSize = MemoryProtection::getPageSize();
+            const size_t uMapSize = ((sizeof(BlockHeader) + size + uPageSize - 1) / uPageSize) * uPageSize;
+            bool bLocked = false;
+            char* p = mapPages(state, uMapSize, &bLocked);
+            if (p == nullptr) {
+                return nullptr;
+            }
+            pHeader = reinterpret_cast<BlockHeader*>(p);
+            pHeader->uCapacity = uMapSize - sizeof(BlockHeader);
+            pHeader->uMagic = BLOCK_MAGIC;
+            pHeader->uFlags = FLAG_LARGE | (bLocked ? FLAG_LOCKED : 0);
+        }
+    }
+
+    ++state.stats.uAllocations;
+    state.stats.uBytesInUse += pHeader->uCapacity;
+    return pHeader + 1;
+}
+
+void SecureArena::release(void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    BlockHeader* pHeader = headerOf(ptr);
+    Q_ASSERT(pHeader->uMagic == BLOCK_MAGIC);
+    if (pHeader->uMagic != BLOCK_MAGIC) {
+        return;  // Not a live arena block; leaking beats corrupting the free lists
+    }
+
+    // Erase outside the lock, the block is not shared
+    OPENSSL_cleanse(ptr, pHeader->uCapacity);
+
+    ArenaState& state = arenaState();
+    std::lock_guard<std::mutex> guard(state.mutex);
+    pHeader->uMagic = 0;  // Catches a second release
+    state.stats.uBytesInUse -= pHeader->uCapacity;
+
+    if ((pHeader->uFlags & FLAG_LARGE) == 0) {
+        state.vFree[classIndex(pHeader->uCapacity)].push_back(ptr);
+        return;
+    }
+
+    const size_t uMapSize = sizeof(BlockHeader) + pHeader->uCapacity;
+    if (uMapSize > LARGE_CACHE_LIMIT) {
+        unmapPages(state, pHeader, uMapSize, (pHeader->uFlags & FLAG_LOCKED) != 0);
+        return;
+    }
+
+    state.vLargeFree.push_back(pHeader);
+    state.uLargeFreeBytes += uMapSize;
+    while (state.uLargeFreeBytes > LARGE_CACHE_LIMIT) {
+        BlockHeader* pOldest = state.vLargeFree.front();
+        const size_t uOldestSize = sizeof(BlockHeader) + pOldest->uCapacity;
+        state.vLargeFree.erase(state.vLargeFree.begin());
+        state.uLargeFreeBytes -= uOldestSize;
+        unmapPages(state, pOldest, uOldestSize, (pOldest->uFlags & FLAG_LOCKED) != 0);
+    }
+}
+
+size_t SecureArena::capacity(const void* ptr)
+{
+    return (ptr != nullptr) ? static_cast<size_t>(headerOf(ptr)->uCapacity) : 0;
+}
+
+bool SecureArena::isLocked(const void* ptr)
+{
+    return (ptr != nullptr) && ((headerOf(ptr)->uFlags & FLAG_LOCKED) != 0);
+}
+
+SecureArena::Stats SecureArena::getStats()
+{
+    ArenaState& state = arenaState();
+    std::lock_guard<std::mutex> guard(state.mutex);
+
+    // Locking every block on its own takes one mlock and one munlock call
+    Stats stats = state.stats;
+    const quint64 uPerBlockCalls = 2 * stats.uAllocations;
+    const quint64 uArenaCalls = stats.uLockCalls + state.uUnlockCalls;
+    stats.uSyscallsSaved = (uPerBlockCalls > uArenaCalls) ? (uPerBlockCalls - uArenaCalls) : 0;
+    return stats;
+}
@@ -287,6 +287,58 @@ void PwSettings::setHideUsernameStars(bool hide)
     m_settings.setValue(KEY_HIDE_USERNAME_STARS, hide);
 }
 
+// Key transformation calibration
+
+int PwSettings::getKeyTransformTargetMs() const
+{
+    return m_settings.value(KEY_KEY_TRANSFORM_TARGET_MS, 1000).toInt();
+}
+
+void PwSettings::setKeyTransformTargetMs(int ms)
+{
+    m_settings.setValue(KEY_KEY_TRANSFORM_TARGET_MS, ms);
+}
+
+QString PwSettings::calibrationGroup(const QString& machineKey)
+{
+    // Slashes would open nested groups
+    QString name = machineKey;
+    name.replace(QLatin1Char('/'), QLatin1Char('_'));
+    name.replace(QLatin1Char('\\'), QLatin1Char('_'));
+    return QString::fromLatin1(KEY_KEY_TRANSFORM_CALIBRATION) + QLatin1Char('/') + name;
+}
+
+bool PwSettings::getKeyTransformCalibration(const QString& machineKey, quint64* pMedianRoundsPerSec,
+                                            quint64* pP95RoundsPerSec, QDateTime* pMeasured) const
+{
+    const QString group = calibrationGroup(machineKey);
+    const quint64 median = m_settings.value(group + "/MedianRoundsPerSec", 0).toULongLong();
+    if (median == 0)
+        return false;
+
+    if (pMedianRoundsPerSec != nullptr)
+        *pMedianRoundsPerSec = median;
+    if (pP95RoundsPerSec != nullptr)
+        *pP95RoundsPerSec = m_settings.value(group + "/P95RoundsPerSec", median).toULongLong();
+    if (pMeasured != nullptr)
+        *pMeasured = m_settings.value(group + "/Measured").toDateTime();
+    return true;
+}
+
+void PwSettings::setKeyTransformCalibration(const QString& machineKey, quint64 medianRoundsPerSec,
+                                            quint64 p95RoundsPerSec, const QDateTime& measured)
+{
+    const QString group = calibrationGroup(machineKey);
+    m_settings.setValue(group + "/MedianRoundsPerSec", medianRoundsPerSec);
+    m_settings.setValue(group + "/P95RoundsPerSec", p95RoundsPerSec);
+    m_settings.setValue(group + "/Measured", measured);
+}
+
+void PwSettings::clearKeyTransformCalibrations()
+{
+    m_settings.remove(KEY_KEY_TRANSFORM_CALIBRATION);
+}
+
 // Generic access
 
 QVariant PwSettings::get(const QString& key, const QVariant& defaultValue) const
@@ -13,6 +13,7 @@
 #ifndef PWSETTINGS_H
 #define PWSETTINGS_H
 
+#include <QDateTime>
 #include <QSettings>
 #include <QString>
 #include <QVariant>
@@ -105,6 +106,18 @@ public:
     [[nodiscard]] bool getHideUsernameStars() const;  // Hide usernames with stars (default: false)
     void setHideUsernameStars(bool hide);
 
+    // Key transformation calibration
+    [[nodiscard]] int getKeyTransformTargetMs() const;  // Unlock time new keys aim for (default: 1000)
+    void setKeyTransformTargetMs(int ms);
+
+    /// Cached speed measurement of one machine (see KeyTransformCalibrator::machineKey)
+    /// @return false if nothing is stored for the key
+    [[nodiscard]] bool getKeyTransformCalibration(const QString& machineKey, quint64* pMedianRoundsPerSec,
+                                                  quint64* pP95RoundsPerSec, QDateTime* pMeasured) const;
+    void setKeyTransformCalibration(const QString& machineKey, quint64 medianRoundsPerSec,
+                                    quint64 p95RoundsPerSec, const QDateTime& measured);
+    void clearKeyTransformCalibrations();
+
     // Generic access (for future settings)
     [[nodiscard]] QVariant get(const QString& key, const QVariant& defaultValue = QVariant()) const;
     void set(const QString& key, const QVariant& value);
@@ -118,6 +131,8 @@ private:
 
     QSettings m_settings;
 
+    [[nodiscard]] static QString calibrationGroup(const QString& machineKey);
+
     // Setting keys
     static constexpr const char* KEY_LAST_DB_PATH = "Database/LastPath";
     static constexpr const char* KEY_DEFAULT_KEY_ROUNDS = "Database/DefaultKeyRounds";
@@ -142,6 +157,8 @@ private:
     static constexpr const char* KEY_AUTO_TYPE_IE_FIX = "AutoType/InternetExplorerFix";
     static constexpr const char* KEY_HIDE_PASSWORD_STARS = "View/HidePasswordStars";
     static constexpr const char* KEY_HIDE_USERNAME_STARS = "View/HideUsernameStars";
+    static constexpr const char* KEY_KEY_TRANSFORM_TARGET_MS = "KeyTransform/TargetMs";
+    static constexpr const char* KEY_KEY_TRANSFORM_CALIBRATION = "KeyTransform/Calibration";
 };
 
 #endif // PWSETTINGS_H
@@ -0,0 +1,76 @@
+/*
+  Qt KeePass - Secure Memory Arena
+
+  Pooled allocator for sensitive buffers (keys, decrypted database data,
+  passwords, attachments). Memory comes from page-aligned mappings that are
+  locked into RAM and excluded from core dumps once per mapping, instead of
+  one lock call per object.
+
+  Platform implementations:
+  - Unix (macOS/Linux): mmap + mlock + madvise(MADV_DONTDUMP / MADV_NOCORE)
+*/
+
+#ifndef SECUREARENA_H
+#define SECUREARENA_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * Process-wide secure arena
+ *
+ * Small blocks (up to 4 KB) are carved out of 64 KB chunks and recycled
+ * through power-of-two size-class free lists. Larger blocks get a mapping
+ * of their own; a few released ones are kept for reuse. Locking is best
+ * effort: when RLIMIT_MEMLOCK is exhausted, further mappings stay unlocked
+ * but are still excluded from core dumps.
+ *
+ * All functions are thread-safe.
+ */
+class SecureArena
+{
+public:
+    /// Statistics since program start
+    struct Stats
+    {
+        quint64 uAllocations;     ///< Blocks handed out (new or recycled)
+        quint64 uRecycledBlocks;  ///< Allocations served from a free list
+        quint64 uMapCalls;        ///< mmap calls
+        quint64 uLockCalls;       ///< mlock calls (successful or not)
+        quint64 uLockFailures;    ///< mlock calls that failed
+        quint64 uSyscallsSaved;   ///< mlock/munlock calls avoided compared to locking every block on its own
+        size_t uBytesMapped;      ///< Bytes currently mapped
+        size_t uBytesLocked;      ///< Bytes currently locked
+        size_t uBytesLockedPeak;  ///< High-water mark of uBytesLocked
+        size_t uBytesInUse;       ///< Capacity of the live blocks
+    };
+
+    /**
+     * Allocate a zero-filled block, 16-byte aligned
+     * @param size Size in bytes (0 is allowed)
+     * @return Block pointer, or nullptr if no memory could be mapped
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * Erase a block and return it to the arena
+     * @param ptr Block from allocate(), or nullptr
+     */
+    static void release(void* ptr);
+
+    /**
+     * @param ptr Block from allocate()
+     * @return Usable size of the block (at least the requested size)
+     */
+    static size_t capacity(const void* ptr);
+
+    /**
+     * @param ptr Block from allocate()
+     * @return true if the memory of the block is locked into RAM
+     */
+    static bool isLocked(const void* ptr);
+
+    static Stats getStats();
+};
+
+#endif // SECUREARENA_H
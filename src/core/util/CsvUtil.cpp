@@ -11,6 +11,7 @@
 #include <QTextStream>
 #include <QDateTime>
 #include <QStringConverter>
+#include <QVector>
 #include <cstring>
 
 bool CsvUtil::exportToCSV(const QString& filePath,
@@ -64,9 +65,6 @@ bool CsvUtil::exportToCSV(const QString& filePath,
             }
         }
 
-        // Unlock password for export
-        pwManager->unlockEntryPassword(entry);
-
         // Build field list
         QStringList fields;
         if (options.includeGroup) {
@@ -79,7 +77,7 @@ bool CsvUtil::exportToCSV(const QString& filePath,
             fields << escapeCsvField(QString::fromUtf8(entry->pszUserName ? entry->pszUserName : ""));
         }
         if (options.includePassword) {
-            fields << escapeCsvField(QString::fromUtf8(entry->pszPassword ? entry->pszPassword : ""));
+            fields << escapeCsvField(PwUnlockedPassword(pwManager, entry).toString());
         }
         if (options.includeUrl) {
             fields << escapeCsvField(QString::fromUtf8(entry->pszURL ? entry->pszURL : ""));
@@ -111,9 +109,6 @@ bool CsvUtil::exportToCSV(const QString& filePath,
             fields << escapeCsvField(dt.toString(Qt::ISODate));
         }
 
-        // Lock password again
-        pwManager->lockEntryPassword(entry);
-
         // Write quoted row
         out << "\"" << fields.join("\",\"") << "\"" << "\n";
     }
@@ -150,6 +145,10 @@ bool CsvUtil::importFromCSV(const QString& filePath,
     int imported = 0;
     int lineNumber = 0;
 
+    // Rows are collected first and added in one batch (single array growth,
+    // single random generator call for all UUIDs)
+    QVector<PW_ENTRY> vTemplates;
+
     while (!in.atEnd()) {
         QString line = in.readLine();
         lineNumber++;
@@ -220,23 +219,28 @@ bool CsvUtil::importFromCSV(const QString& filePath,
         entryTemplate.uGroupId = options.targetGroupId;
         entryTemplate.uImageId = 0;  // Default icon
 
-        // Add entry to database
-        bool success = pwManager->addEntry(&entryTemplate);
+        vTemplates.append(entryTemplate);
+    }
+
+    file.close();
 
-        // Clean up allocated memory
+    // Add entries to database
+    bool success = pwManager->addEntries(vTemplates.constData(),
+                                         static_cast<quint32>(vTemplates.size()));
+
+    // Clean up allocated memory
+    for (PW_ENTRY& entryTemplate : vTemplates) {
         delete[] entryTemplate.pszTitle;
         delete[] entryTemplate.pszUserName;
         delete[] entryTemplate.pszPassword;
         delete[] entryTemplate.pszURL;
         delete[] entryTemplate.pszAdditional;
         delete[] entryTemplate.pszBinaryDesc;
-
-        if (success) {
-            imported++;
-        }
     }
 
-    file.close();
+    if (success) {
+        imported = vTemplates.size();
+    }
 
     if (entriesImported) {
         *entriesImported = imported;
@@ -0,0 +1,60 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "ExpiryIndex.h"
+#include "PwUtil.h"
+#include <algorithm>
+
+namespace {
+    inline bool keyLess(const ExpiryIndex::Key& a, const ExpiryIndex::Key& b)
+    {
+        return (a.qwTime < b.qwTime) || (a.qwTime == b.qwTime && a.dwIndex < b.dwIndex);
+    }
+}
+
+void ExpiryIndex::insert(quint32 dwIndex, const PW_TIME* pExpire)
+{
+    const Key key = { PwUtil::timeToKey(pExpire), dwIndex };
+    m_vKeys.insert(std::lower_bound(m_vKeys.begin(), m_vKeys.end(), key, keyLess), key);
+}
+
+void ExpiryIndex::remove(quint32 dwIndex, const PW_TIME* pExpire)
+{
+    const Key key = { PwUtil::timeToKey(pExpire), dwIndex };
+    const auto it = std::lower_bound(m_vKeys.begin(), m_vKeys.end(), key, keyLess);
+    if (it != m_vKeys.end() && it->qwTime == key.qwTime && it->dwIndex == dwIndex)
+        m_vKeys.erase(it);
+}
+
+void ExpiryIndex::remapIndexes(const quint32* pNewIndexes, quint32 dwFirst)
+{
+    int nOut = 0;
+    for (int i = 0; i < m_vKeys.size(); ++i) {
+        Key key = m_vKeys[i];
+        if (key.dwIndex >= dwFirst) {
+            key.dwIndex = pNewIndexes[key.dwIndex];
+            if (key.dwIndex == REMOVED)
+                continue;
+        }
+        m_vKeys[nOut++] = key;
+    }
+    m_vKeys.resize(nOut);
+
+    // Deletions keep the order; moves only reorder entries with equal times
+    if (!std::is_sorted(m_vKeys.begin(), m_vKeys.end(), keyLess))
+        std::sort(m_vKeys.begin(), m_vKeys.end(), keyLess);
+}
+
+const ExpiryIndex::Key* ExpiryIndex::lowerBound(quint64 qwTime) const
+{
+    return std::lower_bound(begin(), end(), qwTime,
+                            [](const Key& key, quint64 qwValue) { return key.qwTime < qwValue; });
+}
@@ -0,0 +1,57 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef EXPIRY_INDEX_H
+#define EXPIRY_INDEX_H
+
+#include <QVector>
+#include "../PwStructs.h"
+
+/// Entry indexes sorted by expiration time (PwUtil::timeToKey), so the
+/// entries expiring in a time range are a binary search plus a walk over
+/// exactly these entries.
+class ExpiryIndex
+{
+public:
+    struct Key
+    {
+        quint64 qwTime;   ///< PwUtil::timeToKey() of the expiration time
+        quint32 dwIndex;  ///< Entry index
+    };
+
+    /// Marks a removed entry for remapIndexes()
+    static constexpr quint32 REMOVED = 0xFFFFFFFFU;
+
+    void insert(quint32 dwIndex, const PW_TIME* pExpire);
+
+    /// Remove an entry; pExpire must be the time it was inserted with
+    void remove(quint32 dwIndex, const PW_TIME* pExpire);
+
+    /// Renumber the entries with indexes >= dwFirst: index i becomes
+    /// pNewIndexes[i], or is dropped if that is REMOVED
+    void remapIndexes(const quint32* pNewIndexes, quint32 dwFirst);
+
+    /// First key with a time >= qwTime (end() if there is none)
+    [[nodiscard]] const Key* lowerBound(quint64 qwTime) const;
+
+    [[nodiscard]] const Key* begin() const { return m_vKeys.constData(); }
+    [[nodiscard]] const Key* end() const { return m_vKeys.constData() + m_vKeys.size(); }
+    [[nodiscard]] quint32 getCount() const { return static_cast<quint32>(m_vKeys.size()); }
+
+    void clear() { m_vKeys.clear(); }
+    void swap(ExpiryIndex& other) noexcept { m_vKeys.swap(other.m_vKeys); }
+
+private:
+    // Sorted by time, then by index
+    QVector<Key> m_vKeys;
+};
+
+#endif // EXPIRY_INDEX_H
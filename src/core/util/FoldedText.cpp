@@ -0,0 +1,151 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "FoldedText.h"
+#include <QChar>
+#include <QtAlgorithms>
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU, so no CPU check is needed
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOLDED_TEXT_SSE2 1
+#endif
+
+namespace {
+    constexpr uint REPLACEMENT_CHAR = 0xFFFD;
+
+    inline bool isContinuation(quint8 c)
+    {
+        return (c & 0xC0) == 0x80;
+    }
+
+    // Decodes one code point at pText[0..uLeft); malformed input (including
+    // overlong forms and surrogates) is one U+FFFD per byte
+    uint decode(const quint8* pText, size_t uLeft, size_t* puLength)
+    {
+        const quint8 c = pText[0];
+        *puLength = 1;
+        if (c < 0x80)
+            return c;
+
+        if (c >= 0xC2 && c <= 0xDF) {
+            if (uLeft >= 2 && isContinuation(pText[1])) {
+                *puLength = 2;
+                return (static_cast<uint>(c & 0x1F) << 6) | (pText[1] & 0x3F);
+            }
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            const quint8 uMin = (c == 0xE0) ? 0xA0 : 0x80;
+            const quint8 uMax = (c == 0xED) ? 0x9F : 0xBF;
+            if (uLeft >= 3 && pText[1] >= uMin && pText[1] <= uMax && isContinuation(pText[2])) {
+                *puLength = 3;
+                return (static_cast<uint>(c & 0x0F) << 12) | (static_cast<uint>(pText[1] & 0x3F) << 6) |
+                       (pText[2] & 0x3F);
+            }
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            const quint8 uMin = (c == 0xF0) ? 0x90 : 0x80;
+            const quint8 uMax = (c == 0xF4) ? 0x8F : 0xBF;
+            if (uLeft >= 4 && pText[1] >= uMin && pText[1] <= uMax && isContinuation(pText[2]) &&
+                isContinuation(pText[3])) {
+                *puLength = 4;
+                return (static_cast<uint>(c & 0x07) << 18) | (static_cast<uint>(pText[1] & 0x3F) << 12) |
+                       (static_cast<uint>(pText[2] & 0x3F) << 6) | (pText[3] & 0x3F);
+            }
+        }
+        return REPLACEMENT_CHAR;
+    }
+
+    inline char* encode(uint ucs4, char* pOut)
+    {
+        if (ucs4 < 0x80) {
+            *pOut++ = static_cast<char>(ucs4);
+        } else if (ucs4 < 0x800) {
+            *pOut++ = static_cast<char>(0xC0 | (ucs4 >> 6));
+            *pOut++ = static_cast<char>(0x80 | (ucs4 & 0x3F));
+        } else if (ucs4 < 0x10000) {
+            *pOut++ = static_cast<char>(0xE0 | (ucs4 >> 12));
+            *pOut++ = static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3F));
+            *pOut++ = static_cast<char>(0x80 | (ucs4 & 0x3F));
+        } else {
+            *pOut++ = static_cast<char>(0xF0 | (ucs4 >> 18));
+            *pOut++ = static_cast<char>(0x80 | ((ucs4 >> 12) & 0x3F));
+            *pOut++ = static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3F));
+            *pOut++ = static_cast<char>(0x80 | (ucs4 & 0x3F));
+        }
+        return pOut;
+    }
+}
+
+size_t FoldedText::fold(const char* pText, size_t uLength, char* pOut)
+{
+    const quint8* p = reinterpret_cast<const quint8*>(pText);
+    const quint8* pEnd = p + uLength;
+    char* pWrite = pOut;
+
+    while (p != pEnd) {
+        // Runs of ASCII, the common case, only need A-Z lowered
+        if (*p < 0x80) {
+            const quint8 c = *p++;
+            *pWrite++ = static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+            continue;
+        }
+
+        size_t uCodeLength = 0;
+        const uint ucs4 = decode(p, static_cast<size_t>(pEnd - p), &uCodeLength);
+        p += uCodeLength;
+        pWrite = encode(QChar::toCaseFolded(ucs4), pWrite);
+    }
+
+    return static_cast<size_t>(pWrite - pOut);
+}
+
+const char* FoldedText::find(const char* pText, size_t uLength, const char* pNeedle, size_t uNeedleLen)
+{
+    if (uNeedleLen == 0)
+        return pText;
+    if (uNeedleLen > uLength)
+        return nullptr;
+
+    // Candidates start at 0..uPositions-1. The first and the last byte of
+    // the needle are checked before the bytes in between.
+    const size_t uPositions = uLength - uNeedleLen + 1;
+    const size_t uLast = uNeedleLen - 1;
+    const size_t uMiddle = (uNeedleLen > 2) ? uNeedleLen - 2 : 0;
+    size_t i = 0;
+
+#if defined(FOLDED_TEXT_SSE2)
+    // 16 candidates per step; both loads end inside the text
+    const __m128i vFirst = _mm_set1_epi8(pNeedle[0]);
+    const __m128i vLast = _mm_set1_epi8(pNeedle[uLast]);
+    for (; i + 16 <= uPositions; i += 16) {
+        const __m128i vA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pText + i));
+        const __m128i vB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pText + i + uLast));
+        quint32 uMask = static_cast<quint32>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(vA, vFirst), _mm_cmpeq_epi8(vB, vLast))));
+        while (uMask != 0) {
+            const char* pCandidate = pText + i + qCountTrailingZeroBits(uMask);
+            if (std::memcmp(pCandidate + 1, pNeedle + 1, uMiddle) == 0)
+                return pCandidate;
+            uMask &= uMask - 1;
+        }
+    }
+#endif
+
+    while (i < uPositions) {
+        const char* pCandidate = static_cast<const char*>(std::memchr(pText + i, pNeedle[0], uPositions - i));
+        if (pCandidate == nullptr)
+            return nullptr;
+        if (pCandidate[uLast] == pNeedle[uLast] && std::memcmp(pCandidate + 1, pNeedle + 1, uMiddle) == 0)
+            return pCandidate;
+        i = static_cast<size_t>(pCandidate - pText) + 1;
+    }
+    return nullptr;
+}
@@ -0,0 +1,43 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef FOLDED_TEXT_H
+#define FOLDED_TEXT_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+/// Case folding and substring search on UTF-8 bytes, without QString.
+///
+/// fold() maps every code point like QString's case-insensitive compare
+/// does (QChar::toCaseFolded), so a case-insensitive QString::contains()
+/// is the same as find() on both folded texts. Malformed UTF-8 becomes
+/// U+FFFD per byte. Neither function allocates memory.
+namespace FoldedText {
+    /// Folded UTF-8 is at most this many times as long as the input
+    constexpr size_t MAX_EXPANSION = 3;
+
+    /// Fold uLength bytes of UTF-8 into pOut (room for MAX_EXPANSION * uLength)
+    /// @return Length of the folded text
+    size_t fold(const char* pText, size_t uLength, char* pOut);
+
+    /// First occurrence of the needle in the text (SSE2 where available).
+    /// An empty needle is found at the start.
+    /// @return Pointer into pText, or nullptr if there is none
+    const char* find(const char* pText, size_t uLength, const char* pNeedle, size_t uNeedleLen);
+
+    inline bool contains(const char* pText, size_t uLength, const char* pNeedle, size_t uNeedleLen)
+    {
+        return find(pText, uLength, pNeedle, uNeedleLen) != nullptr;
+    }
+}
+
+#endif // FOLDED_TEXT_H
@@ -0,0 +1,185 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "FoldedTextStore.h"
+#include "FoldedText.h"
+#include "../platform/SecureArena.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+    constexpr size_t MIN_COLUMN_BYTES = 4096;
+
+    // Columns with less unused space than this are never compacted
+    constexpr size_t MIN_COMPACT_BYTES = 64 * 1024;
+}
+
+FoldedTextStore::FoldedTextStore()
+{
+    std::memset(m_aColumns, 0, sizeof(m_aColumns));
+}
+
+FoldedTextStore::~FoldedTextStore()
+{
+    clear();
+}
+
+void FoldedTextStore::setRow(quint32 dwRow, const char* const* ppTexts)
+{
+    Q_ASSERT(dwRow <= getRowCount());
+
+    Row row;
+    for (int c = 0; c < ColumnCount; ++c)
+        row.aSpans[c] = append(static_cast<Column>(c), ppTexts[c]);
+
+    if (dwRow == getRowCount()) {
+        m_vRows.append(row);
+        return;
+    }
+
+    for (int c = 0; c < ColumnCount; ++c)
+        m_aColumns[c].uUnused += m_vRows[static_cast<int>(dwRow)].aSpans[c].uLength;
+    m_vRows[static_cast<int>(dwRow)] = row;
+    compactSparseColumns();
+}
+
+void FoldedTextStore::removeRows(const quint32* pRows, quint32 dwCount)
+{
+    if (dwCount == 0)
+        return;
+
+    // One pass moves the remaining rows down
+    int nOut = static_cast<int>(pRows[0]);
+    quint32 dwNext = 0;
+    for (int i = nOut; i < m_vRows.size(); ++i) {
+        if (dwNext < dwCount && pRows[dwNext] == static_cast<quint32>(i)) {
+            for (int c = 0; c < ColumnCount; ++c)
+                m_aColumns[c].uUnused += m_vRows[i].aSpans[c].uLength;
+            ++dwNext;
+            continue;
+        }
+        m_vRows[nOut++] = m_vRows[i];
+    }
+    m_vRows.resize(nOut);
+    compactSparseColumns();
+}
+
+void FoldedTextStore::moveRow(quint32 dwFrom, quint32 dwTo)
+{
+    Q_ASSERT(dwFrom < getRowCount() && dwTo < getRowCount());
+
+    Row* pRows = m_vRows.data();
+    if (dwFrom < dwTo)
+        std::rotate(pRows + dwFrom, pRows + dwFrom + 1, pRows + dwTo + 1);
+    else if (dwTo < dwFrom)
+        std::rotate(pRows + dwTo, pRows + dwFrom, pRows + dwFrom + 1);
+}
+
+void FoldedTextStore::remapRows(const quint32* pNewRows, quint32 dwFirst)
+{
+    const QVector<Row> vOld = m_vRows.mid(static_cast<int>(dwFirst));
+    for (int i = 0; i < vOld.size(); ++i)
+        m_vRows[static_cast<int>(pNewRows[dwFirst + static_cast<quint32>(i)])] = vOld[i];
+}
+
+void FoldedTextStore::clear()
+{
+    for (ColumnData& data : m_aColumns)
+        SecureArena::release(data.pData);  // Erases the texts
+    std::memset(m_aColumns, 0, sizeof(m_aColumns));
+    m_vRows.clear();
+}
+
+void FoldedTextStore::swap(FoldedTextStore& other) noexcept
+{
+    for (int c = 0; c < ColumnCount; ++c)
+        std::swap(m_aColumns[c], other.m_aColumns[c]);
+    m_vRows.swap(other.m_vRows);
+}
+
+FoldedTextStore::Stats FoldedTextStore::getStats() const
+{
+    Stats stats;
+    std::memset(&stats, 0, sizeof(Stats));
+    stats.uRows = getRowCount();
+    stats.uBytes = static_cast<size_t>(m_vRows.capacity()) * sizeof(Row);
+    for (const ColumnData& data : m_aColumns) {
+        stats.uBytes += data.uCapacity;
+        stats.uUnusedBytes += data.uUnused;
+    }
+    return stats;
+}
+
+FoldedTextStore::Span FoldedTextStore::append(Column column, const char* pszText)
+{
+    ColumnData& data = m_aColumns[column];
+    const size_t uLength = (pszText != nullptr) ? std::strlen(pszText) : 0;
+    reserve(data, data.uSize + uLength * FoldedText::MAX_EXPANSION);
+
+    Span span;
+    span.uOffset = static_cast<quint32>(data.uSize);
+    span.uLength = static_cast<quint32>(FoldedText::fold(pszText, uLength, data.pData + data.uSize));
+    data.uSize += span.uLength;
+    Q_ASSERT(data.uSize <= 0xFFFFFFFFU);
+    return span;
+}
+
+void FoldedTextStore::reserve(ColumnData& data, size_t uNeeded)
+{
+    if (uNeeded <= data.uCapacity)
+        return;
+
+    size_t uNewCapacity = qMax(MIN_COLUMN_BYTES, data.uCapacity * 2);
+    while (uNewCapacity < uNeeded)
+        uNewCapacity *= 2;
+
+    char* pNewData = static_cast<char*>(SecureArena::allocate(uNewCapacity));
+    if (pNewData == nullptr)
+        throw std::bad_alloc();
+    if (data.uSize != 0)
+        std::memcpy(pNewData, data.pData, data.uSize);
+
+    SecureArena::release(data.pData);
+    data.pData = pNewData;
+    data.uCapacity = uNewCapacity;
+}
+
+void FoldedTextStore::compact(Column column)
+{
+    // The live texts are copied in row order into a block of their size
+    ColumnData& data = m_aColumns[column];
+    const size_t uLive = data.uSize - data.uUnused;
+    ColumnData newData;
+    std::memset(&newData, 0, sizeof(ColumnData));
+    reserve(newData, uLive);
+
+    for (Row& row : m_vRows) {
+        Span& span = row.aSpans[column];
+        if (span.uLength != 0)
+            std::memcpy(newData.pData + newData.uSize, data.pData + span.uOffset, span.uLength);
+        span.uOffset = static_cast<quint32>(newData.uSize);
+        newData.uSize += span.uLength;
+    }
+
+    SecureArena::release(data.pData);
+    data = newData;
+}
+
+void FoldedTextStore::compactSparseColumns()
+{
+    for (int c = 0; c < ColumnCount; ++c) {
+        const ColumnData& data = m_aColumns[c];
+        if (data.uUnused >= MIN_COMPACT_BYTES && data.uUnused * 2 > data.uSize)
+            compact(static_cast<Column>(c));
+    }
+}
@@ -0,0 +1,111 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef FOLDED_TEXT_STORE_H
+#define FOLDED_TEXT_STORE_H
+
+#include <QVector>
+#include <cstddef>
+
+/// Case-folded copies (see FoldedText::fold) of the searchable text fields
+/// of all entries, one row per entry index.
+///
+/// Each column keeps the texts of all rows back to back in one SecureArena
+/// block, so a case-insensitive scan over a field reads one contiguous
+/// buffer and needs no conversion or allocation per entry. Replaced texts
+/// are appended; the column is compacted once half of it is unused.
+/// Passwords are not stored.
+class FoldedTextStore
+{
+public:
+    enum Column
+    {
+        Title = 0,
+        UserName,
+        Url,
+        Notes,
+        ColumnCount
+    };
+
+    /// Memory statistics
+    struct Stats
+    {
+        quint32 uRows;
+        size_t uBytes;        ///< Capacity of the column blocks and the row table
+        size_t uUnusedBytes;  ///< Texts that were replaced or removed, until compaction
+    };
+
+    FoldedTextStore();
+    ~FoldedTextStore();
+
+    FoldedTextStore(const FoldedTextStore&) = delete;
+    FoldedTextStore& operator=(const FoldedTextStore&) = delete;
+
+    /// Set the texts of a row (ColumnCount NUL-terminated UTF-8 strings,
+    /// nullptr allowed); dwRow == getRowCount() appends a row
+    void setRow(quint32 dwRow, const char* const* ppTexts);
+
+    /// Remove rows (ascending, no duplicates); the following rows move down
+    void removeRows(const quint32* pRows, quint32 dwCount);
+
+    /// Move a row to dwTo, shifting the rows in between by one
+    void moveRow(quint32 dwFrom, quint32 dwTo);
+
+    /// Renumber the rows >= dwFirst: row i becomes row pNewRows[i]
+    /// (a permutation of these rows)
+    void remapRows(const quint32* pNewRows, quint32 dwFirst);
+
+    /// Folded text of a row (not NUL-terminated)
+    const char* text(quint32 dwRow, Column column, size_t* puLength) const
+    {
+        const Span& span = m_vRows[static_cast<int>(dwRow)].aSpans[column];
+        *puLength = span.uLength;
+        return m_aColumns[column].pData + span.uOffset;
+    }
+
+    [[nodiscard]] quint32 getRowCount() const { return static_cast<quint32>(m_vRows.size()); }
+
+    /// Erase and free everything
+    void clear();
+
+    void swap(FoldedTextStore& other) noexcept;
+
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    struct Span
+    {
+        quint32 uOffset;
+        quint32 uLength;
+    };
+    struct Row
+    {
+        Span aSpans[ColumnCount];
+    };
+    struct ColumnData
+    {
+        char* pData;       // SecureArena block
+        size_t uSize;      // Bytes in use, including unused texts
+        size_t uCapacity;
+        size_t uUnused;    // Bytes of texts no row refers to any more
+    };
+
+    // Folds pszText onto the end of the column
+    Span append(Column column, const char* pszText);
+    void reserve(ColumnData& data, size_t uNeeded);
+    void compact(Column column);
+    void compactSparseColumns();
+
+    ColumnData m_aColumns[ColumnCount];
+    QVector<Row> m_vRows;
+};
+
+#endif // FOLDED_TEXT_STORE_H
@@ -0,0 +1,110 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "KeyTransformCalibrator.h"
+#include "../PwManager.h"
+#include "../platform/PwSettings.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+
+namespace {
+
+// Set while calibrateInBackground() is measuring
+std::atomic<bool> g_bCalibrating(false);
+
+void storeCalibration(const KeyTransform::Calibration& calibration)
+{
+    if (calibration.qwMedianRoundsPerSec == 0)
+        return;
+
+    PwSettings::instance().setKeyTransformCalibration(KeyTransformCalibrator::machineKey(calibration.backend),
+                                                      calibration.qwMedianRoundsPerSec,
+                                                      calibration.qwP95RoundsPerSec,
+                                                      QDateTime::currentDateTimeUtc());
+}
+
+} // namespace
+
+QString KeyTransformCalibrator::machineKey(KeyTransform::Backend backend)
+{
+    // The OpenSSL backend runs one thread per half, so a machine with a
+    // different core count (e.g. a resized VM) gets its own entry
+    return QString("%1|%2|%3 threads")
+        .arg(KeyTransform::cpuModelName(), QString::fromLatin1(KeyTransform::backendName(backend)))
+        .arg(QThread::idealThreadCount());
+}
+
+bool KeyTransformCalibrator::cached(KeyTransform::Calibration* pCalibration)
+{
+    const KeyTransform::Backend backend = KeyTransform::activeBackend();
+    quint64 qwMedian = 0;
+    quint64 qwP95 = 0;
+    QDateTime measured;
+    if (!PwSettings::instance().getKeyTransformCalibration(machineKey(backend), &qwMedian, &qwP95, &measured))
+        return false;
+
+    // Clock changes can put the date into the future; treat that as stale too
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (!measured.isValid() || (measured > now) || (measured.daysTo(now) > MAX_AGE_DAYS))
+        return false;
+
+    if (pCalibration != nullptr) {
+        pCalibration->backend = backend;
+        pCalibration->qwMedianRoundsPerSec = qwMedian;
+        pCalibration->qwP95RoundsPerSec = qMin(qwP95, qwMedian);
+        pCalibration->dwTrials = 0;  // Not known for stored results
+    }
+    return true;
+}
+
+KeyTransform::Calibration KeyTransformCalibrator::current(bool bRemeasure)
+{
+    KeyTransform::Calibration calibration;
+    if (!bRemeasure && cached(&calibration))
+        return calibration;
+
+    const KeyTransform::Backend backend = KeyTransform::activeBackend();
+    calibration = KeyTransform::calibrate(backend, TRIALS, TRIAL_MS);
+    storeCalibration(calibration);
+    return calibration;
+}
+
+void KeyTransformCalibrator::calibrateInBackground()
+{
+    QCoreApplication* pApp = QCoreApplication::instance();
+    if ((pApp == nullptr) || g_bCalibrating.exchange(true))
+        return;
+
+    // Only the measurement runs on the pool; PwSettings is not thread-safe,
+    // so the result is stored from the application's thread
+    const KeyTransform::Backend backend = KeyTransform::activeBackend();
+    QThreadPool::globalInstance()->start(QRunnable::create([pApp, backend]() {
+        const KeyTransform::Calibration calibration = KeyTransform::calibrate(backend, TRIALS, TRIAL_MS);
+        QMetaObject::invokeMethod(pApp, [calibration]() {
+            storeCalibration(calibration);
+            g_bCalibrating = false;
+        }, Qt::QueuedConnection);
+    }));
+}
+
+quint32 KeyTransformCalibrator::suggestRounds(quint32 dwTargetMs, bool bRemeasure, bool bKeepMinimum)
+{
+    if (dwTargetMs == 0)
+        dwTargetMs = static_cast<quint32>(qMax(PwSettings::instance().getKeyTransformTargetMs(), 1));
+
+    const quint32 dwMinimum = bKeepMinimum ? PWM_STD_KEYENCROUNDS : 1;
+    const quint32 dwRounds = KeyTransform::roundsForDuration(current(bRemeasure), dwTargetMs);
+    return qMax(dwRounds, dwMinimum);
+}
@@ -0,0 +1,56 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef KEY_TRANSFORM_CALIBRATOR_H
+#define KEY_TRANSFORM_CALIBRATOR_H
+
+#include "../crypto/KeyTransform.h"
+#include <QString>
+
+/// Per-machine key transformation speed, for suggesting round counts.
+///
+/// KeyTransform::calibrate() of the active backend is run once and stored
+/// in PwSettings under machineKey(), so the dialogs can translate between
+/// rounds and unlock time without benchmarking every time. A result is
+/// measured again when it is older than MAX_AGE_DAYS, or on request.
+class KeyTransformCalibrator
+{
+public:
+    /// Stored calibrations older than this are measured again
+    static constexpr qint64 MAX_AGE_DAYS = 90;
+
+    /// Trials of one measurement; with the warm-up, about one second in total
+    static constexpr quint32 TRIALS = 9;
+    static constexpr quint32 TRIAL_MS = 100;
+
+    /// @return Cache key of this machine: CPU model, backend and logical CPU count
+    static QString machineKey(KeyTransform::Backend backend);
+
+    /// Stored calibration of the active backend
+    /// @return false if there is none or it is out of date
+    static bool cached(KeyTransform::Calibration* pCalibration);
+
+    /// Stored calibration of the active backend; measured (about one second)
+    /// and stored first if there is none, it is out of date, or bRemeasure
+    static KeyTransform::Calibration current(bool bRemeasure = false);
+
+    /// Measure the active backend on the global thread pool and store the
+    /// result from the application's thread; for callers that must not
+    /// block (e.g. the GUI thread). Does nothing while a measurement runs.
+    static void calibrateInBackground();
+
+    /// Rounds that unlock a database in about dwTargetMs on this machine
+    /// @param dwTargetMs Target time, 0 = PwSettings::getKeyTransformTargetMs()
+    /// @return Round count, at least PWM_STD_KEYENCROUNDS when bKeepMinimum is set
+    static quint32 suggestRounds(quint32 dwTargetMs = 0, bool bRemeasure = false, bool bKeepMinimum = true);
+};
+
+#endif // KEY_TRANSFORM_CALIBRATOR_H
@@ -6,6 +6,8 @@
 */
 
 #include "PwUtil.h"
+#include "MemUtil.h"
+#include "../platform/SecureArena.h"
 #include <QFile>
 #include <QFileInfo>
 #include <cstring>
@@ -162,6 +164,23 @@ int PwUtil::compareTime(const PW_TIME* t1, const PW_TIME* t2)
     return 0;  // They are exactly the same
 }
 
+quint64 PwUtil::timeToKey(const PW_TIME* pTime)
+{
+    return (static_cast<quint64>(pTime->shYear) << 40) | (static_cast<quint64>(pTime->btMonth) << 32) |
+           (static_cast<quint64>(pTime->btDay) << 24) | (static_cast<quint64>(pTime->btHour) << 16) |
+           (static_cast<quint64>(pTime->btMinute) << 8) | pTime->btSecond;
+}
+
+void PwUtil::keyToTime(quint64 qwKey, PW_TIME* pTime)
+{
+    pTime->shYear = static_cast<USHORT>(qwKey >> 40);
+    pTime->btMonth = static_cast<BYTE>(qwKey >> 32);
+    pTime->btDay = static_cast<BYTE>(qwKey >> 24);
+    pTime->btHour = static_cast<BYTE>(qwKey >> 16);
+    pTime->btMinute = static_cast<BYTE>(qwKey >> 8);
+    pTime->btSecond = static_cast<BYTE>(qwKey);
+}
+
 //==============================================================================
 // Binary Attachment Functions
 //==============================================================================
@@ -216,6 +235,15 @@ bool PwUtil::attachFileAsBinaryData(PW_ENTRY* entry, const QString& filePath,
         return false;
     }
 
+    // Stored attachments live in the SecureArena
+    quint8* pData = static_cast<quint8*>(SecureArena::allocate(static_cast<size_t>(fileSize)));
+    if (pData == nullptr) {
+        if (errorMsg) *errorMsg = "Out of memory";
+        return false;
+    }
+    std::memcpy(pData, fileData.constData(), static_cast<size_t>(fileSize));
+    MemUtil::mem_erase(fileData.data(), static_cast<size_t>(fileData.size()));
+
     // Remove old attachment if present
     removeBinaryData(entry);
 
@@ -223,10 +251,8 @@ bool PwUtil::attachFileAsBinaryData(PW_ENTRY* entry, const QString& filePath,
     entry->pszBinaryDesc = new char[fileNameUtf8.size() + 1];
     std::strcpy(entry->pszBinaryDesc, fileNameUtf8.constData());
 
-    // Allocate and copy binary data
+    entry->pBinaryData = pData;
     entry->uBinaryDataLen = static_cast<quint32>(fileSize);
-    entry->pBinaryData = new quint8[entry->uBinaryDataLen];
-    std::memcpy(entry->pBinaryData, fileData.constData(), entry->uBinaryDataLen);
 
     return true;
 }
@@ -276,8 +302,8 @@ void PwUtil::removeBinaryData(PW_ENTRY* entry)
     if (!entry)
         return;
 
-    // Delete old binary data
-    delete[] entry->pBinaryData;
+    // Erase and release old binary data
+    SecureArena::release(entry->pBinaryData);
     entry->pBinaryData = nullptr;
     entry->uBinaryDataLen = 0;
 
@@ -50,6 +50,13 @@ public:
     /// Returns: -1 if t1 < t2, 0 if equal, 1 if t1 > t2
     static int compareTime(const PW_TIME* t1, const PW_TIME* t2);
 
+    /// Pack a PW_TIME into one integer that orders like compareTime():
+    /// year << 40 | month << 32 | day << 24 | hour << 16 | minute << 8 | second
+    static quint64 timeToKey(const PW_TIME* pTime);
+
+    /// Inverse of timeToKey()
+    static void keyToTime(quint64 qwKey, PW_TIME* pTime);
+
     //==========================================================================
     // Binary Attachment Functions
     //==========================================================================
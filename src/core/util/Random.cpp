@@ -10,16 +10,212 @@
 */
 
 #include "Random.h"
+#include "MemUtil.h"
+#include <QtEndian>
 #include <openssl/rand.h>
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <cstring>
 
+#ifdef Q_OS_UNIX
+#include <pthread.h>
+#endif
+
+namespace {
+    // Keystream produced per refill of a thread's buffer
+    constexpr size_t BUFFER_SIZE = 1024;
+
+    // Larger requests go to RAND_bytes directly: its per-call overhead no
+    // longer matters, and its AES-based DRBG is faster than portable ChaCha20
+    constexpr size_t DIRECT_THRESHOLD = BUFFER_SIZE;
+
+    // Reseed from RAND_bytes after this much output or time
+    constexpr quint64 RESEED_BYTES = 1024 * 1024;
+    constexpr std::chrono::minutes RESEED_INTERVAL(5);
+
+    // Bumped by addEntropy() and in a forked child; generators of an older
+    // epoch reseed before their next output
+    std::atomic<quint64> g_uSeedEpoch{0};
+
+    inline quint32 rotl32(quint32 v, int c)
+    {
+        return (v << c) | (v >> (32 - c));
+    }
+
+    inline void quarterRound(quint32* x, int a, int b, int c, int d)
+    {
+        x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 7);
+    }
+
+    // ChaCha20 block function (RFC 8439, section 2.3): 64 bytes of keystream
+    void chacha20Block(const quint32* pState16, quint8* pOut64)
+    {
+        quint32 x[16];
+        std::memcpy(x, pState16, sizeof(x));
+
+        for (int i = 0; i < 10; ++i) {
+            quarterRound(x, 0, 4, 8, 12);
+            quarterRound(x, 1, 5, 9, 13);
+            quarterRound(x, 2, 6, 10, 14);
+            quarterRound(x, 3, 7, 11, 15);
+            quarterRound(x, 0, 5, 10, 15);
+            quarterRound(x, 1, 6, 11, 12);
+            quarterRound(x, 2, 7, 8, 13);
+            quarterRound(x, 3, 4, 9, 14);
+        }
+
+        for (int i = 0; i < 16; ++i)
+            qToLittleEndian<quint32>(x[i] + pState16[i], pOut64 + 4 * i);
+
+        MemUtil::mem_erase(x, sizeof(x));
+    }
+
+    /// Per-thread ChaCha20 generator with fast key erasure
+    class ThreadGenerator
+    {
+    public:
+        ThreadGenerator()
+            : m_uPos(BUFFER_SIZE)
+            , m_uBytesSinceSeed(0)
+            , m_uEpoch(0)
+            , m_bSeeded(false)
+        {
+            std::memset(m_aState, 0, sizeof(m_aState));
+            std::memset(m_aBuffer, 0, sizeof(m_aBuffer));
+        }
+
+        ~ThreadGenerator()
+        {
+            MemUtil::mem_erase(m_aState, sizeof(m_aState));
+            MemUtil::mem_erase(m_aBuffer, sizeof(m_aBuffer));
+        }
+
+        ThreadGenerator(const ThreadGenerator&) = delete;
+        ThreadGenerator& operator=(const ThreadGenerator&) = delete;
+
+        bool read(quint8* pOut, size_t uSize)
+        {
+            // Bytes buffered before a fork or addEntropy() are dropped, so
+            // the next generate() reseeds: otherwise a forked child would
+            // hand out the same unserved bytes as its parent
+            if (m_uEpoch != g_uSeedEpoch.load(std::memory_order_acquire) && m_uPos != BUFFER_SIZE) {
+                MemUtil::mem_erase(m_aBuffer, sizeof(m_aBuffer));
+                m_uPos = BUFFER_SIZE;
+            }
+
+            while (uSize > 0) {
+                if (m_uPos == BUFFER_SIZE) {
+                    if (!generate(m_aBuffer))
+                        return false;
+                    m_uPos = 0;
+                }
+
+                const size_t uTake = qMin(uSize, BUFFER_SIZE - m_uPos);
+                std::memcpy(pOut, m_aBuffer + m_uPos, uTake);
+                std::memset(m_aBuffer + m_uPos, 0, uTake);  // Served bytes do not stay around
+                m_uPos += uTake;
+                pOut += uTake;
+                uSize -= uTake;
+            }
+            return true;
+        }
+
+    private:
+        // BUFFER_SIZE bytes of keystream to pOut, then replace the key
+        bool generate(quint8* pOut)
+        {
+            const quint64 uEpoch = g_uSeedEpoch.load(std::memory_order_acquire);
+            if (!m_bSeeded || m_uEpoch != uEpoch || m_uBytesSinceSeed >= RESEED_BYTES ||
+                std::chrono::steady_clock::now() - m_seedTime >= RESEED_INTERVAL) {
+                if (!reseed(uEpoch))
+                    return false;
+            }
+
+            m_aState[12] = 0;
+            m_aState[13] = 0;
+            for (size_t i = 0; i < BUFFER_SIZE / 64; ++i) {
+                chacha20Block(m_aState, pOut + 64 * i);
+                ++m_aState[12];
+            }
+
+            // The next block becomes the key, so earlier output cannot be
+            // recomputed from the state
+            quint8 aNext[64];
+            chacha20Block(m_aState, aNext);
+            for (int i = 0; i < 8; ++i)
+                m_aState[4 + i] = qFromLittleEndian<quint32>(aNext + 4 * i);
+            MemUtil::mem_erase(aNext, sizeof(aNext));
+
+            m_uBytesSinceSeed += BUFFER_SIZE;
+            return true;
+        }
+
+        // Mix 32 bytes from RAND_bytes into the key
+        bool reseed(quint64 uEpoch)
+        {
+            quint8 aSeed[32];
+            if (!Random::fillBufferDirect(aSeed, sizeof(aSeed)))
+                return false;
+
+            // "expand 32-byte k"; words 12-15 are the block counter and a zero nonce
+            m_aState[0] = 0x61707865;
+            m_aState[1] = 0x3320646e;
+            m_aState[2] = 0x79622d32;
+            m_aState[3] = 0x6b206574;
+            for (int i = 0; i < 8; ++i)
+                m_aState[4 + i] ^= qFromLittleEndian<quint32>(aSeed + 4 * i);
+            MemUtil::mem_erase(aSeed, sizeof(aSeed));
+
+            // Buffered bytes came from the old key
+            MemUtil::mem_erase(m_aBuffer, sizeof(m_aBuffer));
+            m_uPos = BUFFER_SIZE;
+
+            m_uBytesSinceSeed = 0;
+            m_seedTime = std::chrono::steady_clock::now();
+            m_uEpoch = uEpoch;
+            m_bSeeded = true;
+            return true;
+        }
+
+        quint32 m_aState[16];
+        quint8 m_aBuffer[BUFFER_SIZE];
+        size_t m_uPos;  // Bytes before it have been served (and zeroed)
+        quint64 m_uBytesSinceSeed;
+        std::chrono::steady_clock::time_point m_seedTime;
+        quint64 m_uEpoch;
+        bool m_bSeeded;
+    };
+
+#ifdef Q_OS_UNIX
+    void reseedAfterFork()
+    {
+        g_uSeedEpoch.fetch_add(1, std::memory_order_release);
+    }
+#endif
+
+    ThreadGenerator& threadGenerator()
+    {
+#ifdef Q_OS_UNIX
+        // A forked child must not repeat the parent's output
+        static const bool s_bAtForkRegistered = (pthread_atfork(nullptr, nullptr, reseedAfterFork) == 0);
+        Q_UNUSED(s_bAtForkRegistered);
+#endif
+        thread_local ThreadGenerator generator;
+        return generator;
+    }
+}
+
 QByteArray Random::generateBytes(int count)
 {
     if (count <= 0)
         return QByteArray();
 
     QByteArray result(count, 0);
-    if (RAND_bytes(reinterpret_cast<unsigned char*>(result.data()), count) != 1) {
+    if (!fillBuffer(reinterpret_cast<quint8*>(result.data()), static_cast<size_t>(count))) {
         // Failed to generate random bytes
         result.clear();
     }
@@ -32,6 +228,16 @@ bool Random::fillBuffer(quint8* buffer, size_t size)
     if (!buffer || size == 0)
         return false;
 
+    if (size >= DIRECT_THRESHOLD)
+        return fillBufferDirect(buffer, size);
+    return threadGenerator().read(buffer, size);
+}
+
+bool Random::fillBufferDirect(quint8* buffer, size_t size)
+{
+    if (!buffer || size == 0 || size > static_cast<size_t>(INT_MAX))
+        return false;
+
     return RAND_bytes(buffer, static_cast<int>(size)) == 1;
 }
 
@@ -49,6 +255,20 @@ quint64 Random::generateUInt64()
     return value;
 }
 
+quint32 Random::uniform(quint32 n)
+{
+    if (n == 0)
+        return 0;
+
+    // Values below 2^32 mod n would make the low results more likely
+    const quint32 uThreshold = (0u - n) % n;
+    for (;;) {
+        const quint32 value = generateUInt32();
+        if (value >= uThreshold)
+            return value % n;
+    }
+}
+
 bool Random::generateUuid(quint8* uuid)
 {
     if (!uuid)
@@ -58,6 +278,14 @@ bool Random::generateUuid(quint8* uuid)
     return fillBuffer(uuid, 16);
 }
 
+bool Random::generateUuids(quint8* uuids, size_t count)
+{
+    if (!uuids || count == 0)
+        return false;
+
+    return fillBuffer(uuids, count * 16);
+}
+
 void Random::addEntropy(const void* data, size_t size)
 {
     if (!data || size == 0)
@@ -67,4 +295,7 @@ void Random::addEntropy(const void* data, size_t size)
     // The second parameter (entropy estimate) is set to 0.0 because
     // we don't know how much entropy the data actually contains
     RAND_add(data, static_cast<int>(size), 0.0);
+
+    // Let the per-thread generators pick it up
+    g_uSeedEpoch.fetch_add(1, std::memory_order_release);
 }
@@ -16,7 +16,15 @@
 #include <QByteArray>
 
 /// Cross-platform cryptographic random number generator
-/// Uses OpenSSL RAND_bytes() for cryptographic quality randomness
+///
+/// Every thread has a buffered ChaCha20 generator keyed from OpenSSL
+/// RAND_bytes(), so small requests (integers, UUIDs, password characters)
+/// do not each go through OpenSSL's locked DRBG; requests of 1 KB and more
+/// still do. After every refill of the
+/// buffer the key is replaced by fresh keystream (fast key erasure), and
+/// served bytes are wiped from the buffer. The generator is reseeded from
+/// RAND_bytes() after 1 MB of output, after 5 minutes, after addEntropy()
+/// and in the child after fork().
 class Random
 {
 public:
@@ -31,6 +39,10 @@ public:
     /// @return true on success, false on failure
     static bool fillBuffer(quint8* buffer, size_t size);
 
+    /// fillBuffer() straight from OpenSSL RAND_bytes(), bypassing the
+    /// per-thread generator (used for its seed)
+    static bool fillBufferDirect(quint8* buffer, size_t size);
+
     /// Generate a random 32-bit unsigned integer
     /// @return Random uint32 value
     static quint32 generateUInt32();
@@ -39,13 +51,25 @@ public:
     /// @return Random uint64 value
     static quint64 generateUInt64();
 
+    /// Uniformly distributed integer below n, without modulo bias
+    /// (rejection sampling)
+    /// @param n Upper bound (exclusive); 0 returns 0
+    /// @return Random value in [0, n)
+    static quint32 uniform(quint32 n);
+
     /// Generate a random UUID (16 bytes)
     /// @param uuid Pointer to 16-byte buffer to fill with UUID
     /// @return true on success, false on failure
     static bool generateUuid(quint8* uuid);
 
+    /// Generate count UUIDs in one call
+    /// @param uuids Buffer of count * 16 bytes
+    /// @return true on success, false on failure
+    static bool generateUuids(quint8* uuids, size_t count);
+
     /// Add entropy to the random number generator pool
-    /// This can be used to mix in additional randomness from user events
+    /// This can be used to mix in additional randomness from user events;
+    /// the per-thread generators reseed before their next output
     /// @param data Pointer to data to add as entropy
     /// @param size Size of data in bytes
     static void addEntropy(const void* data, size_t size);
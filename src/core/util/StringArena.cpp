@@ -0,0 +1,246 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "StringArena.h"
+#include "MemUtil.h"
+#include "../crypto/MemoryProtection.h"
+#include "../platform/SecureArena.h"
+#include <cstring>
+#include <utility>
+
+namespace {
+    // Slab size; a database with a few thousand entries fits in a handful
+    constexpr size_t SLAB_SIZE = 64 * 1024;
+
+    // Strings needing more than this get a slab of their own, so that the
+    // slab being filled is not abandoned half-empty
+    constexpr size_t DEDICATED_SLAB_THRESHOLD = SLAB_SIZE / 4;
+
+    // Block capacities are multiples of GRANULE; each block is preceded by
+    // a header holding its capacity
+    constexpr size_t GRANULE = 8;
+    constexpr size_t HEADER_SIZE = sizeof(quint64);
+
+    // Released blocks up to this capacity go to exact size-class free lists
+    constexpr size_t MAX_POOLED_CAPACITY = 1024;
+
+    const char EMPTY_STRING[] = "";
+}
+
+StringArena::StringArena()
+    : m_stats{}
+    , m_bLockMemory(false)
+{
+    m_vFreeLists.resize(static_cast<int>(MAX_POOLED_CAPACITY / GRANULE) + 1);
+}
+
+StringArena::~StringArena()
+{
+    clear();
+}
+
+char* StringArena::dup(const char* psz)
+{
+    return assign(nullptr, psz);
+}
+
+char* StringArena::assign(char* pszOld, const char* pszNew)
+{
+    if (pszNew == nullptr)
+        pszNew = EMPTY_STRING;
+    if (pszOld == pszNew)
+        return pszOld;
+
+    const size_t uSize = std::strlen(pszNew) + 1;
+
+    // Overwrite in place if the new value fits into the old block
+    if (pszOld != nullptr) {
+        const size_t uCapacity = blockCapacity(pszOld);
+        if (uSize <= uCapacity) {
+            std::memmove(pszOld, pszNew, uSize);
+            MemUtil::mem_erase(pszOld + uSize, uCapacity - uSize);
+            ++m_stats.uInPlaceUpdates;
+            return pszOld;
+        }
+    }
+
+    char* pszCopy = allocate(uSize);
+    std::memcpy(pszCopy, pszNew, uSize);
+    release(pszOld);
+    return pszCopy;
+}
+
+void StringArena::release(char* psz)
+{
+    if (psz == nullptr)
+        return;
+
+    const size_t uCapacity = blockCapacity(psz);
+    MemUtil::mem_erase(psz, uCapacity);
+    m_stats.uBytesInUse -= HEADER_SIZE + uCapacity;
+
+    if (uCapacity <= MAX_POOLED_CAPACITY)
+        m_vFreeLists[static_cast<int>(uCapacity / GRANULE)].append(psz);
+    else
+        m_vLargeFree.append(psz);
+}
+
+void StringArena::clear()
+{
+    for (Slab& slab : m_vSlabs) {
+        if (slab.bSecure) {
+            SecureArena::release(slab.pData);  // Erases the whole slab
+            continue;
+        }
+
+        // Released blocks are already erased, but live ones are not
+        MemUtil::mem_erase(slab.pData, slab.uUsed);
+        if (slab.bLocked)
+            MemoryProtection::unlockMemory(slab.pData, slab.uSize);
+        delete[] slab.pData;
+    }
+    m_vSlabs.clear();
+
+    for (QVector<char*>& vFree : m_vFreeLists)
+        vFree.clear();
+    m_vLargeFree.clear();
+
+    m_stats = Stats{};
+}
+
+void StringArena::setLockMemory(bool bLock)
+{
+    m_bLockMemory = bLock;
+
+    // Heap slabs are locked one by one; SecureArena slabs keep their state
+    for (Slab& slab : m_vSlabs) {
+        if (slab.bSecure)
+            continue;
+        if (bLock && !slab.bLocked) {
+            slab.bLocked = MemoryProtection::lockMemory(slab.pData, slab.uSize);
+        } else if (!bLock && slab.bLocked) {
+            MemoryProtection::unlockMemory(slab.pData, slab.uSize);
+            slab.bLocked = false;
+        }
+    }
+}
+
+void StringArena::swap(StringArena& other) noexcept
+{
+    m_vSlabs.swap(other.m_vSlabs);
+    m_vFreeLists.swap(other.m_vFreeLists);
+    m_vLargeFree.swap(other.m_vLargeFree);
+    std::swap(m_stats, other.m_stats);
+    std::swap(m_bLockMemory, other.m_bLockMemory);
+}
+
+bool StringArena::isMemoryLocked() const
+{
+    if (!m_bLockMemory)
+        return false;
+
+    for (const Slab& slab : m_vSlabs) {
+        if (!slab.bLocked)
+            return false;
+    }
+    return true;
+}
+
+char* StringArena::allocate(size_t uSize)
+{
+    const size_t uCapacity = ((uSize + GRANULE - 1) / GRANULE) * GRANULE;
+    ++m_stats.uStringAllocations;
+
+    // Recycle a released block if possible
+    char* psz = nullptr;
+    if (uCapacity <= MAX_POOLED_CAPACITY) {
+        QVector<char*>& vFree = m_vFreeLists[static_cast<int>(uCapacity / GRANULE)];
+        if (!vFree.isEmpty()) {
+            psz = vFree.takeLast();
+        }
+    } else {
+        for (int i = 0; i < m_vLargeFree.size(); ++i) {
+            if (blockCapacity(m_vLargeFree[i]) >= uCapacity) {
+                psz = m_vLargeFree[i];
+                m_vLargeFree[i] = m_vLargeFree.last();
+                m_vLargeFree.removeLast();
+                break;
+            }
+        }
+    }
+
+    if (psz != nullptr) {
+        ++m_stats.uRecycledBlocks;
+        m_stats.uBytesInUse += HEADER_SIZE + blockCapacity(psz);
+        return psz;
+    }
+
+    return allocateFromSlab(uCapacity);
+}
+
+char* StringArena::allocateFromSlab(size_t uCapacity)
+{
+    const size_t uNeeded = HEADER_SIZE + uCapacity;
+
+    Slab* pSlab = nullptr;
+    if (uNeeded > DEDICATED_SLAB_THRESHOLD) {
+        pSlab = addSlab(uNeeded, true);
+    } else {
+        if (m_vSlabs.isEmpty() || (m_vSlabs.last().uSize - m_vSlabs.last().uUsed) < uNeeded) {
+            addSlab(SLAB_SIZE, false);
+        }
+        pSlab = &m_vSlabs.last();
+    }
+
+    char* pBlock = pSlab->pData + pSlab->uUsed;
+    pSlab->uUsed += uNeeded;
+    m_stats.uBytesInUse += uNeeded;
+
+    const quint64 uHeader = uCapacity;
+    std::memcpy(pBlock, &uHeader, HEADER_SIZE);
+    return pBlock + HEADER_SIZE;
+}
+
+StringArena::Slab* StringArena::addSlab(size_t uSize, bool bDedicated)
+{
+    Slab slab;
+    slab.uUsed = 0;
+    slab.pData = m_bLockMemory ? static_cast<char*>(SecureArena::allocate(uSize)) : nullptr;
+    slab.bSecure = (slab.pData != nullptr);
+    if (slab.bSecure) {
+        // Locked (best effort) and kept out of core dumps with its mapping
+        slab.uSize = SecureArena::capacity(slab.pData);
+        slab.bLocked = SecureArena::isLocked(slab.pData);
+    } else {
+        slab.uSize = uSize;
+        slab.pData = new char[slab.uSize];
+        slab.bLocked = m_bLockMemory && MemoryProtection::lockMemory(slab.pData, slab.uSize);
+    }
+
+    ++m_stats.uSlabAllocations;
+    m_stats.uBytesReserved += slab.uSize;
+
+    // Dedicated slabs go in front of the slab currently being filled
+    if (bDedicated && !m_vSlabs.isEmpty()) {
+        m_vSlabs.insert(m_vSlabs.size() - 1, slab);
+        return &m_vSlabs[m_vSlabs.size() - 2];
+    }
+
+    m_vSlabs.append(slab);
+    return &m_vSlabs.last();
+}
+
+size_t StringArena::blockCapacity(const char* psz)
+{
+    quint64 uCapacity = 0;
+    std::memcpy(&uCapacity, psz - HEADER_SIZE, HEADER_SIZE);
+    return static_cast<size_t>(uCapacity);
+}
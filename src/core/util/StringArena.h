@@ -0,0 +1,100 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <QVector>
+#include <cstddef>
+
+/// Slab allocator for the string fields of one database.
+///
+/// Strings are carved out of large chunks ("slabs") instead of getting one
+/// heap block each. Every block remembers its capacity, so a new value that
+/// fits is written over the old one in place. Released blocks are erased and
+/// recycled through size-class free lists. clear() erases and frees all
+/// slabs at once; optionally, every slab is locked into RAM.
+///
+/// With locking enabled, new slabs come from the SecureArena (locked and
+/// excluded from core dumps per mapping); slabs created before that are
+/// locked one by one.
+class StringArena
+{
+public:
+    /// Allocation statistics, reset by clear()
+    struct Stats
+    {
+        quint64 uSlabAllocations;    ///< Heap allocations made for slabs
+        quint64 uStringAllocations;  ///< Blocks handed out (new or recycled)
+        quint64 uInPlaceUpdates;     ///< assign() calls that reused the old block
+        quint64 uRecycledBlocks;     ///< Allocations served from a free list
+        size_t uBytesReserved;       ///< Total size of all slabs
+        size_t uBytesInUse;          ///< Bytes in live blocks, headers included
+    };
+
+    StringArena();
+    ~StringArena();
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    /// Copy a NUL-terminated string into the arena (nullptr is copied as "")
+    char* dup(const char* psz);
+
+    /// Replace pszOld (an arena string or nullptr) by a copy of pszNew.
+    /// The old block is reused when the new value fits, otherwise it is
+    /// released. pszNew may point into pszOld.
+    /// @return The string to store in place of pszOld
+    char* assign(char* pszOld, const char* pszNew);
+
+    /// Erase an arena string and put its block on a free list
+    void release(char* psz);
+
+    /// Erase and free all slabs; every string handed out becomes invalid
+    void clear();
+
+    /// Lock all current and future slabs into RAM (mlock / VirtualLock).
+    /// Locking is best effort, see isMemoryLocked(). Disabling it leaves
+    /// the SecureArena slabs locked.
+    void setLockMemory(bool bLock);
+
+    /// @return true if locking is enabled and every slab is locked
+    [[nodiscard]] bool isMemoryLocked() const;
+
+    /// Exchange all slabs, free lists and statistics with another arena;
+    /// the strings of both stay valid and change owner
+    void swap(StringArena& other) noexcept;
+
+    [[nodiscard]] Stats getStats() const { return m_stats; }
+
+private:
+    struct Slab
+    {
+        char* pData;
+        size_t uSize;
+        size_t uUsed;
+        bool bLocked;
+        bool bSecure;  // From SecureArena instead of new[]
+    };
+
+    char* allocate(size_t uSize);
+    char* allocateFromSlab(size_t uCapacity);
+    Slab* addSlab(size_t uSize, bool bDedicated);
+    static size_t blockCapacity(const char* psz);
+
+    QVector<Slab> m_vSlabs;                // The last slab is the one being filled
+    QVector<QVector<char*>> m_vFreeLists;  // Indexed by capacity / GRANULE
+    QVector<char*> m_vLargeFree;           // Released blocks above the largest size class
+    Stats m_stats;
+    bool m_bLockMemory;
+};
+
+#endif // STRING_ARENA_H
@@ -0,0 +1,375 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "TrigramIndex.h"
+#include "FoldedText.h"
+#include "MemUtil.h"
+#include "../platform/SecureArena.h"
+#include <QByteArray>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+    constexpr quint32 MIN_SLOTS = 1024;
+
+    inline quint32 trigramKey(quint8 b0, quint8 b1, quint8 b2)
+    {
+        return (static_cast<quint32>(b0) << 16) | (static_cast<quint32>(b1) << 8) | b2;
+    }
+
+    inline quint8 asciiLower(quint8 c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<quint8>(c + ('a' - 'A')) : c;
+    }
+
+    inline quint32 slotHash(quint32 uKey)
+    {
+        quint32 h = uKey * 0x9E3779B1U;
+        return h ^ (h >> 16);
+    }
+
+    void appendTrigrams(const char* pszText, QVector<quint32>& vKeys)
+    {
+        if (pszText == nullptr)
+            return;
+        const size_t uLength = std::strlen(pszText);
+        if (uLength < 3)
+            return;
+
+        const quint8* pText = reinterpret_cast<const quint8*>(pszText);
+        quint8 uBits = 0;
+        for (size_t i = 0; i < uLength; ++i)
+            uBits |= pText[i];
+
+        if ((uBits & 0x80) == 0) {
+            for (size_t i = 0; i + 3 <= uLength; ++i)
+                vKeys.append(trigramKey(asciiLower(pText[i]), asciiLower(pText[i + 1]), asciiLower(pText[i + 2])));
+            return;
+        }
+
+        // Non-ASCII text is folded like the search does it; the copy is erased
+        QByteArray baFolded(static_cast<int>(uLength * FoldedText::MAX_EXPANSION), '\0');
+        const size_t uFolded = FoldedText::fold(pszText, uLength, baFolded.data());
+        const quint8* pFolded = reinterpret_cast<const quint8*>(baFolded.constData());
+        for (size_t i = 0; i + 3 <= uFolded; ++i)
+            vKeys.append(trigramKey(pFolded[i], pFolded[i + 1], pFolded[i + 2]));
+
+        MemUtil::mem_erase(baFolded.data(), uFolded);
+    }
+}
+
+TrigramIndex::TrigramIndex()
+    : m_pSlots(nullptr)
+    , m_uSlotCount(0)
+    , m_uUsedSlots(0)
+    , m_uDocuments(0)
+{
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    clear();
+}
+
+void TrigramIndex::collectTrigrams(const char* const* ppTexts, int nTexts, QVector<quint32>& vKeys)
+{
+    for (int i = 0; i < nTexts; ++i)
+        appendTrigrams(ppTexts[i], vKeys);
+
+    std::sort(vKeys.begin(), vKeys.end());
+    vKeys.erase(std::unique(vKeys.begin(), vKeys.end()), vKeys.end());
+}
+
+void TrigramIndex::add(quint32 dwId, const char* const* ppTexts, int nTexts)
+{
+    QVector<quint32> vKeys;
+    collectTrigrams(ppTexts, nTexts, vKeys);
+    for (quint32 uKey : vKeys)
+        insertId(insertSlot(uKey), dwId);
+    ++m_uDocuments;
+
+    // The keys are pieces of the (possibly sensitive) text
+    MemUtil::mem_erase(vKeys.data(), static_cast<size_t>(vKeys.size()) * sizeof(quint32));
+}
+
+void TrigramIndex::remove(quint32 dwId, const char* const* ppTexts, int nTexts)
+{
+    QVector<quint32> vKeys;
+    collectTrigrams(ppTexts, nTexts, vKeys);
+    for (quint32 uKey : vKeys) {
+        Slot* pSlot = findSlot(uKey);
+        if (pSlot != nullptr)
+            removeId(pSlot, dwId);
+    }
+    if (m_uDocuments > 0)
+        --m_uDocuments;
+
+    MemUtil::mem_erase(vKeys.data(), static_cast<size_t>(vKeys.size()) * sizeof(quint32));
+}
+
+void TrigramIndex::remapIds(const quint32* pNewIds, quint32 dwFirst)
+{
+    for (quint32 s = 0; s < m_uSlotCount; ++s) {
+        Slot& slot = m_pSlots[s];
+        if (slot.uCount == 0)
+            continue;
+
+        // IDs below dwFirst keep their numbers, the others stay above them
+        quint32* pIds = slot.ids();
+        quint32* pEnd = pIds + slot.uCount;
+        quint32* pFirst = std::lower_bound(pIds, pEnd, dwFirst);
+        for (quint32* p = pFirst; p != pEnd; ++p)
+            *p = pNewIds[*p];
+        if (!std::is_sorted(pFirst, pEnd))
+            std::sort(pFirst, pEnd);
+
+        // A document that was not removed completely may now collide with another
+        quint32* pUniqueEnd = std::unique(pFirst, pEnd);
+        if (pUniqueEnd != pEnd) {
+            std::fill(pUniqueEnd, pEnd, 0U);
+            slot.uCount = static_cast<quint32>(pUniqueEnd - pIds);
+        }
+    }
+}
+
+bool TrigramIndex::lookup(const QString& text, QVector<quint32>* pIds) const
+{
+    pIds->clear();
+
+    QByteArray baText = text.toUtf8();
+    const char* pszText = baText.constData();
+    QVector<quint32> vKeys;
+    collectTrigrams(&pszText, 1, vKeys);
+    MemUtil::mem_erase(baText.data(), static_cast<size_t>(baText.size()));
+    if (vKeys.isEmpty())
+        return false;
+
+    QVector<const Slot*> vSlots;
+    vSlots.reserve(vKeys.size());
+    for (quint32 uKey : vKeys) {
+        const Slot* pSlot = findSlot(uKey);
+        if (pSlot == nullptr || pSlot->uCount == 0) {
+            vSlots.clear();  // Some trigram occurs nowhere
+            break;
+        }
+        vSlots.append(pSlot);
+    }
+    MemUtil::mem_erase(vKeys.data(), static_cast<size_t>(vKeys.size()) * sizeof(quint32));
+    if (vSlots.isEmpty())
+        return true;
+
+    // Intersect, shortest posting list first
+    std::sort(vSlots.begin(), vSlots.end(), [](const Slot* a, const Slot* b) {
+        return a->uCount < b->uCount;
+    });
+
+    const quint32* pFirst = vSlots.first()->ids();
+    pIds->reserve(static_cast<int>(vSlots.first()->uCount));
+    for (quint32 i = 0; i < vSlots.first()->uCount; ++i)
+        pIds->append(pFirst[i]);
+
+    for (int i = 1; i < vSlots.size() && !pIds->isEmpty(); ++i) {
+        const quint32* pList = vSlots[i]->ids();
+        const quint32* pListEnd = pList + vSlots[i]->uCount;
+
+        // Candidates are looked up in a much longer list, otherwise merged;
+        // the survivors are compacted in place
+        const bool bSearch = static_cast<quint64>(pIds->size()) * 16 < vSlots[i]->uCount;
+        quint32* pOut = pIds->data();
+        for (const quint32* p = pIds->constData(); p != pIds->constData() + pIds->size(); ++p) {
+            if (bSearch) {
+                pList = std::lower_bound(pList, pListEnd, *p);
+            } else {
+                while (pList != pListEnd && *pList < *p)
+                    ++pList;
+            }
+            if (pList == pListEnd)
+                break;
+            if (*pList == *p)
+                *pOut++ = *p;
+        }
+        pIds->resize(static_cast<int>(pOut - pIds->constData()));
+    }
+    return true;
+}
+
+void TrigramIndex::clear()
+{
+    for (quint32 s = 0; s < m_uSlotCount; ++s)
+        releaseIds(&m_pSlots[s]);
+    SecureArena::release(m_pSlots);  // Erases the keys
+
+    m_pSlots = nullptr;
+    m_uSlotCount = 0;
+    m_uUsedSlots = 0;
+    m_uDocuments = 0;
+}
+
+void TrigramIndex::swap(TrigramIndex& other) noexcept
+{
+    std::swap(m_pSlots, other.m_pSlots);
+    std::swap(m_uSlotCount, other.m_uSlotCount);
+    std::swap(m_uUsedSlots, other.m_uUsedSlots);
+    std::swap(m_uDocuments, other.m_uDocuments);
+}
+
+TrigramIndex::Stats TrigramIndex::getStats() const
+{
+    Stats stats;
+    std::memset(&stats, 0, sizeof(Stats));
+    stats.uDocuments = m_uDocuments;
+    stats.uBytes = static_cast<size_t>(m_uSlotCount) * sizeof(Slot);
+    for (quint32 s = 0; s < m_uSlotCount; ++s) {
+        const Slot& slot = m_pSlots[s];
+        if (slot.uCount != 0)
+            ++stats.uTrigrams;
+        stats.uPostings += slot.uCount;
+        if (slot.uCapacity > INLINE_IDS)
+            stats.uBytes += static_cast<size_t>(slot.uCapacity) * sizeof(quint32);
+    }
+    stats.uBytesPerDocument = (m_uDocuments != 0) ? stats.uBytes / m_uDocuments : 0;
+    return stats;
+}
+
+TrigramIndex::Slot* TrigramIndex::findSlot(quint32 uKey) const
+{
+    if (m_uSlotCount == 0)
+        return nullptr;
+
+    // Linear probing; keys are never removed, so an unused slot ends the run
+    const quint32 uMask = m_uSlotCount - 1;
+    for (quint32 s = slotHash(uKey) & uMask;; s = (s + 1) & uMask) {
+        if (m_pSlots[s].uKey == uKey)
+            return &m_pSlots[s];
+        if (m_pSlots[s].uKey == 0)
+            return nullptr;
+    }
+}
+
+TrigramIndex::Slot* TrigramIndex::insertSlot(quint32 uKey)
+{
+    Slot* pSlot = findSlot(uKey);
+    if (pSlot != nullptr)
+        return pSlot;
+
+    // At most 3/4 full
+    if ((m_uUsedSlots + 1) * 4 > m_uSlotCount * 3)
+        growTable();
+
+    const quint32 uMask = m_uSlotCount - 1;
+    quint32 s = slotHash(uKey) & uMask;
+    while (m_pSlots[s].uKey != 0)
+        s = (s + 1) & uMask;
+
+    pSlot = &m_pSlots[s];
+    pSlot->uKey = uKey;
+    pSlot->uCount = 0;
+    pSlot->uCapacity = INLINE_IDS;
+    ++m_uUsedSlots;
+    return pSlot;
+}
+
+void TrigramIndex::growTable()
+{
+    // Keys whose posting list became empty are dropped on the way
+    quint32 uLiveSlots = 0;
+    for (quint32 s = 0; s < m_uSlotCount; ++s) {
+        if (m_pSlots[s].uCount != 0)
+            ++uLiveSlots;
+    }
+    quint32 uNewCount = MIN_SLOTS;
+    while ((uLiveSlots + 1) * 2 > uNewCount)
+        uNewCount *= 2;
+
+    Slot* pNewSlots = static_cast<Slot*>(SecureArena::allocate(uNewCount * sizeof(Slot)));
+    if (pNewSlots == nullptr)
+        throw std::bad_alloc();
+
+    const quint32 uMask = uNewCount - 1;
+    for (quint32 s = 0; s < m_uSlotCount; ++s) {
+        Slot& slot = m_pSlots[s];
+        if (slot.uCount == 0) {
+            releaseIds(&slot);
+            continue;
+        }
+
+        quint32 t = slotHash(slot.uKey) & uMask;
+        while (pNewSlots[t].uKey != 0)
+            t = (t + 1) & uMask;
+        pNewSlots[t] = slot;
+    }
+
+    SecureArena::release(m_pSlots);
+    m_pSlots = pNewSlots;
+    m_uSlotCount = uNewCount;
+    m_uUsedSlots = uLiveSlots;
+}
+
+void TrigramIndex::insertId(Slot* pSlot, quint32 dwId)
+{
+    quint32* pIds = pSlot->ids();
+    quint32* pEnd = pIds + pSlot->uCount;
+
+    // Documents are mostly added in ID order
+    quint32* pPos = pEnd;
+    if (pSlot->uCount != 0 && pEnd[-1] >= dwId) {
+        pPos = std::lower_bound(pIds, pEnd, dwId);
+        if (*pPos == dwId)
+            return;
+    }
+
+    if (pSlot->uCount == pSlot->uCapacity) {
+        const quint32 uNewCapacity = qMax<quint32>(4, pSlot->uCapacity * 2);
+        quint32* pNewIds = static_cast<quint32*>(SecureArena::allocate(uNewCapacity * sizeof(quint32)));
+        if (pNewIds == nullptr)
+            throw std::bad_alloc();
+        std::memcpy(pNewIds, pIds, pSlot->uCount * sizeof(quint32));
+        const size_t uPos = static_cast<size_t>(pPos - pIds);
+
+        releaseIds(pSlot);
+        pSlot->pIds = pNewIds;
+        pSlot->uCapacity = uNewCapacity;
+        pIds = pNewIds;
+        pPos = pIds + uPos;
+        pEnd = pIds + pSlot->uCount;
+    }
+
+    std::memmove(pPos + 1, pPos, static_cast<size_t>(pEnd - pPos) * sizeof(quint32));
+    *pPos = dwId;
+    ++pSlot->uCount;
+}
+
+void TrigramIndex::removeId(Slot* pSlot, quint32 dwId)
+{
+    quint32* pIds = pSlot->ids();
+    quint32* pEnd = pIds + pSlot->uCount;
+    quint32* pPos = std::lower_bound(pIds, pEnd, dwId);
+    if (pPos == pEnd || *pPos != dwId)
+        return;
+
+    std::memmove(pPos, pPos + 1, static_cast<size_t>(pEnd - pPos - 1) * sizeof(quint32));
+    --pSlot->uCount;
+    pEnd[-1] = 0;
+
+    if (pSlot->uCount == 0)
+        releaseIds(pSlot);
+}
+
+void TrigramIndex::releaseIds(Slot* pSlot)
+{
+    // Back to the inline list; the arena erases the block
+    if (pSlot->uCapacity > INLINE_IDS)
+        SecureArena::release(pSlot->pIds);
+    pSlot->pIds = nullptr;
+    pSlot->uCapacity = INLINE_IDS;
+}
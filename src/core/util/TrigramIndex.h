@@ -0,0 +1,106 @@
+/*
+  KeePass Password Safe - Qt Port
+  Copyright (C) 2003-2025 Dominik Reichl <dominik.reichl@t-online.de>
+  Qt Port Copyright (C) 2025
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include <QString>
+#include <QVector>
+#include <cstddef>
+
+/// Inverted index from the 3-byte substrings ("trigrams") of case-folded
+/// UTF-8 text to the IDs of the documents containing them.
+///
+/// Text is folded with FoldedText::fold(), like the search compares it,
+/// so every document containing a search text (with or without case
+/// sensitivity) contains all of the text's folded trigrams: intersecting
+/// their posting lists gives a superset of the matches, which the caller
+/// then verifies.
+///
+/// The hash table and all posting lists live in the SecureArena; folded
+/// copies of the text are erased after use. Posting lists are sorted by ID.
+class TrigramIndex
+{
+public:
+    /// Memory statistics
+    struct Stats
+    {
+        quint32 uDocuments;          ///< Documents added and not removed
+        quint32 uTrigrams;           ///< Distinct trigrams with at least one document
+        quint64 uPostings;           ///< Sum of all posting list lengths
+        size_t uBytes;               ///< Hash table and posting list capacity
+        size_t uBytesPerDocument;    ///< uBytes / uDocuments
+    };
+
+    TrigramIndex();
+    ~TrigramIndex();
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    /// Index the texts (NUL-terminated UTF-8, nullptr allowed) of a document.
+    /// Trigrams never span two texts.
+    void add(quint32 dwId, const char* const* ppTexts, int nTexts);
+
+    /// Remove a document; ppTexts must be the texts it was added with
+    void remove(quint32 dwId, const char* const* ppTexts, int nTexts);
+
+    /// Renumber the documents with IDs >= dwFirst: ID i becomes pNewIds[i]
+    /// (pNewIds has an element for every ID in use). Removed documents must
+    /// not be in the index any more.
+    void remapIds(const quint32* pNewIds, quint32 dwFirst);
+
+    /// Candidates for a substring search, ascending
+    /// @return false if the text is too short to narrow the search (fewer
+    ///         than 3 bytes once folded); every document is a candidate then
+    bool lookup(const QString& text, QVector<quint32>* pIds) const;
+
+    /// Erase and free everything
+    void clear();
+
+    void swap(TrigramIndex& other) noexcept;
+
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    // Posting lists of up to INLINE_IDS documents are stored in the slot
+    struct Slot
+    {
+        quint32 uKey;       // Folded bytes b0 << 16 | b1 << 8 | b2; 0 = unused slot
+        quint32 uCount;
+        quint32 uCapacity;
+        union {
+            quint32* pIds;
+            quint32 aInline[2];
+        };
+
+        quint32* ids() { return (uCapacity > INLINE_IDS) ? pIds : aInline; }
+        const quint32* ids() const { return (uCapacity > INLINE_IDS) ? pIds : aInline; }
+    };
+    static constexpr quint32 INLINE_IDS = 2;
+
+    // Collects the distinct trigrams of the texts into vKeys (sorted)
+    static void collectTrigrams(const char* const* ppTexts, int nTexts, QVector<quint32>& vKeys);
+
+    Slot* findSlot(quint32 uKey) const;
+    Slot* insertSlot(quint32 uKey);
+    void growTable();
+    static void insertId(Slot* pSlot, quint32 dwId);
+    static void removeId(Slot* pSlot, quint32 dwId);
+    static void releaseIds(Slot* pSlot);
+
+    Slot* m_pSlots;       // SecureArena block, m_uSlotCount slots
+    quint32 m_uSlotCount; // Power of two (or 0)
+    quint32 m_uUsedSlots; // Slots with a key, including ones whose list became empty
+    quint32 m_uDocuments;
+};
+
+#endif // TRIGRAM_INDEX_H
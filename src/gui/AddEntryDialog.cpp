@@ -293,14 +293,14 @@ void AddEntryDialog::populateFromEntry(PW_ENTRY *entry)
         return;
     }
 
-    // Unlock password for editing
-    m_pwManager->unlockEntryPassword(entry);
+    // Decrypted copy of the password for editing; the stored one stays locked
+    const QString password = PwUnlockedPassword(m_pwManager, entry).toString();
 
     // Set all fields from entry
     m_titleEdit->setText(QString::fromUtf8(entry->pszTitle));
     m_usernameEdit->setText(QString::fromUtf8(entry->pszUserName));
-    m_passwordEdit->setText(QString::fromUtf8(entry->pszPassword));
-    m_repeatPasswordEdit->setText(QString::fromUtf8(entry->pszPassword));
+    m_passwordEdit->setText(password);
+    m_repeatPasswordEdit->setText(password);
     m_urlEdit->setText(QString::fromUtf8(entry->pszURL));
 
     // Parse notes and auto-type configuration
@@ -319,9 +319,6 @@ void AddEntryDialog::populateFromEntry(PW_ENTRY *entry)
 
     m_iconIdSpin->setValue(entry->uImageId);
 
-    // Lock password again
-    m_pwManager->lockEntryPassword(entry);
-
     // Set group selection
     for (int i = 0; i < m_groupCombo->count(); ++i) {
         if (m_groupCombo->itemData(i).toUInt() == entry->uGroupId) {
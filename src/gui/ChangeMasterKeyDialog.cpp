@@ -3,6 +3,8 @@
 */
 
 #include "ChangeMasterKeyDialog.h"
+#include "../core/platform/PwSettings.h"
+#include "../core/util/KeyTransformCalibrator.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -12,6 +14,8 @@
 #include <QPushButton>
 #include <QMessageBox>
 #include <QGroupBox>
+#include <QSpinBox>
+#include <QApplication>
 
 ChangeMasterKeyDialog::ChangeMasterKeyDialog(QWidget *parent)
     : QDialog(parent)
@@ -22,6 +26,9 @@ ChangeMasterKeyDialog::ChangeMasterKeyDialog(QWidget *parent)
     , m_confirmPasswordLabel(nullptr)
     , m_warningLabel(nullptr)
     , m_infoLabel(nullptr)
+    , m_roundsSpin(nullptr)
+    , m_suggestRoundsButton(nullptr)
+    , m_unlockTimeLabel(nullptr)
     , m_okButton(nullptr)
     , m_cancelButton(nullptr)
 {
@@ -83,6 +90,33 @@ void ChangeMasterKeyDialog::setupUi()
 
     mainLayout->addWidget(passwordGroup);
 
+    // Key transformation rounds of the new key
+    QGroupBox *roundsGroup = new QGroupBox(tr("Key Transformation"), this);
+    QGridLayout *roundsLayout = new QGridLayout(roundsGroup);
+
+    QLabel *roundsLabel = new QLabel(tr("&Rounds:"), roundsGroup);
+    m_roundsSpin = new QSpinBox(roundsGroup);
+    m_roundsSpin->setRange(1, 2147483646);  // Max: 0xFFFFFFFE
+    m_roundsSpin->setValue(600000);
+    m_roundsSpin->setMinimumWidth(150);
+    roundsLabel->setBuddy(m_roundsSpin);
+
+    const double targetSec = PwSettings::instance().getKeyTransformTargetMs() / 1000.0;
+    m_suggestRoundsButton = new QPushButton(
+        tr("&Unlock in %1 s").arg(targetSec, 0, 'g', 3), roundsGroup);
+    m_suggestRoundsButton->setToolTip(
+        tr("Number of rounds for unlocking in %1 s on this computer").arg(targetSec, 0, 'g', 3));
+
+    m_unlockTimeLabel = new QLabel(roundsGroup);
+    m_unlockTimeLabel->setWordWrap(true);
+
+    roundsLayout->addWidget(roundsLabel, 0, 0);
+    roundsLayout->addWidget(m_roundsSpin, 0, 1);
+    roundsLayout->addWidget(m_suggestRoundsButton, 0, 2);
+    roundsLayout->addWidget(m_unlockTimeLabel, 1, 1, 1, 2);
+
+    mainLayout->addWidget(roundsGroup);
+
     // Warning label (initially hidden)
     m_warningLabel = new QLabel(this);
     m_warningLabel->setStyleSheet("QLabel { color: red; }");
@@ -113,11 +147,17 @@ void ChangeMasterKeyDialog::setupUi()
             this, &ChangeMasterKeyDialog::onPasswordChanged);
     connect(m_confirmPasswordEdit, &QLineEdit::textChanged,
             this, &ChangeMasterKeyDialog::onPasswordChanged);
+    connect(m_suggestRoundsButton, &QPushButton::clicked,
+            this, &ChangeMasterKeyDialog::onSuggestRounds);
+    connect(m_roundsSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ChangeMasterKeyDialog::onRoundsChanged);
     connect(m_okButton, &QPushButton::clicked,
             this, &ChangeMasterKeyDialog::onOkClicked);
     connect(m_cancelButton, &QPushButton::clicked,
             this, &QDialog::reject);
 
+    onRoundsChanged(m_roundsSpin->value());
+
     // Focus on new password field
     m_newPasswordEdit->setFocus();
 }
@@ -127,6 +167,43 @@ QString ChangeMasterKeyDialog::getNewPassword() const
     return m_newPasswordEdit->text();
 }
 
+void ChangeMasterKeyDialog::setKeyTransformRounds(quint32 rounds)
+{
+    m_roundsSpin->setValue(static_cast<int>(qMin(rounds, static_cast<quint32>(m_roundsSpin->maximum()))));
+}
+
+quint32 ChangeMasterKeyDialog::getKeyTransformRounds() const
+{
+    return static_cast<quint32>(m_roundsSpin->value());
+}
+
+void ChangeMasterKeyDialog::onSuggestRounds()
+{
+    // Measuring takes about a second the first time on this computer;
+    // afterwards the stored result is used
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const quint32 rounds = KeyTransformCalibrator::suggestRounds();
+    QApplication::restoreOverrideCursor();
+
+    setKeyTransformRounds(rounds);
+    onRoundsChanged(m_roundsSpin->value());
+}
+
+void ChangeMasterKeyDialog::onRoundsChanged(int rounds)
+{
+    KeyTransform::Calibration calibration;
+    if (!KeyTransformCalibrator::cached(&calibration)) {
+        m_unlockTimeLabel->setText(tr("The unlock time on this computer has not been measured yet."));
+        return;
+    }
+
+    const double typicalSec = KeyTransform::durationForRounds(calibration, static_cast<quint64>(rounds)) / 1000.0;
+    const double worstSec = KeyTransform::durationForRounds(calibration, static_cast<quint64>(rounds), true) / 1000.0;
+    m_unlockTimeLabel->setText(tr("Unlocking takes about %1 s on this computer (up to %2 s).")
+                                   .arg(typicalSec, 0, 'f', 2)
+                                   .arg(worstSec, 0, 'f', 2));
+}
+
 void ChangeMasterKeyDialog::onShowPasswordToggled(bool checked)
 {
     QLineEdit::EchoMode mode = checked ? QLineEdit::Normal : QLineEdit::Password;
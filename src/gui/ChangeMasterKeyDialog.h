@@ -17,6 +17,7 @@ class QLineEdit;
 class QCheckBox;
 class QLabel;
 class QPushButton;
+class QSpinBox;
 
 class ChangeMasterKeyDialog : public QDialog
 {
@@ -29,9 +30,15 @@ public:
     // Get the new password
     QString getNewPassword() const;
 
+    // Key transformation rounds for the new key
+    void setKeyTransformRounds(quint32 rounds);
+    quint32 getKeyTransformRounds() const;
+
 private slots:
     void onShowPasswordToggled(bool checked);
     void onPasswordChanged();
+    void onSuggestRounds();
+    void onRoundsChanged(int rounds);
     void onOkClicked();
 
 private:
@@ -45,6 +52,9 @@ private:
     QLabel *m_confirmPasswordLabel;
     QLabel *m_warningLabel;
     QLabel *m_infoLabel;
+    QSpinBox *m_roundsSpin;
+    QPushButton *m_suggestRoundsButton;
+    QLabel *m_unlockTimeLabel;
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
 };
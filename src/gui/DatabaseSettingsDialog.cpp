@@ -6,6 +6,8 @@
 #include "DatabaseSettingsDialog.h"
 #include "../core/PwManager.h"
 #include "../core/crypto/KeyTransform.h"
+#include "../core/platform/PwSettings.h"
+#include "../core/util/KeyTransformCalibrator.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -33,6 +35,8 @@ DatabaseSettingsDialog::DatabaseSettingsDialog(PwManager* pwManager, QWidget* pa
     , m_algorithm(0)
     , m_keyRounds(600000)
     , m_color(0xFFFFFFFF)  // DWORD_MAX = no custom color
+    , m_fastResave(false)
+    , m_retransformKey(false)
 {
     setupUI();
     setWindowTitle(tr("Database Settings"));
@@ -98,7 +102,11 @@ void DatabaseSettingsDialog::setupUI()
     m_roundsSpin->setMinimumWidth(150);
 
     m_calculateButton = new QPushButton(tr("Calculate"), this);
-    m_calculateButton->setToolTip(tr("Benchmark to determine optimal number of rounds"));
+    m_calculateButton->setToolTip(
+        tr("Number of rounds for unlocking in %1 s on this computer")
+            .arg(PwSettings::instance().getKeyTransformTargetMs() / 1000.0, 0, 'g', 3));
+
+    m_unlockTimeLabel = new QLabel(this);
 
     roundsLayout->addWidget(roundsLabel);
     roundsLayout->addWidget(m_roundsSpin);
@@ -114,8 +122,21 @@ void DatabaseSettingsDialog::setupUI()
     roundsHelp->setWordWrap(true);
     roundsHelp->setStyleSheet("color: #666; font-size: 10px;");
 
+    m_fastResaveCheck = new QCheckBox(
+        tr("Fast resave: reuse the transformed key when saving"), this);
+    m_fastResaveCheck->setToolTip(
+        tr("Keep the key transformation seed of the last open or save, so that saving "
+           "does not have to transform the master key again. The encryption key "
+           "and IV still change with every save."));
+
+    m_retransformCheck = new QCheckBox(
+        tr("Transform the master key with a new seed on the next save"), this);
+
     keyLayout->addLayout(roundsLayout);
+    keyLayout->addWidget(m_unlockTimeLabel);
     keyLayout->addWidget(roundsHelp);
+    keyLayout->addWidget(m_fastResaveCheck);
+    keyLayout->addWidget(m_retransformCheck);
 
     mainLayout->addWidget(keyGroup);
 
@@ -176,6 +197,7 @@ void DatabaseSettingsDialog::setupUI()
 
     // Connect signals
     connect(m_calculateButton, &QPushButton::clicked, this, &DatabaseSettingsDialog::onCalculateRounds);
+    connect(m_roundsSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &DatabaseSettingsDialog::onRoundsChanged);
     connect(m_customColorCheck, &QCheckBox::toggled, this, &DatabaseSettingsDialog::onCustomColorToggled);
     connect(m_colorSlider, &QSlider::valueChanged, this, &DatabaseSettingsDialog::onColorSliderChanged);
     connect(m_okButton, &QPushButton::clicked, this, &DatabaseSettingsDialog::onAccept);
@@ -183,6 +205,7 @@ void DatabaseSettingsDialog::setupUI()
 
     // Initial state
     updateColorPreview();
+    onRoundsChanged(m_roundsSpin->value());
 }
 
 void DatabaseSettingsDialog::setEncryptionAlgorithm(int algorithm)
@@ -209,6 +232,14 @@ void DatabaseSettingsDialog::setDefaultUsername(const QString& username)
     }
 }
 
+void DatabaseSettingsDialog::setFastResave(bool enabled)
+{
+    m_fastResave = enabled;
+    if (m_fastResaveCheck != nullptr) {
+        m_fastResaveCheck->setChecked(enabled);
+    }
+}
+
 void DatabaseSettingsDialog::setFilePath(const QString& filePath)
 {
     m_filePath = filePath;
@@ -284,22 +315,42 @@ void DatabaseSettingsDialog::setDatabaseColor(quint32 color)
 void DatabaseSettingsDialog::onCalculateRounds()
 {
     // Reference: MFC OnBtnCalcRounds
+    // The speed of this computer is measured once and then taken from the
+    // settings; only show progress when a measurement is due
+    const bool bMeasure = !KeyTransformCalibrator::cached(nullptr);
     QProgressDialog progress(tr("Benchmarking key transformation..."),
                             tr("Cancel"), 0, 0, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setMinimumDuration(0);
-    progress.setValue(0);
-    QApplication::processEvents();
+    if (bMeasure) {
+        progress.setWindowModality(Qt::WindowModal);
+        progress.setMinimumDuration(0);
+        progress.setValue(0);
+        QApplication::processEvents();
+    }
+
+    // Rounds for the configured unlock time (1 second by default)
+    const quint32 rounds = KeyTransformCalibrator::suggestRounds();
 
-    // Run benchmark (1 second)
-    quint64 rounds = KeyTransform::benchmark(1000);
+    // Clamp to the range of the spin box
+    m_roundsSpin->setValue(static_cast<int>(std::min(rounds, static_cast<quint32>(m_roundsSpin->maximum()))));
 
-    // Clamp to valid range
-    rounds = std::min(rounds, static_cast<quint64>(0xFFFFFFFE));
+    if (bMeasure) {
+        progress.setValue(1);
+    }
+}
 
-    m_roundsSpin->setValue(static_cast<quint32>(rounds));
+void DatabaseSettingsDialog::onRoundsChanged(int rounds)
+{
+    KeyTransform::Calibration calibration;
+    if (!KeyTransformCalibrator::cached(&calibration)) {
+        m_unlockTimeLabel->setText(tr("Click Calculate to measure the unlock time on this computer."));
+        return;
+    }
 
-    progress.setValue(1);
+    const double typicalSec = KeyTransform::durationForRounds(calibration, static_cast<quint64>(rounds)) / 1000.0;
+    const double worstSec = KeyTransform::durationForRounds(calibration, static_cast<quint64>(rounds), true) / 1000.0;
+    m_unlockTimeLabel->setText(tr("Unlocking takes about %1 s on this computer (up to %2 s).")
+                                   .arg(typicalSec, 0, 'f', 2)
+                                   .arg(worstSec, 0, 'f', 2));
 }
 
 void DatabaseSettingsDialog::onCustomColorToggled([[maybe_unused]] bool checked)
@@ -319,6 +370,8 @@ void DatabaseSettingsDialog::onAccept()
     m_algorithm = m_algorithmCombo->currentIndex();
     m_keyRounds = m_roundsSpin->value();
     m_defaultUsername = m_usernameEdit->text();
+    m_fastResave = m_fastResaveCheck->isChecked();
+    m_retransformKey = m_retransformCheck->isChecked();
 
     // Get color
     if (m_customColorCheck->isChecked()) {
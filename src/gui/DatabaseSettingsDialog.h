@@ -40,14 +40,22 @@ public:
     /// Get database color (DWORD_MAX if no custom color)
     quint32 databaseColor() const { return m_color; }
 
+    /// Get whether saving may reuse the transformed master key
+    bool fastResave() const { return m_fastResave; }
+
+    /// Get whether the next save must transform the master key again
+    bool retransformKey() const { return m_retransformKey; }
+
     /// Set initial values
     void setEncryptionAlgorithm(int algorithm);
     void setKeyTransformRounds(quint32 rounds);
     void setDefaultUsername(const QString& username);
     void setDatabaseColor(quint32 color);
+    void setFastResave(bool enabled);
 
 private slots:
     void onCalculateRounds();
+    void onRoundsChanged(int rounds);
     void onCustomColorToggled(bool checked);
     void onColorSliderChanged(int value);
     void onAccept();
@@ -69,6 +77,9 @@ private:
     QComboBox* m_algorithmCombo;
     QSpinBox* m_roundsSpin;
     QPushButton* m_calculateButton;
+    QLabel* m_unlockTimeLabel;
+    QCheckBox* m_fastResaveCheck;
+    QCheckBox* m_retransformCheck;
     QLineEdit* m_usernameEdit;
     QCheckBox* m_customColorCheck;
     QSlider* m_colorSlider;
@@ -83,6 +94,8 @@ private:
     quint32 m_keyRounds;
     QString m_defaultUsername;
     quint32 m_color;  // DWORD_MAX = no custom color
+    bool m_fastResave;
+    bool m_retransformKey;
 };
 
 #endif // DATABASESETTINGSDIALOG_H
@@ -126,7 +126,7 @@ void EntropyCollectorDialog::mouseMoveEvent(QMouseEvent* event)
         if (areaRect.contains(localPos)) {
             if (m_mousePoints.size() < MaxMousePoints) {
                 // Only collect some points (randomize collection)
-                if ((Random::generateUInt32() % 5) == 0) {
+                if (Random::uniform(5) == 0) {
                     m_mousePoints.append(event->globalPosition().toPoint());
                     m_progressBar->setValue(m_mousePoints.size());
 
@@ -105,7 +105,7 @@ QVariant EntryModel::data(const QModelIndex &index, int role) const
                 }
             } else {
                 // Show actual password (for when user disables masking)
-                return QString::fromUtf8(entry->pszPassword);
+                return PwUnlockedPassword(m_pwManager, entry).toString();
             }
             return QString();
         case ColumnNotes:
@@ -300,20 +300,25 @@ QList<PW_ENTRY*> EntryModel::getFilteredEntries() const
         return result;
     }
 
-    // Otherwise, use group filter if active
+    // Otherwise, use group filter if active (only visits the group's entries)
+    if (m_hasGroupFilter) {
+        quint32 numInGroup = m_pwManager->getNumberOfItemsInGroupN(m_filterGroupId);
+        result.reserve(static_cast<int>(numInGroup));
+        for (quint32 n = 0; n < numInGroup; ++n) {
+            PW_ENTRY *entry = m_pwManager->getEntryByGroup(m_filterGroupId, n);
+            if (entry) {
+                result.append(entry);
+            }
+        }
+        return result;
+    }
+
     quint32 numEntries = m_pwManager->getNumberOfEntries();
     for (quint32 i = 0; i < numEntries; ++i) {
         PW_ENTRY *entry = m_pwManager->getEntry(i);
-        if (!entry) continue;
-
-        // Apply group filter if active
-        if (m_hasGroupFilter) {
-            if (entry->uGroupId != m_filterGroupId) {
-                continue;
-            }
+        if (entry) {
+            result.append(entry);
         }
-
-        result.append(entry);
     }
 
     return result;
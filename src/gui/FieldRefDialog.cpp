@@ -306,9 +306,7 @@ bool FieldRefDialog::idMatchesMultipleTimes(const QString& value, QChar searchTy
                 break;
             case 'P':
                 if (entry->pszPassword != nullptr) {
-                    m_pwManager->unlockEntryPassword(entry);
-                    fieldValue = QString::fromUtf8(entry->pszPassword);
-                    m_pwManager->lockEntryPassword(entry);
+                    fieldValue = PwUnlockedPassword(m_pwManager, entry).toString();
                 }
                 break;
             case 'A':
@@ -369,9 +367,7 @@ void FieldRefDialog::validateAndAccept()
     } else if (m_radioIdPassword->isChecked()) {
         idField = 'P';
         if (entry->pszPassword != nullptr) {
-            m_pwManager->unlockEntryPassword(entry);
-            idValue = QString::fromUtf8(entry->pszPassword);
-            m_pwManager->lockEntryPassword(entry);
+            idValue = PwUnlockedPassword(m_pwManager, entry).toString();
         }
     } else if (m_radioIdUrl->isChecked()) {
         idField = 'A';
@@ -10,6 +10,11 @@
 #include <QString>
 #include <QIcon>
 
+namespace {
+    // PwManager group tree: parent index of top-level groups (and "not found")
+    constexpr quint32 TREE_ROOT = 0xFFFFFFFF;
+}
+
 GroupModel::GroupModel(PwManager *pwManager, QObject *parent)
     : QAbstractItemModel(parent)
     , m_pwManager(pwManager)
@@ -22,27 +27,19 @@ QModelIndex GroupModel::index(int row, int column, const QModelIndex &parent) co
         return QModelIndex();
     }
 
-    PW_GROUP *parentGroup = nullptr;
+    quint32 parentIndex = TREE_ROOT;
     if (parent.isValid()) {
-        parentGroup = getGroupByIndex(parent);
+        parentIndex = m_pwManager->getGroupIndex(getGroupByIndex(parent));
+        if (parentIndex == TREE_ROOT) {
+            return QModelIndex();  // Stale parent
+        }
     }
 
-    // Find the child group at the specified row
-    quint32 numGroups = m_pwManager->getNumberOfGroups();
-    int currentRow = 0;
-
-    for (quint32 i = 0; i < numGroups; ++i) {
-        PW_GROUP *group = m_pwManager->getGroup(i);
-        if (!group) continue;
-
-        // Check if this group's parent matches
-        PW_GROUP *groupParent = getParentGroup(group);
-        if (groupParent == parentGroup) {
-            if (currentRow == row) {
-                return createIndex(row, column, group);
-            }
-            currentRow++;
-        }
+    // Walk the parent's child list (maintained by PwManager)
+    quint32 childIndex = m_pwManager->getGroupChildN(parentIndex, static_cast<quint32>(row));
+    PW_GROUP *group = m_pwManager->getGroup(childIndex);
+    if (group) {
+        return createIndex(row, column, group);
     }
 
     return QModelIndex();
@@ -78,26 +75,15 @@ int GroupModel::rowCount(const QModelIndex &parent) const
         return 0;
     }
 
-    PW_GROUP *parentGroup = nullptr;
+    quint32 parentIndex = TREE_ROOT;
     if (parent.isValid()) {
-        parentGroup = getGroupByIndex(parent);
-    }
-
-    // Count children of this parent
-    quint32 numGroups = m_pwManager->getNumberOfGroups();
-    int count = 0;
-
-    for (quint32 i = 0; i < numGroups; ++i) {
-        PW_GROUP *group = m_pwManager->getGroup(i);
-        if (!group) continue;
-
-        PW_GROUP *groupParent = getParentGroup(group);
-        if (groupParent == parentGroup) {
-            count++;
+        parentIndex = m_pwManager->getGroupIndex(getGroupByIndex(parent));
+        if (parentIndex == TREE_ROOT) {
+            return 0;  // Stale parent
         }
     }
 
-    return count;
+    return static_cast<int>(m_pwManager->getGroupChildCount(parentIndex));
 }
 
 int GroupModel::columnCount(const QModelIndex &parent) const
@@ -154,15 +140,10 @@ QModelIndex GroupModel::indexForGroup(quint32 groupId) const
         return QModelIndex();
     }
 
-    quint32 numGroups = m_pwManager->getNumberOfGroups();
-    for (quint32 i = 0; i < numGroups; ++i) {
-        PW_GROUP *group = m_pwManager->getGroup(i);
-        if (group && group->uGroupId == groupId) {
-            int row = getGroupRow(group);
-            if (row >= 0) {
-                return createIndex(row, 0, group);
-            }
-        }
+    PW_GROUP *group = m_pwManager->getGroup(m_pwManager->getGroupByIdN(groupId));
+    int row = getGroupRow(group);
+    if (row >= 0) {
+        return createIndex(row, 0, group);
     }
 
     return QModelIndex();
@@ -189,26 +170,13 @@ int GroupModel::getGroupRow(PW_GROUP *group) const
         return -1;
     }
 
-    PW_GROUP *parentGroup = getParentGroup(group);
-
-    // Find the row of this group among its siblings
-    quint32 numGroups = m_pwManager->getNumberOfGroups();
-    int row = 0;
-
-    for (quint32 i = 0; i < numGroups; ++i) {
-        PW_GROUP *g = m_pwManager->getGroup(i);
-        if (!g) continue;
-
-        PW_GROUP *gParent = getParentGroup(g);
-        if (gParent == parentGroup) {
-            if (g == group) {
-                return row;
-            }
-            row++;
-        }
+    // Row among the siblings is stored in the PwManager group tree index
+    quint32 row = m_pwManager->getGroupRowN(m_pwManager->getGroupIndex(group));
+    if (row == TREE_ROOT) {
+        return -1;
     }
 
-    return -1;
+    return static_cast<int>(row);
 }
 
 PW_GROUP* GroupModel::getParentGroup(PW_GROUP *group) const
@@ -217,34 +185,9 @@ PW_GROUP* GroupModel::getParentGroup(PW_GROUP *group) const
         return nullptr;
     }
 
-    // In KDB format, groups are stored flat with usLevel indicating hierarchy
-    // Level 0 = top-level, level 1 = child of previous level 0, etc.
-    // We need to find the parent by walking backwards until we find a group
-    // with level = (current level - 1)
-
-    if (group->usLevel == 0) {
-        return nullptr;  // Top-level group
-    }
-
-    quint32 numGroups = m_pwManager->getNumberOfGroups();
-    quint16 parentLevel = group->usLevel - 1;
-
-    // Find this group's index
-    quint32 groupIndex = 0;
-    for (quint32 i = 0; i < numGroups; ++i) {
-        if (m_pwManager->getGroup(i) == group) {
-            groupIndex = i;
-            break;
-        }
-    }
-
-    // Walk backwards from this group to find parent
-    for (int i = groupIndex - 1; i >= 0; --i) {
-        PW_GROUP *candidate = m_pwManager->getGroup(static_cast<quint32>(i));
-        if (candidate && candidate->usLevel == parentLevel) {
-            return candidate;
-        }
-    }
-
-    return nullptr;
+    // In KDB format, groups are stored flat with usLevel indicating hierarchy.
+    // PwManager derives the parent links from the levels once and keeps them
+    // up to date, so this is a plain lookup (nullptr for top-level groups).
+    quint32 parentIndex = m_pwManager->getGroupParentN(m_pwManager->getGroupIndex(group));
+    return m_pwManager->getGroup(parentIndex);
 }
@@ -20,10 +20,12 @@
 #include "IconManager.h"
 #include "LanguagesDialog.h"
 #include "../core/PwManager.h"
+#include "../core/PwSearchPlan.h"
 #include "TranslationManager.h"
 #include "../core/platform/PwSettings.h"
 #include "../core/util/PwUtil.h"
 #include "../core/util/CsvUtil.h"
+#include "../core/util/KeyTransformCalibrator.h"
 #include "../core/io/PwExport.h"
 #include "../core/io/PwImport.h"
 #include "../autotype/AutoTypeSequence.h"
@@ -36,6 +38,7 @@
 #include "FieldRefDialog.h"
 #include "UpdateInfoDialog.h"
 #include "../core/UpdateChecker.h"
+#include "../core/ExpiryScheduler.h"
 
 #include <QApplication>
 #include <QMenuBar>
@@ -68,6 +71,9 @@
 #include <QProcess>
 #include <QUrl>
 #include <QThread>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QEventLoop>
 
 #include "../core/PwStructs.h"
 #include <cstring>
@@ -81,15 +87,18 @@ MainWindow::MainWindow(QWidget *parent)
     , m_groupView(nullptr)
     , m_entryView(nullptr)
     , m_toolBar(nullptr)
+    , m_quickFindEdit(nullptr)
     , m_statusLabel(nullptr)
     , m_isModified(false)
     , m_hasDatabase(false)
     , m_isLocked(false)
+    , m_isBusy(false)
     , m_clipboardTimer(new QTimer(this))
     , m_clipboardCountdown(-1)
     , m_clipboardTimeoutSecs(11)  // Default: 10+1 seconds (matching MFC)
     , m_inactivityTimer(new QTimer(this))
     , m_inactivityTimeoutMs(300000)  // Default: 5 minutes
+    , m_expiryScheduler(new ExpiryScheduler(m_pwManager, this))
     , m_systemTrayIcon(nullptr)
     , m_trayIconMenu(nullptr)
     , m_updateChecker(nullptr)
@@ -102,6 +111,9 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_inactivityTimer, &QTimer::timeout, this, &MainWindow::onInactivityTimer);
     m_inactivityTimer->setSingleShot(true);
 
+    // Connect expiry notification
+    connect(m_expiryScheduler, &ExpiryScheduler::entriesExpired, this, &MainWindow::onEntriesExpired);
+
     // Install event filter for activity tracking
     qApp->installEventFilter(this);
 
@@ -636,6 +648,17 @@ void MainWindow::createToolBar()
     m_toolBar->addSeparator();
     m_toolBar->addAction(m_actionEditCopyUsername);
     m_toolBar->addAction(m_actionEditCopyPassword);
+    m_toolBar->addSeparator();
+
+    // Reference: MFC PwSafeDlg quick find combo box; results update while typing
+    m_quickFindEdit = new QLineEdit(this);
+    m_quickFindEdit->setPlaceholderText(tr("Quick Find"));
+    m_quickFindEdit->setClearButtonEnabled(true);
+    m_quickFindEdit->setMaximumWidth(220);
+    m_quickFindEdit->setEnabled(false);
+    connect(m_quickFindEdit, &QLineEdit::textChanged, this, &MainWindow::onQuickFind);
+    connect(m_quickFindEdit, &QLineEdit::returnPressed, this, &MainWindow::onQuickFindReturn);
+    m_toolBar->addWidget(m_quickFindEdit);
 }
 
 void MainWindow::createStatusBar()
@@ -684,6 +707,9 @@ void MainWindow::loadSettings()
 {
     PwSettings &settings = PwSettings::instance();
 
+    m_pwManager->setFastResave(settings.get("Security/FastResave", false).toBool());
+    m_pwManager->setSearchIndexPasswords(settings.get("Advanced/QuickFindInPasswords", false).toBool());
+
     // Restore window geometry
     if (settings.getRememberWindowSize()) {
         QByteArray geometry = settings.getMainWindowGeometry();
@@ -734,50 +760,58 @@ void MainWindow::updateActions()
 {
     bool hasSelection = (m_entryView != nullptr) && m_entryView->selectionModel()->hasSelection();
     bool unlocked = m_hasDatabase && !m_isLocked;
+    // Nothing may touch the database while it is opened or saved
+    bool usable = unlocked && !m_isBusy;
 
     // File menu - most actions disabled when locked
-    m_actionFileSave->setEnabled(unlocked && m_isModified);
-    m_actionFileSaveAs->setEnabled(unlocked);
-    m_actionFileClose->setEnabled(unlocked);
-    m_actionFileLockWorkspace->setEnabled(m_hasDatabase);  // Can lock/unlock anytime
-    m_actionFileChangeMasterKey->setEnabled(unlocked);  // Can only change when unlocked
-    m_actionFileExportHtml->setEnabled(unlocked);  // Can export when unlocked
-    m_actionFileExportXml->setEnabled(unlocked);  // Can export when unlocked
-    m_actionFileExportTxt->setEnabled(unlocked);  // Can export when unlocked
-    m_actionFileExportCsv->setEnabled(unlocked);  // Can export when unlocked
-    m_actionFileImportCsv->setEnabled(unlocked);  // Can import when unlocked
-    m_actionFileImportCodeWallet->setEnabled(unlocked);  // Can import when unlocked
-    m_actionFileImportPwSafe->setEnabled(unlocked);  // Can import when unlocked
-    m_actionFileImportKeePass->setEnabled(unlocked);  // Can import when unlocked
-    m_actionFilePrint->setEnabled(unlocked);  // Can print when unlocked
-    m_actionFilePrintPreview->setEnabled(unlocked);  // Can print preview when unlocked
+    m_actionFileNew->setEnabled(!m_isBusy);
+    m_actionFileOpen->setEnabled(!m_isBusy);
+    m_actionFileSave->setEnabled(usable && m_isModified);
+    m_actionFileSaveAs->setEnabled(usable);
+    m_actionFileClose->setEnabled(usable);
+    m_actionFileLockWorkspace->setEnabled(m_hasDatabase && !m_isBusy);  // Can lock/unlock unless busy
+    m_actionFileChangeMasterKey->setEnabled(usable);  // Can only change when unlocked
+    m_actionFileExportHtml->setEnabled(usable);  // Can export when unlocked
+    m_actionFileExportXml->setEnabled(usable);  // Can export when unlocked
+    m_actionFileExportTxt->setEnabled(usable);  // Can export when unlocked
+    m_actionFileExportCsv->setEnabled(usable);  // Can export when unlocked
+    m_actionFileImportCsv->setEnabled(usable);  // Can import when unlocked
+    m_actionFileImportCodeWallet->setEnabled(usable);  // Can import when unlocked
+    m_actionFileImportPwSafe->setEnabled(usable);  // Can import when unlocked
+    m_actionFileImportKeePass->setEnabled(usable);  // Can import when unlocked
+    m_actionFilePrint->setEnabled(usable);  // Can print when unlocked
+    m_actionFilePrintPreview->setEnabled(usable);  // Can print preview when unlocked
 
     // Edit menu - all disabled when locked
-    m_actionEditAddGroup->setEnabled(unlocked);
-    m_actionEditAddEntry->setEnabled(unlocked);
-    m_actionEditEditEntry->setEnabled(unlocked && hasSelection);
-    m_actionEditDuplicateEntry->setEnabled(unlocked && hasSelection);
-    m_actionEditDeleteEntry->setEnabled(unlocked && hasSelection);
-    m_actionEditMassModify->setEnabled(unlocked && hasSelection);
-    m_actionEditDeleteGroup->setEnabled(unlocked);
+    m_actionEditAddGroup->setEnabled(usable);
+    m_actionEditAddEntry->setEnabled(usable);
+    m_actionEditEditEntry->setEnabled(usable && hasSelection);
+    m_actionEditDuplicateEntry->setEnabled(usable && hasSelection);
+    m_actionEditDeleteEntry->setEnabled(usable && hasSelection);
+    m_actionEditMassModify->setEnabled(usable && hasSelection);
+    m_actionEditDeleteGroup->setEnabled(usable);
 
     // Group management actions - enabled only when a group is selected
-    bool hasGroupSelection = unlocked && m_groupView->currentIndex().isValid();
+    bool hasGroupSelection = usable && m_groupView->currentIndex().isValid();
     m_actionEditMoveGroupUp->setEnabled(hasGroupSelection);
     m_actionEditMoveGroupDown->setEnabled(hasGroupSelection);
     m_actionEditMoveGroupLeft->setEnabled(hasGroupSelection);
     m_actionEditMoveGroupRight->setEnabled(hasGroupSelection);
-    m_actionEditSortGroups->setEnabled(unlocked);  // Always enabled when unlocked
+    m_actionEditSortGroups->setEnabled(usable);  // Always enabled when unlocked
 
     // Entry management actions - enabled only when an entry is selected
-    m_actionEditMoveEntryUp->setEnabled(unlocked && hasSelection);
-    m_actionEditMoveEntryDown->setEnabled(unlocked && hasSelection);
+    m_actionEditMoveEntryUp->setEnabled(usable && hasSelection);
+    m_actionEditMoveEntryDown->setEnabled(usable && hasSelection);
 
-    m_actionEditFind->setEnabled(unlocked);
-    m_actionEditCopyUsername->setEnabled(unlocked && hasSelection);
-    m_actionEditCopyPassword->setEnabled(unlocked && hasSelection);
-    m_actionEditVisitUrl->setEnabled(unlocked && hasSelection);
-    m_actionEditAutoType->setEnabled(unlocked && hasSelection);
+    m_actionEditFind->setEnabled(usable);
+    m_quickFindEdit->setEnabled(usable);
+    if (!unlocked) {
+        m_quickFindEdit->clear();
+    }
+    m_actionEditCopyUsername->setEnabled(usable && hasSelection);
+    m_actionEditCopyPassword->setEnabled(usable && hasSelection);
+    m_actionEditVisitUrl->setEnabled(usable && hasSelection);
+    m_actionEditAutoType->setEnabled(usable && hasSelection);
 
     // View menu - some view options work when locked
     m_actionViewExpandAll->setEnabled(m_hasDatabase);
@@ -803,12 +837,23 @@ void MainWindow::updateActions()
     m_actionViewHideUsernameStars->setChecked(PwSettings::instance().getHideUsernameStars());
 
     // Tools menu - disabled when locked
-    m_actionToolsPasswordGenerator->setEnabled(unlocked);
-    m_actionToolsDatabaseSettings->setEnabled(unlocked);
-    m_actionToolsTanWizard->setEnabled(unlocked);
-    m_actionToolsRepairDatabase->setEnabled(!m_hasDatabase && !m_isLocked);  // Only enabled when NO DB is open
-    m_actionToolsShowExpiredEntries->setEnabled(unlocked);
-    m_actionToolsShowExpiringSoon->setEnabled(unlocked);
+    m_actionToolsPasswordGenerator->setEnabled(usable);
+    m_actionToolsDatabaseSettings->setEnabled(usable);
+    m_actionToolsTanWizard->setEnabled(usable);
+    m_actionToolsRepairDatabase->setEnabled(!m_hasDatabase && !m_isLocked && !m_isBusy);  // Only enabled when NO DB is open
+    m_actionToolsShowExpiredEntries->setEnabled(usable);
+    m_actionToolsShowExpiringSoon->setEnabled(usable);
+
+    // Expiry notification - re-armed for the entries as they are now
+    // (restarted by the code that replaces the database, so the last check
+    // time of the previous database is never carried over)
+    if (!unlocked) {
+        m_expiryScheduler->stop();
+    } else if (!m_expiryScheduler->isActive()) {
+        m_expiryScheduler->start();
+    } else {
+        m_expiryScheduler->reschedule();
+    }
 }
 
 void MainWindow::updateStatusBar()
@@ -843,6 +888,12 @@ void MainWindow::refreshModels()
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
+    // The database must not go away under a running open or save
+    if (m_isBusy) {
+        event->ignore();
+        return;
+    }
+
     if (confirmSaveChanges()) {
         saveSettings();
         event->accept();
@@ -877,6 +928,10 @@ bool MainWindow::confirmSaveChanges()
 
 void MainWindow::onFileNew()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Check if we need to save current database
     if (!confirmSaveChanges()) {
         return;
@@ -896,6 +951,16 @@ void MainWindow::onFileNew()
     // Create new database
     m_pwManager->newDatabase();
 
+    // Key transformation rounds for the configured unlock time on this
+    // computer; measuring takes about a second, so without a stored result
+    // keep the default and measure in the background for next time
+    if (KeyTransformCalibrator::cached(nullptr)) {
+        m_pwManager->setKeyEncRounds(KeyTransformCalibrator::suggestRounds());
+    } else {
+        m_pwManager->setKeyEncRounds(PWM_STD_KEYENCROUNDS);
+        KeyTransformCalibrator::calibrateInBackground();
+    }
+
     // Set master key
     if (m_pwManager->setMasterKey(password, true, "", false, "") != PWE_SUCCESS) {
         QMessageBox::critical(this, tr("Error"),
@@ -949,6 +1014,7 @@ void MainWindow::onFileNew()
     m_hasDatabase = true;
     m_isModified = true;
     m_currentFilePath.clear();
+    m_expiryScheduler->start();
     refreshModels();
     updateWindowTitle();
     updateActions();
@@ -959,6 +1025,10 @@ void MainWindow::onFileNew()
 
 void MainWindow::onFileOpen()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Check if we need to save current database
     if (!confirmSaveChanges()) {
         m_statusLabel->setText(tr("Open cancelled"));
@@ -1010,6 +1080,10 @@ void MainWindow::onFileSaveAs()
 
 void MainWindow::onFileClose()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     if (confirmSaveChanges()) {
         closeDatabase();
     }
@@ -1026,7 +1100,7 @@ void MainWindow::onFileLockWorkspace()
 
 void MainWindow::lockWorkspace()
 {
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1122,12 +1196,13 @@ bool MainWindow::unlockWorkspace()
 void MainWindow::onFileChangeMasterKey()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileChangeKey
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
     // Show Change Master Key dialog
     ChangeMasterKeyDialog dialog(this);
+    dialog.setKeyTransformRounds(m_pwManager->getKeyEncRounds());
     if (dialog.exec() != QDialog::Accepted) {
         m_statusLabel->setText(tr("Master key change cancelled"));
         return;
@@ -1144,6 +1219,9 @@ void MainWindow::onFileChangeMasterKey()
         return;
     }
 
+    // Only together with the new key, so a failure keeps the old settings
+    m_pwManager->setKeyEncRounds(dialog.getKeyTransformRounds());
+
     // Save the database with the new key
     // This will re-encrypt the database with the new master password
     if (!saveDatabase()) {
@@ -1164,7 +1242,7 @@ void MainWindow::onFileChangeMasterKey()
 void MainWindow::onFileExportCsv()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileDbSettings
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1214,7 +1292,7 @@ void MainWindow::onFileExportCsv()
 
 void MainWindow::onFileExportHtml()
 {
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1264,7 +1342,7 @@ void MainWindow::onFileExportHtml()
 
 void MainWindow::onFileExportXml()
 {
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1313,7 +1391,7 @@ void MainWindow::onFileExportXml()
 
 void MainWindow::onFileExportTxt()
 {
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1363,7 +1441,7 @@ void MainWindow::onFileExportTxt()
 void MainWindow::onFilePrint()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFilePrint
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1410,7 +1488,7 @@ void MainWindow::onFilePrint()
 void MainWindow::onFilePrintPreview()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFilePrintPreview
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1452,7 +1530,7 @@ void MainWindow::onFilePrintPreview()
 void MainWindow::onFileImportCsv()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileImport
-    if (!m_hasDatabase || m_isLocked) {
+    if (!m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -1507,6 +1585,10 @@ void MainWindow::onFileImportCodeWallet()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileImport (PWIMP_CWALLET)
 
+    if (m_isBusy) {
+        return;
+    }
+
     QString filePath = QFileDialog::getOpenFileName(
         this,
         tr("Import from CodeWallet TXT"),
@@ -1547,6 +1629,10 @@ void MainWindow::onFileImportPwSafe()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileImport (PWIMP_PWSAFE)
 
+    if (m_isBusy) {
+        return;
+    }
+
     QString filePath = QFileDialog::getOpenFileName(
         this,
         tr("Import from Password Safe TXT"),
@@ -1587,6 +1673,10 @@ void MainWindow::onFileImportKeePass()
 {
     // Reference: MFC WinGUI/PwSafeDlg.cpp OnFileImport (PWIMP_KEEPASS)
 
+    if (m_isBusy) {
+        return;
+    }
+
     QString filePath = QFileDialog::getOpenFileName(
         this,
         tr("Merge KeePass Database"),
@@ -1669,6 +1759,10 @@ void MainWindow::onFileExit()
 
 void MainWindow::onEditAddGroup()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Show Add Group dialog
     AddGroupDialog dialog(this);
     if (dialog.exec() != QDialog::Accepted) {
@@ -1726,6 +1820,10 @@ void MainWindow::onEditAddGroup()
 
 void MainWindow::onEditAddEntry()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Get currently selected group ID (if any)
     quint32 selectedGroupId = 0;
     QModelIndex currentIndex = m_groupView->currentIndex();
@@ -1848,6 +1946,10 @@ void MainWindow::onEditAddEntry()
 
 void MainWindow::onEditEditEntry()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Get currently selected entry
     QModelIndex currentIndex = m_entryView->currentIndex();
     if (!currentIndex.isValid()) {
@@ -1936,21 +2038,11 @@ void MainWindow::onEditEditEntry()
     entryTemplate.pszAdditional = new char[notesUtf8.size() + 1];
     std::strcpy(entryTemplate.pszAdditional, notesUtf8.constData());
 
-    // Copy binary data from original entry
-    if (entry->pszBinaryDesc != nullptr && entry->pBinaryData != nullptr && entry->uBinaryDataLen > 0) {
-        size_t descLen = std::strlen(entry->pszBinaryDesc);
-        entryTemplate.pszBinaryDesc = new char[descLen + 1];
-        std::strcpy(entryTemplate.pszBinaryDesc, entry->pszBinaryDesc);
-
-        entryTemplate.uBinaryDataLen = entry->uBinaryDataLen;
-        entryTemplate.pBinaryData = new BYTE[entry->uBinaryDataLen];
-        std::memcpy(entryTemplate.pBinaryData, entry->pBinaryData, entry->uBinaryDataLen);
-    } else {
-        entryTemplate.pszBinaryDesc = new char[1];
-        entryTemplate.pszBinaryDesc[0] = '\0';
-        entryTemplate.pBinaryData = nullptr;
-        entryTemplate.uBinaryDataLen = 0;
-    }
+    // Keep the attachment: setEntry leaves it alone when the template points
+    // at the entry's own buffers, so no plaintext copy is made
+    entryTemplate.pszBinaryDesc = entry->pszBinaryDesc;
+    entryTemplate.pBinaryData = entry->pBinaryData;
+    entryTemplate.uBinaryDataLen = entry->uBinaryDataLen;
 
     // Set other properties
     entryTemplate.uGroupId = groupId;
@@ -1965,8 +2057,6 @@ void MainWindow::onEditEditEntry()
     delete[] entryTemplate.pszPassword;
     delete[] entryTemplate.pszURL;
     delete[] entryTemplate.pszAdditional;
-    delete[] entryTemplate.pszBinaryDesc;
-    delete[] entryTemplate.pBinaryData;
 
     if (!success) {
         QMessageBox::critical(this, tr("Error"),
@@ -2005,6 +2095,10 @@ void MainWindow::onEditEditEntry()
 
 void MainWindow::onEditDuplicateEntry()
 {
+    if (m_isBusy) {
+        return;
+    }
+
     // Get currently selected entry
     QModelIndex currentIndex = m_entryView->currentIndex();
     if (!currentIndex.isValid()) {
@@ -2021,8 +2115,8 @@ void MainWindow::onEditDuplicateEntry()
         return;
     }
 
-    // Unlock the password before copying
-    m_pwManager->unlockEntryPassword(originalEntry);
+    // Decrypted copy of the password; the stored one stays locked
+    const PwUnlockedPassword password(m_pwManager, originalEntry);
 
     // Create duplicate entry template (copy all fields)
     PW_ENTRY entryTemplate;
@@ -2047,11 +2141,9 @@ void MainWindow::onEditDuplicateEntry()
     entryTemplate.pszUserName = new char[usernameUtf8.size() + 1];
     std::strcpy(entryTemplate.pszUserName, usernameUtf8.constData());
 
-    // Copy password
-    QByteArray passwordUtf8 = QString::fromUtf8(originalEntry->pszPassword).toUtf8();
-    entryTemplate.pszPassword = new char[passwordUtf8.size() + 1];
-    std::strcpy(entryTemplate.pszPassword, passwordUtf8.constData());
-    entryTemplate.uPasswordLen = passwordUtf8.size();
+    // Copy password (addEntry copies it into the arena and locks it)
+    entryTemplate.pszPassword = const_cast<char*>(password.data());
+    entryTemplate.uPasswordLen = password.size();
 
     // Copy URL
     QByteArray urlUtf8 = QString::fromUtf8(originalEntry->pszURL).toUtf8();
@@ -2063,22 +2155,13 @@ void MainWindow::onEditDuplicateEntry()
     entryTemplate.pszAdditional = new char[notesUtf8.size() + 1];
     std::strcpy(entryTemplate.pszAdditional, notesUtf8.constData());
 
-    // Copy binary data if present
+    // Binary data if present: addEntry copies it straight from the original
+    // into the SecureArena, so no plaintext copy is made here
     if (originalEntry->pszBinaryDesc != nullptr && originalEntry->pBinaryData != nullptr &&
         originalEntry->uBinaryDataLen > 0) {
-        size_t descLen = std::strlen(originalEntry->pszBinaryDesc);
-        entryTemplate.pszBinaryDesc = new char[descLen + 1];
-        std::strcpy(entryTemplate.pszBinaryDesc, originalEntry->pszBinaryDesc);
-
+        entryTemplate.pszBinaryDesc = originalEntry->pszBinaryDesc;
+        entryTemplate.pBinaryData = originalEntry->pBinaryData;
         entryTemplate.uBinaryDataLen = originalEntry->uBinaryDataLen;
-        entryTemplate.pBinaryData = new quint8[originalEntry->uBinaryDataLen];
-        std::memcpy(entryTemplate.pBinaryData, originalEntry->pBinaryData,
-                   originalEntry->uBinaryDataLen);
-    } else {
-        entryTemplate.pszBinaryDesc = new char[1];
-        entryTemplate.pszBinaryDesc[0] = '\0';
-        entryTemplate.pBinaryData = nullptr;
-        entryTemplate.uBinaryDataLen = 0;
     }
 
     // Set other properties (copy from original)
@@ -2087,20 +2170,14 @@ void MainWindow::onEditDuplicateEntry()
 
     // UUID will be auto-generated by addEntry() (memset to 0 above)
 
-    // Lock original password again
-    m_pwManager->lockEntryPassword(originalEntry);
-
     // Add the duplicate entry to database
     bool success = m_pwManager->addEntry(&entryTemplate);
 
     // Clean up allocated memory
     delete[] entryTemplate.pszTitle;
     delete[] entryTemplate.pszUserName;
-    delete[] entryTemplate.pszPassword;
     delete[] entryTemplate.pszURL;
     delete[] entryTemplate.pszAdditional;
-    delete[] entryTemplate.pszBinaryDesc;
-    delete[] entryTemplate.pBinaryData;
 
     if (!success) {
         QMessageBox::critical(this, tr("Error"),
@@ -2122,7 +2199,7 @@ void MainWindow::onEditDuplicateEntry()
 void MainWindow::onEditDeleteEntry()
 {
     // Check if database is open
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2200,7 +2277,7 @@ void MainWindow::onEditDeleteEntry()
 void MainWindow::onEditDeleteGroup()
 {
     // Check if database is open
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2310,7 +2387,7 @@ void MainWindow::onEditDeleteGroup()
 void MainWindow::onEditMoveGroupUp()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnGroupMoveUp (line ~7115)
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2355,7 +2432,7 @@ void MainWindow::onEditMoveGroupUp()
 void MainWindow::onEditMoveGroupDown()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnGroupMoveDown
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2401,7 +2478,7 @@ void MainWindow::onEditMoveGroupLeft()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnGroupMoveLeft
     // Decrease tree level (move to parent's level)
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2425,8 +2502,10 @@ void MainWindow::onEditMoveGroupLeft()
         return;
     }
 
-    // Decrease tree level
-    group->usLevel--;
+    // Decrease tree level (through PwManager, so the group tree index is rebuilt)
+    PW_GROUP groupTemplate = *group;
+    --groupTemplate.usLevel;
+    m_pwManager->setGroup(m_pwManager->getGroupByIdN(group->uGroupId), &groupTemplate);
 
     // Update UI
     m_isModified = true;
@@ -2449,7 +2528,7 @@ void MainWindow::onEditMoveGroupRight()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnGroupMoveRight
     // Increase tree level (make it a child of previous sibling)
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2484,8 +2563,10 @@ void MainWindow::onEditMoveGroupRight()
         return;
     }
 
-    // Increase tree level
-    group->usLevel++;
+    // Increase tree level (through PwManager, so the group tree index is rebuilt)
+    PW_GROUP groupTemplate = *group;
+    ++groupTemplate.usLevel;
+    m_pwManager->setGroup(groupIndex, &groupTemplate);
 
     // Update UI
     m_isModified = true;
@@ -2510,7 +2591,7 @@ void MainWindow::onEditMoveGroupRight()
 void MainWindow::onEditSortGroups()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnGroupSort
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2563,7 +2644,7 @@ void MainWindow::onEditSortGroups()
 void MainWindow::onEditMoveEntryUp()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnPwlistMoveUp (line ~6540)
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2606,7 +2687,7 @@ void MainWindow::onEditMoveEntryUp()
 void MainWindow::onEditMoveEntryDown()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnPwlistMoveDown (line ~6595)
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2650,7 +2731,7 @@ void MainWindow::onEditMoveEntryDown()
 void MainWindow::onEditFind()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp _Find method
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2727,6 +2808,51 @@ void MainWindow::onEditFind()
         tr("Found %n matching entr(ies) for '%1'", "", results.count()).arg(searchString));
 }
 
+void MainWindow::onQuickFind(const QString &text)
+{
+    // Reference: MFC PwSafeDlg::OnQuickFind
+    // Runs on every keystroke; while the text only grows, the search session
+    // checks just the entries that matched the previous text
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isLocked || m_isBusy) {
+        return;
+    }
+
+    if (text.isEmpty()) {
+        // Back to the selected group
+        m_pwManager->getSearchSession().reset();
+        m_entryModel->clearIndexFilter();
+        onGroupSelectionChanged();
+        return;
+    }
+
+    PwSettings &settings = PwSettings::instance();
+    quint32 searchFlags = PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_ADDITIONAL | PWMF_GROUPNAME;
+    if (settings.get("Advanced/QuickFindInPasswords", false).toBool()) {
+        searchFlags |= PWMF_PASSWORD;
+    }
+    const bool excludeBackups = !settings.get("Advanced/QuickFindIncBackup", false).toBool();
+    const bool excludeExpired = !settings.get("Advanced/QuickFindIncExpired", false).toBool();
+
+    const QList<quint32> results = m_pwManager->getSearchSession().search(
+        text, false, searchFlags, excludeBackups, excludeExpired);
+
+    m_entryModel->clearGroupFilter();
+    m_entryModel->setIndexFilter(results);
+    m_statusLabel->setText(tr("Found %n matching entr(ies)", "", results.count()));
+}
+
+void MainWindow::onQuickFindReturn()
+{
+    // Optionally continue in the result list, like MFC's "focus after quick find"
+    if (!PwSettings::instance().get("Advanced/FocusAfterQuickFind", false).toBool()) {
+        return;
+    }
+    if (m_entryModel->rowCount() > 0) {
+        m_entryView->selectRow(0);
+        m_entryView->setFocus();
+    }
+}
+
 void MainWindow::onViewToolbar()
 {
     m_toolBar->setVisible(m_actionViewToolbar->isChecked());
@@ -2760,6 +2886,10 @@ void MainWindow::onToolsOptions()
         hotkey.unregisterHotkey();
 
         PwSettings& settings = PwSettings::instance();
+
+        // Passwords only go into the search index if they are searched for
+        m_pwManager->setSearchIndexPasswords(settings.get("Advanced/QuickFindInPasswords", false).toBool());
+
         if (settings.getAutoTypeEnabled()) {
             QKeySequence keySeq = dialog.autoTypeGlobalHotkey();
             if (!keySeq.isEmpty()) {
@@ -2787,7 +2917,7 @@ void MainWindow::onToolsPasswordGenerator()
 void MainWindow::onToolsDatabaseSettings()
 {
     // Reference: MFC shows DbSettingsDlg
-    if ((m_pwManager == nullptr) || !m_hasDatabase) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isBusy) {
         return;
     }
 
@@ -2798,6 +2928,7 @@ void MainWindow::onToolsDatabaseSettings()
     dialog.setEncryptionAlgorithm(m_pwManager->getAlgorithm());
     dialog.setKeyTransformRounds(m_pwManager->getKeyEncRounds());
     dialog.setDefaultUsername(m_pwManager->getDefaultUserName());
+    dialog.setFastResave(m_pwManager->isFastResave());
 
     // Convert QColor to DWORD (0x00RRGGBB), or DWORD_MAX if invalid
     QColor color = m_pwManager->getColor();
@@ -2817,6 +2948,13 @@ void MainWindow::onToolsDatabaseSettings()
         m_pwManager->setKeyEncRounds(dialog.keyTransformRounds());
         m_pwManager->setDefaultUserName(dialog.defaultUsername());
 
+        // Fast resave is an application-wide preference
+        m_pwManager->setFastResave(dialog.fastResave());
+        PwSettings::instance().set("Security/FastResave", dialog.fastResave());
+        if (dialog.retransformKey()) {
+            m_pwManager->invalidateTransformedMasterKey();
+        }
+
         // Convert DWORD to QColor
         quint32 newColor = dialog.databaseColor();
         if (newColor == 0xFFFFFFFF) {
@@ -2843,7 +2981,7 @@ void MainWindow::onToolsDatabaseSettings()
 void MainWindow::onToolsTanWizard()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnExtrasTanWizard
-    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isLocked) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -2895,23 +3033,27 @@ void MainWindow::onToolsTanWizard()
         // Set never-expire time
         PwManager::getNeverExpireTime(&entryTemplate.tExpire);
 
-        // Add each TAN as a separate entry
+        // Title is always "<TAN>"
+        entryTemplate.pszTitle = const_cast<char*>("<TAN>");
+
+        // Build one entry per TAN, then add them all in one batch.
+        // The byte arrays keep the template strings alive until then.
+        QVector<PW_ENTRY> tanEntries;
+        QVector<QByteArray> tanStrings;
+        tanEntries.reserve(tanList.count());
+        tanStrings.reserve(tanList.count() * 2);
+
         int tanNumber = startNumber;
         for (const QString& tan : tanList) {
-            // Title is always "<TAN>"
-            QByteArray titleBytes = QString("<TAN>").toUtf8();
-            entryTemplate.pszTitle = const_cast<char*>(titleBytes.constData());
-
             // Password is the TAN code
-            QByteArray passwordBytes = tan.toUtf8();
-            entryTemplate.pszPassword = const_cast<char*>(passwordBytes.constData());
-            entryTemplate.uPasswordLen = passwordBytes.length();
+            tanStrings.append(tan.toUtf8());
+            entryTemplate.pszPassword = const_cast<char*>(tanStrings.last().constData());
+            entryTemplate.uPasswordLen = tanStrings.last().length();
 
             // Username is the sequential number (if enabled)
-            QByteArray usernameBytes;
             if (useNumbering) {
-                usernameBytes = QString::number(tanNumber).toUtf8();
-                entryTemplate.pszUserName = const_cast<char*>(usernameBytes.constData());
+                tanStrings.append(QString::number(tanNumber).toUtf8());
+                entryTemplate.pszUserName = const_cast<char*>(tanStrings.last().constData());
                 tanNumber++;
             } else {
                 entryTemplate.pszUserName = const_cast<char*>("");
@@ -2926,16 +3068,19 @@ void MainWindow::onToolsTanWizard()
             entryTemplate.pszBinaryDesc = const_cast<char*>("");
             entryTemplate.uBinaryDataLen = 0;
 
-            // UUID will be generated by AddEntry
+            // UUID will be generated by addEntries
             std::memset(&entryTemplate.uuid[0], 0, 16);
 
-            // Add the entry
-            bool success = m_pwManager->addEntry(&entryTemplate);
-            if (!success) {
-                QMessageBox::warning(this, tr("TAN Wizard"),
-                    tr("Failed to add TAN entry: %1").arg(tan));
-                break;
-            }
+            tanEntries.append(entryTemplate);
+        }
+
+        // Add the entries
+        bool success = m_pwManager->addEntries(tanEntries.constData(),
+                                               static_cast<quint32>(tanEntries.size()));
+        if (!success) {
+            QMessageBox::warning(this, tr("TAN Wizard"),
+                tr("Failed to add the TAN entries."));
+            return;
         }
 
         // Update UI
@@ -2953,6 +3098,10 @@ void MainWindow::onToolsRepairDatabase()
 {
     // Reference: MFC/MFC-KeePass/WinGUI/PwSafeDlg.cpp OnExtrasRepairDb
 
+    if (m_isBusy) {
+        return;
+    }
+
     // Cannot repair if a database is already open
     if (m_hasDatabase) {
         QMessageBox::warning(this, tr("Repair Database"),
@@ -3037,6 +3186,7 @@ void MainWindow::onToolsRepairDatabase()
     m_currentFilePath = filePath;
     m_hasDatabase = true;
     m_isModified = true;  // Mark as modified since we rescued data
+    m_expiryScheduler->start();
 
     // Update UI
     refreshModels();
@@ -3196,6 +3346,10 @@ void MainWindow::onEntryDoubleClicked(const QModelIndex &index)
 
 bool MainWindow::openDatabase(const QString &filePath)
 {
+    if (m_isBusy) {
+        return false;
+    }
+
     // Check if file exists
     if (!QFile::exists(filePath)) {
         QMessageBox::critical(this, tr("Error"),
@@ -3222,8 +3376,14 @@ bool MainWindow::openDatabase(const QString &filePath)
         return false;
     }
 
-    // Try to open the database
-    int result = m_pwManager->openDatabase(filePath, nullptr);
+    // Try to open the database (on a worker thread)
+    int result = runDatabaseOperation([this, &filePath]() { return m_pwManager->openDatabaseAsync(filePath); },
+                                      tr("Opening database..."));
+
+    if (result == PWE_CANCELED) {
+        m_statusLabel->setText(tr("Opening cancelled"));
+        return false;
+    }
 
     if (result != PWE_SUCCESS) {
         // Handle different error codes
@@ -3260,6 +3420,7 @@ bool MainWindow::openDatabase(const QString &filePath)
     m_hasDatabase = true;
     m_currentFilePath = filePath;
     m_isModified = false;
+    m_expiryScheduler->start();  // Watch the new database from now on
     refreshModels();
     updateWindowTitle();
     updateActions();
@@ -3270,6 +3431,10 @@ bool MainWindow::openDatabase(const QString &filePath)
 
 bool MainWindow::saveDatabase()
 {
+    if (m_isBusy) {
+        return false;
+    }
+
     // If no file path, use Save As
     if (m_currentFilePath.isEmpty()) {
         m_statusLabel->setText(tr("Choose save location..."));
@@ -3278,8 +3443,14 @@ bool MainWindow::saveDatabase()
 
     m_statusLabel->setText(tr("Saving database..."));
 
-    // Save to current file
-    int result = m_pwManager->saveDatabase(m_currentFilePath, nullptr);
+    // Save to current file (encrypted and written on a worker thread)
+    int result = runDatabaseOperation([this]() { return m_pwManager->saveDatabaseAsync(m_currentFilePath); },
+                                      tr("Saving database..."));
+
+    if (result == PWE_CANCELED) {
+        m_statusLabel->setText(tr("Save cancelled"));
+        return false;
+    }
 
     if (result != PWE_SUCCESS) {
         // Handle different error codes
@@ -3314,6 +3485,10 @@ bool MainWindow::saveDatabase()
 
 bool MainWindow::saveDatabaseAs()
 {
+    if (m_isBusy) {
+        return false;
+    }
+
     m_statusLabel->setText(tr("Choose save location..."));
     qApp->processEvents(); // Force status bar update
 
@@ -3349,8 +3524,14 @@ bool MainWindow::saveDatabaseAs()
         filePath += ".kdb";
     }
 
-    // Save to new file
-    int result = m_pwManager->saveDatabase(filePath, nullptr);
+    // Save to new file (encrypted and written on a worker thread)
+    int result = runDatabaseOperation([this, &filePath]() { return m_pwManager->saveDatabaseAsync(filePath); },
+                                      tr("Saving database..."));
+
+    if (result == PWE_CANCELED) {
+        m_statusLabel->setText(tr("Save cancelled"));
+        return false;
+    }
 
     if (result != PWE_SUCCESS) {
         QString errorMsg;
@@ -3383,12 +3564,77 @@ bool MainWindow::saveDatabaseAs()
     return true;
 }
 
+int MainWindow::runDatabaseOperation(const std::function<QFuture<int>()> &startOperation,
+                                     const QString &title)
+{
+    // Only one operation at a time: a nested call must neither start a second
+    // one nor finish the operation that is already running
+    if (m_isBusy || m_pwManager->isAsyncOperationPending()) {
+        return PWE_INVALID_PARAM;
+    }
+
+    // A local event loop keeps the window responsive while the worker runs;
+    // the actions stay disabled and the window-modal dialog is shown right
+    // away, so the database cannot be edited meanwhile
+    m_isBusy = true;
+    updateActions();
+
+    const QFuture<int> future = startOperation();
+
+    QProgressDialog progress(title, tr("Cancel"), 0, 100, this);
+    progress.setWindowTitle(title);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setAutoReset(false);  // Every stage counts up to 100 again
+    progress.setAutoClose(false);
+    progress.setMinimumDuration(0);
+    progress.setValue(0);
+
+    auto stageText = [this](PwManager::OperationStage stage) {
+        switch (stage) {
+            case PwManager::OperationStage::Read: return tr("Reading database file...");
+            case PwManager::OperationStage::KeyTransform: return tr("Transforming master key...");
+            case PwManager::OperationStage::Decrypt: return tr("Decrypting database...");
+            case PwManager::OperationStage::Parse: return tr("Loading groups and entries...");
+            case PwManager::OperationStage::Serialize: return tr("Preparing data...");
+            case PwManager::OperationStage::Encrypt: return tr("Encrypting database...");
+            case PwManager::OperationStage::Write: return tr("Writing database file...");
+        }
+        return QString();
+    };
+
+    QFutureWatcher<int> watcher;
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcher<int>::progressValueChanged, &progress,
+            [&progress, &stageText](int value) {
+        if (progress.wasCanceled()) {
+            return;
+        }
+        progress.setLabelText(stageText(PwManager::progressStage(value)));
+        progress.setValue(PwManager::progressPercent(value));
+    });
+    connect(&watcher, &QFutureWatcher<int>::finished, &loop, &QEventLoop::quit);
+    connect(&progress, &QProgressDialog::canceled, &watcher, &QFutureWatcher<int>::cancel);
+    watcher.setFuture(future);
+
+    if (!future.isFinished()) {
+        loop.exec();
+    }
+
+    const int result = m_pwManager->finishAsyncOperation();
+    m_isBusy = false;
+    updateActions();
+    return result;
+}
+
 bool MainWindow::closeDatabase()
 {
     m_hasDatabase = false;
     m_isModified = false;
     m_currentFilePath.clear();
 
+    // The check time belongs to this database; the next one starts afresh
+    m_expiryScheduler->stop();
+
     // Clear the database
     if (m_pwManager != nullptr) {
         m_pwManager->newDatabase(); // Reset to empty state
@@ -3450,10 +3696,8 @@ void MainWindow::onEditCopyPassword()
         return;
     }
 
-    // Unlock password, copy, then lock again (like MFC)
-    m_pwManager->unlockEntryPassword(entry);
-    QString password = QString::fromUtf8(entry->pszPassword);
-    m_pwManager->lockEntryPassword(entry);
+    // Decrypt a copy of the password; the stored bytes stay locked
+    const QString password = PwUnlockedPassword(m_pwManager, entry).toString();
 
     copyToClipboard(password);
 
@@ -3713,7 +3957,7 @@ void MainWindow::onEditAutoType()
 void MainWindow::onEditMassModify()
 {
     // Reference: MFC CPwSafeDlg::OnPwlistMassModify (PwSafeDlg.cpp)
-    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isLocked) {
+    if ((m_pwManager == nullptr) || !m_hasDatabase || m_isLocked || m_isBusy) {
         return;
     }
 
@@ -3772,7 +4016,8 @@ void MainWindow::onEditMassModify()
 
         // Modify group
         if (dialog.modifyGroup()) {
-            entry->uGroupId = dialog.getGroupId();
+            // Through PwManager, so the per-group entry lists stay in sync
+            m_pwManager->setEntryGroup(entryIndex, dialog.getGroupId());
             modified = true;
         }
 
@@ -3784,23 +4029,15 @@ void MainWindow::onEditMassModify()
 
         // Modify expiration
         if (dialog.modifyExpiration()) {
-            entry->tExpire = dialog.getExpirationTime();
+            // Through PwManager, so the expiry index stays in sync
+            const PW_TIME tExpire = dialog.getExpirationTime();
+            m_pwManager->setEntryExpiry(entryIndex, &tExpire);
             modified = true;
         }
 
         // Delete attachments
         if (dialog.deleteAttachments()) {
-            if (entry->pBinaryData != nullptr) {
-                delete[] entry->pBinaryData;
-                entry->pBinaryData = nullptr;
-            }
-            entry->uBinaryDataLen = 0;
-
-            if (entry->pszBinaryDesc != nullptr) {
-                delete[] entry->pszBinaryDesc;
-                entry->pszBinaryDesc = new char[1];
-                entry->pszBinaryDesc[0] = '\0';
-            }
+            PwUtil::removeBinaryData(entry);
             modified = true;
         }
 
@@ -3817,6 +4054,7 @@ void MainWindow::onEditMassModify()
         m_entryModel->refresh();
         m_groupModel->refresh();
         updateWindowTitle();
+        updateActions();
         m_statusLabel->setText(tr("Modified %1 entries").arg(modifiedCount));
     }
 }
@@ -3866,6 +4104,26 @@ void MainWindow::onInactivityTimer()
     }
 }
 
+void MainWindow::onEntriesExpired(const QList<quint32>& vIndexes)
+{
+    if (!m_hasDatabase || m_isLocked) {
+        return;
+    }
+
+    QString message;
+    const PW_ENTRY* entry = m_pwManager->getEntry(vIndexes.first());
+    if (vIndexes.count() == 1 && entry != nullptr) {
+        message = tr("Entry '%1' has expired").arg(QString::fromUtf8(entry->pszTitle));
+    } else {
+        message = tr("%1 entries have expired").arg(vIndexes.count());
+    }
+
+    m_statusLabel->setText(message);
+    if ((m_systemTrayIcon != nullptr) && m_systemTrayIcon->isVisible()) {
+        m_systemTrayIcon->showMessage(tr("KeePass Password Safe"), message, QSystemTrayIcon::Warning);
+    }
+}
+
 void MainWindow::resetInactivityTimer()
 {
     if (!m_hasDatabase || m_isLocked) {
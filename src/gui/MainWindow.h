@@ -19,15 +19,19 @@
 #include <QToolBar>
 #include <QMenuBar>
 #include <QLabel>
+#include <QLineEdit>
 #include <QTimer>
 #include <QByteArray>
+#include <QFuture>
 #include <QSystemTrayIcon>
+#include <functional>
 
 // Forward declarations
 class PwManager;
 class GroupModel;
 class EntryModel;
 class UpdateChecker;
+class ExpiryScheduler;
 
 class MainWindow : public QMainWindow
 {
@@ -79,6 +83,8 @@ private slots:
     void onEditMoveEntryUp();
     void onEditMoveEntryDown();
     void onEditFind();
+    void onQuickFind(const QString &text);
+    void onQuickFindReturn();
     void onEditCopyUsername();
     void onEditCopyPassword();
     void onEditVisitUrl();
@@ -139,6 +145,9 @@ private slots:
     // Inactivity timer
     void onInactivityTimer();
 
+    // Expiry notification
+    void onEntriesExpired(const QList<quint32>& vIndexes);
+
     // System tray icon
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void onTrayRestore();
@@ -166,6 +175,12 @@ private:
     bool closeDatabase();
     bool confirmSaveChanges();
 
+    // Start an asynchronous open/save of m_pwManager and wait for it behind a
+    // progress dialog with a Cancel button, then apply its result. Refused
+    // with PWE_INVALID_PARAM while another operation is running
+    int runDatabaseOperation(const std::function<QFuture<int>()> &startOperation,
+                             const QString &title);
+
     // Lock/Unlock operations
     void lockWorkspace();
     bool unlockWorkspace();
@@ -210,6 +225,7 @@ private:
     QTreeView *m_groupView;
     QTableView *m_entryView;
     QToolBar *m_toolBar;
+    QLineEdit *m_quickFindEdit;
     QLabel *m_statusLabel;
 
     // Actions - File
@@ -298,6 +314,7 @@ private:
     bool m_isModified;
     bool m_hasDatabase;
     bool m_isLocked;
+    bool m_isBusy;  // An open or save is running on a worker thread
 
     // Clipboard management
     QTimer *m_clipboardTimer;
@@ -309,6 +326,9 @@ private:
     QTimer *m_inactivityTimer;
     int m_inactivityTimeoutMs;
 
+    // Expiry notification (armed while a database is open and unlocked)
+    ExpiryScheduler *m_expiryScheduler;
+
     // System tray
     QSystemTrayIcon *m_systemTrayIcon;
     QMenu *m_trayIconMenu;
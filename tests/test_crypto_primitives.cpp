@@ -12,10 +12,23 @@
 
 #include <QtTest/QtTest>
 #include <QByteArray>
+#include <QSet>
+#include <QThread>
+#include "../src/core/crypto/CipherBackend.h"
+#include "../src/core/crypto/PayloadKernels.h"
 #include "../src/core/crypto/Rijndael.h"
-#include "../src/core/crypto/Twofish.h"
+#include "../src/core/crypto/TwofishClass.h"
 #include "../src/core/crypto/SHA256.h"
+#include "../src/core/crypto/KeyTransform.h"
+#include "../src/core/crypto/ProtectedStringCipher.h"
+#include "../src/core/util/Random.h"
 #include "../src/core/PwStructs.h"
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 class TestCryptoPrimitives : public QObject
 {
@@ -31,6 +44,10 @@ private slots:
     void testAES256_ECB();
     void testAES256_CBC();
     void testRijndaelPadEncrypt();
+    void testCbcDecryptInPieces();
+    void testCipherBackends();
+    void testParallelCbcDecrypt();
+    void testPayloadKernels();
 
     // Twofish Tests
     void testTwofish128();
@@ -42,10 +59,21 @@ private slots:
     void testSHA256_SingleBlock();
     void testSHA256_MultiBlock();
     void testSHA256_Incremental();
+    void testSHA256_Backends();
+    void testSHA256_HashMany();
 
     // Key Transformation Tests
     void testKeyTransformation();
     void testKeyTransformationRounds();
+    void testKeyTransformBackends();
+    void testKeyTransformCalibration();
+
+    // In-memory string protection
+    void testProtectedStringCipher();
+
+    // Random number generator
+    void testRandomGenerator();
+    void testRandomAfterFork();
 
     // Time Compression Tests
     void testPwTimeSize();
@@ -255,6 +283,290 @@ void TestCryptoPrimitives::testRijndaelPadEncrypt()
     QCOMPARE(decryptedText, originalText);
 }
 
+void TestCryptoPrimitives::testCbcDecryptInPieces()
+{
+    // openDatabase decrypts the file in pieces; the result must match a
+    // single PadDecrypt call for both ciphers
+
+    QByteArray key = hexToBytes("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    QByteArray iv = hexToBytes("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    const UINT8* pKey = reinterpret_cast<const UINT8*>(key.constData());
+    const UINT8* pIV = reinterpret_cast<const UINT8*>(iv.constData());
+
+    QByteArray plaintext;
+    for (int i = 0; i < 100; ++i) {
+        plaintext.append(static_cast<char>(i * 7));
+    }
+    const UINT8* pPlain = reinterpret_cast<const UINT8*>(plaintext.constData());
+
+    // AES: whole blocks with BlockDecrypt, continued via SetInitVector
+    UINT8 ciphertext[128];
+    CRijndael aesEnc;
+    QCOMPARE(aesEnc.Init(CRijndael::CBC, CRijndael::EncryptDir, pKey, CRijndael::Key32Bytes, pIV),
+             RIJNDAEL_SUCCESS);
+    const int ciphertextLen = aesEnc.PadEncrypt(pPlain, plaintext.size(), ciphertext);
+    QCOMPARE(ciphertextLen, 112);
+
+    CRijndael aesDec;
+    QCOMPARE(aesDec.Init(CRijndael::CBC, CRijndael::DecryptDir, pKey, CRijndael::Key32Bytes, pIV),
+             RIJNDAEL_SUCCESS);
+    UINT8 nextIV[16];
+    std::memcpy(nextIV, ciphertext + 48, 16);
+    QCOMPARE(aesDec.BlockDecrypt(ciphertext, 64 * 8, ciphertext), 64 * 8);
+    aesDec.SetInitVector(nextIV);
+    QCOMPARE(aesDec.PadDecrypt(ciphertext + 64, ciphertextLen - 64, ciphertext + 64), 36);
+    QCOMPARE(QByteArray(reinterpret_cast<const char*>(ciphertext), 100), plaintext);
+
+    // Twofish: BlockDecrypt carries the IV by itself
+    CTwofish twofishEnc;
+    QVERIFY(twofishEnc.Init(pKey, 32, pIV));
+    QCOMPARE(twofishEnc.PadEncrypt(pPlain, plaintext.size(), ciphertext), 112);
+
+    CTwofish twofishDec;
+    QVERIFY(twofishDec.Init(pKey, 32, pIV));
+    QCOMPARE(twofishDec.BlockDecrypt(ciphertext, 64, ciphertext), 64);
+    QCOMPARE(twofishDec.PadDecrypt(ciphertext + 64, 48, ciphertext + 64), 36);
+    QCOMPARE(QByteArray(reinterpret_cast<const char*>(ciphertext), 100), plaintext);
+}
+
+void TestCryptoPrimitives::testCipherBackends()
+{
+    // Every implementation must produce byte-identical output to the
+    // reference one, also when decrypting in pieces like openDatabase
+
+    QByteArray key = hexToBytes("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray iv = hexToBytes("000102030405060708090a0b0c0d0e0f");
+    const quint8* pKey = reinterpret_cast<const quint8*>(key.constData());
+    const quint8* pIV = reinterpret_cast<const quint8*>(iv.constData());
+
+    const CipherBackend::Cipher ciphers[] = {
+        CipherBackend::Cipher::Aes256, CipherBackend::Cipher::Twofish256
+    };
+    const CipherBackend::Implementation impls[] = {
+        CipherBackend::Implementation::Reference, CipherBackend::Implementation::OpenSsl
+    };
+    const int sizes[] = { 0, 1, 15, 16, 17, 100, 4096, 70001 };
+
+    QVERIFY(CipherBackend::isSupported(CipherBackend::Cipher::Aes256,
+                                       CipherBackend::Implementation::OpenSsl));
+    QVERIFY(!CipherBackend::isSupported(CipherBackend::Cipher::Twofish256,
+                                        CipherBackend::Implementation::OpenSsl));
+    QVERIFY(CipherBackend::create(CipherBackend::Cipher::Twofish256,
+                                  CipherBackend::Implementation::OpenSsl) == nullptr);
+
+    for (CipherBackend::Cipher cipher : ciphers) {
+        for (int size : sizes) {
+            QByteArray plaintext(size, Qt::Uninitialized);
+            for (int i = 0; i < size; ++i) {
+                plaintext[i] = static_cast<char>((i * 31 + 7) & 0xFF);
+            }
+            const quint8* pPlain = reinterpret_cast<const quint8*>(plaintext.constData());
+
+            QByteArray referenceCiphertext;
+            for (CipherBackend::Implementation impl : impls) {
+                std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(cipher, impl);
+                if (pEnc == nullptr)
+                    continue;
+                QCOMPARE(pEnc->implementation(), impl);
+
+                QByteArray ciphertext(size + 16, 0);
+                QVERIFY(pEnc->init(true, pKey, pIV));
+                const qint64 nLen = pEnc->padEncrypt(pPlain, static_cast<quint32>(size),
+                                                     reinterpret_cast<quint8*>(ciphertext.data()));
+                QCOMPARE(nLen, (size == 0) ? 0 : ((size / 16) + 1) * 16);
+                ciphertext.truncate(static_cast<int>(nLen));
+
+                if (impl == CipherBackend::Implementation::Reference)
+                    referenceCiphertext = ciphertext;
+                QCOMPARE(ciphertext, referenceCiphertext);
+                if (size == 0)
+                    continue;
+
+                // Decrypt in 32-byte pieces, then the last piece with padding
+                std::unique_ptr<CipherBackend> pDec = CipherBackend::create(cipher, impl);
+                QVERIFY(pDec->init(false, pKey, pIV));
+                quint8* pData = reinterpret_cast<quint8*>(ciphertext.data());
+                quint32 uPos = 0;
+                while ((static_cast<quint32>(nLen) - uPos) > 32) {
+                    QVERIFY(pDec->decryptBlocks(pData + uPos, 32));
+                    uPos += 32;
+                }
+                QCOMPARE(pDec->decryptFinal(pData + uPos, static_cast<quint32>(nLen) - uPos),
+                         static_cast<qint32>(size - uPos));
+                QCOMPARE(ciphertext.left(size), plaintext);
+            }
+        }
+    }
+
+    // Bad padding is rejected by every implementation: dropping the padding
+    // block of an all-zero plaintext leaves a final block ending in 0x00
+    for (CipherBackend::Implementation impl : impls) {
+        std::unique_ptr<CipherBackend> pCipher =
+            CipherBackend::create(CipherBackend::Cipher::Aes256, impl);
+        QByteArray zeros(16, 0);
+        QByteArray ciphertext(32, 0);
+        QVERIFY(pCipher->init(true, pKey, pIV));
+        QCOMPARE(pCipher->padEncrypt(reinterpret_cast<const quint8*>(zeros.constData()), 16,
+                                     reinterpret_cast<quint8*>(ciphertext.data())),
+                 static_cast<qint64>(32));
+
+        pCipher = CipherBackend::create(CipherBackend::Cipher::Aes256, impl);
+        QVERIFY(pCipher->init(false, pKey, pIV));
+        QVERIFY(pCipher->decryptFinal(reinterpret_cast<quint8*>(ciphertext.data()), 16) < 0);
+    }
+
+    // Cross-check mode runs both implementations on every call
+    CipherBackend::setCrossCheck(true);
+    QVERIFY(CipherBackend::isCrossCheckEnabled());
+    for (CipherBackend::Cipher cipher : ciphers) {
+        QByteArray data(1000, 'x');
+        std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(cipher);
+        QVERIFY(pEnc->init(true, pKey, pIV));
+        QByteArray ciphertext(1016, 0);
+        const qint64 nLen = pEnc->padEncrypt(reinterpret_cast<const quint8*>(data.constData()), 1000,
+                                             reinterpret_cast<quint8*>(ciphertext.data()));
+        QCOMPARE(nLen, static_cast<qint64>(1008));
+
+        std::unique_ptr<CipherBackend> pDec = CipherBackend::create(cipher);
+        QVERIFY(pDec->init(false, pKey, pIV));
+        quint8* pData = reinterpret_cast<quint8*>(ciphertext.data());
+        QVERIFY(pDec->decryptBlocks(pData, 512));
+        QCOMPARE(pDec->decryptFinal(pData + 512, 496), 488);
+        QCOMPARE(ciphertext.left(1000), data);
+    }
+    CipherBackend::setCrossCheck(false);
+}
+
+void TestCryptoPrimitives::testParallelCbcDecrypt()
+{
+    // Each slice starts from the previous slice's last ciphertext block; the
+    // result must match the sequential decryption for any thread count,
+    // piece size and slice boundary
+
+    QByteArray key = hexToBytes("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    QByteArray iv = hexToBytes("0f0e0d0c0b0a09080706050403020100");
+    const quint8* pKey = reinterpret_cast<const quint8*>(key.constData());
+    const quint8* pIV = reinterpret_cast<const quint8*>(iv.constData());
+
+    const int sizes[] = { 1, 16, 65536, 65537, 300001 };
+    const int threadCounts[] = { 1, 2, 3, 8 };
+
+    for (CipherBackend::Cipher cipher : { CipherBackend::Cipher::Aes256, CipherBackend::Cipher::Twofish256 }) {
+        for (int size : sizes) {
+            QByteArray plaintext(size, Qt::Uninitialized);
+            for (int i = 0; i < size; ++i) {
+                plaintext[i] = static_cast<char>((i * 131 + 3) & 0xFF);
+            }
+
+            QByteArray ciphertext(size + 16, 0);
+            std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(cipher);
+            QVERIFY(pEnc->init(true, pKey, pIV));
+            const qint64 nLen = pEnc->padEncrypt(reinterpret_cast<const quint8*>(plaintext.constData()),
+                                                 static_cast<quint32>(size),
+                                                 reinterpret_cast<quint8*>(ciphertext.data()));
+            QVERIFY(nLen > 0);
+            ciphertext.truncate(static_cast<int>(nLen));
+
+            for (int nThreads : threadCounts) {
+                QByteArray data = ciphertext;
+                quint8* pData = reinterpret_cast<quint8*>(data.data());
+                std::unique_ptr<CipherBackend> pDec = CipherBackend::createParallelDecryptor(cipher, nThreads);
+                QVERIFY(!pDec->init(true, pKey, pIV));  // Decryption only
+                QVERIFY(pDec->init(false, pKey, pIV));
+
+                // 128 KB pieces, so the chaining value also crosses calls
+                quint32 uPos = 0;
+                while ((static_cast<quint32>(nLen) - uPos) > 131072) {
+                    QVERIFY(pDec->decryptBlocks(pData + uPos, 131072));
+                    uPos += 131072;
+                }
+                QCOMPARE(pDec->decryptFinal(pData + uPos, static_cast<quint32>(nLen) - uPos),
+                         static_cast<qint32>(size - uPos));
+                QCOMPARE(data.left(size), plaintext);
+            }
+        }
+    }
+
+    // The padding is still checked at the end
+    QByteArray zeros(16, 0);
+    QByteArray ciphertext(32, 0);
+    std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(CipherBackend::Cipher::Aes256);
+    QVERIFY(pEnc->init(true, pKey, pIV));
+    QCOMPARE(pEnc->padEncrypt(reinterpret_cast<const quint8*>(zeros.constData()), 16,
+                              reinterpret_cast<quint8*>(ciphertext.data())),
+             static_cast<qint64>(32));
+    std::unique_ptr<CipherBackend> pDec = CipherBackend::createParallelDecryptor(CipherBackend::Cipher::Aes256, 4);
+    QVERIFY(pDec->init(false, pKey, pIV));
+    QVERIFY(pDec->decryptFinal(reinterpret_cast<quint8*>(ciphertext.data()), 16) < 0);
+}
+
+void TestCryptoPrimitives::testPayloadKernels()
+{
+    // Tiled hash-then-encrypt and decrypt-then-hash must give the same
+    // ciphertext, plaintext and hash as one pass per step
+
+    QByteArray key = hexToBytes("8899aabbccddeeff00112233445566778899aabbccddeeff0011223344556677");
+    QByteArray iv = hexToBytes("00112233445566778899aabbccddeeff");
+    const quint8* pKey = reinterpret_cast<const quint8*>(key.constData());
+    const quint8* pIV = reinterpret_cast<const quint8*>(iv.constData());
+
+    const int sizes[] = { 1, 16, 17, 1000, 65536, 65537, 200000 };
+    const quint32 tileSizes[] = { 16, 48, PayloadKernels::DEFAULT_TILE_SIZE };
+
+    for (CipherBackend::Cipher cipher : { CipherBackend::Cipher::Aes256, CipherBackend::Cipher::Twofish256 }) {
+        for (int size : sizes) {
+            QByteArray plaintext(size, Qt::Uninitialized);
+            for (int i = 0; i < size; ++i) {
+                plaintext[i] = static_cast<char>((i * 29 + size) & 0xFF);
+            }
+            const QByteArray expectedHash = SHA256::hash(plaintext);
+
+            QByteArray expected(size + 16, 0);
+            std::unique_ptr<CipherBackend> pRef = CipherBackend::create(cipher, CipherBackend::Implementation::Reference);
+            QVERIFY(pRef->init(true, pKey, pIV));
+            const qint64 nLen = pRef->padEncrypt(reinterpret_cast<const quint8*>(plaintext.constData()),
+                                                 static_cast<quint32>(size),
+                                                 reinterpret_cast<quint8*>(expected.data()));
+            expected.truncate(static_cast<int>(nLen));
+
+            for (quint32 uTile : tileSizes) {
+                QByteArray data = plaintext;
+                data.resize(size + 16);
+                quint8* pData = reinterpret_cast<quint8*>(data.data());
+
+                std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(cipher);
+                QVERIFY(pEnc->init(true, pKey, pIV));
+                SHA256::Context saveHash;
+                QCOMPARE(PayloadKernels::hashThenEncrypt(*pEnc, saveHash, pData, static_cast<quint32>(size), uTile),
+                         nLen);
+                QCOMPARE(saveHash.finalize(), expectedHash);
+                data.truncate(static_cast<int>(nLen));
+                QCOMPARE(data, expected);
+
+                // Open in two pieces, like openDatabase reading the file
+                const quint32 uFirst = (static_cast<quint32>(nLen) / 32) * 16;
+                std::unique_ptr<CipherBackend> pDec = CipherBackend::create(cipher);
+                QVERIFY(pDec->init(false, pKey, pIV));
+                SHA256::Context openHash;
+                QCOMPARE(PayloadKernels::decryptThenHash(*pDec, &openHash, pData, uFirst, false, uTile),
+                         static_cast<qint64>(uFirst));
+                QCOMPARE(PayloadKernels::decryptThenHash(*pDec, &openHash, pData + uFirst,
+                                                         static_cast<quint32>(nLen) - uFirst, true, uTile),
+                         static_cast<qint64>(size) - uFirst);
+                QCOMPARE(openHash.finalize(), expectedHash);
+                QCOMPARE(data.left(size), plaintext);
+            }
+        }
+    }
+
+    // Tiles must be whole blocks
+    QByteArray data(32, 0);
+    std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(CipherBackend::Cipher::Aes256);
+    QVERIFY(pEnc->init(true, pKey, pIV));
+    SHA256::Context hash;
+    QVERIFY(PayloadKernels::hashThenEncrypt(*pEnc, hash, reinterpret_cast<quint8*>(data.data()), 16, 20) < 0);
+}
+
 // =============================================================================
 // Twofish Tests (Official Twofish Test Vectors)
 // =============================================================================
@@ -420,6 +732,105 @@ void TestCryptoPrimitives::testSHA256_Incremental()
     QCOMPARE(bytesToHex(hash), bytesToHex(expectedHash));
 }
 
+void TestCryptoPrimitives::testSHA256_Backends()
+{
+    // Every supported backend must reproduce the NIST vectors above, also
+    // when the input arrives in pieces that do not line up with the blocks
+
+    struct Vector { QByteArray input; const char* expected; };
+    const Vector vectors[] = {
+        { QByteArray(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { QByteArray("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { QByteArray("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+        { QByteArray(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" }
+    };
+
+    QVERIFY(SHA256::isBackendSupported(SHA256::activeBackend()));
+    const SHA256::Backend backends[] = {
+        SHA256::Backend::Portable, SHA256::Backend::OpenSsl, SHA256::Backend::ShaNi
+    };
+
+    for (SHA256::Backend backend : backends) {
+        if (!SHA256::isBackendSupported(backend)) {
+            qDebug() << "SHA-256 backend not supported on this CPU:" << SHA256::backendName(backend);
+            continue;
+        }
+
+        for (const Vector& v : vectors) {
+            QByteArray hash(32, 0);
+            SHA256::hash(reinterpret_cast<const unsigned char*>(v.input.constData()),
+                         static_cast<unsigned long>(v.input.size()),
+                         reinterpret_cast<unsigned char*>(hash.data()), backend);
+            QCOMPARE(bytesToHex(hash), QString::fromLatin1(v.expected));
+
+            SHA256::Context ctx(backend);
+            for (int nPos = 0; nPos < v.input.size(); nPos += 63) {
+                ctx.update(v.input.mid(nPos, 63));
+            }
+            QCOMPARE(bytesToHex(ctx.finalize()), QString::fromLatin1(v.expected));
+        }
+
+        // Lengths around the padding boundaries
+        for (int nLength = 50; nLength <= 130; ++nLength) {
+            QByteArray input(nLength, static_cast<char>(nLength));
+            QByteArray hash(32, 0);
+            SHA256::hash(reinterpret_cast<const unsigned char*>(input.constData()),
+                         static_cast<unsigned long>(nLength),
+                         reinterpret_cast<unsigned char*>(hash.data()), backend);
+
+            QByteArray reference(32, 0);
+            SHA256::hash(reinterpret_cast<const unsigned char*>(input.constData()),
+                         static_cast<unsigned long>(nLength),
+                         reinterpret_cast<unsigned char*>(reference.data()), SHA256::Backend::Portable);
+            QCOMPARE(hash, reference);
+        }
+    }
+}
+
+void TestCryptoPrimitives::testSHA256_HashMany()
+{
+    // Both batch modes give each message the digest SHA256::hash gives it,
+    // in the input order, whatever the mix of lengths
+
+    QVector<QByteArray> vInputs;
+    for (int i = 0; i < 37; ++i) {
+        QByteArray input((i * 97) % 301, Qt::Uninitialized);
+        for (int j = 0; j < input.size(); ++j) {
+            input[j] = static_cast<char>(i + j * 13);
+        }
+        vInputs.append(input);
+    }
+
+    QVector<const unsigned char*> vPointers;
+    QVector<unsigned long> vLengths;
+    for (const QByteArray& input : vInputs) {
+        vPointers.append(reinterpret_cast<const unsigned char*>(input.constData()));
+        vLengths.append(static_cast<unsigned long>(input.size()));
+    }
+
+    for (SHA256::BatchMode mode : { SHA256::BatchMode::Sequential, SHA256::BatchMode::Avx2x8 }) {
+        if (!SHA256::isBatchModeSupported(mode)) {
+            qDebug() << "SHA-256 AVX2 batch mode not supported on this CPU";
+            continue;
+        }
+
+        QByteArray digests(32 * vInputs.size(), 0);
+        SHA256::hashMany(vPointers.constData(), vLengths.constData(), vInputs.size(),
+                         reinterpret_cast<unsigned char*>(digests.data()), mode);
+        for (int i = 0; i < vInputs.size(); ++i) {
+            QCOMPARE(digests.mid(32 * i, 32), SHA256::hash(vInputs[i]));
+        }
+    }
+
+    const QVector<QByteArray> vDigests = SHA256::hashMany(vInputs);
+    QCOMPARE(vDigests.size(), vInputs.size());
+    for (int i = 0; i < vInputs.size(); ++i) {
+        QCOMPARE(vDigests[i], SHA256::hash(vInputs[i]));
+    }
+    QVERIFY(SHA256::hashMany(QVector<QByteArray>()).isEmpty());
+}
+
 // =============================================================================
 // Key Transformation Tests (KeePass-specific)
 // =============================================================================
@@ -510,6 +921,270 @@ void TestCryptoPrimitives::testKeyTransformationRounds()
     QVERIFY(!compareBytes(key1, key2, 32));
 }
 
+void TestCryptoPrimitives::testKeyTransformBackends()
+{
+    // Every backend must match plain AES-256 ECB applied round by round
+
+    UINT8 expected[32];
+    UINT8 seed[32];
+    for (int i = 0; i < 32; ++i) {
+        expected[i] = static_cast<UINT8>(255 - i);
+        seed[i] = static_cast<UINT8>(i * 3 + 1);
+    }
+    UINT8 input[32];
+    std::memcpy(input, expected, 32);
+
+    CRijndael aes;
+    aes.Init(CRijndael::ECB, CRijndael::EncryptDir, seed, CRijndael::Key32Bytes, nullptr);
+    for (int i = 0; i < 1000; ++i) {
+        aes.BlockEncrypt(expected, 128, expected);
+        aes.BlockEncrypt(expected + 16, 128, expected + 16);
+    }
+
+    QVERIFY(KeyTransform::isBackendSupported(KeyTransform::Backend::OpenSsl));
+    for (KeyTransform::Backend backend : { KeyTransform::Backend::OpenSsl, KeyTransform::Backend::AesNi }) {
+        if (!KeyTransform::isBackendSupported(backend))
+            continue;
+
+        UINT8 buffer[32];
+        std::memcpy(buffer, input, 32);
+        QVERIFY(KeyTransform::transform256(1000, buffer, seed, backend));
+        QVERIFY2(compareBytes(buffer, expected, 32), KeyTransform::backendName(backend));
+    }
+
+    // The default overload uses the active backend
+    UINT8 buffer[32];
+    std::memcpy(buffer, input, 32);
+    QVERIFY(KeyTransform::transform256(1000, buffer, seed));
+    QVERIFY(compareBytes(buffer, expected, 32));
+}
+
+void TestCryptoPrimitives::testKeyTransformCalibration()
+{
+    for (KeyTransform::Backend backend : { KeyTransform::Backend::OpenSsl, KeyTransform::Backend::AesNi }) {
+        const KeyTransform::Calibration calibration = KeyTransform::calibrate(backend, 5, 20);
+        QVERIFY(calibration.backend == backend);
+        if (!KeyTransform::isBackendSupported(backend)) {
+            QCOMPARE(calibration.qwMedianRoundsPerSec, quint64(0));
+            QCOMPARE(KeyTransform::roundsForDuration(calibration, 1000), 0u);
+            continue;
+        }
+
+        QCOMPARE(calibration.dwTrials, 5u);
+        QVERIFY2(calibration.qwMedianRoundsPerSec > 10000, KeyTransform::backendName(backend));
+        QVERIFY(calibration.qwP95RoundsPerSec > 0);
+        QVERIFY(calibration.qwP95RoundsPerSec <= calibration.qwMedianRoundsPerSec);
+    }
+
+    // Conversions between rounds and time
+    KeyTransform::Calibration calibration;
+    calibration.qwMedianRoundsPerSec = 2000000;
+    calibration.qwP95RoundsPerSec = 1000000;
+    QCOMPARE(KeyTransform::roundsForDuration(calibration, 1000), 2000000u);
+    QCOMPARE(KeyTransform::roundsForDuration(calibration, 250), 500000u);
+    QCOMPARE(KeyTransform::roundsForDuration(calibration, 0), 1u);
+    QCOMPARE(KeyTransform::durationForRounds(calibration, 3000000), 1500.0);
+    QCOMPARE(KeyTransform::durationForRounds(calibration, 3000000, true), 3000.0);
+
+    // Round counts stay within the file format limit
+    calibration.qwMedianRoundsPerSec = quint64(1) << 40;
+    QCOMPARE(KeyTransform::roundsForDuration(calibration, 60000), 0xFFFFFFFEu);
+
+    // Invalid arguments give an empty calibration
+    QCOMPARE(KeyTransform::calibrate(KeyTransform::Backend::OpenSsl, 0, 20).qwMedianRoundsPerSec, quint64(0));
+    QVERIFY(!KeyTransform::cpuModelName().isEmpty());
+}
+
+void TestCryptoPrimitives::testProtectedStringCipher()
+{
+    // NIST SP 800-38A F.5.5 (CTR-AES256.Encrypt), plus counters that carry
+    // out of the low 64 bits and wrap around 2^128 (reference: OpenSSL
+    // EVP_aes_256_ctr, 40 zero bytes so the last block is partial)
+
+    const QByteArray key = hexToBytes(
+        "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+
+    struct Vector { const char* nonce; QByteArray plain; const char* expected; };
+    const Vector vectors[] = {
+        { "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+          hexToBytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                     "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710"),
+          "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+          "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6" },
+        { "0011223344556677ffffffffffffffff", QByteArray(40, 0),
+          "2465d5379acdf198d9c064a072c9f47193ac15aae3afb879eb0b14c17676f54ef36de3e7a5c6fedc" },
+        { "ffffffffffffffffffffffffffffffff", QByteArray(40, 0),
+          "3b3c2921c85a24de9ac606ce6d1d60cce568f68194cf76d6174d4cc04310a85491151e5d0b7a1f1b" }
+    };
+
+    // Strings of all lengths up to a few blocks, each with its own nonce
+    QList<QByteArray> plains;
+    QList<QByteArray> nonces;
+    for (int i = 0; i < 150; ++i) {
+        QByteArray plain(i % 75, 0);
+        QByteArray nonce(16, 0);
+        for (int j = 0; j < plain.size(); ++j)
+            plain[j] = static_cast<char>(i * 7 + j);
+        for (int j = 0; j < 16; ++j)
+            nonce[j] = static_cast<char>((i < 20) ? 0xFF : (i * 13 + j));
+        plains.append(plain);
+        nonces.append(nonce);
+    }
+
+    QVERIFY(ProtectedStringCipher::isBackendSupported(ProtectedStringCipher::activeBackend()));
+    QList<QByteArray> reference;
+
+    for (ProtectedStringCipher::Backend backend : { ProtectedStringCipher::Backend::OpenSsl,
+                                                    ProtectedStringCipher::Backend::AesNi }) {
+        if (!ProtectedStringCipher::isBackendSupported(backend)) {
+            qDebug() << "String cipher backend not supported on this CPU:"
+                     << ProtectedStringCipher::backendName(backend);
+            continue;
+        }
+
+        ProtectedStringCipher cipher(backend);
+        QByteArray data(16, 0);
+        QVERIFY(!cipher.crypt(reinterpret_cast<const quint8*>(nonces[0].constData()),
+                              reinterpret_cast<quint8*>(data.data()), 16));  // No key yet
+        QVERIFY(cipher.setKey(reinterpret_cast<const quint8*>(key.constData())));
+
+        for (const Vector& v : vectors) {
+            const QByteArray nonce = hexToBytes(QString::fromLatin1(v.nonce));
+            data = v.plain;
+            QVERIFY(cipher.crypt(reinterpret_cast<const quint8*>(nonce.constData()),
+                                 reinterpret_cast<quint8*>(data.data()),
+                                 static_cast<quint32>(data.size())));
+            QVERIFY2(bytesToHex(data) == QString::fromLatin1(v.expected),
+                     ProtectedStringCipher::backendName(backend));
+
+            // Encryption and decryption are the same operation
+            QVERIFY(cipher.crypt(reinterpret_cast<const quint8*>(nonce.constData()),
+                                 reinterpret_cast<quint8*>(data.data()),
+                                 static_cast<quint32>(data.size())));
+            QCOMPARE(data, v.plain);
+        }
+
+        // cryptMany and Batch must give the same bytes as one crypt per string
+        QList<QByteArray> single = plains;
+        QList<QByteArray> many = plains;
+        QList<QByteArray> batched = plains;
+        QList<ProtectedStringCipher::Item> items;
+        {
+            ProtectedStringCipher::Batch batch(cipher);
+            for (int i = 0; i < plains.size(); ++i) {
+                const quint8* pNonce = reinterpret_cast<const quint8*>(nonces[i].constData());
+                const quint32 uSize = static_cast<quint32>(plains[i].size());
+                QVERIFY(cipher.crypt(pNonce, reinterpret_cast<quint8*>(single[i].data()), uSize));
+                items.append(ProtectedStringCipher::Item{ pNonce, reinterpret_cast<quint8*>(many[i].data()), uSize });
+                batch.add(pNonce, reinterpret_cast<quint8*>(batched[i].data()), uSize);
+            }
+            QVERIFY(cipher.cryptMany(items.constData(), static_cast<int>(items.size())));
+            QVERIFY(batch.flush());
+        }
+        QCOMPARE(many, single);
+        QCOMPARE(batched, single);
+
+        // All backends produce the same keystream
+        if (reference.isEmpty())
+            reference = single;
+        QCOMPARE(single, reference);
+    }
+}
+
+void TestCryptoPrimitives::testRandomGenerator()
+{
+    // Small requests come from the per-thread buffer, large ones from
+    // RAND_bytes; both must produce fresh bytes every time
+    for (int size : { 4, 16, 100, 1023, 1024, 5000 }) {
+        const QByteArray a = Random::generateBytes(size);
+        const QByteArray b = Random::generateBytes(size);
+        QCOMPARE(a.size(), size);
+        QVERIFY(a != b);
+    }
+
+    // Requests crossing buffer refills
+    QByteArray stream(3000, 0);
+    for (int nPos = 0; nPos < stream.size(); nPos += 100)
+        QVERIFY(Random::fillBuffer(reinterpret_cast<quint8*>(stream.data()) + nPos, 100));
+    QVERIFY(stream.count('\0') < 60);  // About 12 expected
+
+    // Batch UUIDs are all different
+    QByteArray uuids(1000 * 16, 0);
+    QVERIFY(Random::generateUuids(reinterpret_cast<quint8*>(uuids.data()), 1000));
+    QSet<QByteArray> seen;
+    for (int i = 0; i < 1000; ++i)
+        seen.insert(uuids.mid(i * 16, 16));
+    QCOMPARE(seen.size(), 1000);
+    QVERIFY(!Random::generateUuids(nullptr, 1));
+
+    // uniform() stays in range and hits every value about equally often
+    QCOMPARE(Random::uniform(0), 0u);
+    QCOMPARE(Random::uniform(1), 0u);
+    constexpr int BUCKETS = 7;
+    constexpr int SAMPLES = 70000;
+    int aCounts[BUCKETS] = { 0 };
+    for (int i = 0; i < SAMPLES; ++i) {
+        const quint32 value = Random::uniform(BUCKETS);
+        QVERIFY(value < static_cast<quint32>(BUCKETS));
+        ++aCounts[value];
+    }
+    for (int nCount : aCounts)
+        QVERIFY(qAbs(nCount - SAMPLES / BUCKETS) < 500);  // > 5 sigma
+
+    // A bound just above 2^31 rejects almost half of all values
+    for (int i = 0; i < 100; ++i)
+        QVERIFY(Random::uniform(0x80000001u) <= 0x80000000u);
+
+    // New entropy makes the generators reseed; output continues normally
+    const quint8 aEntropy[4] = { 1, 2, 3, 4 };
+    const QByteArray before = Random::generateBytes(32);
+    Random::addEntropy(aEntropy, sizeof(aEntropy));
+    QVERIFY(Random::generateBytes(32) != before);
+
+    // Every thread has its own generator
+    QByteArray otherThread;
+    QThread* pThread = QThread::create([&otherThread]() { otherThread = Random::generateBytes(32); });
+    pThread->start();
+    QVERIFY(pThread->wait(10000));
+    delete pThread;
+    QCOMPARE(otherThread.size(), 32);
+    QVERIFY(otherThread != Random::generateBytes(32));
+}
+
+void TestCryptoPrimitives::testRandomAfterFork()
+{
+#ifdef Q_OS_UNIX
+    // A partial read leaves unserved bytes in this thread's buffer; the
+    // child must not get the same bytes as the parent
+    QVERIFY(!Random::generateBytes(16).isEmpty());
+
+    int aPipe[2];
+    QCOMPARE(pipe(aPipe), 0);
+    const pid_t pid = fork();
+    QVERIFY(pid >= 0);
+    if (pid == 0) {
+        quint8 aChild[32];
+        const bool bOk = Random::fillBuffer(aChild, sizeof(aChild));
+        const bool bWritten = bOk && write(aPipe[1], aChild, sizeof(aChild)) == static_cast<ssize_t>(sizeof(aChild));
+        _exit(bWritten ? 0 : 1);
+    }
+    close(aPipe[1]);
+
+    quint8 aParent[32];
+    QVERIFY(Random::fillBuffer(aParent, sizeof(aParent)));
+    quint8 aChild[32];
+    const ssize_t nRead = read(aPipe[0], aChild, sizeof(aChild));
+    close(aPipe[0]);
+    int nStatus = 0;
+    QCOMPARE(waitpid(pid, &nStatus, 0), pid);
+    QVERIFY(WIFEXITED(nStatus) && WEXITSTATUS(nStatus) == 0);
+    QCOMPARE(nRead, static_cast<ssize_t>(sizeof(aChild)));
+    QVERIFY(std::memcmp(aParent, aChild, sizeof(aParent)) != 0);
+#else
+    QSKIP("fork() is only available on Unix");
+#endif
+}
+
 // =============================================================================
 // Time Compression Tests (PW_TIME structure)
 // =============================================================================
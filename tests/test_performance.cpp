@@ -7,6 +7,11 @@
   - Twofish-256 encryption/decryption
   - SHA-256 hashing
   - Database open/save operations
+  - Entry lookup by UUID
+  - Entry string storage (heap allocations, bytes per entry)
+  - In-memory password protection (lock/unlock, reading passwords)
+  - Secure memory (per-block mlock vs. the pooled SecureArena)
+  - Random numbers (per-thread buffered generator vs. RAND_bytes per call)
 
   Reference: Issue #13 - Performance benchmarking
 */
@@ -14,13 +19,59 @@
 #include <QtTest>
 #include <QElapsedTimer>
 #include <QTemporaryFile>
+#include <QThread>
 
 #include "core/PwManager.h"
+#include "core/PwSearchPlan.h"
+#include "core/PasswordGenerator.h"
+#include "core/crypto/CipherBackend.h"
 #include "core/crypto/KeyTransform.h"
+#include "core/crypto/MemoryProtection.h"
+#include "core/crypto/PayloadKernels.h"
+#include "core/crypto/ProtectedStringCipher.h"
 #include "core/crypto/Rijndael.h"
 #include "core/crypto/TwofishClass.h"
 #include "core/crypto/SHA256.h"
 #include "core/util/Random.h"
+#include "core/platform/SecureArena.h"
+#include "core/util/StringArena.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Count heap allocations made through operator new, so the string storage
+// benchmark can report how many blocks each approach needs
+namespace {
+    std::atomic<quint64> g_heapAllocations{0};
+}
+
+void* operator new(size_t size)
+{
+    ++g_heapAllocations;
+    if (void* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
 
 class TestPerformance : public QObject
 {
@@ -51,6 +102,38 @@ private:
         return QString("%1 ops/s").arg(ops, 0, 'f', 2);
     }
 
+    // Peak resident set size in bytes (VmHWM), or -1 where /proc is not available
+    static qint64 peakRssBytes()
+    {
+        QFile status("/proc/self/status");
+        if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+            return -1;
+        for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+        return -1;
+    }
+
+    // CPU time stamp counter (x86), or 0 where there is none; the fused
+    // payload benchmark reports bytes per cycle from it
+    static quint64 readCycleCounter()
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // Reset the peak RSS to the current RSS (Linux 4.0 and later)
+    static void resetPeakRss()
+    {
+        QFile clearRefs("/proc/self/clear_refs");
+        if (clearRefs.open(QIODevice::WriteOnly))
+            clearRefs.write("5");
+    }
+
 private slots:
     void initTestCase()
     {
@@ -92,22 +175,43 @@ private slots:
         Random::fillBuffer(buffer, 32);
         Random::fillBuffer(keySeed, 32);
 
-        QElapsedTimer timer;
-        timer.start();
+        qDebug() << QString("Key Transform %1 (%2), active backend %3:")
+                    .arg(rounds)
+                    .arg(description)
+                    .arg(KeyTransform::backendName(KeyTransform::activeBackend()));
 
-        bool success = KeyTransform::transform256(rounds, buffer, keySeed);
+        // Compare all backends this CPU supports; results must be identical
+        quint8 reference[32];
+        bool bHaveReference = false;
+        for (KeyTransform::Backend backend : { KeyTransform::Backend::OpenSsl, KeyTransform::Backend::AesNi }) {
+            if (!KeyTransform::isBackendSupported(backend))
+                continue;
 
-        qint64 elapsed = timer.elapsed();
+            quint8 result[32];
+            std::memcpy(result, buffer, 32);
 
-        QVERIFY(success);
+            QElapsedTimer timer;
+            timer.start();
 
-        double roundsPerSec = (double)rounds / (elapsed / 1000.0);
+            bool success = KeyTransform::transform256(rounds, result, keySeed, backend);
 
-        qDebug() << QString("Key Transform %1: %2 ms (%3) - %4")
-                    .arg(rounds)
-                    .arg(elapsed)
-                    .arg(description)
-                    .arg(formatOpsPerSec(roundsPerSec));
+            qint64 elapsedNs = timer.nsecsElapsed();
+
+            QVERIFY(success);
+            if (bHaveReference) {
+                QVERIFY(std::memcmp(result, reference, 32) == 0);
+            } else {
+                std::memcpy(reference, result, 32);
+                bHaveReference = true;
+            }
+
+            double roundsPerSec = (double)rounds / (qMax<qint64>(elapsedNs, 1) / 1e9);
+
+            qDebug() << QString("  %1: %2 ms - %3")
+                        .arg(KeyTransform::backendName(backend), -8)
+                        .arg(elapsedNs / 1e6, 0, 'f', 1)
+                        .arg(formatOpsPerSec(roundsPerSec));
+        }
     }
 
     void benchmarkKeyTransformBuiltin()
@@ -135,6 +239,32 @@ private slots:
                  "Modern hardware should achieve at least 100K rounds/sec");
     }
 
+    void benchmarkKeyTransformCalibration()
+    {
+        // Spread of the trials that KeyTransformCalibrator stores per machine
+        for (KeyTransform::Backend backend : { KeyTransform::Backend::OpenSsl, KeyTransform::Backend::AesNi }) {
+            if (!KeyTransform::isBackendSupported(backend))
+                continue;
+
+            QElapsedTimer timer;
+            timer.start();
+            const KeyTransform::Calibration calibration = KeyTransform::calibrate(backend);
+            const qint64 elapsed = timer.elapsed();
+
+            QVERIFY(calibration.qwMedianRoundsPerSec > 0);
+            qDebug() << QString("Calibration %1 (%2, %3 trials, %4 ms): median %5, p95 %6 (%7% slower)")
+                        .arg(KeyTransform::backendName(backend), KeyTransform::cpuModelName())
+                        .arg(calibration.dwTrials)
+                        .arg(elapsed)
+                        .arg(formatOpsPerSec(static_cast<double>(calibration.qwMedianRoundsPerSec)))
+                        .arg(formatOpsPerSec(static_cast<double>(calibration.qwP95RoundsPerSec)))
+                        .arg(100.0 * (1.0 - static_cast<double>(calibration.qwP95RoundsPerSec)
+                                            / calibration.qwMedianRoundsPerSec), 0, 'f', 1);
+            qDebug() << QString("  Rounds for a 1 s unlock: %1")
+                        .arg(KeyTransform::roundsForDuration(calibration, 1000));
+        }
+    }
+
     // =========================================================================
     // AES-256 ENCRYPTION BENCHMARKS
     // =========================================================================
@@ -162,57 +292,245 @@ private slots:
         Random::fillBuffer(iv, 16);
 
         QByteArray plaintext = Random::generateBytes(dataSize);
-        QByteArray ciphertext(dataSize + 16, 0);  // Extra for padding
 
-        CRijndael aes;
+        qDebug() << QString("AES-256 %1 (%2):")
+                    .arg(dataSize)
+                    .arg(description);
+
+        // Every payload backend on the same data, side by side
+        const CipherBackend::Implementation impls[] = {
+            CipherBackend::Implementation::Reference,
+            CipherBackend::Implementation::OpenSsl
+        };
+        QByteArray referenceCiphertext;
+
+        for (CipherBackend::Implementation impl : impls) {
+            std::unique_ptr<CipherBackend> pCipher =
+                CipherBackend::create(CipherBackend::Cipher::Aes256, impl);
+            QVERIFY(pCipher != nullptr);
+
+            QByteArray ciphertext(dataSize + 16, 0);  // Extra for padding
+
+            // Benchmark encryption
+            QElapsedTimer timer;
+            timer.start();
+
+            QVERIFY(pCipher->init(true, key, iv));
+            const qint64 encLen = pCipher->padEncrypt(
+                reinterpret_cast<const quint8*>(plaintext.constData()),
+                static_cast<quint32>(plaintext.size()),
+                reinterpret_cast<quint8*>(ciphertext.data()));
+
+            const qint64 encNs = timer.nsecsElapsed();
+
+            QVERIFY(encLen > 0);
+            ciphertext.truncate(static_cast<int>(encLen));
+            if (referenceCiphertext.isEmpty())
+                referenceCiphertext = ciphertext;
+            QCOMPARE(ciphertext, referenceCiphertext);
+
+            // Benchmark decryption (in place, like openDatabase)
+            pCipher = CipherBackend::create(CipherBackend::Cipher::Aes256, impl);
+
+            timer.restart();
+
+            QVERIFY(pCipher->init(false, key, iv));
+            const qint32 decLen = pCipher->decryptFinal(
+                reinterpret_cast<quint8*>(ciphertext.data()),
+                static_cast<quint32>(ciphertext.size()));
+
+            const qint64 decNs = timer.nsecsElapsed();
+
+            QCOMPARE(decLen, dataSize);
+            QVERIFY(std::memcmp(ciphertext.constData(), plaintext.constData(),
+                                static_cast<size_t>(dataSize)) == 0);
+
+            const double encThroughput = (double)dataSize / (qMax<qint64>(encNs, 1) / 1e9);
+            const double decThroughput = (double)dataSize / (qMax<qint64>(decNs, 1) / 1e9);
+
+            qDebug() << QString("  %1: encrypt %2 ms (%3), decrypt %4 ms (%5)")
+                        .arg(QString::fromLatin1(CipherBackend::implementationName(impl)), -9)
+                        .arg(encNs / 1e6, 0, 'f', 2)
+                        .arg(formatThroughput(encThroughput))
+                        .arg(decNs / 1e6, 0, 'f', 2)
+                        .arg(formatThroughput(decThroughput));
+        }
+    }
+
+    // =========================================================================
+    // PARALLEL CBC DECRYPTION BENCHMARKS
+    // =========================================================================
+
+    void benchmarkParallelDecrypt_data()
+    {
+        QTest::addColumn<int>("cipher");
+        QTest::addColumn<int>("threads");
+
+        for (int nThreads : { 1, 2, 4, 8 }) {
+            QTest::newRow(qPrintable(QString("AES-256, %1 threads").arg(nThreads)))
+                << static_cast<int>(CipherBackend::Cipher::Aes256) << nThreads;
+        }
+        for (int nThreads : { 1, 2, 4, 8 }) {
+            QTest::newRow(qPrintable(QString("Twofish-256, %1 threads").arg(nThreads)))
+                << static_cast<int>(CipherBackend::Cipher::Twofish256) << nThreads;
+        }
+    }
+
+    void benchmarkParallelDecrypt()
+    {
+        QFETCH(int, cipher);
+        QFETCH(int, threads);
+
+        // 64 MB payload, decrypted in 1 MB pieces like openDatabase does
+        const quint32 uDataSize = 64 * 1024 * 1024;
+        const quint32 uPieceSize = 1024 * 1024;
+        const CipherBackend::Cipher c = static_cast<CipherBackend::Cipher>(cipher);
+
+        quint8 key[32];
+        quint8 iv[16];
+        Random::fillBuffer(key, 32);
+        Random::fillBuffer(iv, 16);
+
+        QByteArray data(static_cast<int>(uDataSize + 16), 0);
+        Random::fillBuffer(reinterpret_cast<quint8*>(data.data()), uDataSize);
+        std::unique_ptr<CipherBackend> pEnc = CipherBackend::create(c);
+        QVERIFY(pEnc->init(true, key, iv));
+        const qint64 encLen = pEnc->padEncrypt(reinterpret_cast<const quint8*>(data.constData()),
+                                               uDataSize, reinterpret_cast<quint8*>(data.data()));
+        QCOMPARE(encLen, static_cast<qint64>(uDataSize + 16));
+
+        std::unique_ptr<CipherBackend> pDec = CipherBackend::createParallelDecryptor(c, threads);
+        quint8* pData = reinterpret_cast<quint8*>(data.data());
 
-        // Benchmark encryption
         QElapsedTimer timer;
         timer.start();
 
-        int result = aes.Init(CRijndael::CBC, CRijndael::EncryptDir,
-                              key, CRijndael::Key32Bytes, iv);
-        QCOMPARE(result, RIJNDAEL_SUCCESS);
+        QVERIFY(pDec->init(false, key, iv));
+        quint32 uPos = 0;
+        while ((static_cast<quint32>(encLen) - uPos) > uPieceSize) {
+            QVERIFY(pDec->decryptBlocks(pData + uPos, uPieceSize));
+            uPos += uPieceSize;
+        }
+        QCOMPARE(pDec->decryptFinal(pData + uPos, static_cast<quint32>(encLen) - uPos),
+                 static_cast<qint32>(uDataSize - uPos));
 
-        int encLen = aes.PadEncrypt(
-            reinterpret_cast<const UINT8*>(plaintext.constData()),
-            plaintext.size(),
-            reinterpret_cast<UINT8*>(ciphertext.data()));
+        const qint64 elapsed = timer.nsecsElapsed();
+        const double throughput = (double)uDataSize / (qMax<qint64>(elapsed, 1) / 1e9);
 
-        qint64 encElapsed = timer.elapsed();
+        qDebug() << QString("%1 parallel decrypt, %2 threads (%3 CPUs): %4 ms (%5)")
+                    .arg(c == CipherBackend::Cipher::Aes256 ? "AES-256" : "Twofish-256")
+                    .arg(threads)
+                    .arg(QThread::idealThreadCount())
+                    .arg(elapsed / 1e6, 0, 'f', 1)
+                    .arg(formatThroughput(throughput));
+    }
 
-        QVERIFY(encLen > 0);
+    // =========================================================================
+    // FUSED PAYLOAD PASS BENCHMARKS
+    // =========================================================================
 
-        // Benchmark decryption
-        QByteArray decrypted(encLen, 0);
+    void benchmarkFusedPayloadPasses_data()
+    {
+        QTest::addColumn<int>("cipher");
+        QTest::addColumn<int>("sizeMB");
 
-        timer.restart();
+        QTest::newRow("AES-256, 16 MB")      << static_cast<int>(CipherBackend::Cipher::Aes256) << 16;
+        QTest::newRow("AES-256, 256 MB")     << static_cast<int>(CipherBackend::Cipher::Aes256) << 256;
+        QTest::newRow("Twofish-256, 16 MB")  << static_cast<int>(CipherBackend::Cipher::Twofish256) << 16;
+        QTest::newRow("Twofish-256, 256 MB") << static_cast<int>(CipherBackend::Cipher::Twofish256) << 256;
+    }
 
-        result = aes.Init(CRijndael::CBC, CRijndael::DecryptDir,
-                          key, CRijndael::Key32Bytes, iv);
-        QCOMPARE(result, RIJNDAEL_SUCCESS);
+    void benchmarkFusedPayloadPasses()
+    {
+        QFETCH(int, cipher);
+        QFETCH(int, sizeMB);
 
-        int decLen = aes.PadDecrypt(
-            reinterpret_cast<const UINT8*>(ciphertext.constData()),
-            encLen,
-            reinterpret_cast<UINT8*>(decrypted.data()));
+        // Save hashes and encrypts, open decrypts and hashes the payload;
+        // compare one full pass per step with the tiled PayloadKernels
+        const CipherBackend::Cipher c = static_cast<CipherBackend::Cipher>(cipher);
+        const quint32 uSize = static_cast<quint32>(sizeMB) * 1024 * 1024;
 
-        qint64 decElapsed = timer.elapsed();
+        quint8 key[32];
+        quint8 iv[16];
+        Random::fillBuffer(key, 32);
+        Random::fillBuffer(iv, 16);
 
-        QCOMPARE(decLen, dataSize);
+        QByteArray data(static_cast<int>(uSize + 16), 0);
+        Random::fillBuffer(reinterpret_cast<quint8*>(data.data()), uSize);
+        quint8* pData = reinterpret_cast<quint8*>(data.data());
 
-        double encThroughput = (double)dataSize / (encElapsed / 1000.0);
-        double decThroughput = (double)dataSize / (decElapsed / 1000.0);
+        QByteArray hashSeparate(32, 0);
+        QByteArray hashFused(32, 0);
+        unsigned char* pHashSeparate = reinterpret_cast<unsigned char*>(hashSeparate.data());
+        unsigned char* pHashFused = reinterpret_cast<unsigned char*>(hashFused.data());
+        QElapsedTimer timer;
 
-        qDebug() << QString("AES-256 %1 (%2):")
-                    .arg(dataSize)
-                    .arg(description);
-        qDebug() << QString("  Encrypt: %1 ms (%2)")
-                    .arg(encElapsed)
-                    .arg(formatThroughput(encThroughput));
-        qDebug() << QString("  Decrypt: %1 ms (%2)")
-                    .arg(decElapsed)
-                    .arg(formatThroughput(decThroughput));
+        // Save, separate passes
+        std::unique_ptr<CipherBackend> pCipher = CipherBackend::create(c);
+        QVERIFY(pCipher->init(true, key, iv));
+        timer.start();
+        quint64 qwStart = readCycleCounter();
+        SHA256::hash(pData, uSize, pHashSeparate);
+        const qint64 nEncrypted = pCipher->padEncrypt(pData, uSize, pData);
+        const quint64 qwSaveSeparate = readCycleCounter() - qwStart;
+        const qint64 nsSaveSeparate = timer.nsecsElapsed();
+        QCOMPARE(nEncrypted, static_cast<qint64>(uSize + 16));
+
+        // Open, separate passes
+        pCipher = CipherBackend::create(c);
+        QVERIFY(pCipher->init(false, key, iv));
+        timer.restart();
+        qwStart = readCycleCounter();
+        QCOMPARE(pCipher->decryptFinal(pData, static_cast<quint32>(nEncrypted)), static_cast<qint32>(uSize));
+        SHA256::hash(pData, uSize, pHashFused);
+        const quint64 qwOpenSeparate = readCycleCounter() - qwStart;
+        const qint64 nsOpenSeparate = timer.nsecsElapsed();
+        QCOMPARE(hashFused, hashSeparate);
+
+        // Save, fused
+        pCipher = CipherBackend::create(c);
+        QVERIFY(pCipher->init(true, key, iv));
+        timer.restart();
+        qwStart = readCycleCounter();
+        {
+            SHA256::Context hash;
+            QCOMPARE(PayloadKernels::hashThenEncrypt(*pCipher, hash, pData, uSize), nEncrypted);
+            hash.finalize(pHashFused);
+        }
+        const quint64 qwSaveFused = readCycleCounter() - qwStart;
+        const qint64 nsSaveFused = timer.nsecsElapsed();
+        QCOMPARE(hashFused, hashSeparate);
+
+        // Open, fused
+        pCipher = CipherBackend::create(c);
+        QVERIFY(pCipher->init(false, key, iv));
+        timer.restart();
+        qwStart = readCycleCounter();
+        {
+            SHA256::Context hash;
+            QCOMPARE(PayloadKernels::decryptThenHash(*pCipher, &hash, pData, static_cast<quint32>(nEncrypted), true),
+                     static_cast<qint64>(uSize));
+            hash.finalize(pHashFused);
+        }
+        const quint64 qwOpenFused = readCycleCounter() - qwStart;
+        const qint64 nsOpenFused = timer.nsecsElapsed();
+        QCOMPARE(hashFused, hashSeparate);
+
+        auto describe = [uSize](quint64 qwCycles, qint64 ns) {
+            const QString rate = formatThroughput((double)uSize / (qMax<qint64>(ns, 1) / 1e9));
+            if (qwCycles == 0)
+                return rate;
+            return QString("%1 bytes/cycle, %2").arg((double)uSize / qwCycles, 0, 'f', 3).arg(rate);
+        };
+
+        qDebug() << QString("%1 payload, %2 MB (tile %3 KB):")
+                    .arg(c == CipherBackend::Cipher::Aes256 ? "AES-256" : "Twofish-256")
+                    .arg(sizeMB)
+                    .arg(PayloadKernels::DEFAULT_TILE_SIZE / 1024);
+        qDebug() << QString("  Save, hash then encrypt: %1").arg(describe(qwSaveSeparate, nsSaveSeparate));
+        qDebug() << QString("  Save, fused:             %1").arg(describe(qwSaveFused, nsSaveFused));
+        qDebug() << QString("  Open, decrypt then hash: %1").arg(describe(qwOpenSeparate, nsOpenSeparate));
+        qDebug() << QString("  Open, fused:             %1").arg(describe(qwOpenFused, nsOpenFused));
     }
 
     // =========================================================================
@@ -315,22 +633,97 @@ private slots:
 
         QByteArray data = Random::generateBytes(dataSize);
 
-        QElapsedTimer timer;
-        timer.start();
+        qDebug() << QString("SHA-256 %1 (%2), active backend %3:")
+                    .arg(dataSize)
+                    .arg(description)
+                    .arg(SHA256::backendName(SHA256::activeBackend()));
 
-        QByteArray hash = SHA256::hash(data);
+        const SHA256::Backend backends[] = {
+            SHA256::Backend::Portable, SHA256::Backend::OpenSsl, SHA256::Backend::ShaNi
+        };
+        QByteArray referenceHash;
 
-        qint64 elapsed = timer.elapsed();
+        for (SHA256::Backend backend : backends) {
+            if (!SHA256::isBackendSupported(backend))
+                continue;
 
-        QCOMPARE(hash.size(), 32);
+            QByteArray hash(32, 0);
 
-        double throughput = (double)dataSize / (elapsed / 1000.0);
+            QElapsedTimer timer;
+            timer.start();
 
-        qDebug() << QString("SHA-256 %1 (%2): %3 ms (%4)")
-                    .arg(dataSize)
-                    .arg(description)
-                    .arg(elapsed)
-                    .arg(formatThroughput(throughput));
+            SHA256::hash(reinterpret_cast<const unsigned char*>(data.constData()),
+                         static_cast<unsigned long>(data.size()),
+                         reinterpret_cast<unsigned char*>(hash.data()), backend);
+
+            const qint64 elapsed = timer.nsecsElapsed();
+
+            if (referenceHash.isEmpty())
+                referenceHash = hash;
+            QCOMPARE(hash, referenceHash);
+
+            const double throughput = (double)dataSize / (qMax<qint64>(elapsed, 1) / 1e9);
+
+            qDebug() << QString("  %1: %2 ms (%3)")
+                        .arg(QString::fromLatin1(SHA256::backendName(backend)), -8)
+                        .arg(elapsed / 1e6, 0, 'f', 3)
+                        .arg(formatThroughput(throughput));
+        }
+    }
+
+    void benchmarkSHA256HashMany_data()
+    {
+        QTest::addColumn<int>("messageCount");
+        QTest::addColumn<int>("messageSize");
+
+        QTest::newRow("10000 x 64 B")  << 10000 << 64;
+        QTest::newRow("10000 x 1 KB")  << 10000 << 1024;
+        QTest::newRow("1000 x 64 KB")  << 1000  << 65536;
+    }
+
+    void benchmarkSHA256HashMany()
+    {
+        QFETCH(int, messageCount);
+        QFETCH(int, messageSize);
+
+        QVector<QByteArray> vMessages;
+        QVector<const unsigned char*> vPointers;
+        QVector<unsigned long> vLengths;
+        for (int i = 0; i < messageCount; ++i) {
+            vMessages.append(Random::generateBytes(messageSize));
+        }
+        for (const QByteArray& message : vMessages) {
+            vPointers.append(reinterpret_cast<const unsigned char*>(message.constData()));
+            vLengths.append(static_cast<unsigned long>(message.size()));
+        }
+
+        const double totalBytes = (double)messageCount * messageSize;
+        qDebug() << QString("SHA-256 hashMany %1 x %2 bytes:").arg(messageCount).arg(messageSize);
+
+        QByteArray referenceDigests;
+        for (SHA256::BatchMode mode : { SHA256::BatchMode::Sequential, SHA256::BatchMode::Avx2x8 }) {
+            if (!SHA256::isBatchModeSupported(mode))
+                continue;
+
+            QByteArray digests(32 * messageCount, 0);
+
+            QElapsedTimer timer;
+            timer.start();
+
+            SHA256::hashMany(vPointers.constData(), vLengths.constData(), messageCount,
+                             reinterpret_cast<unsigned char*>(digests.data()), mode);
+
+            const qint64 elapsed = timer.nsecsElapsed();
+
+            if (referenceDigests.isEmpty())
+                referenceDigests = digests;
+            QCOMPARE(digests, referenceDigests);
+
+            qDebug() << QString("  %1: %2 ms (%3)")
+                        .arg(mode == SHA256::BatchMode::Avx2x8 ? "AVX2 x8   " : "Sequential")
+                        .arg(elapsed / 1e6, 0, 'f', 2)
+                        .arg(formatThroughput(totalBytes / (qMax<qint64>(elapsed, 1) / 1e9)));
+        }
     }
 
     // =========================================================================
@@ -457,6 +850,615 @@ private slots:
         qDebug() << QString("  Open: %1 ms").arg(openElapsed);
     }
 
+    void benchmarkOpenLargeDatabase_data()
+    {
+        QTest::addColumn<int>("attachmentCount");
+
+        // One 1 MB attachment per entry
+        QTest::newRow("10 MB")  << 10;
+        QTest::newRow("100 MB") << 100;
+        QTest::newRow("1 GB")   << 1000;
+    }
+
+    void benchmarkOpenLargeDatabase()
+    {
+        QFETCH(int, attachmentCount);
+        const quint32 uAttachmentSize = 1024 * 1024;
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        QVERIFY(tempFile.open());
+        const QString filePath = tempFile.fileName();
+        tempFile.close();
+
+        {
+            PwManager manager;
+            manager.newDatabase();
+            manager.setMasterKey("BenchmarkPassword123!", false, QString(), true, QString());
+            manager.setKeyEncRounds(1000);  // Low rounds for fast benchmark
+
+            PW_GROUP group;
+            memset(&group, 0, sizeof(group));
+            group.uGroupId = 1;
+            group.pszGroupName = const_cast<char*>("Attachments");
+            QVERIFY(manager.addGroup(&group));
+
+            QByteArray attachment(static_cast<int>(uAttachmentSize), Qt::Uninitialized);
+            Random::fillBuffer(reinterpret_cast<quint8*>(attachment.data()), uAttachmentSize);
+
+            static char emptyString[] = "";
+            static char binaryDesc[] = "attachment.bin";
+            PW_ENTRY entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.uGroupId = group.uGroupId;
+            entry.pszTitle = emptyString;
+            entry.pszUserName = emptyString;
+            entry.pszURL = emptyString;
+            entry.pszPassword = emptyString;
+            entry.pszAdditional = emptyString;
+            entry.pszBinaryDesc = binaryDesc;
+            entry.pBinaryData = reinterpret_cast<BYTE*>(attachment.data());
+            entry.uBinaryDataLen = uAttachmentSize;
+
+            for (int i = 0; i < attachmentCount; ++i) {
+                memset(entry.uuid, 0, sizeof(entry.uuid));
+                QVERIFY(manager.addEntry(&entry));
+            }
+
+            QCOMPARE(manager.saveDatabase(filePath), PWE_SUCCESS);
+        }
+
+        const qint64 fileSize = QFileInfo(filePath).size();
+
+        // Measure the open alone
+        resetPeakRss();
+        const qint64 rssBefore = peakRssBytes();
+
+        PwManager manager2;
+        manager2.setMasterKey("BenchmarkPassword123!", false, QString(), true, QString());
+
+        QElapsedTimer timer;
+        timer.start();
+        const int openResult = manager2.openDatabase(filePath, nullptr);
+        const qint64 openElapsed = timer.elapsed();
+        const qint64 rssPeak = peakRssBytes();
+
+        QCOMPARE(openResult, PWE_SUCCESS);
+        QCOMPARE(manager2.getNumberOfEntries(), static_cast<quint32>(attachmentCount));
+
+        qDebug() << QString("Open %1 MB database (%2 attachments of 1 MB):")
+                    .arg(fileSize / (1024 * 1024))
+                    .arg(attachmentCount);
+        qDebug() << QString("  Open: %1 ms (%2)")
+                    .arg(openElapsed)
+                    .arg(formatThroughput(openElapsed > 0 ? fileSize * 1000.0 / openElapsed : 0.0));
+        if (rssBefore >= 0 && rssPeak >= 0) {
+            qDebug() << QString("  Peak RSS growth: %1 MB (%2x file size)")
+                        .arg((rssPeak - rssBefore) / (1024 * 1024))
+                        .arg(static_cast<double>(rssPeak - rssBefore) / fileSize, 0, 'f', 2);
+        }
+    }
+
+    // =========================================================================
+    // UUID LOOKUP BENCHMARKS
+    // =========================================================================
+
+    void benchmarkUuidLookup_data()
+    {
+        QTest::addColumn<int>("entryCount");
+
+        QTest::newRow("1K entries")   << 1000;
+        QTest::newRow("100K entries") << 100000;
+        QTest::newRow("1M entries")   << 1000000;
+    }
+
+    void benchmarkUuidLookup()
+    {
+        QFETCH(int, entryCount);
+
+        PwManager manager;
+        manager.newDatabase();
+
+        PW_GROUP group;
+        memset(&group, 0, sizeof(group));
+        group.pszGroupName = const_cast<char*>("Benchmark Group");
+        QVERIFY(manager.addGroup(&group));
+        const quint32 groupId = manager.getGroup(0)->uGroupId;
+
+        // Minimal entries: lookup cost must not depend on entry contents
+        manager.reserveEntries(static_cast<quint32>(entryCount));
+        QVector<PW_UUID_STRUCT> uuids;
+        uuids.reserve(entryCount);
+        for (int i = 0; i < entryCount; ++i) {
+            PW_ENTRY entry;
+            memset(&entry, 0, sizeof(entry));
+            Random::generateUuid(entry.uuid);
+            entry.uGroupId = groupId;
+            QVERIFY(manager.addEntry(&entry));
+
+            PW_UUID_STRUCT u;
+            memcpy(u.uuid, entry.uuid, 16);
+            uuids.append(u);
+        }
+
+        // Same number of lookups for every size, so times are comparable
+        constexpr int LOOKUPS = 100000;
+        QVector<PW_UUID_STRUCT> probes;
+        probes.reserve(LOOKUPS);
+        for (int i = 0; i < LOOKUPS; ++i) {
+            probes.append(uuids[(static_cast<qint64>(i) * 7919) % entryCount]);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        quint32 found = 0;
+        for (const PW_UUID_STRUCT& u : probes) {
+            if (manager.getEntryByUuidN(u.uuid) != 0xFFFFFFFF) {
+                ++found;
+            }
+        }
+        const qint64 singleNs = timer.nsecsElapsed();
+        QCOMPARE(found, static_cast<quint32>(LOOKUPS));
+
+        // Misses must be just as cheap
+        PW_UUID_STRUCT missing;
+        memset(missing.uuid, 0xAB, 16);
+        quint32 missed = 0;
+        timer.restart();
+        for (int i = 0; i < LOOKUPS; ++i) {
+            missing.uuid[0] = static_cast<quint8>(i);
+            missing.uuid[1] = static_cast<quint8>(i >> 8);
+            if (manager.getEntryByUuid(missing.uuid) == nullptr) {
+                ++missed;
+            }
+        }
+        const qint64 missNs = timer.nsecsElapsed();
+        QCOMPARE(missed, static_cast<quint32>(LOOKUPS));
+
+        timer.restart();
+        const QVector<quint32> resolved = manager.resolveUuids(probes);
+        const qint64 bulkNs = timer.nsecsElapsed();
+        QCOMPARE(resolved.size(), LOOKUPS);
+        for (int i = 0; i < LOOKUPS; i += 997) {
+            QCOMPARE(memcmp(manager.getEntry(resolved[i])->uuid, probes[i].uuid, 16), 0);
+        }
+
+        qDebug() << QString("UUID lookup, %1 entries (%2 lookups each):")
+                    .arg(entryCount).arg(LOOKUPS);
+        qDebug() << QString("  getEntryByUuidN (hit): %1 ns/lookup")
+                    .arg(static_cast<double>(singleNs) / LOOKUPS, 0, 'f', 1);
+        qDebug() << QString("  getEntryByUuid (miss): %1 ns/lookup")
+                    .arg(static_cast<double>(missNs) / LOOKUPS, 0, 'f', 1);
+        qDebug() << QString("  resolveUuids (bulk):   %1 ns/lookup")
+                    .arg(static_cast<double>(bulkNs) / LOOKUPS, 0, 'f', 1);
+    }
+
+    // =========================================================================
+    // SEARCH BENCHMARKS
+    // =========================================================================
+
+    void benchmarkFindAll_data()
+    {
+        QTest::addColumn<QString>("findString");
+        QTest::addColumn<bool>("caseSensitive");
+        QTest::addColumn<quint32>("searchFlags");
+
+        const quint32 textFields = PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_ADDITIONAL;
+        QTest::newRow("case-insensitive") << QString("example") << false << textFields;
+        QTest::newRow("case-sensitive")   << QString("Account 4") << true << textFields;
+        QTest::newRow("non-ASCII")        << QString::fromUtf8("\xC3\xA4rger") << false << textFields;
+        QTest::newRow("regex")            << QString("user\\d+7$") << false << (textFields | PWMS_REGEX);
+        QTest::newRow("password")         << QString("pw-99") << false << quint32(PWMF_PASSWORD);
+        QTest::newRow("all fields")       << QString("missing") << false
+                                          << (textFields | PWMF_PASSWORD | PWMF_UUID | PWMF_GROUPNAME);
+    }
+
+    void benchmarkFindAll()
+    {
+        QFETCH(QString, findString);
+        QFETCH(bool, caseSensitive);
+        QFETCH(quint32, searchFlags);
+
+        constexpr int ENTRY_COUNT = 100000;
+
+        PwManager manager;
+        manager.newDatabase();
+        manager.setMasterKey("BenchmarkPassword123!", false, QString(), true, QString());
+
+        PW_GROUP group;
+        memset(&group, 0, sizeof(group));
+        group.pszGroupName = const_cast<char*>("Benchmark Group");
+        QVERIFY(manager.addGroup(&group));
+        const quint32 groupId = manager.getGroup(0)->uGroupId;
+
+        for (int i = 0; i < ENTRY_COUNT; ++i) {
+            const QByteArray title = QString("Account %1").arg(i).toUtf8();
+            const QByteArray user = QString("user%1").arg(i).toUtf8();
+            const QByteArray url = QString("https://example.com/login/%1").arg(i).toUtf8();
+            const QByteArray password = QString("pw-%1").arg(i).toUtf8();
+            const char* notes = (i % 10 == 0) ? "\xC3\x84rger mit dem Login" : "Notes";
+
+            PW_ENTRY entry;
+            memset(&entry, 0, sizeof(entry));
+            Random::generateUuid(entry.uuid);
+            entry.uGroupId = groupId;
+            entry.pszTitle = const_cast<char*>(title.constData());
+            entry.pszUserName = const_cast<char*>(user.constData());
+            entry.pszURL = const_cast<char*>(url.constData());
+            entry.pszPassword = const_cast<char*>(password.constData());
+            entry.uPasswordLen = static_cast<quint32>(password.size());
+            entry.pszAdditional = const_cast<char*>(notes);
+            entry.pszBinaryDesc = const_cast<char*>("");
+            PwManager::getNeverExpireTime(&entry.tExpire);
+            QVERIFY(manager.addEntry(&entry));
+        }
+
+        // The first search builds the trigram index and the folded texts
+        QElapsedTimer timer;
+        timer.start();
+        const TrigramIndex::Stats indexStats = manager.getSearchIndexStats();
+        const qint64 indexMs = timer.elapsed();
+
+        timer.restart();
+        const FoldedTextStore::Stats foldedStats = manager.getFoldedText().getStats();
+        const qint64 foldedMs = timer.elapsed();
+
+        timer.restart();
+        const PwSearchPlan singlePlan(&manager, findString, caseSensitive, searchFlags);
+        const QList<quint32> single = singlePlan.findAll(0, 0xFFFFFFFF, 1);
+        const qint64 singleMs = timer.elapsed();
+
+        timer.restart();
+        QString error;
+        const QList<quint32> parallel = manager.findAll(findString, caseSensitive, searchFlags,
+                                                        false, false, &error);
+        const qint64 parallelMs = timer.elapsed();
+        QVERIFY(error.isEmpty());
+        QCOMPARE(parallel, single);
+
+        qDebug() << QString("findAll \"%1\", %2 entries: %3 matches")
+                    .arg(findString).arg(ENTRY_COUNT).arg(parallel.size());
+        qDebug() << QString("  index build: %1 ms, %2 trigrams, %3 bytes/entry")
+                    .arg(indexMs).arg(indexStats.uTrigrams).arg(indexStats.uBytesPerDocument);
+        qDebug() << QString("  folded text build: %1 ms, %2 bytes/entry")
+                    .arg(foldedMs).arg(foldedStats.uBytes / ENTRY_COUNT);
+        qDebug() << QString("  1 thread:  %1 ms").arg(singleMs);
+        qDebug() << QString("  %1 threads: %2 ms").arg(QThread::idealThreadCount()).arg(parallelMs);
+    }
+
+    // =========================================================================
+    // STRING STORAGE BENCHMARKS
+    // =========================================================================
+
+    void benchmarkStringStorage_data()
+    {
+        QTest::addColumn<int>("entryCount");
+
+        QTest::newRow("10K entries")  << 10000;
+        QTest::newRow("100K entries") << 100000;
+    }
+
+    void benchmarkStringStorage()
+    {
+        QFETCH(int, entryCount);
+
+        // Typical field lengths for the five text fields of an entry
+        const QByteArray notes(120, 'n');
+        const char* fields[] = {
+            "Example account title",
+            "someone@example.com",
+            "https://www.example.com/login",
+            "Tr0ub4dor&3-correct-horse",
+            notes.constData()
+        };
+        constexpr int FIELDS = 5;
+
+        size_t payload = 0;
+        for (const char* field : fields) {
+            payload += strlen(field) + 1;
+        }
+
+        // Before: one heap block per field, as setEntry() used to allocate them
+        QVector<char*> blocks;
+        blocks.reserve(entryCount * FIELDS);
+        quint64 allocs = g_heapAllocations;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < entryCount; ++i) {
+            for (const char* field : fields) {
+                const size_t len = strlen(field) + 1;
+                char* p = new char[len];
+                memcpy(p, field, len);
+                blocks.append(p);
+            }
+        }
+        const qint64 heapNs = timer.nsecsElapsed();
+        const quint64 heapAllocs = g_heapAllocations - allocs;
+        for (char* p : blocks) {
+            delete[] p;
+        }
+
+        // After: the same strings in a StringArena
+        StringArena arena;
+        allocs = g_heapAllocations;
+        timer.restart();
+        for (int i = 0; i < entryCount; ++i) {
+            for (const char* field : fields) {
+                QVERIFY(arena.dup(field) != nullptr);
+            }
+        }
+        const qint64 arenaNs = timer.nsecsElapsed();
+        const quint64 arenaAllocs = g_heapAllocations - allocs;
+        const StringArena::Stats stats = arena.getStats();
+        QCOMPARE(stats.uStringAllocations, static_cast<quint64>(entryCount) * FIELDS);
+        QVERIFY(arenaAllocs < heapAllocs);
+
+        // Whole entries through PwManager (includes the attachment description
+        // and index updates, which are not arena-backed)
+        PwManager manager;
+        manager.newDatabase();
+        PW_GROUP group;
+        memset(&group, 0, sizeof(group));
+        group.pszGroupName = const_cast<char*>("Benchmark Group");
+        QVERIFY(manager.addGroup(&group));
+
+        QVector<PW_ENTRY> templates(entryCount);
+        for (PW_ENTRY& entry : templates) {
+            memset(&entry, 0, sizeof(entry));
+            entry.uGroupId = manager.getGroup(0)->uGroupId;
+            entry.pszTitle = const_cast<char*>(fields[0]);
+            entry.pszUserName = const_cast<char*>(fields[1]);
+            entry.pszURL = const_cast<char*>(fields[2]);
+            entry.pszPassword = const_cast<char*>(fields[3]);
+            entry.pszAdditional = const_cast<char*>(fields[4]);
+        }
+        manager.reserveEntries(static_cast<quint32>(entryCount));
+        allocs = g_heapAllocations;
+        QVERIFY(manager.addEntries(templates.constData(), static_cast<quint32>(entryCount)));
+        const quint64 managerAllocs = g_heapAllocations - allocs;
+        const StringArena::Stats managerStats = manager.getStringMemoryStats();
+
+        qDebug() << QString("String storage, %1 entries (%2 payload bytes/entry):")
+                    .arg(entryCount).arg(payload);
+        qDebug() << QString("  Heap block per field: %1 allocations/entry, %2 ms")
+                    .arg(static_cast<double>(heapAllocs) / entryCount, 0, 'f', 2)
+                    .arg(static_cast<double>(heapNs) / 1e6, 0, 'f', 2);
+        qDebug() << QString("  StringArena:          %1 allocations/entry, %2 ms, %3 bytes/entry reserved")
+                    .arg(static_cast<double>(arenaAllocs) / entryCount, 0, 'f', 3)
+                    .arg(static_cast<double>(arenaNs) / 1e6, 0, 'f', 2)
+                    .arg(static_cast<double>(stats.uBytesReserved) / entryCount, 0, 'f', 1);
+        qDebug() << QString("  PwManager::addEntries: %1 allocations/entry, %2 slabs, %3 bytes/entry in use")
+                    .arg(static_cast<double>(managerAllocs) / entryCount, 0, 'f', 2)
+                    .arg(managerStats.uSlabAllocations)
+                    .arg(static_cast<double>(managerStats.uBytesInUse) / entryCount, 0, 'f', 1);
+    }
+
+    // =========================================================================
+    // PASSWORD PROTECTION BENCHMARKS
+    // =========================================================================
+
+    void benchmarkPasswordProtection_data()
+    {
+        QTest::addColumn<int>("entryCount");
+
+        QTest::newRow("5K entries")   << 5000;
+        QTest::newRow("100K entries") << 100000;
+    }
+
+    void benchmarkPasswordProtection()
+    {
+        QFETCH(int, entryCount);
+
+        PwManager manager;
+        manager.newDatabase();
+        PW_GROUP group;
+        memset(&group, 0, sizeof(group));
+        group.pszGroupName = const_cast<char*>("Benchmark Group");
+        QVERIFY(manager.addGroup(&group));
+
+        const char* password = "Tr0ub4dor&3-correct-horse";
+        const quint32 passwordLen = static_cast<quint32>(strlen(password));
+        QVector<PW_ENTRY> templates(entryCount);
+        for (PW_ENTRY& entry : templates) {
+            memset(&entry, 0, sizeof(entry));
+            Random::generateUuid(entry.uuid);
+            entry.uGroupId = manager.getGroup(0)->uGroupId;
+            entry.pszPassword = const_cast<char*>(password);
+        }
+        manager.reserveEntries(static_cast<quint32>(entryCount));
+        QVERIFY(manager.addEntries(templates.constData(), static_cast<quint32>(entryCount)));
+
+        // Before: XOR with a 32-byte session key, unlock + lock per reader
+        quint8 aSessionKey[32];
+        Random::fillBuffer(aSessionKey, 32);
+        QVector<QByteArray> legacy(entryCount, QByteArray(password));
+        for (QByteArray& bytes : legacy)
+            bytes.detach();
+        QElapsedTimer timer;
+        timer.start();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (QByteArray& bytes : legacy) {
+                char* p = bytes.data();
+                for (quint32 i = 0; i < passwordLen; ++i)
+                    p[i] = static_cast<char>(p[i] ^ aSessionKey[i & 31]);
+            }
+        }
+        const qint64 legacyNs = timer.nsecsElapsed();
+        QCOMPARE(legacy.first(), QByteArray(password));
+
+        // After: per-entry AES-CTR, all entries in one batch
+        timer.restart();
+        manager.unlockEntryPassword(nullptr);
+        manager.lockEntryPassword(nullptr);
+        const qint64 batchNs = timer.nsecsElapsed();
+
+        // Readers decrypt a copy instead of unlocking and locking the entry
+        timer.restart();
+        quint64 totalLen = 0;
+        for (int i = 0; i < entryCount; ++i) {
+            totalLen += PwUnlockedPassword(&manager, manager.getEntry(static_cast<quint32>(i))).size();
+        }
+        const qint64 readNs = timer.nsecsElapsed();
+        QCOMPARE(totalLen, static_cast<quint64>(entryCount) * passwordLen);
+        QCOMPARE(PwUnlockedPassword(&manager, manager.getEntry(0)).toString(), QString::fromLatin1(password));
+
+        qDebug() << QString("Password protection, %1 entries (%2):")
+                    .arg(entryCount)
+                    .arg(ProtectedStringCipher::backendName(ProtectedStringCipher::activeBackend()));
+        qDebug() << QString("  Session-key XOR, unlock + lock:  %1 ms")
+                    .arg(static_cast<double>(legacyNs) / 1e6, 0, 'f', 3);
+        qDebug() << QString("  AES-CTR batch, unlock + lock:    %1 ms")
+                    .arg(static_cast<double>(batchNs) / 1e6, 0, 'f', 3);
+        qDebug() << QString("  PwUnlockedPassword, every entry: %1 ms")
+                    .arg(static_cast<double>(readNs) / 1e6, 0, 'f', 3);
+    }
+
+    // =========================================================================
+    // SECURE MEMORY BENCHMARKS
+    // =========================================================================
+
+    void benchmarkSecureMemory_data()
+    {
+        QTest::addColumn<int>("blockCount");
+        QTest::addColumn<int>("blockSize");
+
+        QTest::newRow("10K x 32 bytes")  << 10000 << 32;
+        QTest::newRow("10K x 256 bytes") << 10000 << 256;
+    }
+
+    void benchmarkSecureMemory()
+    {
+        QFETCH(int, blockCount);
+        QFETCH(int, blockSize);
+        const size_t uSize = static_cast<size_t>(blockSize);
+
+        // Before: one heap block and one lock/unlock pair per object
+        QVector<char*> blocks(blockCount, nullptr);
+        int nLocked = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (char*& p : blocks) {
+            p = new char[uSize];
+            if (MemoryProtection::lockMemory(p, uSize))
+                ++nLocked;
+        }
+        for (char* p : blocks) {
+            MemoryProtection::secureErase(p, uSize);
+            MemoryProtection::unlockMemory(p, uSize);
+            delete[] p;
+        }
+        const qint64 perBlockNs = timer.nsecsElapsed();
+
+        // After: blocks from the SecureArena, locked per 64 KB chunk
+        const SecureArena::Stats before = SecureArena::getStats();
+        timer.restart();
+        for (char*& p : blocks) {
+            p = static_cast<char*>(SecureArena::allocate(uSize));
+        }
+        for (char* p : blocks) {
+            SecureArena::release(p);
+        }
+        const qint64 arenaNs = timer.nsecsElapsed();
+        const SecureArena::Stats after = SecureArena::getStats();
+        QCOMPARE(after.uAllocations - before.uAllocations, static_cast<quint64>(blockCount));
+
+        qDebug() << QString("Secure memory, %1 blocks of %2 bytes:").arg(blockCount).arg(blockSize);
+        qDebug() << QString("  new[] + mlock per block: %1 ms, %2 syscalls, %3 of %4 blocks locked")
+                    .arg(static_cast<double>(perBlockNs) / 1e6, 0, 'f', 2)
+                    .arg(2 * blockCount).arg(nLocked).arg(blockCount);
+        qDebug() << QString("  SecureArena:             %1 ms, %2 mlock calls (%3 failed), %4 syscalls saved")
+                    .arg(static_cast<double>(arenaNs) / 1e6, 0, 'f', 2)
+                    .arg(after.uLockCalls - before.uLockCalls)
+                    .arg(after.uLockFailures - before.uLockFailures)
+                    .arg(after.uSyscallsSaved - before.uSyscallsSaved);
+        qDebug() << QString("  Arena: %1 KB locked, peak %2 KB, %3 KB mapped")
+                    .arg(after.uBytesLocked / 1024)
+                    .arg(after.uBytesLockedPeak / 1024)
+                    .arg(after.uBytesMapped / 1024);
+    }
+
+    // =========================================================================
+    // RANDOM NUMBER BENCHMARKS
+    // =========================================================================
+
+    void benchmarkRandom()
+    {
+        constexpr int CALLS = 1000000;
+        constexpr int UUIDS = 100000;
+        constexpr int TANS = 10000;
+        volatile quint32 uSink = 0;  // Keeps the loops from being optimized away
+
+        // Before: every 32-bit value straight from RAND_bytes
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < CALLS; ++i) {
+            quint32 value = 0;
+            QVERIFY(Random::fillBufferDirect(reinterpret_cast<quint8*>(&value), sizeof(value)));
+            uSink = value;
+        }
+        const qint64 directNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < CALLS; ++i) {
+            uSink = Random::generateUInt32();
+        }
+        const qint64 bufferedNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < CALLS; ++i) {
+            uSink = Random::uniform(62);
+        }
+        const qint64 uniformNs = timer.nsecsElapsed();
+
+        // UUIDs one by one from RAND_bytes, one by one buffered, and in one batch
+        QByteArray uuids(UUIDS * 16, 0);
+        quint8* pUuids = reinterpret_cast<quint8*>(uuids.data());
+        timer.restart();
+        for (int i = 0; i < UUIDS; ++i) {
+            Random::fillBufferDirect(pUuids + i * 16, 16);
+        }
+        const qint64 uuidDirectNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < UUIDS; ++i) {
+            Random::generateUuid(pUuids + i * 16);
+        }
+        const qint64 uuidSingleNs = timer.nsecsElapsed();
+
+        timer.restart();
+        QVERIFY(Random::generateUuids(pUuids, UUIDS));
+        const qint64 uuidBatchNs = timer.nsecsElapsed();
+
+        // TAN-style passwords: 8 digits each
+        PasswordGeneratorSettings settings = PasswordGenerator::getDefaultSettings();
+        settings.length = 8;
+        settings.includeUpperCase = false;
+        settings.includeLowerCase = false;
+        settings.includeDigits = true;
+        settings.includeSpecial = false;
+        timer.restart();
+        for (int i = 0; i < TANS; ++i) {
+            QCOMPARE(PasswordGenerator::generate(settings).length(), 8);
+        }
+        const qint64 tanNs = timer.nsecsElapsed();
+
+        qDebug() << QString("Random numbers (%1 calls):").arg(CALLS);
+        qDebug() << QString("  RAND_bytes, 4 bytes per call: %1 ns/call")
+                    .arg(static_cast<double>(directNs) / CALLS, 0, 'f', 1);
+        qDebug() << QString("  generateUInt32 (buffered):    %1 ns/call (%2x)")
+                    .arg(static_cast<double>(bufferedNs) / CALLS, 0, 'f', 1)
+                    .arg(static_cast<double>(directNs) / qMax<qint64>(bufferedNs, 1), 0, 'f', 1);
+        qDebug() << QString("  uniform(62):                  %1 ns/call")
+                    .arg(static_cast<double>(uniformNs) / CALLS, 0, 'f', 1);
+        qDebug() << QString("  %1 UUIDs: RAND_bytes each %2 ms, buffered each %3 ms, batch %4 ms")
+                    .arg(UUIDS)
+                    .arg(static_cast<double>(uuidDirectNs) / 1e6, 0, 'f', 2)
+                    .arg(static_cast<double>(uuidSingleNs) / 1e6, 0, 'f', 2)
+                    .arg(static_cast<double>(uuidBatchNs) / 1e6, 0, 'f', 2);
+        qDebug() << QString("  %1 TANs (8 digits): %2 ms")
+                    .arg(TANS).arg(static_cast<double>(tanNs) / 1e6, 0, 'f', 2);
+    }
+
     // =========================================================================
     // SUMMARY
     // =========================================================================
@@ -474,6 +1476,9 @@ private slots:
         qDebug() << "- AES-256 1MB: Target > 50 MB/s";
         qDebug() << "- SHA-256 1MB: Target > 100 MB/s";
         qDebug() << "- Database 1000 entries: Target < 500 ms open";
+        qDebug() << "- Open with attachments: Peak RSS growth near 2x file size (buffer + attachments)";
+        qDebug() << "- UUID lookup: Constant ns/lookup from 1K to 1M entries";
+        qDebug() << "- String storage: Well under 1 heap allocation per entry";
         qDebug() << "==============================================";
     }
 };
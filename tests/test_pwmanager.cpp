@@ -14,9 +14,16 @@
 #include <QFile>
 #include <QDir>
 #include "../src/core/PwManager.h"
+#include "../src/core/PwSearchPlan.h"
 #include "../src/core/PwStructs.h"
+#include "../src/core/crypto/CipherBackend.h"
+#include "../src/core/crypto/MemoryProtection.h"
+#include "../src/core/platform/SecureArena.h"
 #include "../src/core/util/Random.h"
 #include "../src/core/util/PwUtil.h"
+#include "../src/core/util/StringArena.h"
+#include "../src/core/util/FoldedText.h"
+#include "../src/core/ExpiryScheduler.h"
 #include "../src/core/PasswordGenerator.h"
 
 class TestPwManager : public QObject
@@ -41,6 +48,20 @@ private slots:
     void testFindAll();
     void testFindExcludeBackups();
     void testFindExcludeExpired();
+    void testUuidIndex();
+    void testSearchPlan();
+    void testSearchIndex();
+    void testSearchSession();
+    void testFoldedText();
+    void testExpiryIndex();
+    void testExpiryScheduler();
+    void testGroupTreeIndex();
+    void testGroupEntryLists();
+    void testAddEntries();
+    void testStringArena();
+    void testSecureArena();
+    void testDeleteEntries();
+    void testSortGroups();
 
     // Password Generator tests
     void testPasswordGeneratorBasic();
@@ -53,6 +74,10 @@ private slots:
 
     void testSaveAndOpenEmptyDatabase();
     void testSaveAndOpenDatabaseWithData();
+    void testFastResave();
+    void testSaveAndOpenLargeDatabase();
+    void testAsyncOpenAndSave();
+    void testProgressAndCancel();
     void testPasswordEncryption();
     void testInvalidFileOperations();
     void testKDBXDetection();
@@ -73,6 +98,10 @@ void TestPwManager::initTestCase()
 
     // Ensure test data directory exists
     QDir().mkpath(m_testDataDir);
+
+    // Every database payload encrypted or decrypted by these tests must be
+    // byte-identical between the fast and the reference cipher backend
+    CipherBackend::setCrossCheck(true);
 }
 
 void TestPwManager::cleanupTestCase()
@@ -419,6 +448,347 @@ void TestPwManager::testSaveAndOpenDatabaseWithData()
     QFile::remove(testFile);
 }
 
+void TestPwManager::testFastResave()
+{
+    QString testFile = m_testDataDir + "/test_fast_resave.kdb";
+    QFile::remove(testFile);
+
+    QString masterPassword = "FastResave789!";
+    PwManager* mgr1 = createTestManager();
+    mgr1->newDatabase();
+    mgr1->setMasterKey(masterPassword, false, QString(), false, QString());
+    QVERIFY(!mgr1->isFastResave());
+    mgr1->setFastResave(true);
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.uGroupId = 1;
+    group.pszGroupName = const_cast<char*>("General");
+    PwManager::getNeverExpireTime(&group.tExpire);
+    mgr1->addGroup(&group);
+
+    // First save has nothing cached yet and must transform the key
+    QCOMPARE(mgr1->saveDatabase(testFile), PWE_SUCCESS);
+    PW_DBHEADER hdr1;
+    std::memcpy(&hdr1, mgr1->getLastDatabaseHeader(), sizeof(PW_DBHEADER));
+
+    // Resave keeps the transformation seed, but not the final key seed or IV
+    QCOMPARE(mgr1->saveDatabase(testFile), PWE_SUCCESS);
+    const PW_DBHEADER* hdr2 = mgr1->getLastDatabaseHeader();
+    QVERIFY(std::memcmp(hdr2->aMasterSeed2, hdr1.aMasterSeed2, 32) == 0);
+    QVERIFY(std::memcmp(hdr2->aMasterSeed, hdr1.aMasterSeed, 16) != 0);
+    QVERIFY(std::memcmp(hdr2->aEncryptionIV, hdr1.aEncryptionIV, 16) != 0);
+    delete mgr1;
+
+    // The resaved file opens normally; saving after an open reuses its seed
+    PwManager* mgr2 = createTestManager();
+    mgr2->setMasterKey(masterPassword, false, QString(), false, QString());
+    QCOMPARE(mgr2->openDatabase(testFile), PWE_SUCCESS);
+    verifyDatabaseIntegrity(mgr2, 1, 0);
+    mgr2->setFastResave(true);
+    QCOMPARE(mgr2->saveDatabase(testFile), PWE_SUCCESS);
+    QVERIFY(std::memcmp(mgr2->getLastDatabaseHeader()->aMasterSeed2, hdr1.aMasterSeed2, 32) == 0);
+
+    // Forcing a re-transform, changing the rounds or changing the key all
+    // produce a new transformation seed
+    std::memcpy(&hdr1, mgr2->getLastDatabaseHeader(), sizeof(PW_DBHEADER));
+    mgr2->invalidateTransformedMasterKey();
+    QCOMPARE(mgr2->saveDatabase(testFile), PWE_SUCCESS);
+    QVERIFY(std::memcmp(mgr2->getLastDatabaseHeader()->aMasterSeed2, hdr1.aMasterSeed2, 32) != 0);
+
+    std::memcpy(&hdr1, mgr2->getLastDatabaseHeader(), sizeof(PW_DBHEADER));
+    mgr2->setKeyEncRounds(hdr1.dwKeyEncRounds + 1);
+    QCOMPARE(mgr2->saveDatabase(testFile), PWE_SUCCESS);
+    QVERIFY(std::memcmp(mgr2->getLastDatabaseHeader()->aMasterSeed2, hdr1.aMasterSeed2, 32) != 0);
+
+    std::memcpy(&hdr1, mgr2->getLastDatabaseHeader(), sizeof(PW_DBHEADER));
+    masterPassword = "ChangedKey789!";
+    mgr2->setMasterKey(masterPassword, false, QString(), false, QString());
+    QCOMPARE(mgr2->saveDatabase(testFile), PWE_SUCCESS);
+    QVERIFY(std::memcmp(mgr2->getLastDatabaseHeader()->aMasterSeed2, hdr1.aMasterSeed2, 32) != 0);
+    delete mgr2;
+
+    PwManager* mgr3 = createTestManager();
+    mgr3->setMasterKey(masterPassword, false, QString(), false, QString());
+    QCOMPARE(mgr3->openDatabase(testFile), PWE_SUCCESS);
+    verifyDatabaseIntegrity(mgr3, 1, 0);
+    delete mgr3;
+    QFile::remove(testFile);
+}
+
+void TestPwManager::testSaveAndOpenLargeDatabase()
+{
+    // Above 4 MB the payload is decrypted on several threads; the result
+    // must be the same as with the sequential path for both ciphers
+    QString testFile = m_testDataDir + "/test_large.kdb";
+    const QString masterPassword = "LargeDatabase321!";
+    const quint32 uAttachmentSize = 5 * 1024 * 1024 + 123;
+
+    QByteArray attachment(static_cast<int>(uAttachmentSize), Qt::Uninitialized);
+    Random::fillBuffer(reinterpret_cast<quint8*>(attachment.data()), uAttachmentSize);
+
+    for (int nAlgorithm : { ALGO_AES, ALGO_TWOFISH }) {
+        QFile::remove(testFile);
+
+        PwManager* mgr1 = createTestManager();
+        mgr1->newDatabase();
+        mgr1->setMasterKey(masterPassword, false, QString(), false, QString());
+        QVERIFY(mgr1->setAlgorithm(nAlgorithm));
+
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.uGroupId = 1;
+        group.pszGroupName = const_cast<char*>("General");
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr1->addGroup(&group));
+
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 1;
+        entry.pszTitle = const_cast<char*>("Large");
+        entry.pszUserName = const_cast<char*>("");
+        entry.pszURL = const_cast<char*>("");
+        entry.pszPassword = const_cast<char*>("");
+        entry.pszAdditional = const_cast<char*>("");
+        entry.pszBinaryDesc = const_cast<char*>("large.bin");
+        entry.pBinaryData = reinterpret_cast<BYTE*>(attachment.data());
+        entry.uBinaryDataLen = uAttachmentSize;
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr1->addEntry(&entry));
+
+        QCOMPARE(mgr1->saveDatabase(testFile), PWE_SUCCESS);
+        delete mgr1;
+
+        PwManager* mgr2 = createTestManager();
+        mgr2->setMasterKey(masterPassword, false, QString(), false, QString());
+        QCOMPARE(mgr2->openDatabase(testFile), PWE_SUCCESS);
+        QCOMPARE(mgr2->getAlgorithm(), nAlgorithm);
+        verifyDatabaseIntegrity(mgr2, 1, 1);
+
+        PW_ENTRY* pLoaded = mgr2->getEntry(0);
+        QVERIFY(pLoaded != nullptr);
+        QCOMPARE(pLoaded->uBinaryDataLen, uAttachmentSize);
+        QVERIFY(std::memcmp(pLoaded->pBinaryData, attachment.constData(), uAttachmentSize) == 0);
+        delete mgr2;
+
+        // A wrong key must still be detected (bad padding or content hash)
+        PwManager* mgr3 = createTestManager();
+        mgr3->setMasterKey("WrongPassword", false, QString(), false, QString());
+        QCOMPARE(mgr3->openDatabase(testFile), PWE_INVALID_KEY);
+        delete mgr3;
+    }
+
+    QFile::remove(testFile);
+}
+
+void TestPwManager::testAsyncOpenAndSave()
+{
+    QString testFile = m_testDataDir + "/test_async.kdb";
+    QFile::remove(testFile);
+    const QString masterPassword = "AsyncOpenSave654!";
+
+    PwManager* mgr1 = createTestManager();
+    mgr1->newDatabase();
+    mgr1->setMasterKey(masterPassword, false, QString(), false, QString());
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.uGroupId = 1;
+    group.pszGroupName = const_cast<char*>("Async");
+    PwManager::getNeverExpireTime(&group.tExpire);
+    mgr1->addGroup(&group);
+
+    PW_ENTRY entry;
+    std::memset(&entry, 0, sizeof(PW_ENTRY));
+    entry.uGroupId = 1;
+    entry.pszTitle = const_cast<char*>("Async Entry");
+    entry.pszUserName = const_cast<char*>("asyncuser");
+    entry.pszURL = const_cast<char*>("");
+    entry.pszPassword = const_cast<char*>("async-secret");
+    entry.uPasswordLen = 12;
+    entry.pszAdditional = const_cast<char*>("");
+    entry.pszBinaryDesc = const_cast<char*>("");
+    Random::fillBuffer(entry.uuid, 16);
+    PwManager::getNeverExpireTime(&entry.tExpire);
+    mgr1->addEntry(&entry);
+
+    // The save future ends with the write stage at 100%; the header is only
+    // recorded by finishAsyncOperation()
+    PW_DBHEADER hdrBefore;
+    std::memcpy(&hdrBefore, mgr1->getLastDatabaseHeader(), sizeof(PW_DBHEADER));
+    QFuture<int> saving = mgr1->saveDatabaseAsync(testFile);
+    QVERIFY(mgr1->isAsyncOperationPending());
+    saving.waitForFinished();
+    QCOMPARE(saving.result(), PWE_SUCCESS);
+    QCOMPARE(saving.progressValue(), PwManager::PROGRESS_MAXIMUM);
+    QVERIFY(PwManager::progressStage(saving.progressValue()) == PwManager::OperationStage::Write);
+    QVERIFY(std::memcmp(mgr1->getLastDatabaseHeader(), &hdrBefore, sizeof(PW_DBHEADER)) == 0);
+    QCOMPARE(mgr1->finishAsyncOperation(), PWE_SUCCESS);
+    QVERIFY(!mgr1->isAsyncOperationPending());
+    QVERIFY(std::memcmp(mgr1->getLastDatabaseHeader(), &hdrBefore, sizeof(PW_DBHEADER)) != 0);
+    QCOMPARE(mgr1->finishAsyncOperation(), PWE_UNKNOWN);
+    verifyDatabaseIntegrity(mgr1, 1, 1);
+    delete mgr1;
+
+    // Opening into a manager that holds another database leaves that one in
+    // place until finishAsyncOperation() swaps the opened one in
+    PwManager* mgr2 = createTestManager();
+    mgr2->newDatabase();
+    mgr2->setMasterKey(masterPassword, false, QString(), false, QString());
+    group.uGroupId = 7;
+    group.pszGroupName = const_cast<char*>("Other");
+    mgr2->addGroup(&group);
+
+    QFuture<int> opening = mgr2->openDatabaseAsync(testFile);
+    opening.waitForFinished();
+    QCOMPARE(opening.result(), PWE_SUCCESS);
+    QCOMPARE(mgr2->getNumberOfGroups(), 1u);
+    QCOMPARE(QString(mgr2->getGroup(0)->pszGroupName), QString("Other"));
+    QCOMPARE(mgr2->finishAsyncOperation(), PWE_SUCCESS);
+    verifyDatabaseIntegrity(mgr2, 1, 1);
+    QCOMPARE(QString(mgr2->getGroup(0)->pszGroupName), QString("Async"));
+    QCOMPARE(QString(mgr2->getEntry(0)->pszTitle), QString("Async Entry"));
+    {
+        // The locked passwords come along with the keystream they were locked with
+        PwUnlockedPassword password(mgr2, mgr2->getEntry(0));
+        QCOMPARE(password.toString(), QString("async-secret"));
+    }
+
+    // Saving again after an asynchronous open, then opening synchronously
+    QCOMPARE(mgr2->saveDatabaseAsync(testFile).result(), PWE_SUCCESS);
+    QCOMPARE(mgr2->finishAsyncOperation(), PWE_SUCCESS);
+    delete mgr2;
+
+    PwManager* mgr3 = createTestManager();
+    mgr3->setMasterKey(masterPassword, false, QString(), false, QString());
+    QCOMPARE(mgr3->openDatabase(testFile), PWE_SUCCESS);
+    verifyDatabaseIntegrity(mgr3, 1, 1);
+    {
+        PwUnlockedPassword password(mgr3, mgr3->getEntry(0));
+        QCOMPARE(password.toString(), QString("async-secret"));
+    }
+
+    // A wrong key fails without touching the loaded database
+    mgr3->setMasterKey("WrongPassword", false, QString(), false, QString());
+    QCOMPARE(mgr3->openDatabaseAsync(testFile).result(), PWE_INVALID_KEY);
+    QCOMPARE(mgr3->finishAsyncOperation(), PWE_INVALID_KEY);
+    verifyDatabaseIntegrity(mgr3, 1, 1);
+    delete mgr3;
+    QFile::remove(testFile);
+}
+
+void TestPwManager::testProgressAndCancel()
+{
+    QString testFile = m_testDataDir + "/test_progress.kdb";
+    QFile::remove(testFile);
+    const QString masterPassword = "Progress987!";
+
+    PwManager* mgr1 = createTestManager();
+    mgr1->newDatabase();
+    mgr1->setMasterKey(masterPassword, false, QString(), false, QString());
+    mgr1->setKeyEncRounds(200000);  // Enough for several key transformation slices
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.uGroupId = 1;
+    group.pszGroupName = const_cast<char*>("General");
+    PwManager::getNeverExpireTime(&group.tExpire);
+    mgr1->addGroup(&group);
+
+    // Every stage is reported in order and counts up to 100
+    QVector<PwManager::OperationStage> vStages;
+    int nLastPercent = -1;
+    bool bAscending = true;
+    const PwManager::ProgressCallback fnRecord = [&](PwManager::OperationStage eStage, int nPercent) {
+        if (vStages.isEmpty() || vStages.last() != eStage)
+            vStages.append(eStage);
+        else if (nPercent < nLastPercent)
+            bAscending = false;
+        nLastPercent = nPercent;
+        return true;
+    };
+
+    QCOMPARE(mgr1->saveDatabase(testFile, nullptr, fnRecord), PWE_SUCCESS);
+    QVERIFY(vStages == QVector<PwManager::OperationStage>({ PwManager::OperationStage::Serialize,
+        PwManager::OperationStage::KeyTransform, PwManager::OperationStage::Encrypt,
+        PwManager::OperationStage::Write }));
+    QVERIFY(bAscending);
+    QCOMPARE(nLastPercent, 100);
+
+    PwManager* mgr2 = createTestManager();
+    mgr2->setMasterKey(masterPassword, false, QString(), false, QString());
+    vStages.clear();
+    QCOMPARE(mgr2->openDatabase(testFile, nullptr, fnRecord), PWE_SUCCESS);
+    QVERIFY(vStages == QVector<PwManager::OperationStage>({ PwManager::OperationStage::Read,
+        PwManager::OperationStage::KeyTransform, PwManager::OperationStage::Decrypt,
+        PwManager::OperationStage::Parse }));
+    QVERIFY(bAscending);
+    QCOMPARE(nLastPercent, 100);
+    verifyDatabaseIntegrity(mgr2, 1, 0);
+
+    QFile file(testFile);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray baSaved = file.readAll();
+    file.close();
+
+    // Canceling a save leaves the file and the database as they were
+    const quint32 dwEntries = mgr1->getNumberOfEntries();
+    for (PwManager::OperationStage eCancel : { PwManager::OperationStage::Serialize,
+                                               PwManager::OperationStage::KeyTransform,
+                                               PwManager::OperationStage::Encrypt }) {
+        const int nResult = mgr1->saveDatabase(testFile, nullptr,
+            [eCancel](PwManager::OperationStage eStage, int) { return eStage != eCancel; });
+        QCOMPARE(nResult, PWE_CANCELED);
+        QCOMPARE(mgr1->getNumberOfEntries(), dwEntries);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll() == baSaved);
+        file.close();
+    }
+
+    // Writing is not stopped halfway
+    QCOMPARE(mgr1->saveDatabase(testFile, nullptr,
+        [](PwManager::OperationStage eStage, int) { return eStage != PwManager::OperationStage::Write; }),
+        PWE_SUCCESS);
+
+    // Canceling an open keeps the loaded database
+    for (PwManager::OperationStage eCancel : { PwManager::OperationStage::Read,
+                                               PwManager::OperationStage::KeyTransform,
+                                               PwManager::OperationStage::Decrypt }) {
+        const int nResult = mgr2->openDatabase(testFile, nullptr,
+            [eCancel](PwManager::OperationStage eStage, int) { return eStage != eCancel; });
+        QCOMPARE(nResult, PWE_CANCELED);
+        verifyDatabaseIntegrity(mgr2, 1, 0);
+    }
+
+    // Canceled futures: a canceled open is dropped even if the worker got
+    // through, a save is stopped before anything is written
+    QFuture<int> opening = mgr2->openDatabaseAsync(testFile);
+    opening.cancel();
+    QCOMPARE(mgr2->finishAsyncOperation(), PWE_CANCELED);
+    verifyDatabaseIntegrity(mgr2, 1, 0);
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray baResaved = file.readAll();
+    file.close();
+    mgr1->setKeyEncRounds(50000000);
+    QFuture<int> saving = mgr1->saveDatabaseAsync(testFile);
+    saving.cancel();
+    QCOMPARE(mgr1->finishAsyncOperation(), PWE_CANCELED);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll() == baResaved);
+    file.close();
+
+    // Progress values of the futures carry stage and percentage
+    const int nValue = PwManager::encodeProgress(PwManager::OperationStage::Decrypt, 42);
+    QVERIFY(PwManager::progressStage(nValue) == PwManager::OperationStage::Decrypt);
+    QCOMPARE(PwManager::progressPercent(nValue), 42);
+    QCOMPARE(PwManager::encodeProgress(PwManager::OperationStage::Write, 100), PwManager::PROGRESS_MAXIMUM);
+
+    delete mgr1;
+    delete mgr2;
+    QFile::remove(testFile);
+}
+
 void TestPwManager::testPasswordEncryption()
 {
     PwManager* mgr = createTestManager();
@@ -478,6 +848,40 @@ void TestPwManager::testPasswordEncryption()
     mgr->unlockEntryPassword(storedEntry);
     QString decryptedPassword2(storedEntry->pszPassword);
     QCOMPARE(decryptedPassword2, password);
+    mgr->lockEntryPassword(storedEntry);
+
+    // Readers decrypt a copy and leave the stored bytes locked
+    const QByteArray lockedBytes(storedEntry->pszPassword, static_cast<int>(storedEntry->uPasswordLen));
+    QVERIFY(lockedBytes != passwordUtf8);
+    {
+        const PwUnlockedPassword unlocked(mgr, storedEntry);
+        QCOMPARE(unlocked.toString(), password);
+        QCOMPARE(unlocked.size(), static_cast<quint32>(passwordUtf8.length()));
+    }
+    QCOMPARE(QByteArray(storedEntry->pszPassword, static_cast<int>(storedEntry->uPasswordLen)), lockedBytes);
+
+    // Every stored password gets its own nonce, so equal passwords are stored differently
+    Random::fillBuffer(entry.uuid, 16);
+    mgr->addEntry(&entry);
+    QCOMPARE(mgr->getNumberOfEntries(), 2u);
+    PW_ENTRY* secondEntry = mgr->getEntry(1);
+    QCOMPARE(PwUnlockedPassword(mgr, secondEntry).toString(), password);
+    QVERIFY(QByteArray(secondEntry->pszPassword, static_cast<int>(secondEntry->uPasswordLen)) != lockedBytes);
+
+    // nullptr unlocks and locks all entries at once
+    mgr->unlockEntryPassword(nullptr);
+    QCOMPARE(QString::fromUtf8(mgr->getEntry(0)->pszPassword), password);
+    QCOMPARE(QString::fromUtf8(mgr->getEntry(1)->pszPassword), password);
+    mgr->lockEntryPassword(nullptr);
+    QCOMPARE(QByteArray(mgr->getEntry(0)->pszPassword, static_cast<int>(mgr->getEntry(0)->uPasswordLen)),
+             lockedBytes);
+
+    // Storing the same password in the same entry again takes a new nonce
+    std::memcpy(entry.uuid, mgr->getEntry(0)->uuid, 16);
+    QVERIFY(mgr->setEntry(0, &entry));
+    QCOMPARE(PwUnlockedPassword(mgr, mgr->getEntry(0)).toString(), password);
+    QVERIFY(QByteArray(mgr->getEntry(0)->pszPassword, static_cast<int>(mgr->getEntry(0)->uPasswordLen)) !=
+            lockedBytes);
 
     // Cleanup
     delete[] entry.pszTitle;
@@ -1154,6 +1558,1146 @@ void TestPwManager::testFindExcludeExpired()
     delete mgr;
 }
 
+void TestPwManager::testUuidIndex()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.pszGroupName = const_cast<char*>("Test Group");
+    group.uGroupId = 1;
+    PwManager::getNeverExpireTime(&group.tExpire);
+    QVERIFY(mgr->addGroup(&group));
+
+    // Add entries with random UUIDs and remember them
+    QVector<PW_UUID_STRUCT> uuids;
+    for (int i = 0; i < 5; ++i) {
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 1;
+        Random::fillBuffer(entry.uuid, 16);
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+
+        PW_UUID_STRUCT u;
+        std::memcpy(u.uuid, entry.uuid, 16);
+        uuids.append(u);
+    }
+
+    for (int i = 0; i < uuids.size(); ++i) {
+        QCOMPARE(mgr->getEntryByUuidN(uuids[i].uuid), static_cast<quint32>(i));
+    }
+
+    // Deleting shifts the following entries down
+    QVERIFY(mgr->deleteEntry(1));
+    QCOMPARE(mgr->getEntryByUuidN(uuids[1].uuid), 0xFFFFFFFFu);
+    QVERIFY(mgr->getEntryByUuid(uuids[1].uuid) == nullptr);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[2].uuid), 1u);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[4].uuid), 3u);
+
+    // Moving reorders the entries inside the group
+    mgr->moveEntry(1, 0, 3);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[0].uuid), 3u);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[2].uuid), 0u);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[4].uuid), 2u);
+
+    // Changing the UUID through setEntry re-keys the entry
+    PW_ENTRY changed;
+    std::memset(&changed, 0, sizeof(PW_ENTRY));
+    changed.uGroupId = 1;
+    changed.pszTitle = const_cast<char*>("Changed");
+    changed.pszUserName = const_cast<char*>("");
+    changed.pszPassword = const_cast<char*>("");
+    changed.pszURL = const_cast<char*>("");
+    changed.pszAdditional = const_cast<char*>("");
+    PwManager::getNeverExpireTime(&changed.tExpire);
+    Random::fillBuffer(changed.uuid, 16);
+    QVERIFY(mgr->setEntry(0, &changed));
+    QCOMPARE(mgr->getEntryByUuidN(changed.uuid), 0u);
+    QCOMPARE(mgr->getEntryByUuidN(uuids[2].uuid), 0xFFFFFFFFu);
+
+    // Bulk resolution is parallel to the input
+    const QVector<quint32> resolved = mgr->resolveUuids(uuids);
+    QCOMPARE(resolved.size(), uuids.size());
+    QCOMPARE(resolved[0], 3u);
+    QCOMPARE(resolved[1], 0xFFFFFFFFu);
+    QCOMPARE(resolved[3], 1u);
+
+    // Every remaining entry resolves to itself
+    for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+        QCOMPARE(mgr->getEntryByUuid(mgr->getEntry(i)->uuid), mgr->getEntry(i));
+    }
+
+    delete mgr;
+}
+
+void TestPwManager::testSearchPlan()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+
+    const char* aGroupNames[] = { "Internet", PWS_BACKUPGROUP, "Stra\xC3\x9F" "e" };
+    for (quint32 g = 0; g < 3; ++g) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(aGroupNames[g]);
+        group.uGroupId = g + 1;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    // Enough entries for several chunks, with ASCII and non-ASCII text
+    const char* aTitles[] = { "Mail Account", "BANK login", "Stra\xC3\x9F" "e 5", "\xC3\x84RGER",
+                              "mail", "Kelvin \xE2\x84\xAA", "" };
+    const quint32 dwEntries = 3 * PwSearchPlan::CHUNK_ENTRIES + 123;
+    for (quint32 i = 0; i < dwEntries; ++i) {
+        const QByteArray baUser = QString("user%1").arg(i).toUtf8();
+        const QByteArray baUrl = (i % 2 == 0) ? QString("https://example.com/%1").arg(i).toUtf8() : QByteArray();
+        const QByteArray baPassword = QString("pw-%1").arg(i).toUtf8();
+
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 1 + i % 3;
+        entry.pszTitle = const_cast<char*>(aTitles[i % 7]);
+        entry.pszUserName = const_cast<char*>(baUser.constData());
+        entry.pszURL = const_cast<char*>(baUrl.constData());
+        entry.pszPassword = const_cast<char*>(baPassword.constData());
+        entry.uPasswordLen = static_cast<quint32>(baPassword.size());
+        entry.pszAdditional = const_cast<char*>((i % 11 == 0) ? "Note MAIL \xC3\xA4rger" : "");
+        entry.pszBinaryDesc = const_cast<char*>("");
+        Random::generateUuid(entry.uuid);
+        if (i % 13 == 0)
+            PwUtil::dateTimeToPwTime(QDateTime::currentDateTime().addDays(-1), &entry.tExpire);
+        else
+            PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    // Reference: the field-by-field QString comparison find() used to do
+    auto reference = [mgr](const QString& text, bool bCaseSensitive, quint32 flags,
+                           bool excludeBackups, bool excludeExpired) {
+        QList<quint32> results;
+        const bool bRegex = (flags & PWMS_REGEX) != 0;
+        const QRegularExpression regex(text, bCaseSensitive ? QRegularExpression::NoPatternOption
+                                                            : QRegularExpression::CaseInsensitiveOption);
+        auto matches = [&](const QString& field) {
+            if (field.isEmpty())
+                return false;
+            return bRegex ? regex.match(field).hasMatch()
+                          : field.contains(text, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        };
+
+        PW_TIME now;
+        PwUtil::getCurrentTime(&now);
+        const quint32 backupGroupId = mgr->getGroupId(PWS_BACKUPGROUP);
+        for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+            PW_ENTRY* entry = mgr->getEntry(i);
+            if (excludeBackups && entry->uGroupId == backupGroupId)
+                continue;
+            if (excludeExpired && PwUtil::compareTime(&now, &entry->tExpire) > 0)
+                continue;
+
+            const PwUnlockedPassword password(mgr, entry);
+            const PW_GROUP* group = mgr->getGroupById(entry->uGroupId);
+            if (((flags & PWMF_TITLE) && matches(QString::fromUtf8(entry->pszTitle))) ||
+                ((flags & PWMF_USER) && matches(QString::fromUtf8(entry->pszUserName))) ||
+                ((flags & PWMF_URL) && matches(QString::fromUtf8(entry->pszURL))) ||
+                ((flags & PWMF_PASSWORD) && matches(password.toString())) ||
+                ((flags & PWMF_ADDITIONAL) && matches(QString::fromUtf8(entry->pszAdditional))) ||
+                ((flags & PWMF_UUID) && matches(PwUtil::uuidToString(entry->uuid))) ||
+                ((flags & PWMF_GROUPNAME) && group && matches(QString::fromUtf8(group->pszGroupName)))) {
+                results.append(i);
+            }
+        }
+        return results;
+    };
+
+    struct Query
+    {
+        QString text;
+        bool bCaseSensitive;
+        quint32 flags;
+    };
+    const QString strUuid = PwUtil::uuidToString(mgr->getEntry(4321)->uuid).mid(3, 12);
+    const Query aQueries[] = {
+        { "mail", false, PWMF_TITLE | PWMF_ADDITIONAL },
+        { "Mail", true, PWMF_TITLE },
+        { QString::fromUtf8("STRA\xC3\x9F"), false, PWMF_TITLE | PWMF_GROUPNAME },
+        { QString::fromUtf8("\xC3\xA4rger"), false, PWMF_TITLE | PWMF_ADDITIONAL },
+        { QString::fromUtf8("\xE2\x84\xAA"), true, PWMF_TITLE },
+        { "k", false, PWMF_TITLE },
+        { "pw-12", false, PWMF_PASSWORD },
+        { "^user1\\d$", true, PWMF_USER | PWMS_REGEX },
+        { "EXAMPLE\\.com/\\d*7$", false, PWMF_URL | PWMS_REGEX },
+        { "internet", false, PWMF_GROUPNAME },
+        { strUuid, false, PWMF_UUID },
+        { "user", false, PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_PASSWORD | PWMF_ADDITIONAL | PWMF_UUID | PWMF_GROUPNAME }
+    };
+
+    for (const Query& query : aQueries) {
+        for (int nFilter = 0; nFilter < 4; ++nFilter) {
+            const bool excludeBackups = (nFilter & 1) != 0;
+            const bool excludeExpired = (nFilter & 2) != 0;
+            const QList<quint32> expected = reference(query.text, query.bCaseSensitive, query.flags,
+                                                      excludeBackups, excludeExpired);
+            QString error;
+            QCOMPARE(mgr->findAll(query.text, query.bCaseSensitive, query.flags,
+                                  excludeBackups, excludeExpired, &error), expected);
+            QVERIFY(error.isEmpty());
+
+            // Same result on one thread, in any range, and for find()
+            const PwSearchPlan plan(mgr, query.text, query.bCaseSensitive, query.flags,
+                                    excludeBackups, excludeExpired);
+            QCOMPARE(plan.findAll(0, 0xFFFFFFFF, 1), expected);
+            QList<quint32> inRange;
+            for (quint32 i : expected) {
+                if (i >= 1000 && i < 5000)
+                    inRange.append(i);
+            }
+            QCOMPARE(plan.findAll(1000, 5000, 3), inRange);
+            if (nFilter == 0) {
+                QCOMPARE(mgr->find(query.text, query.bCaseSensitive, query.flags, 0, 0xFFFFFFFF),
+                         expected.isEmpty() ? 0xFFFFFFFFu : expected.first());
+            }
+        }
+    }
+    QCOMPARE(mgr->findAll(strUuid, false, PWMF_UUID, false, false).size(), 1);
+
+    // Invalid queries report the same errors as before
+    QString error;
+    QVERIFY(mgr->findAll("(unclosed", false, PWMF_TITLE | PWMS_REGEX, false, false, &error).isEmpty());
+    QVERIFY(error.startsWith("Invalid regular expression"));
+    error.clear();
+    QCOMPARE(mgr->find("", false, PWMF_TITLE, 0, 0xFFFFFFFF, &error), 0xFFFFFFFFu);
+    QVERIFY(!error.isEmpty());
+
+    delete mgr;
+}
+
+void TestPwManager::testSearchIndex()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+
+    const char* aGroupNames[] = { "Mail Accounts", "Banking" };
+    for (quint32 g = 0; g < 2; ++g) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(aGroupNames[g]);
+        group.uGroupId = g + 1;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    const char* aTitles[] = { "Mail Account", "BANK login", "\xC3\x84rger", "Shop", "mailbox" };
+    auto makeEntry = [](PW_ENTRY& entry, quint32 uGroupId, const char* pszTitle, const QByteArray& baUser,
+                        const QByteArray& baPassword) {
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = uGroupId;
+        entry.pszTitle = const_cast<char*>(pszTitle);
+        entry.pszUserName = const_cast<char*>(baUser.constData());
+        entry.pszURL = const_cast<char*>("https://example.com");
+        entry.pszPassword = const_cast<char*>(baPassword.constData());
+        entry.uPasswordLen = static_cast<quint32>(baPassword.size());
+        entry.pszAdditional = const_cast<char*>("");
+        entry.pszBinaryDesc = const_cast<char*>("");
+        PwManager::getNeverExpireTime(&entry.tExpire);
+    };
+    for (quint32 i = 0; i < 300; ++i) {
+        const QByteArray baUser = QString("user%1").arg(i).toUtf8();
+        const QByteArray baPassword = QString("pw-%1").arg(i).toUtf8();
+        PW_ENTRY entry;
+        makeEntry(entry, 1 + i % 2, aTitles[i % 5], baUser, baPassword);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    // The same search as a regular expression never uses the index
+    const QStringList queries = { "mail", "ACCOUNT", "bank", QString::fromUtf8("\xC3\xA4rg"), "user12",
+                                  "ma", "nowhere" };
+    auto checkSearches = [mgr, &queries](quint32 flags) {
+        for (const QString& query : queries) {
+            const QList<quint32> viaIndex = mgr->findAll(query, false, flags, false, false);
+            const QList<quint32> viaScan = mgr->findAll(QRegularExpression::escape(query), false,
+                                                        flags | PWMS_REGEX, false, false);
+            if (viaIndex != viaScan)
+                return false;
+        }
+        return true;
+    };
+    const quint32 textFields = PWMF_TITLE | PWMF_USER | PWMF_URL | PWMF_ADDITIONAL;
+    QVERIFY(checkSearches(textFields));
+    QVERIFY(checkSearches(PWMF_TITLE | PWMF_GROUPNAME));
+
+    TrigramIndex::Stats stats = mgr->getSearchIndexStats();
+    QCOMPARE(stats.uDocuments, mgr->getNumberOfEntries());
+    QVERIFY(stats.uTrigrams > 0);
+    QVERIFY(stats.uBytesPerDocument > 0);
+
+    // Every change is applied to the index built above
+    PW_ENTRY entry;
+    const QByteArray baUser("mailer");
+    const QByteArray baPassword("secret");
+    makeEntry(entry, 2, "New Bank Account", baUser, baPassword);
+    QVERIFY(mgr->addEntry(&entry));
+    QVERIFY(checkSearches(textFields));
+
+    const QByteArray baChangedUser("someone");
+    const QByteArray baChangedPassword("pw-changed");
+    PW_ENTRY changed;
+    makeEntry(changed, 1, "Renamed mail", baChangedUser, baChangedPassword);
+    std::memcpy(changed.uuid, mgr->getEntry(7)->uuid, 16);
+    QVERIFY(mgr->setEntry(7, &changed));
+    QVERIFY(checkSearches(textFields));
+
+    QVERIFY(mgr->deleteEntry(3));
+    QVERIFY(checkSearches(textFields));
+
+    mgr->moveEntry(1, 0, 40);
+    mgr->moveEntry(2, 30, 2);
+    QVERIFY(checkSearches(textFields));
+
+    mgr->sortGroup(1, 0);
+    QVERIFY(checkSearches(textFields));
+
+    QCOMPARE(mgr->deleteEntries(QVector<quint32>{ 0, 11, 12, 250 }), 4u);
+    QVERIFY(checkSearches(textFields | PWMF_GROUPNAME));
+    QCOMPARE(mgr->getSearchIndexStats().uDocuments, mgr->getNumberOfEntries());
+
+    // Passwords are only in the index after opting in
+    QVERIFY(!mgr->isSearchIndexPasswords());
+    QVERIFY(checkSearches(PWMF_PASSWORD));
+    mgr->setSearchIndexPasswords(true);
+    QVERIFY(checkSearches(PWMF_PASSWORD | PWMF_TITLE));
+    QCOMPARE(mgr->findAll("SECRET", false, PWMF_PASSWORD, false, false).size(), 1);
+    QVERIFY(mgr->getSearchIndexStats().uBytes > stats.uBytes);
+
+    delete mgr;
+}
+
+void TestPwManager::testSearchSession()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.pszGroupName = const_cast<char*>("General");
+    group.uGroupId = 1;
+    PwManager::getNeverExpireTime(&group.tExpire);
+    QVERIFY(mgr->addGroup(&group));
+
+    const char* aTitles[] = { "Bank", "banana", "Band practice", "Mail", "BANKING portal" };
+    for (quint32 i = 0; i < 200; ++i) {
+        const QByteArray baUser = QString("user%1").arg(i).toUtf8();
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 1;
+        entry.pszTitle = const_cast<char*>(aTitles[i % 5]);
+        entry.pszUserName = const_cast<char*>(baUser.constData());
+        entry.pszURL = const_cast<char*>("");
+        entry.pszPassword = const_cast<char*>("");
+        entry.pszAdditional = const_cast<char*>("");
+        entry.pszBinaryDesc = const_cast<char*>("");
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    const quint32 flags = PWMF_TITLE | PWMF_USER;
+    PwSearchSession& session = mgr->getSearchSession();
+    QCOMPARE(&mgr->getSearchSession(), &session);
+
+    // Typing ahead only checks the previous results
+    QCOMPARE(session.search("ba", false, flags, false, false), mgr->findAll("ba", false, flags, false, false));
+    QVERIFY(!session.wasRefined());
+    QCOMPARE(session.search("ban", false, flags, false, false), mgr->findAll("ban", false, flags, false, false));
+    QVERIFY(session.wasRefined());
+    QCOMPARE(session.search("BANK", false, flags, false, false), mgr->findAll("BANK", false, flags, false, false));
+    QVERIFY(session.wasRefined());
+    QCOMPARE(session.search("bank", false, flags, false, false).size(), 80);
+
+    // Deleting characters or changing the options starts over
+    QCOMPARE(session.search("ban", false, flags, false, false).size(), 160);
+    QVERIFY(!session.wasRefined());
+    QCOMPARE(session.search("bank", true, flags, false, false), mgr->findAll("bank", true, flags, false, false));
+    QVERIFY(!session.wasRefined());
+    QCOMPARE(session.search("bank", true, PWMF_TITLE, false, false).size(), 0);
+    QVERIFY(!session.wasRefined());
+
+    // Any change to the database invalidates the previous results
+    QCOMPARE(session.search("ban", false, flags, false, false).size(), 160);
+    PW_ENTRY changed;  // Replaces entry 3 ("Mail")
+    std::memset(&changed, 0, sizeof(PW_ENTRY));
+    std::memcpy(changed.uuid, mgr->getEntry(3)->uuid, 16);
+    changed.uGroupId = 1;
+    changed.pszTitle = const_cast<char*>("Bankers");
+    changed.pszUserName = const_cast<char*>("user3");
+    changed.pszURL = const_cast<char*>("");
+    changed.pszPassword = const_cast<char*>("");
+    changed.pszAdditional = const_cast<char*>("");
+    changed.pszBinaryDesc = const_cast<char*>("");
+    PwManager::getNeverExpireTime(&changed.tExpire);
+    QVERIFY(mgr->setEntry(3, &changed));
+    const QList<quint32> results = session.search("bank", false, flags, false, false);
+    QVERIFY(!session.wasRefined());
+    QCOMPARE(results, mgr->findAll("bank", false, flags, false, false));
+    QVERIFY(results.contains(3u));
+
+    session.search("user1", false, flags, false, false);
+    QVERIFY(mgr->deleteEntry(0));
+    QCOMPARE(session.search("user10", false, flags, false, false),
+             mgr->findAll("user10", false, flags, false, false));
+    QVERIFY(!session.wasRefined());
+
+    // Regular expressions always look at every entry
+    session.search("ban", false, flags | PWMS_REGEX, false, false);
+    session.search("bank", false, flags | PWMS_REGEX, false, false);
+    QVERIFY(!session.wasRefined());
+
+    delete mgr;
+}
+
+void TestPwManager::testFoldedText()
+{
+    auto fold = [](const QByteArray& text) {
+        QByteArray folded(text.size() * static_cast<int>(FoldedText::MAX_EXPANSION), '\0');
+        folded.resize(static_cast<int>(FoldedText::fold(text.constData(), static_cast<size_t>(text.size()),
+                                                        folded.data())));
+        return folded;
+    };
+
+    // Same result as QString's case-insensitive contains()
+    const char* aTexts[] = { "Hello World", "STRA\xC3\x9F" "E", "\xC3\x84rger \xC3\xA4RGER",
+                             "\xE2\x84\xAA" "elvin", "\xF0\x90\x90\x80 Deseret", "\xC8\xBA wide", "" };
+    const char* aNeedles[] = { "world", "O W", "stra\xC3\x9F", "\xC3\xA4rger", "K", "kelvin",
+                               "\xF0\x90\x90\xA8", "\xE2\xB1\xA5", "x" };
+    for (const char* pszText : aTexts) {
+        const QByteArray foldedText = fold(pszText);
+        for (const char* pszNeedle : aNeedles) {
+            const QByteArray foldedNeedle = fold(pszNeedle);
+            const bool bFound = FoldedText::contains(foldedText.constData(), static_cast<size_t>(foldedText.size()),
+                                                     foldedNeedle.constData(), static_cast<size_t>(foldedNeedle.size()));
+            QCOMPARE(bFound, QString::fromUtf8(pszText).contains(QString::fromUtf8(pszNeedle), Qt::CaseInsensitive));
+        }
+    }
+
+    // Malformed UTF-8 becomes U+FFFD per byte
+    QCOMPARE(fold("A\xFF\xC3"), QByteArray("a\xEF\xBF\xBD\xEF\xBF\xBD"));
+
+    // Matches at every position and across the 16-byte blocks of the SIMD loop
+    QByteArray haystack(100, 'a');
+    for (int nPos = 0; nPos < 95; ++nPos) {
+        for (int nLength = 1; nLength <= 5 && nPos + nLength <= haystack.size(); ++nLength) {
+            QByteArray text = haystack;
+            QByteArray needle(nLength, 'b');
+            needle[0] = 'x';
+            text.replace(nPos, nLength, needle);
+            const char* pFound = FoldedText::find(text.constData(), static_cast<size_t>(text.size()),
+                                                  needle.constData(), static_cast<size_t>(needle.size()));
+            QVERIFY(pFound == text.constData() + nPos);
+            QVERIFY(FoldedText::find(text.constData(), static_cast<size_t>(nPos + nLength - 1),
+                                     needle.constData(), static_cast<size_t>(needle.size())) == nullptr);
+        }
+    }
+    const char* pszShort = "abc";
+    QVERIFY(FoldedText::find(pszShort, 3, "abcd", 4) == nullptr);
+    QVERIFY(FoldedText::find(pszShort, 3, "", 0) == pszShort);
+
+    // The store follows every change to the entries
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+    for (quint32 g = 1; g <= 2; ++g) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(g == 1 ? "General" : "Internet");
+        group.uGroupId = g;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+    auto addEntry = [mgr](quint32 uGroupId, const QByteArray& baTitle) {
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = uGroupId;
+        entry.pszTitle = const_cast<char*>(baTitle.constData());
+        entry.pszUserName = const_cast<char*>("User");
+        entry.pszURL = const_cast<char*>("");
+        entry.pszPassword = const_cast<char*>("");
+        entry.pszAdditional = const_cast<char*>("Notes \xC3\x84");
+        entry.pszBinaryDesc = const_cast<char*>("");
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        return mgr->addEntry(&entry);
+    };
+    auto storeMatches = [mgr, &fold]() {
+        const FoldedTextStore& store = mgr->getFoldedText();
+        if (store.getRowCount() != mgr->getNumberOfEntries())
+            return false;
+        for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+            const PW_ENTRY* pEntry = mgr->getEntry(i);
+            const char* apszTexts[] = { pEntry->pszTitle, pEntry->pszUserName, pEntry->pszURL, pEntry->pszAdditional };
+            for (int c = 0; c < FoldedTextStore::ColumnCount; ++c) {
+                size_t uLength = 0;
+                const char* pText = store.text(i, static_cast<FoldedTextStore::Column>(c), &uLength);
+                if (QByteArray(pText, static_cast<int>(uLength)) != fold(apszTexts[c]))
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 50; ++i)
+        QVERIFY(addEntry(1 + i % 2, QString("Entry %1 TITLE").arg(i).toUtf8()));
+    QVERIFY(storeMatches());
+
+    QVERIFY(addEntry(2, "Added Later"));
+    QVERIFY(mgr->deleteEntry(5));
+    mgr->moveEntry(1, 0, 10);
+    mgr->sortGroup(2, 0);
+    QCOMPARE(mgr->deleteEntries(QVector<quint32>{ 0, 17, 18, 40 }), 4u);
+    QVERIFY(mgr->setEntryGroup(3, 1));
+    QVERIFY(storeMatches());
+
+    // Replacing texts many times leaves the store compact
+    const QByteArray baLongTitle(2000, 'T');
+    for (int nRound = 0; nRound < 100; ++nRound) {
+        PW_ENTRY changed;
+        std::memset(&changed, 0, sizeof(PW_ENTRY));
+        std::memcpy(changed.uuid, mgr->getEntry(7)->uuid, 16);
+        changed.uGroupId = 1;
+        changed.pszTitle = const_cast<char*>(baLongTitle.constData());
+        changed.pszUserName = const_cast<char*>("");
+        changed.pszURL = const_cast<char*>("");
+        changed.pszPassword = const_cast<char*>("");
+        changed.pszAdditional = const_cast<char*>("");
+        changed.pszBinaryDesc = const_cast<char*>("");
+        PwManager::getNeverExpireTime(&changed.tExpire);
+        QVERIFY(mgr->setEntry(7, &changed));
+    }
+    QVERIFY(storeMatches());
+    const FoldedTextStore::Stats stats = mgr->getFoldedText().getStats();
+    QVERIFY(stats.uUnusedBytes < 100 * 2000);
+    QCOMPARE(stats.uRows, mgr->getNumberOfEntries());
+
+    // Case-insensitive searches read the store
+    QCOMPARE(mgr->findAll("notes \xC3\xA4", false, PWMF_ADDITIONAL, false, false).size(),
+             static_cast<int>(mgr->getNumberOfEntries()) - 1);
+
+    delete mgr;
+}
+
+void TestPwManager::testExpiryIndex()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+    for (quint32 g = 1; g <= 2; ++g) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(g == 1 ? "General" : PWS_BACKUPGROUP);
+        group.uGroupId = g;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    // Half an hour after now, so no entry expires while the test runs
+    const QDateTime dtNow = QDateTime::currentDateTime().addSecs(1800);
+    auto makeEntry = [&dtNow](PW_ENTRY* pEntry, quint32 uGroupId, const char* pszTitle, int nDays) {
+        std::memset(pEntry, 0, sizeof(PW_ENTRY));
+        pEntry->uGroupId = uGroupId;
+        pEntry->pszTitle = const_cast<char*>(pszTitle);
+        pEntry->pszUserName = const_cast<char*>("");
+        pEntry->pszURL = const_cast<char*>("");
+        pEntry->pszPassword = const_cast<char*>("");
+        pEntry->pszAdditional = const_cast<char*>("");
+        pEntry->pszBinaryDesc = const_cast<char*>("");
+        PwUtil::dateTimeToPwTime(dtNow.addDays(nDays), &pEntry->tExpire);
+    };
+    auto addEntry = [mgr, &makeEntry](quint32 uGroupId, const char* pszTitle, int nDays) {
+        PW_ENTRY entry;
+        makeEntry(&entry, uGroupId, pszTitle, nDays);
+        return mgr->addEntry(&entry);
+    };
+
+    // References: the loops over all entries the queries used to be
+    auto isListed = [mgr](quint32 i) {
+        const PW_ENTRY* pEntry = mgr->getEntry(i);
+        return pEntry->uGroupId != 2 && std::strcmp(pEntry->pszTitle, "<TAN>") != 0;
+    };
+    auto expectedExpired = [mgr, &isListed]() {
+        PW_TIME tNow;
+        PwUtil::getCurrentTime(&tNow);
+        QList<quint32> vExpected;
+        for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+            if (isListed(i) && PwUtil::compareTime(&tNow, &mgr->getEntry(i)->tExpire) > 0)
+                vExpected.append(i);
+        }
+        return vExpected;
+    };
+    auto expectedSoon = [mgr, &isListed](int nDays) {
+        auto date = [](const PW_TIME& t) {
+            return (static_cast<quint32>(t.shYear) * 13 * 32) + (static_cast<quint32>(t.btMonth) * 32) + t.btDay;
+        };
+        PW_TIME tNow;
+        PwUtil::getCurrentTime(&tNow);
+        QList<quint32> vExpected;
+        for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+            const quint32 dwDate = date(mgr->getEntry(i)->tExpire);
+            if (isListed(i) && dwDate >= date(tNow) && dwDate - date(tNow) <= static_cast<quint32>(nDays))
+                vExpected.append(i);
+        }
+        return vExpected;
+    };
+    auto indexMatches = [mgr, &expectedExpired, &expectedSoon]() {
+        return mgr->getExpiryIndex().getCount() == mgr->getNumberOfEntries() &&
+               mgr->findExpiredEntries() == expectedExpired() &&
+               mgr->findSoonToExpireEntries(7) == expectedSoon(7) &&
+               mgr->findSoonToExpireEntries(45) == expectedSoon(45);  // Spans month ends
+    };
+
+    for (int i = 0; i < 60; ++i)
+        QVERIFY(addEntry((i % 10 == 9) ? 2 : 1, (i % 7 == 3) ? "<TAN>" : "Entry", (i * 37) % 61 - 30));
+    QVERIFY(!expectedExpired().isEmpty());
+    QVERIFY(!expectedSoon(7).isEmpty());
+    QVERIFY(indexMatches());
+
+    // The index follows every change to the entries
+    QVERIFY(addEntry(1, "Added Later", -1));
+    QVERIFY(mgr->deleteEntry(5));
+    mgr->moveEntry(1, 0, 10);
+    mgr->sortGroup(1, 8);  // By expiration time
+    QCOMPARE(mgr->deleteEntries(QVector<quint32>{ 0, 17, 18, 40 }), 4u);
+    PW_TIME tExpire;
+    PwUtil::dateTimeToPwTime(dtNow.addDays(3), &tExpire);
+    QVERIFY(mgr->setEntryExpiry(3, &tExpire));
+    PW_ENTRY changed;
+    makeEntry(&changed, 1, "Changed", -2);
+    std::memcpy(changed.uuid, mgr->getEntry(7)->uuid, 16);
+    QVERIFY(mgr->setEntry(7, &changed));
+    QVERIFY(indexMatches());
+
+    // Time ranges and the next expiration
+    PW_TIME tFrom, tTo, tNext;
+    PwUtil::dateTimeToPwTime(dtNow.addDays(-3), &tFrom);
+    PwUtil::dateTimeToPwTime(dtNow.addDays(3), &tTo);
+    QList<quint32> vExpected;
+    const PW_TIME* pFirst = nullptr;
+    for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+        const PW_TIME* pExpire = &mgr->getEntry(i)->tExpire;
+        if (PwUtil::compareTime(pExpire, &tFrom) < 0)
+            continue;
+        if (PwUtil::compareTime(pExpire, &tTo) < 0)
+            vExpected.append(i);
+        if (pFirst == nullptr || PwUtil::compareTime(pExpire, pFirst) < 0)
+            pFirst = pExpire;
+    }
+    QCOMPARE(mgr->findEntriesExpiringIn(&tFrom, &tTo, false, false), vExpected);
+    QVERIFY(mgr->findNextExpiry(&tFrom, &tNext));
+    QCOMPARE(PwUtil::compareTime(&tNext, pFirst), 0);
+    PwUtil::dateTimeToPwTime(dtNow.addYears(5000), &tFrom);
+    QVERIFY(!mgr->findNextExpiry(&tFrom, &tNext));
+
+    delete mgr;
+}
+
+void TestPwManager::testExpiryScheduler()
+{
+    qRegisterMetaType<QList<quint32>>();
+
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+    mgr->setMasterKey("test", false, "", true, "");
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.pszGroupName = const_cast<char*>("General");
+    group.uGroupId = 1;
+    PwManager::getNeverExpireTime(&group.tExpire);
+    QVERIFY(mgr->addGroup(&group));
+
+    // Expired yesterday, expires in a second, never expires
+    const QDateTime dtNow = QDateTime::currentDateTime();
+    for (int i = 0; i < 3; ++i) {
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 1;
+        entry.pszTitle = const_cast<char*>("Entry");
+        entry.pszUserName = const_cast<char*>("");
+        entry.pszURL = const_cast<char*>("");
+        entry.pszPassword = const_cast<char*>("");
+        entry.pszAdditional = const_cast<char*>("");
+        entry.pszBinaryDesc = const_cast<char*>("");
+        if (i == 2)
+            PwManager::getNeverExpireTime(&entry.tExpire);
+        else
+            PwUtil::dateTimeToPwTime((i == 0) ? dtNow.addDays(-1) : dtNow.addSecs(1), &entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    ExpiryScheduler scheduler(mgr);
+    QSignalSpy spy(&scheduler, &ExpiryScheduler::entriesExpired);
+    scheduler.start();
+    QVERIFY(scheduler.isActive());
+    QVERIFY(scheduler.remainingTime() <= 2000);  // Armed for the entry, no polling
+
+    // Only the entry that expired while the scheduler ran is reported
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<QList<quint32>>(), QList<quint32>{ 1 });
+    QVERIFY(scheduler.remainingTime() > 2000);
+
+    scheduler.stop();
+    QVERIFY(!scheduler.isActive());
+    QCOMPARE(scheduler.remainingTime(), -1);
+
+    delete mgr;
+}
+
+void TestPwManager::testGroupTreeIndex()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    // Tree:  A { A1, A2 { A2a } }, B
+    const char* names[] = { "A", "A1", "A2", "A2a", "B" };
+    const quint16 levels[] = { 0, 1, 1, 2, 0 };
+    for (int i = 0; i < 5; ++i) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(names[i]);
+        group.uGroupId = static_cast<quint32>(10 + i);
+        group.usLevel = levels[i];
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    const quint32 ROOT = 0xFFFFFFFF;
+    QCOMPARE(mgr->getGroupChildCount(ROOT), 2u);
+    QCOMPARE(mgr->getGroupChildN(ROOT, 0), 0u);
+    QCOMPARE(mgr->getGroupChildN(ROOT, 1), 4u);
+    QCOMPARE(mgr->getGroupChildCount(0), 2u);
+    QCOMPARE(mgr->getGroupChildN(0, 1), 2u);
+    QCOMPARE(mgr->getGroupChildN(0, 2), ROOT);
+    QCOMPARE(mgr->getGroupParentN(3), 2u);
+    QCOMPARE(mgr->getGroupParentN(4), ROOT);
+    QCOMPARE(mgr->getGroupRowN(2), 1u);
+    QCOMPARE(mgr->getGroupIndex(mgr->getGroup(3)), 3u);
+    QCOMPARE(mgr->getLastChildGroup(0), 3u);
+
+    quint32 path[3] = { 0, 0, 0 };
+    QVERIFY(mgr->getGroupTree(13, path));
+    QCOMPARE(path[0], 0u);
+    QCOMPARE(path[1], 2u);
+    QCOMPARE(path[2], 3u);
+
+    // ID and case-insensitive name lookups
+    QCOMPARE(mgr->getGroupByIdN(12), 2u);
+    QCOMPARE(mgr->getGroupId("a2A"), 13u);
+    QCOMPARE(mgr->getGroupId("missing"), ROOT);
+
+    // Renaming re-keys the name index
+    PW_GROUP renamed = *mgr->getGroup(4);
+    renamed.pszGroupName = const_cast<char*>("Renamed");
+    QVERIFY(mgr->setGroup(4, &renamed));
+    QCOMPARE(mgr->getGroupId("B"), ROOT);
+    QCOMPARE(mgr->getGroupId("renamed"), 14u);
+
+    // Deleting a group shifts the following groups and relinks the tree
+    QVERIFY(mgr->deleteGroupById(11, false));
+    QCOMPARE(mgr->getGroupByIdN(12), 1u);
+    QCOMPARE(mgr->getGroupChildCount(0), 1u);
+    QCOMPARE(mgr->getGroupParentN(2), 1u);
+    QCOMPARE(mgr->getGroupRowN(3), 1u);
+    QCOMPARE(mgr->getGroupChildN(0, 0), 1u);
+    QCOMPARE(mgr->getGroupChildN(ROOT, 1), 3u);
+    QCOMPARE(mgr->getGroupId("A1"), ROOT);
+
+    delete mgr;
+}
+
+void TestPwManager::testGroupEntryLists()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    for (quint32 id = 1; id <= 2; ++id) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(id == 1 ? "One" : "Two");
+        group.uGroupId = id;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    // Entries 0..5 alternate between group 1 and group 2
+    for (int i = 0; i < 6; ++i) {
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = static_cast<quint32>(1 + (i % 2));
+        entry.uImageId = static_cast<quint32>(i);  // Tag to identify entries
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(1), 3u);
+    QCOMPARE(mgr->getNumberOfItemsInGroup("two"), 3u);
+    QCOMPARE(mgr->getEntryByGroupN(2, 1), 3u);
+    QCOMPARE(mgr->getEntryByGroupN(2, 3), 0xFFFFFFFFu);
+    QCOMPARE(mgr->getEntryPosInGroup(mgr->getEntry(4)), 2u);
+
+    // Move the first entry of group 1 to the end of that group
+    mgr->moveEntry(1, 0, 2);
+    QCOMPARE(mgr->getEntryByGroup(1, 0)->uImageId, 2u);
+    QCOMPARE(mgr->getEntryByGroup(1, 1)->uImageId, 4u);
+    QCOMPARE(mgr->getEntryByGroup(1, 2)->uImageId, 0u);
+    QCOMPARE(mgr->getEntryByGroup(2, 0)->uImageId, 1u);
+    QCOMPARE(mgr->getEntryByGroup(2, 2)->uImageId, 5u);
+
+    // Move an entry to the other group
+    QVERIFY(mgr->setEntryGroup(mgr->getEntryByGroupN(2, 0), 1));
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(1), 4u);
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(2), 2u);
+    QCOMPARE(mgr->getEntryByGroup(1, 0)->uImageId, 1u);
+
+    // Deleting shifts the indexes of later entries in every group
+    QVERIFY(mgr->deleteEntry(0));
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(1), 3u);
+    for (quint32 id = 1; id <= 2; ++id) {
+        for (quint32 n = 0; n < mgr->getNumberOfItemsInGroupN(id); ++n) {
+            PW_ENTRY* entry = mgr->getEntryByGroup(id, n);
+            QVERIFY(entry != nullptr);
+            QCOMPARE(entry->uGroupId, id);
+            QCOMPARE(mgr->getEntryPosInGroup(entry), n);
+        }
+    }
+
+    delete mgr;
+}
+
+void TestPwManager::testAddEntries()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.pszGroupName = const_cast<char*>("Batch");
+    group.uGroupId = 7;
+    PwManager::getNeverExpireTime(&group.tExpire);
+    QVERIFY(mgr->addGroup(&group));
+
+    mgr->reserveEntries(500);
+    QCOMPARE(mgr->getNumberOfEntries(), 0u);
+
+    QVector<PW_ENTRY> templates(500);
+    for (int i = 0; i < templates.size(); ++i) {
+        PW_ENTRY& entry = templates[i];
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = 7;
+        entry.uImageId = static_cast<quint32>(i % 50);
+        entry.pszTitle = const_cast<char*>("Title");
+        entry.pszPassword = const_cast<char*>("secret");
+        entry.uPasswordLen = 6;
+        PwManager::getNeverExpireTime(&entry.tExpire);
+    }
+
+    // A single invalid group ID rejects the whole batch
+    templates[250].uGroupId = 0;
+    QVERIFY(!mgr->addEntries(templates.constData(), static_cast<quint32>(templates.size())));
+    QCOMPARE(mgr->getNumberOfEntries(), 0u);
+
+    templates[250].uGroupId = 7;
+    QVERIFY(mgr->addEntries(templates.constData(), static_cast<quint32>(templates.size())));
+    QCOMPARE(mgr->getNumberOfEntries(), 500u);
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(7), 500u);
+
+    // Zero UUIDs are replaced by unique random ones
+    QSet<QByteArray> uuids;
+    for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+        PW_ENTRY* entry = mgr->getEntry(i);
+        QByteArray uuid(reinterpret_cast<const char*>(entry->uuid), 16);
+        QVERIFY(uuid != QByteArray(16, '\0'));
+        uuids.insert(uuid);
+        QCOMPARE(mgr->getEntryByUuidN(entry->uuid), i);
+    }
+    QCOMPARE(uuids.size(), 500);
+
+    // Passwords are stored locked, like addEntry
+    PW_ENTRY* entry = mgr->getEntry(123);
+    mgr->unlockEntryPassword(entry);
+    QCOMPARE(QByteArray(entry->pszPassword), QByteArray("secret"));
+    mgr->lockEntryPassword(entry);
+
+    delete mgr;
+}
+
+void TestPwManager::testStringArena()
+{
+    StringArena arena;
+
+    char* psz = arena.dup("Hello");
+    QCOMPARE(QByteArray(psz), QByteArray("Hello"));
+    QCOMPARE(QByteArray(arena.dup(nullptr)), QByteArray(""));
+
+    // A value that fits is written over the old one
+    QCOMPARE(arena.assign(psz, "Hi"), psz);
+    QCOMPARE(QByteArray(psz), QByteArray("Hi"));
+    QCOMPARE(arena.assign(psz, psz), psz);
+    QCOMPARE(arena.getStats().uInPlaceUpdates, 1ull);
+
+    // A longer value moves, and the old block is recycled
+    char* pszLong = arena.assign(psz, "A considerably longer string");
+    QVERIFY(pszLong != psz);
+    QCOMPARE(QByteArray(pszLong), QByteArray("A considerably longer string"));
+    QCOMPARE(arena.dup("Bye"), psz);
+    QCOMPARE(arena.getStats().uRecycledBlocks, 1ull);
+
+    // Large strings do not disturb the slab being filled
+    const QByteArray big(100000, 'x');
+    char* pszBig = arena.dup(big.constData());
+    QCOMPARE(QByteArray(pszBig), big);
+    QCOMPARE(QByteArray(pszLong), QByteArray("A considerably longer string"));
+    QCOMPARE(arena.getStats().uSlabAllocations, 2ull);
+
+    arena.clear();
+    QCOMPARE(arena.getStats().uBytesReserved, size_t(0));
+
+    // Entry strings live in the manager's arena; edits reuse their blocks
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    PW_GROUP group;
+    std::memset(&group, 0, sizeof(PW_GROUP));
+    group.pszGroupName = const_cast<char*>("Arena");
+    group.uGroupId = 1;
+    PwManager::getNeverExpireTime(&group.tExpire);
+    QVERIFY(mgr->addGroup(&group));
+
+    PW_ENTRY entry;
+    std::memset(&entry, 0, sizeof(PW_ENTRY));
+    entry.uGroupId = 1;
+    entry.pszTitle = const_cast<char*>("Long original title");
+    entry.pszUserName = const_cast<char*>("");
+    entry.pszURL = const_cast<char*>("");
+    entry.pszPassword = const_cast<char*>("password");
+    entry.pszAdditional = const_cast<char*>("");
+    PwManager::getNeverExpireTime(&entry.tExpire);
+    QVERIFY(mgr->addEntry(&entry));
+
+    const StringArena::Stats before = mgr->getStringMemoryStats();
+    std::memcpy(entry.uuid, mgr->getEntry(0)->uuid, 16);
+    entry.pszTitle = const_cast<char*>("Short");
+    entry.pszPassword = const_cast<char*>("new pass");
+    QVERIFY(mgr->setEntry(0, &entry));
+    QCOMPARE(mgr->getStringMemoryStats().uStringAllocations, before.uStringAllocations);
+    QCOMPARE(QByteArray(mgr->getEntry(0)->pszTitle), QByteArray("Short"));
+
+    PW_ENTRY* stored = mgr->getEntry(0);
+    mgr->unlockEntryPassword(stored);
+    QCOMPARE(QByteArray(stored->pszPassword), QByteArray("new pass"));
+    mgr->lockEntryPassword(stored);
+
+    QVERIFY(mgr->deleteEntry(0));
+    QVERIFY(mgr->addEntry(&entry));
+    QVERIFY(mgr->getStringMemoryStats().uRecycledBlocks > before.uRecycledBlocks);
+
+    delete mgr;
+}
+
+void TestPwManager::testSecureArena()
+{
+    // The arena is shared by the whole process, so only differences count
+    const SecureArena::Stats before = SecureArena::getStats();
+
+    // Blocks are zero-filled, aligned and at least as large as requested
+    quint8* p = static_cast<quint8*>(SecureArena::allocate(40));
+    QVERIFY(p != nullptr);
+    QCOMPARE(reinterpret_cast<quintptr>(p) % 16, quintptr(0));
+    QVERIFY(SecureArena::capacity(p) >= 40);
+    QCOMPARE(QByteArray(reinterpret_cast<const char*>(p), 40), QByteArray(40, 0));
+    std::memset(p, 0xAB, 40);
+
+    // A released block is erased and handed out again for the same size class
+    SecureArena::release(p);
+    quint8* q = static_cast<quint8*>(SecureArena::allocate(33));
+    QCOMPARE(q, p);
+    QCOMPARE(QByteArray(reinterpret_cast<const char*>(q), 33), QByteArray(33, 0));
+    SecureArena::release(q);
+
+    // Large blocks get a mapping of their own and are reused as well
+    quint8* pLarge = static_cast<quint8*>(SecureArena::allocate(100000));
+    QVERIFY(pLarge != nullptr);
+    QVERIFY(SecureArena::capacity(pLarge) >= 100000);
+    pLarge[99999] = 1;
+    SecureArena::release(pLarge);
+    quint8* qLarge = static_cast<quint8*>(SecureArena::allocate(90000));
+    QCOMPARE(qLarge, pLarge);
+    QCOMPARE(qLarge[99999], quint8(0));
+    SecureArena::release(qLarge);
+
+    // Many small blocks share one mapping instead of one lock call each
+    QVector<void*> vBlocks;
+    for (int i = 0; i < 1000; ++i)
+        vBlocks.append(SecureArena::allocate(static_cast<size_t>(i % 200)));
+    for (void* pBlock : vBlocks)
+        SecureArena::release(pBlock);
+
+    const SecureArena::Stats after = SecureArena::getStats();
+    QCOMPARE(after.uAllocations - before.uAllocations, 1004ull);
+    QVERIFY(after.uRecycledBlocks - before.uRecycledBlocks >= 2);
+    QVERIFY(after.uLockCalls - before.uLockCalls < 10);
+    QVERIFY(after.uSyscallsSaved > before.uSyscallsSaved);
+    QCOMPARE(after.uBytesInUse, before.uBytesInUse);
+    QVERIFY(after.uBytesLockedPeak >= after.uBytesLocked);
+
+    // SecureMemory and the key storage of PwManager come from the arena
+    {
+        SecureMemory<quint32> mem(8);
+        QCOMPARE(mem[7], 0u);
+        QCOMPARE(mem.isLocked(), SecureArena::isLocked(mem.data()));
+        QCOMPARE(SecureArena::getStats().uBytesInUse, after.uBytesInUse + SecureArena::capacity(mem.data()));
+    }
+    QCOMPARE(SecureArena::getStats().uBytesInUse, after.uBytesInUse);
+
+    PwManager* mgr = createTestManager();
+    QVERIFY(SecureArena::getStats().uBytesInUse > after.uBytesInUse);
+    delete mgr;
+    QCOMPARE(SecureArena::getStats().uBytesInUse, after.uBytesInUse);
+}
+
+void TestPwManager::testDeleteEntries()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    for (quint32 id = 1; id <= 2; ++id) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(id == 1 ? "Keep" : "Drop");
+        group.uGroupId = id;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    // Entries alternate between the groups; uImageId tags their original position
+    QVector<PW_ENTRY> templates(200);
+    for (int i = 0; i < templates.size(); ++i) {
+        PW_ENTRY& entry = templates[i];
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = static_cast<quint32>(1 + (i % 2));
+        entry.uImageId = static_cast<quint32>(i);
+        entry.pszTitle = const_cast<char*>("Entry");
+        entry.pszPassword = const_cast<char*>("pw");
+        PwManager::getNeverExpireTime(&entry.tExpire);
+    }
+    QVERIFY(mgr->addEntries(templates.constData(), static_cast<quint32>(templates.size())));
+
+    // Index sets may be unsorted and contain duplicates or invalid indexes
+    QCOMPARE(mgr->deleteEntries(QVector<quint32>{ 4, 0, 4, 2, 5000 }), 3u);
+    QCOMPARE(mgr->getNumberOfEntries(), 197u);
+    QCOMPARE(mgr->getEntry(0)->uImageId, 1u);
+    QCOMPARE(mgr->getEntry(1)->uImageId, 3u);
+    QCOMPARE(mgr->getEntry(2)->uImageId, 5u);
+    QCOMPARE(mgr->getEntry(3)->uImageId, 6u);
+
+    QCOMPARE(mgr->deleteEntries([](const PW_ENTRY* pe) { return pe->uImageId >= 190; }), 10u);
+    QCOMPARE(mgr->getNumberOfEntries(), 187u);
+
+    // Deleting a group backs up all its entries in one batch
+    const quint32 dropCount = mgr->getNumberOfItemsInGroupN(2);
+    QVERIFY(mgr->deleteGroupById(2, true));
+    const quint32 backupId = mgr->getGroupId("Backup");
+    QVERIFY(backupId != 0xFFFFFFFF);
+    QCOMPARE(mgr->getNumberOfItemsInGroupN(backupId), dropCount);
+    QCOMPARE(mgr->getNumberOfEntries(), mgr->getNumberOfItemsInGroupN(1) + dropCount);
+
+    // Remaining entries keep their order, and all indexes are consistent
+    quint32 lastKept = 0;
+    for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+        PW_ENTRY* entry = mgr->getEntry(i);
+        QVERIFY(entry->uGroupId == 1 || entry->uGroupId == backupId);
+        QCOMPARE(mgr->getEntryByUuidN(entry->uuid), i);
+        if (entry->uGroupId == 1) {
+            QVERIFY(i == 0 || entry->uImageId > lastKept);
+            lastKept = entry->uImageId;
+        } else {
+            mgr->unlockEntryPassword(entry);
+            QCOMPARE(QByteArray(entry->pszPassword), QByteArray("pw"));
+            mgr->lockEntryPassword(entry);
+        }
+    }
+
+    delete mgr;
+}
+
+void TestPwManager::testSortGroups()
+{
+    PwManager* mgr = createTestManager();
+    mgr->newDatabase();
+
+    // Flat pre-order list: zulu { beta, Alpha { x } }, alpha, Mike
+    struct { const char* name; quint16 level; } groups[] = {
+        { "zulu", 0 }, { "beta", 1 }, { "Alpha", 1 }, { "x", 2 }, { "alpha", 0 }, { "Mike", 0 }
+    };
+    quint32 id = 1;
+    for (const auto& g : groups) {
+        PW_GROUP group;
+        std::memset(&group, 0, sizeof(PW_GROUP));
+        group.pszGroupName = const_cast<char*>(g.name);
+        group.uGroupId = id++;
+        group.usLevel = g.level;
+        PwManager::getNeverExpireTime(&group.tExpire);
+        QVERIFY(mgr->addGroup(&group));
+    }
+
+    // Siblings are sorted, subtrees move with their parents
+    mgr->sortGroupList();
+    const char* expected[] = { "alpha", "Mike", "zulu", "Alpha", "x", "beta" };
+    const quint16 levels[] = { 0, 0, 0, 1, 2, 1 };
+    for (quint32 i = 0; i < 6; ++i) {
+        QCOMPARE(QByteArray(mgr->getGroup(i)->pszGroupName), QByteArray(expected[i]));
+        QCOMPARE(mgr->getGroup(i)->usLevel, levels[i]);
+    }
+    QCOMPARE(mgr->getGroupParentN(mgr->getGroupByIdN(4)), mgr->getGroupByIdN(3));
+
+    // Entries of group 1 interleaved with an entry of group 2
+    const char* titles[] = { "delta", "Bravo", "charlie", "alpha" };
+    const char* passwords[] = { "b", "D", "a", "c" };
+    for (int i = 0; i < 4; ++i) {
+        PW_ENTRY entry;
+        std::memset(&entry, 0, sizeof(PW_ENTRY));
+        entry.uGroupId = (i == 2) ? 2 : 1;
+        entry.uImageId = static_cast<quint32>(i);
+        entry.pszTitle = const_cast<char*>(titles[i]);
+        entry.pszPassword = const_cast<char*>(passwords[i]);
+        PwManager::getNeverExpireTime(&entry.tExpire);
+        QVERIFY(mgr->addEntry(&entry));
+    }
+
+    mgr->sortGroup(1, 0);
+    QCOMPARE(QByteArray(mgr->getEntryByGroup(1, 0)->pszTitle), QByteArray("alpha"));
+    QCOMPARE(QByteArray(mgr->getEntryByGroup(1, 1)->pszTitle), QByteArray("Bravo"));
+    QCOMPARE(QByteArray(mgr->getEntryByGroup(1, 2)->pszTitle), QByteArray("delta"));
+    QCOMPARE(mgr->getEntry(2)->uImageId, 2u);  // Other group's entry stays put
+
+    mgr->sortGroup(1, 3);
+    QCOMPARE(mgr->getEntryByGroup(1, 0)->uImageId, 0u);  // "b"
+    QCOMPARE(mgr->getEntryByGroup(1, 1)->uImageId, 3u);  // "c"
+    QCOMPARE(mgr->getEntryByGroup(1, 2)->uImageId, 1u);  // "D"
+    PW_ENTRY* entry = mgr->getEntryByGroup(1, 2);
+    mgr->unlockEntryPassword(entry);
+    QCOMPARE(QByteArray(entry->pszPassword), QByteArray("D"));
+    mgr->lockEntryPassword(entry);
+
+    for (quint32 i = 0; i < mgr->getNumberOfEntries(); ++i) {
+        QCOMPARE(mgr->getEntryByUuidN(mgr->getEntry(i)->uuid), i);
+    }
+
+    delete mgr;
+}
+
 //==============================================================================
 // Password Generator Tests
 //==============================================================================